@@ -0,0 +1,292 @@
+/*
+ * ArenaBenchmarks.cpp
+ *
+ * arenaPush against malloc and std::vector, single threaded and with
+ * several threads sharing one atomic arena or owning one arena each.
+ */
+
+#include "Benchmark.h"
+#include "Runtime/Memory/Arena.h"
+#include <atomic>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+#define ARENA_BENCHMARK_ITEM_SIZE 16 ///< Bytes per push, a small component or node
+
+struct ArenaItem
+{
+	uint64_t a;
+	uint64_t b;
+};
+static_assert(sizeof(ArenaItem) == ARENA_BENCHMARK_ITEM_SIZE, "ArenaItem size mismatch");
+
+// Reserve sized so the timed pushes never chain, chaining is measured by arena/push_chained
+static uint64_t arenaReserveFor(uint32_t count)
+{
+	return (uint64_t)count * ARENA_BENCHMARK_ITEM_SIZE + Megabyte(1);
+}
+
+///////////////////////////////////////////
+// Single threaded
+
+struct ArenaPushState
+{
+	const BenchmarkParams* pParams;
+	Arena* pArena;
+	void** ppItems; ///< malloc/push only
+	std::vector<ArenaItem> items;
+};
+
+static void* setupArenaPush(const BenchmarkParams* pParams)
+{
+	ArenaParams arenaParams = {};
+	arenaParams.reserveSize = arenaReserveFor(pParams->size);
+	arenaParams.pName = "Benchmark";
+
+	ArenaPushState* pState = new ArenaPushState();
+	pState->pParams = pParams;
+	pState->pArena = arenaCreate(&arenaParams);
+	return pState;
+}
+
+static void* setupArenaPushChained(const BenchmarkParams* pParams)
+{
+	ArenaPushState* pState = new ArenaPushState();
+	pState->pParams = pParams;
+	pState->pArena = arenaCreate(nullptr);
+	return pState;
+}
+
+static void runArenaPush(void* pOpaque)
+{
+	ArenaPushState* pState = (ArenaPushState*)pOpaque;
+	uint64_t sum = 0;
+	for (uint32_t i = 0; i < pState->pParams->size; i++)
+	{
+		ArenaItem* pItem = (ArenaItem*)arenaPush(pState->pArena, sizeof(ArenaItem), 8);
+		pItem->a = i;
+		sum += (uint64_t)(uintptr_t)pItem;
+	}
+	benchmarkConsume(sum);
+}
+
+static void teardownArenaPush(void* pOpaque)
+{
+	ArenaPushState* pState = (ArenaPushState*)pOpaque;
+	arenaRelease(pState->pArena);
+	delete pState;
+}
+
+static void* setupMallocPush(const BenchmarkParams* pParams)
+{
+	ArenaPushState* pState = new ArenaPushState();
+	pState->pParams = pParams;
+	pState->ppItems = (void**)malloc(sizeof(void*) * pParams->size);
+	return pState;
+}
+
+static void runMallocPush(void* pOpaque)
+{
+	ArenaPushState* pState = (ArenaPushState*)pOpaque;
+	for (uint32_t i = 0; i < pState->pParams->size; i++)
+	{
+		ArenaItem* pItem = (ArenaItem*)malloc(sizeof(ArenaItem));
+		pItem->a = i;
+		pState->ppItems[i] = pItem;
+	}
+}
+
+static void teardownMallocPush(void* pOpaque)
+{
+	ArenaPushState* pState = (ArenaPushState*)pOpaque;
+	for (uint32_t i = 0; i < pState->pParams->size; i++)
+		free(pState->ppItems[i]);
+	free(pState->ppItems);
+	delete pState;
+}
+
+static void* setupVectorPush(const BenchmarkParams* pParams)
+{
+	ArenaPushState* pState = new ArenaPushState();
+	pState->pParams = pParams;
+	return pState;
+}
+
+static void runVectorPush(void* pOpaque)
+{
+	ArenaPushState* pState = (ArenaPushState*)pOpaque;
+	for (uint32_t i = 0; i < pState->pParams->size; i++)
+		pState->items.push_back({ i, 0 });
+	benchmarkConsume(pState->items.size());
+}
+
+static void teardownVectorPush(void* pOpaque)
+{
+	delete (ArenaPushState*)pOpaque;
+}
+
+/*
+	arena/push_pop pops back to the start every 1024 pushes, the per frame
+	scratch pattern. The same few pages are reused, so this is the pure
+	bump cost.
+*/
+static void runArenaPushPop(void* pOpaque)
+{
+	ArenaPushState* pState = (ArenaPushState*)pOpaque;
+	uint64_t start = arenaGetPos(pState->pArena);
+	uint64_t sum = 0;
+	for (uint32_t i = 0; i < pState->pParams->size; i++)
+	{
+		if ((i & 1023) == 0)
+			arenaPopTo(pState->pArena, start);
+
+		ArenaItem* pItem = (ArenaItem*)arenaPush(pState->pArena, sizeof(ArenaItem), 8);
+		pItem->a = i;
+		sum += (uint64_t)(uintptr_t)pItem;
+	}
+	benchmarkConsume(sum);
+}
+
+///////////////////////////////////////////
+// Multithreaded
+
+/*
+	Workers are spawned during setup and spin until the run starts them,
+	so thread creation stays out of the measurement. Each pushes its share
+	of size items.
+*/
+struct ArenaThreadState
+{
+	const BenchmarkParams* pParams;
+	std::vector<std::thread> threads;
+	std::vector<Arena*> arenas;			 ///< One shared atomic arena, or one per thread
+	std::vector<void**> itemsPerThread; ///< malloc/push_mt only
+	std::atomic<uint32_t> start;
+	bool shared;
+	bool useMalloc;
+};
+
+static uint32_t threadItemCount(const BenchmarkParams* pParams, uint32_t threadIndex)
+{
+	uint32_t count = pParams->size / pParams->threadCount;
+	return threadIndex == 0 ? count + pParams->size % pParams->threadCount : count;
+}
+
+static void arenaWorker(ArenaThreadState* pState, uint32_t threadIndex)
+{
+	while (pState->start.load(std::memory_order_acquire) == 0)
+		std::this_thread::yield();
+
+	uint32_t count = threadItemCount(pState->pParams, threadIndex);
+	uint64_t sum = 0;
+	if (pState->useMalloc)
+	{
+		void** ppItems = pState->itemsPerThread[threadIndex];
+		for (uint32_t i = 0; i < count; i++)
+		{
+			ArenaItem* pItem = (ArenaItem*)malloc(sizeof(ArenaItem));
+			pItem->a = i;
+			ppItems[i] = pItem;
+		}
+	}
+	else
+	{
+		Arena* pArena = pState->arenas[pState->shared ? 0 : threadIndex];
+		for (uint32_t i = 0; i < count; i++)
+		{
+			ArenaItem* pItem = (ArenaItem*)arenaPush(pArena, sizeof(ArenaItem), 8);
+			pItem->a = i;
+			sum += (uint64_t)(uintptr_t)pItem;
+		}
+	}
+	benchmarkConsume(sum);
+}
+
+static ArenaThreadState* setupArenaThreads(const BenchmarkParams* pParams, bool shared,
+										   bool useMalloc)
+{
+	ArenaThreadState* pState = new ArenaThreadState();
+	pState->pParams = pParams;
+	pState->start.store(0);
+	pState->shared = shared;
+	pState->useMalloc = useMalloc;
+
+	uint32_t arenaCount = useMalloc ? 0 : (shared ? 1 : pParams->threadCount);
+	for (uint32_t i = 0; i < arenaCount; i++)
+	{
+		ArenaParams arenaParams = {};
+		arenaParams.flags = shared ? ArenaFlag_Atomic : ArenaFlag_None;
+		arenaParams.reserveSize = arenaReserveFor(shared ? pParams->size
+														 : threadItemCount(pParams, i));
+		arenaParams.pName = "Benchmark";
+		pState->arenas.push_back(arenaCreate(&arenaParams));
+	}
+
+	if (useMalloc)
+	{
+		for (uint32_t i = 0; i < pParams->threadCount; i++)
+			pState->itemsPerThread.push_back(
+				(void**)malloc(sizeof(void*) * (threadItemCount(pParams, i) + 1)));
+	}
+
+	for (uint32_t i = 0; i < pParams->threadCount; i++)
+		pState->threads.emplace_back(arenaWorker, pState, i);
+	return pState;
+}
+
+static void* setupArenaSharedThreads(const BenchmarkParams* pParams)
+{
+	return setupArenaThreads(pParams, true, false);
+}
+
+static void* setupArenaLocalThreads(const BenchmarkParams* pParams)
+{
+	return setupArenaThreads(pParams, false, false);
+}
+
+static void* setupMallocThreads(const BenchmarkParams* pParams)
+{
+	return setupArenaThreads(pParams, false, true);
+}
+
+static void runArenaThreads(void* pOpaque)
+{
+	ArenaThreadState* pState = (ArenaThreadState*)pOpaque;
+	pState->start.store(1, std::memory_order_release);
+	for (std::thread& thread : pState->threads)
+		thread.join();
+}
+
+static void teardownArenaThreads(void* pOpaque)
+{
+	ArenaThreadState* pState = (ArenaThreadState*)pOpaque;
+	for (Arena* pArena : pState->arenas)
+		arenaRelease(pArena);
+
+	for (uint32_t t = 0; t < (uint32_t)pState->itemsPerThread.size(); t++)
+	{
+		void** ppItems = pState->itemsPerThread[t];
+		uint32_t count = threadItemCount(pState->pParams, t);
+		for (uint32_t i = 0; i < count; i++)
+			free(ppItems[i]);
+		free(ppItems);
+	}
+	delete pState;
+}
+
+void addArenaBenchmarks()
+{
+	addBenchmark({ "arena/push", setupArenaPush, runArenaPush, teardownArenaPush });
+	addBenchmark({ "arena/push_chained", setupArenaPushChained, runArenaPush, teardownArenaPush });
+	addBenchmark({ "arena/push_pop", setupArenaPush, runArenaPushPop, teardownArenaPush });
+	addBenchmark({ "malloc/push", setupMallocPush, runMallocPush, teardownMallocPush });
+	addBenchmark({ "std::vector/push_back", setupVectorPush, runVectorPush, teardownVectorPush });
+
+	addBenchmark({ "arena/push_mt_shared", setupArenaSharedThreads, runArenaThreads,
+				   teardownArenaThreads, BenchmarkFlag_Threads });
+	addBenchmark({ "arena/push_mt_local", setupArenaLocalThreads, runArenaThreads,
+				   teardownArenaThreads, BenchmarkFlag_Threads });
+	addBenchmark({ "malloc/push_mt", setupMallocThreads, runArenaThreads, teardownArenaThreads,
+				   BenchmarkFlag_Threads });
+}
@@ -0,0 +1,78 @@
+/*
+ * Benchmark.h
+ *
+ * Microbenchmark harness for the Core containers and the arena allocator.
+ */
+
+#ifndef _BENCHMARK_H_
+#define _BENCHMARK_H_
+
+#include <stdint.h>
+
+/**
+	Benchmark variations run by the harness.
+
+	Every benchmark runs once per element count. Flags add the access
+	pattern and thread count axes on top.
+*/
+enum BenchmarkFlags : uint32_t
+{
+	BenchmarkFlag_None = 0,
+	BenchmarkFlag_Random = (1 << 0),  ///< Also run with BenchmarkParams::pOrder shuffled
+	BenchmarkFlag_Threads = (1 << 1), ///< Run at 1, 2, 4 ... up to --threads threads
+};
+
+/**
+	Parameters of one benchmark configuration.
+
+	Shared by every repetition of the configuration and alive until its
+	last teardown.
+*/
+struct BenchmarkParams
+{
+	uint32_t size;			///< Elements, every run does this many operations
+	uint32_t threadCount;	///< 1 unless the benchmark has BenchmarkFlag_Threads
+	bool random;			///< pOrder is shuffled
+	const uint32_t* pOrder; ///< Element indices in visit order, a permutation of [0, size)
+};
+
+/**
+	A registered benchmark.
+
+	Each repetition calls pSetup, times pRun and calls pTeardown, so only
+	the operations themselves are measured. Results are reported in
+	nanoseconds per operation, the run time divided by size.
+
+	@see addBenchmark
+*/
+struct Benchmark
+{
+	const char* pName;								 ///< "container/operation", matched by --filter
+	void* (*pSetup)(const BenchmarkParams* pParams); ///< Untimed, returns the run state
+	void (*pRun)(void* pState);						 ///< Timed, performs size operations
+	void (*pTeardown)(void* pState);				 ///< Untimed, frees the run state
+	uint32_t flags;									 ///< BenchmarkFlags
+};
+
+/**
+	Registers a benchmark with the harness.
+
+	@param benchmark Benchmark to run, pName must outlive the harness
+*/
+void addBenchmark(const Benchmark& benchmark);
+
+/**
+	Keeps a result alive so the compiler cannot drop the work producing it.
+
+	@param value Value derived from the benchmarked operations
+*/
+void benchmarkConsume(uint64_t value);
+
+///////////////////////////////////////////
+// Suites
+
+void addArenaBenchmarks();
+void addSlotMapBenchmarks();
+void addHashMapBenchmarks();
+
+#endif // _BENCHMARK_H_
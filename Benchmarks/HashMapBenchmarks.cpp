@@ -0,0 +1,211 @@
+/*
+ * HashMapBenchmarks.cpp
+ *
+ * HashMap insert, get and remove against std::unordered_map keyed by
+ * std::string. Keys look like asset paths and are built before timing.
+ */
+
+#include "Benchmark.h"
+#include "Core/HashMap.h"
+#include "Runtime/Memory/Arena.h"
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define HASHMAP_BENCHMARK_KEY_PREFIX "textures/asset_"
+#define HASHMAP_BENCHMARK_KEY_SIZE 32 ///< Prefix, up to 8 digits and the terminator
+
+struct HashMapValue
+{
+	uint64_t id;
+	uint64_t generation;
+};
+
+struct HashMapState
+{
+	const BenchmarkParams* pParams;
+	Arena* pArena;
+	HashMap* pMap;
+	std::vector<char> keyBuffer;	///< HASHMAP_BENCHMARK_KEY_SIZE bytes per key
+	std::vector<const char*> keys;	///< Key of element i
+	std::vector<HashedKey> hashedKeys;
+	std::vector<std::string> stdKeys;
+	std::unordered_map<std::string, HashMapValue> stdMap;
+};
+
+static void writeKey(char* pKey, uint32_t index)
+{
+	static const char kPrefix[] = HASHMAP_BENCHMARK_KEY_PREFIX;
+	memcpy(pKey, kPrefix, sizeof(kPrefix) - 1);
+	pKey += sizeof(kPrefix) - 1;
+
+	char digits[10];
+	uint32_t count = 0;
+	do
+	{
+		digits[count++] = (char)('0' + index % 10);
+		index /= 10;
+	} while (index);
+
+	while (count)
+		*pKey++ = digits[--count];
+	*pKey = '\0';
+}
+
+static HashMapState* createHashMapState(const BenchmarkParams* pParams, bool stdKeys)
+{
+	HashMapState* pState = new HashMapState();
+	pState->pParams = pParams;
+	pState->pArena = arenaCreate(nullptr);
+	pState->pMap = hashMapCreate(pState->pArena, sizeof(HashMapValue));
+
+	pState->keyBuffer.resize((size_t)pParams->size * HASHMAP_BENCHMARK_KEY_SIZE);
+	pState->keys.resize(pParams->size);
+	for (uint32_t i = 0; i < pParams->size; i++)
+	{
+		char* pKey = &pState->keyBuffer[(size_t)i * HASHMAP_BENCHMARK_KEY_SIZE];
+		writeKey(pKey, i);
+		pState->keys[i] = pKey;
+	}
+
+	if (stdKeys)
+	{
+		pState->stdKeys.reserve(pParams->size);
+		for (uint32_t i = 0; i < pParams->size; i++)
+			pState->stdKeys.emplace_back(pState->keys[i]);
+	}
+	return pState;
+}
+
+static void* setupEmptyHashMap(const BenchmarkParams* pParams)
+{
+	return createHashMapState(pParams, false);
+}
+
+static void* setupFilledHashMap(const BenchmarkParams* pParams)
+{
+	HashMapState* pState = createHashMapState(pParams, false);
+	for (uint32_t i = 0; i < pParams->size; i++)
+		hashMapInsert(pState->pMap, pState->keys[i], HashMapValue{ i, 0 });
+	return pState;
+}
+
+// Hashes are computed up front, the way AssetCache callers pass literal keys
+static void* setupFilledHashedHashMap(const BenchmarkParams* pParams)
+{
+	HashMapState* pState = (HashMapState*)setupFilledHashMap(pParams);
+	pState->hashedKeys.resize(pParams->size);
+	for (uint32_t i = 0; i < pParams->size; i++)
+		pState->hashedKeys[i] = hashedKeyFromString(pState->keys[i]);
+	return pState;
+}
+
+static void* setupEmptyStdMap(const BenchmarkParams* pParams)
+{
+	return createHashMapState(pParams, true);
+}
+
+static void* setupFilledStdMap(const BenchmarkParams* pParams)
+{
+	HashMapState* pState = createHashMapState(pParams, true);
+	for (uint32_t i = 0; i < pParams->size; i++)
+		pState->stdMap.emplace(pState->stdKeys[i], HashMapValue{ i, 0 });
+	return pState;
+}
+
+static void teardownHashMap(void* pOpaque)
+{
+	HashMapState* pState = (HashMapState*)pOpaque;
+	hashMapDestroy(pState->pMap);
+	arenaRelease(pState->pArena);
+	delete pState;
+}
+
+///////////////////////////////////////////
+// HashMap
+
+static void runHashMapInsert(void* pOpaque)
+{
+	HashMapState* pState = (HashMapState*)pOpaque;
+	for (uint32_t i = 0; i < pState->pParams->size; i++)
+		hashMapInsert(pState->pMap, pState->keys[i], HashMapValue{ i, 0 });
+	benchmarkConsume(hashMapCount(pState->pMap));
+}
+
+static void runHashMapGet(void* pOpaque)
+{
+	HashMapState* pState = (HashMapState*)pOpaque;
+	const uint32_t* pOrder = pState->pParams->pOrder;
+	uint64_t sum = 0;
+	for (uint32_t i = 0; i < pState->pParams->size; i++)
+		sum += hashMapGet<HashMapValue>(pState->pMap, pState->keys[pOrder[i]])->id;
+	benchmarkConsume(sum);
+}
+
+static void runHashMapGetHashed(void* pOpaque)
+{
+	HashMapState* pState = (HashMapState*)pOpaque;
+	const uint32_t* pOrder = pState->pParams->pOrder;
+	uint64_t sum = 0;
+	for (uint32_t i = 0; i < pState->pParams->size; i++)
+		sum += hashMapGetHashed<HashMapValue>(pState->pMap, pState->hashedKeys[pOrder[i]])->id;
+	benchmarkConsume(sum);
+}
+
+static void runHashMapRemove(void* pOpaque)
+{
+	HashMapState* pState = (HashMapState*)pOpaque;
+	const uint32_t* pOrder = pState->pParams->pOrder;
+	for (uint32_t i = 0; i < pState->pParams->size; i++)
+		hashMapRemove(pState->pMap, pState->keys[pOrder[i]]);
+	benchmarkConsume(hashMapCount(pState->pMap));
+}
+
+///////////////////////////////////////////
+// Standard containers
+
+static void runStdMapInsert(void* pOpaque)
+{
+	HashMapState* pState = (HashMapState*)pOpaque;
+	for (uint32_t i = 0; i < pState->pParams->size; i++)
+		pState->stdMap.emplace(pState->stdKeys[i], HashMapValue{ i, 0 });
+	benchmarkConsume(pState->stdMap.size());
+}
+
+static void runStdMapFind(void* pOpaque)
+{
+	HashMapState* pState = (HashMapState*)pOpaque;
+	const uint32_t* pOrder = pState->pParams->pOrder;
+	uint64_t sum = 0;
+	for (uint32_t i = 0; i < pState->pParams->size; i++)
+		sum += pState->stdMap.find(pState->stdKeys[pOrder[i]])->second.id;
+	benchmarkConsume(sum);
+}
+
+static void runStdMapErase(void* pOpaque)
+{
+	HashMapState* pState = (HashMapState*)pOpaque;
+	const uint32_t* pOrder = pState->pParams->pOrder;
+	for (uint32_t i = 0; i < pState->pParams->size; i++)
+		pState->stdMap.erase(pState->stdKeys[pOrder[i]]);
+	benchmarkConsume(pState->stdMap.size());
+}
+
+void addHashMapBenchmarks()
+{
+	addBenchmark({ "hashmap/insert", setupEmptyHashMap, runHashMapInsert, teardownHashMap });
+	addBenchmark({ "hashmap/get", setupFilledHashMap, runHashMapGet, teardownHashMap,
+				   BenchmarkFlag_Random });
+	addBenchmark({ "hashmap/get_hashed", setupFilledHashedHashMap, runHashMapGetHashed,
+				   teardownHashMap, BenchmarkFlag_Random });
+	addBenchmark({ "hashmap/remove", setupFilledHashMap, runHashMapRemove, teardownHashMap,
+				   BenchmarkFlag_Random });
+
+	addBenchmark({ "std::unordered_map<string>/insert", setupEmptyStdMap, runStdMapInsert,
+				   teardownHashMap });
+	addBenchmark({ "std::unordered_map<string>/find", setupFilledStdMap, runStdMapFind,
+				   teardownHashMap, BenchmarkFlag_Random });
+	addBenchmark({ "std::unordered_map<string>/erase", setupFilledStdMap, runStdMapErase,
+				   teardownHashMap, BenchmarkFlag_Random });
+}
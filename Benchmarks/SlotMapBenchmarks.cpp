@@ -0,0 +1,196 @@
+/*
+ * SlotMapBenchmarks.cpp
+ *
+ * SlotMap insert, get and remove against std::unordered_map keyed by an
+ * integer id, with std::vector indexing as the lower bound for lookups.
+ */
+
+#include "Benchmark.h"
+#include "Core/SlotMap.h"
+#include "Runtime/Memory/Arena.h"
+#include <unordered_map>
+#include <vector>
+
+#define SLOTMAP_BENCHMARK_INITIAL_CAPACITY 64 ///< Small start so inserts include growth
+
+struct SlotMapValue
+{
+	float data[4]; ///< Transform sized payload
+};
+
+struct SlotMapState
+{
+	const BenchmarkParams* pParams;
+	Arena* pArena;
+	SlotMap* pMap;
+	std::vector<uint32_t> handles; ///< Handle of element i
+	std::unordered_map<uint32_t, SlotMapValue> stdMap;
+	std::vector<SlotMapValue> values;
+};
+
+static SlotMapValue makeValue(uint32_t i)
+{
+	SlotMapValue value = { { (float)i, 0.0f, 0.0f, 1.0f } };
+	return value;
+}
+
+static SlotMapState* createSlotMapState(const BenchmarkParams* pParams)
+{
+	SlotMapState* pState = new SlotMapState();
+	pState->pParams = pParams;
+	pState->pArena = arenaCreate(nullptr);
+	pState->pMap = slotMapCreate(pState->pArena, sizeof(SlotMapValue), alignof(SlotMapValue),
+								 SLOTMAP_BENCHMARK_INITIAL_CAPACITY);
+	return pState;
+}
+
+static void* setupEmpty(const BenchmarkParams* pParams)
+{
+	return createSlotMapState(pParams);
+}
+
+static void* setupFilledSlotMap(const BenchmarkParams* pParams)
+{
+	SlotMapState* pState = createSlotMapState(pParams);
+	pState->handles.resize(pParams->size);
+	for (uint32_t i = 0; i < pParams->size; i++)
+		pState->handles[i] = slotMapInsert(pState->pMap, makeValue(i));
+	return pState;
+}
+
+static void* setupFilledStdMap(const BenchmarkParams* pParams)
+{
+	SlotMapState* pState = createSlotMapState(pParams);
+	for (uint32_t i = 0; i < pParams->size; i++)
+		pState->stdMap.emplace(i, makeValue(i));
+	return pState;
+}
+
+static void* setupFilledVector(const BenchmarkParams* pParams)
+{
+	SlotMapState* pState = createSlotMapState(pParams);
+	pState->values.resize(pParams->size);
+	for (uint32_t i = 0; i < pParams->size; i++)
+		pState->values[i] = makeValue(i);
+	return pState;
+}
+
+static void teardownSlotMap(void* pOpaque)
+{
+	SlotMapState* pState = (SlotMapState*)pOpaque;
+	slotMapDestroy(pState->pMap);
+	arenaRelease(pState->pArena);
+	delete pState;
+}
+
+///////////////////////////////////////////
+// SlotMap
+
+static void runSlotMapInsert(void* pOpaque)
+{
+	SlotMapState* pState = (SlotMapState*)pOpaque;
+	uint64_t sum = 0;
+	for (uint32_t i = 0; i < pState->pParams->size; i++)
+		sum += slotMapInsert(pState->pMap, makeValue(i));
+	benchmarkConsume(sum);
+}
+
+static void runSlotMapGet(void* pOpaque)
+{
+	SlotMapState* pState = (SlotMapState*)pOpaque;
+	const uint32_t* pOrder = pState->pParams->pOrder;
+	float sum = 0.0f;
+	for (uint32_t i = 0; i < pState->pParams->size; i++)
+		sum += slotMapGet<SlotMapValue>(pState->pMap, pState->handles[pOrder[i]])->data[0];
+	benchmarkConsume((uint64_t)sum);
+}
+
+static void runSlotMapRemove(void* pOpaque)
+{
+	SlotMapState* pState = (SlotMapState*)pOpaque;
+	const uint32_t* pOrder = pState->pParams->pOrder;
+	for (uint32_t i = 0; i < pState->pParams->size; i++)
+		slotMapRemove(pState->pMap, pState->handles[pOrder[i]]);
+	benchmarkConsume(slotMapCount(pState->pMap));
+}
+
+// Dense array walk, what systems iterating every element pay
+static void runSlotMapIterate(void* pOpaque)
+{
+	SlotMapState* pState = (SlotMapState*)pOpaque;
+	const SlotMapValue* pValues = (const SlotMapValue*)pState->pMap->pValues;
+	float sum = 0.0f;
+	for (uint32_t i = 0; i < pState->pMap->count; i++)
+		sum += pValues[i].data[0];
+	benchmarkConsume((uint64_t)sum);
+}
+
+///////////////////////////////////////////
+// Standard containers
+
+static void runStdMapInsert(void* pOpaque)
+{
+	SlotMapState* pState = (SlotMapState*)pOpaque;
+	for (uint32_t i = 0; i < pState->pParams->size; i++)
+		pState->stdMap.emplace(i, makeValue(i));
+	benchmarkConsume(pState->stdMap.size());
+}
+
+static void runStdMapFind(void* pOpaque)
+{
+	SlotMapState* pState = (SlotMapState*)pOpaque;
+	const uint32_t* pOrder = pState->pParams->pOrder;
+	float sum = 0.0f;
+	for (uint32_t i = 0; i < pState->pParams->size; i++)
+		sum += pState->stdMap.find(pOrder[i])->second.data[0];
+	benchmarkConsume((uint64_t)sum);
+}
+
+static void runStdMapErase(void* pOpaque)
+{
+	SlotMapState* pState = (SlotMapState*)pOpaque;
+	const uint32_t* pOrder = pState->pParams->pOrder;
+	for (uint32_t i = 0; i < pState->pParams->size; i++)
+		pState->stdMap.erase(pOrder[i]);
+	benchmarkConsume(pState->stdMap.size());
+}
+
+static void runStdMapIterate(void* pOpaque)
+{
+	SlotMapState* pState = (SlotMapState*)pOpaque;
+	float sum = 0.0f;
+	for (const auto& entry : pState->stdMap)
+		sum += entry.second.data[0];
+	benchmarkConsume((uint64_t)sum);
+}
+
+static void runVectorIndex(void* pOpaque)
+{
+	SlotMapState* pState = (SlotMapState*)pOpaque;
+	const uint32_t* pOrder = pState->pParams->pOrder;
+	float sum = 0.0f;
+	for (uint32_t i = 0; i < pState->pParams->size; i++)
+		sum += pState->values[pOrder[i]].data[0];
+	benchmarkConsume((uint64_t)sum);
+}
+
+void addSlotMapBenchmarks()
+{
+	addBenchmark({ "slotmap/insert", setupEmpty, runSlotMapInsert, teardownSlotMap });
+	addBenchmark({ "slotmap/get", setupFilledSlotMap, runSlotMapGet, teardownSlotMap,
+				   BenchmarkFlag_Random });
+	addBenchmark({ "slotmap/remove", setupFilledSlotMap, runSlotMapRemove, teardownSlotMap,
+				   BenchmarkFlag_Random });
+	addBenchmark({ "slotmap/iterate", setupFilledSlotMap, runSlotMapIterate, teardownSlotMap });
+
+	addBenchmark({ "std::unordered_map<u32>/insert", setupEmpty, runStdMapInsert,
+				   teardownSlotMap });
+	addBenchmark({ "std::unordered_map<u32>/find", setupFilledStdMap, runStdMapFind,
+				   teardownSlotMap, BenchmarkFlag_Random });
+	addBenchmark({ "std::unordered_map<u32>/erase", setupFilledStdMap, runStdMapErase,
+				   teardownSlotMap, BenchmarkFlag_Random });
+	addBenchmark({ "std::unordered_map<u32>/iterate", setupFilledStdMap, runStdMapIterate,
+				   teardownSlotMap });
+	addBenchmark({ "std::vector/index", setupFilledVector, runVectorIndex, teardownSlotMap,
+				   BenchmarkFlag_Random });
+}
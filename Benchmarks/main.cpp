@@ -0,0 +1,333 @@
+/*
+ * Benchmarks for Engine
+ * main.cpp
+ *
+ * Runs every registered benchmark over the element counts, access
+ * patterns and thread counts it asks for, then prints a table and
+ * optionally writes JSON and CSV reports for tracking regressions.
+ *
+ * Usage: Benchmarks [--filter text] [--repetitions n] [--warmup n]
+ *                   [--min-size n] [--max-size n] [--threads n]
+ *                   [--json file] [--csv file] [--list]
+ */
+
+#include "Benchmark.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#define BENCHMARK_DEFAULT_REPETITIONS 10
+#define BENCHMARK_DEFAULT_WARMUP 2
+#define BENCHMARK_ORDER_SEED 0x9E3779B97F4A7C15ull ///< Fixed, shuffles match between runs
+
+static const uint32_t kBenchmarkSizes[] = { 1000, 10000, 100000, 1000000, 10000000 };
+
+struct BenchmarkOptions
+{
+	const char* pFilter; ///< Substring of the benchmark names to run, nullptr runs all
+	const char* pJsonPath;
+	const char* pCsvPath;
+	uint32_t repetitions;
+	uint32_t warmup;
+	uint32_t minSize;
+	uint32_t maxSize;
+	uint32_t maxThreads;
+	bool list;
+};
+
+/**
+	Nanoseconds per operation over the timed repetitions of a configuration.
+*/
+struct BenchmarkResult
+{
+	const char* pName;
+	uint32_t size;
+	uint32_t threadCount;
+	bool random;
+	uint32_t repetitions;
+	double min;
+	double mean;
+	double p50;
+	double p90;
+	double p99;
+	double max;
+};
+
+static std::vector<Benchmark> gBenchmarks;
+static std::atomic<uint64_t> gBenchmarkSink(0); ///< Workers consume concurrently
+
+void addBenchmark(const Benchmark& benchmark)
+{
+	gBenchmarks.push_back(benchmark);
+}
+
+void benchmarkConsume(uint64_t value)
+{
+	gBenchmarkSink.fetch_add(value, std::memory_order_relaxed);
+}
+
+///////////////////////////////////////////
+// Measurement
+
+static uint64_t splitMix64(uint64_t* pState)
+{
+	uint64_t z = (*pState += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+static void fillOrder(std::vector<uint32_t>* pOrder, uint32_t size, bool random)
+{
+	pOrder->resize(size);
+	for (uint32_t i = 0; i < size; i++)
+		(*pOrder)[i] = i;
+
+	if (!random)
+		return;
+
+	// Fisher-Yates with a fixed seed
+	uint64_t state = BENCHMARK_ORDER_SEED;
+	for (uint32_t i = size - 1; i > 0; i--)
+	{
+		uint32_t j = (uint32_t)(splitMix64(&state) % (i + 1));
+		std::swap((*pOrder)[i], (*pOrder)[j]);
+	}
+}
+
+// Nearest rank on sorted samples
+static double percentile(const std::vector<double>& sorted, double fraction)
+{
+	size_t rank = (size_t)(fraction * (double)sorted.size() + 0.999999);
+	rank = std::min(std::max(rank, (size_t)1), sorted.size());
+	return sorted[rank - 1];
+}
+
+static double runOnce(const Benchmark& benchmark, const BenchmarkParams* pParams)
+{
+	void* pState = benchmark.pSetup(pParams);
+
+	auto start = std::chrono::steady_clock::now();
+	benchmark.pRun(pState);
+	auto end = std::chrono::steady_clock::now();
+
+	benchmark.pTeardown(pState);
+
+	return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+static BenchmarkResult runConfiguration(const Benchmark& benchmark,
+										const BenchmarkParams* pParams,
+										const BenchmarkOptions* pOptions)
+{
+	for (uint32_t i = 0; i < pOptions->warmup; i++)
+		runOnce(benchmark, pParams);
+
+	std::vector<double> samples(pOptions->repetitions);
+	double sum = 0.0;
+	for (uint32_t i = 0; i < pOptions->repetitions; i++)
+	{
+		samples[i] = runOnce(benchmark, pParams) / (double)pParams->size;
+		sum += samples[i];
+	}
+	std::sort(samples.begin(), samples.end());
+
+	BenchmarkResult result = {};
+	result.pName = benchmark.pName;
+	result.size = pParams->size;
+	result.threadCount = pParams->threadCount;
+	result.random = pParams->random;
+	result.repetitions = pOptions->repetitions;
+	result.min = samples.front();
+	result.mean = sum / (double)samples.size();
+	result.p50 = percentile(samples, 0.50);
+	result.p90 = percentile(samples, 0.90);
+	result.p99 = percentile(samples, 0.99);
+	result.max = samples.back();
+	return result;
+}
+
+///////////////////////////////////////////
+// Reports
+
+static void printResult(const BenchmarkResult& result)
+{
+	printf("%-36s %9u %-10s %3u %10.2f %10.2f %10.2f %10.2f %10.2f\n", result.pName,
+		   result.size, result.random ? "random" : "sequential", result.threadCount, result.min,
+		   result.p50, result.p90, result.p99, result.mean);
+	fflush(stdout);
+}
+
+static bool writeJson(const char* pPath, const std::vector<BenchmarkResult>& results)
+{
+	FILE* pFile = fopen(pPath, "w");
+	if (!pFile)
+		return false;
+
+	fprintf(pFile, "{\n\t\"unit\": \"ns/op\",\n\t\"benchmarks\": [\n");
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchmarkResult& r = results[i];
+		fprintf(pFile,
+				"\t\t{ \"name\": \"%s\", \"size\": %u, \"pattern\": \"%s\", \"threads\": %u, "
+				"\"repetitions\": %u, \"min\": %.3f, \"mean\": %.3f, \"p50\": %.3f, "
+				"\"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f }%s\n",
+				r.pName, r.size, r.random ? "random" : "sequential", r.threadCount, r.repetitions,
+				r.min, r.mean, r.p50, r.p90, r.p99, r.max, i + 1 < results.size() ? "," : "");
+	}
+	fprintf(pFile, "\t]\n}\n");
+	fclose(pFile);
+	return true;
+}
+
+static bool writeCsv(const char* pPath, const std::vector<BenchmarkResult>& results)
+{
+	FILE* pFile = fopen(pPath, "w");
+	if (!pFile)
+		return false;
+
+	fprintf(pFile, "name,size,pattern,threads,repetitions,min_ns,mean_ns,p50_ns,p90_ns,p99_ns,"
+				   "max_ns\n");
+	for (const BenchmarkResult& r : results)
+	{
+		fprintf(pFile, "%s,%u,%s,%u,%u,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n", r.pName, r.size,
+				r.random ? "random" : "sequential", r.threadCount, r.repetitions, r.min, r.mean,
+				r.p50, r.p90, r.p99, r.max);
+	}
+	fclose(pFile);
+	return true;
+}
+
+///////////////////////////////////////////
+// Entry point
+
+static uint32_t parseCount(const char* pText)
+{
+	return (uint32_t)strtoul(pText, nullptr, 10);
+}
+
+static bool parseOptions(int argc, char** argv, BenchmarkOptions* pOptions)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const char* pArg = argv[i];
+		const char* pValue = i + 1 < argc ? argv[i + 1] : nullptr;
+
+		if (strcmp(pArg, "--list") == 0)
+		{
+			pOptions->list = true;
+			continue;
+		}
+		if (!pValue)
+		{
+			fprintf(stderr, "Benchmarks: missing value for %s\n", pArg);
+			return false;
+		}
+
+		if (strcmp(pArg, "--filter") == 0)
+			pOptions->pFilter = pValue;
+		else if (strcmp(pArg, "--json") == 0)
+			pOptions->pJsonPath = pValue;
+		else if (strcmp(pArg, "--csv") == 0)
+			pOptions->pCsvPath = pValue;
+		else if (strcmp(pArg, "--repetitions") == 0)
+			pOptions->repetitions = std::max(parseCount(pValue), 1u);
+		else if (strcmp(pArg, "--warmup") == 0)
+			pOptions->warmup = parseCount(pValue);
+		else if (strcmp(pArg, "--min-size") == 0)
+			pOptions->minSize = parseCount(pValue);
+		else if (strcmp(pArg, "--max-size") == 0)
+			pOptions->maxSize = parseCount(pValue);
+		else if (strcmp(pArg, "--threads") == 0)
+			pOptions->maxThreads = std::max(parseCount(pValue), 1u);
+		else
+		{
+			fprintf(stderr, "Benchmarks: unknown option %s\n", pArg);
+			return false;
+		}
+		i++;
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	BenchmarkOptions options = {};
+	options.repetitions = BENCHMARK_DEFAULT_REPETITIONS;
+	options.warmup = BENCHMARK_DEFAULT_WARMUP;
+	options.maxSize = UINT32_MAX;
+	options.maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	if (!parseOptions(argc, argv, &options))
+		return 1;
+
+	addArenaBenchmarks();
+	addSlotMapBenchmarks();
+	addHashMapBenchmarks();
+
+	if (options.list)
+	{
+		for (const Benchmark& benchmark : gBenchmarks)
+			printf("%s\n", benchmark.pName);
+		return 0;
+	}
+
+	printf("%-36s %9s %-10s %3s %10s %10s %10s %10s %10s   (ns/op)\n", "benchmark", "size",
+		   "pattern", "thr", "min", "p50", "p90", "p99", "mean");
+
+	std::vector<BenchmarkResult> results;
+	std::vector<uint32_t> order;
+	for (const Benchmark& benchmark : gBenchmarks)
+	{
+		if (options.pFilter && !strstr(benchmark.pName, options.pFilter))
+			continue;
+
+		for (uint32_t size : kBenchmarkSizes)
+		{
+			if (size < options.minSize || size > options.maxSize)
+				continue;
+
+			for (uint32_t pattern = 0; pattern < 2; pattern++)
+			{
+				bool random = pattern == 1;
+				if (random && !(benchmark.flags & BenchmarkFlag_Random))
+					continue;
+
+				fillOrder(&order, size, random);
+
+				uint32_t threadLimit = benchmark.flags & BenchmarkFlag_Threads ? options.maxThreads
+																				: 1;
+				for (uint32_t threads = 1; threads <= threadLimit;
+					 threads = threads < threadLimit ? std::min(threads * 2, threadLimit)
+													 : threads + 1)
+				{
+					BenchmarkParams params = {};
+					params.size = size;
+					params.threadCount = threads;
+					params.random = random;
+					params.pOrder = order.data();
+
+					results.push_back(runConfiguration(benchmark, &params, &options));
+					printResult(results.back());
+				}
+			}
+		}
+	}
+
+	int exitCode = 0;
+	if (options.pJsonPath && !writeJson(options.pJsonPath, results))
+	{
+		fprintf(stderr, "Benchmarks: failed to write %s\n", options.pJsonPath);
+		exitCode = 1;
+	}
+	if (options.pCsvPath && !writeCsv(options.pCsvPath, results))
+	{
+		fprintf(stderr, "Benchmarks: failed to write %s\n", options.pCsvPath);
+		exitCode = 1;
+	}
+	return exitCode;
+}
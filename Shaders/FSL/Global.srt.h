@@ -3,8 +3,9 @@
 BEGIN_SRT_NO_AB(SrtData)
 BEGIN_SRT_SET(Persistent)
 	DECL_SAMPLER(Persistent, SamplerState, gSpriteSampler)
-	DECL_TEXTURE(Persistent, Tex2D(float4), gSpriteTexture)
-	DECL_TEXTURE(Persistent, Tex2D(float4), gCubeTexture)
+	// Bindless table filled by the AssetCache, indexed by texture handle slot.
+	// Size matches ASSET_CACHE_MAX_BINDLESS_TEXTURES
+	DECL_ARRAY_TEXTURES(Persistent, Tex2D(float4), gTextures, 1024)
 END_SRT_SET(Persistent)
 
 BEGIN_SRT_SET(PerFrame)
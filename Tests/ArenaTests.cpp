@@ -1,6 +1,8 @@
 #include "catch_amalgamated.hpp"
 #include "Runtime/Memory/Arena.h"
+#include <algorithm>
 #include <cstring>
+#include <thread>
 #include <vector>
 
 TEST_CASE("Arena basic creation and release", "[arena]")
@@ -578,3 +580,302 @@ TEST_CASE("Arena data persistence across operations", "[arena][integrity]")
 
 	arenaRelease(pArena);
 }
+
+TEST_CASE("Arena scratch avoids conflicting arenas", "[arena][scratch]")
+{
+	ArenaTemp first = arenaScratchBegin();
+	REQUIRE(first.pArena != nullptr);
+
+	// Asking again with the first as a conflict hands out the other one
+	ArenaTemp second = arenaScratchBegin(&first.pArena, 1);
+	REQUIRE(second.pArena != nullptr);
+	REQUIRE(second.pArena != first.pArena);
+
+	Arena* ppBoth[2] = {first.pArena, second.pArena};
+	ArenaTemp none = arenaScratchBegin(ppBoth, 2);
+	REQUIRE(none.pArena == nullptr);
+	arenaScratchEnd(none);
+
+	uint64_t startPos = arenaGetPos(second.pArena);
+	arenaPush(second.pArena, 256, 8);
+	arenaScratchEnd(second);
+	REQUIRE(arenaGetPos(second.pArena) == startPos);
+
+	arenaScratchEnd(first);
+}
+
+TEST_CASE("Arena scratch is per thread", "[arena][scratch]")
+{
+	Arena* pMainScratch = nullptr;
+	{
+		ScopedArenaScratch scratch;
+		pMainScratch = scratch.pArena;
+	}
+
+	// Catch assertions are not thread safe, check the results on this thread
+	Arena* pWorkerScratch = nullptr;
+	void* pWorkerAllocation = nullptr;
+	std::thread worker(
+		[&pWorkerScratch, &pWorkerAllocation]()
+		{
+			ScopedArenaScratch scratch;
+			pWorkerScratch = scratch.pArena;
+			pWorkerAllocation = arenaPush(scratch.pArena, 64, 8);
+		});
+	worker.join();
+
+	REQUIRE(pMainScratch != nullptr);
+	REQUIRE(pWorkerScratch != nullptr);
+	REQUIRE(pWorkerAllocation != nullptr);
+	REQUIRE(pWorkerScratch != pMainScratch);
+}
+
+TEST_CASE("Arena atomic flag allows concurrent pushes", "[arena][atomic]")
+{
+	// Small blocks so the threads race through chaining as well
+	ArenaParams params = {};
+	params.flags = ArenaFlag_Atomic;
+	params.reserveSize = Kilobyte(64);
+	params.commitSize = Kilobyte(4);
+	Arena* pArena = arenaCreate(&params);
+	REQUIRE(pArena != nullptr);
+
+	const uint32_t threadCount = 4;
+	const uint32_t pushesPerThread = 2000;
+	std::vector<uint64_t*> pointers[threadCount];
+
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < threadCount; ++t)
+	{
+		threads.emplace_back(
+			[pArena, t, &pointers]()
+			{
+				for (uint32_t i = 0; i < pushesPerThread; ++i)
+				{
+					uint64_t* p = (uint64_t*)arenaPush(pArena, 24, 16);
+					if (!p)
+						break;
+					p[0] = t;
+					p[1] = i;
+					p[2] = ~(uint64_t)i;
+					pointers[t].push_back(p);
+				}
+			});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+
+	std::vector<uintptr_t> all;
+	for (uint32_t t = 0; t < threadCount; ++t)
+	{
+		REQUIRE(pointers[t].size() == pushesPerThread);
+		for (uint32_t i = 0; i < pushesPerThread; ++i)
+		{
+			uint64_t* p = pointers[t][i];
+			REQUIRE(((uintptr_t)p % 16) == 0);
+			REQUIRE(p[0] == t);
+			REQUIRE(p[1] == i);
+			REQUIRE(p[2] == ~(uint64_t)i);
+			all.push_back((uintptr_t)p);
+		}
+	}
+
+	// No two allocations overlap
+	std::sort(all.begin(), all.end());
+	for (size_t i = 1; i < all.size(); ++i)
+		REQUIRE(all[i] - all[i - 1] >= 24);
+
+	arenaRelease(pArena);
+}
+
+TEST_CASE("Arena backing buffer hosts the first block", "[arena][backing]")
+{
+	alignas(64) static uint8_t buffer[Kilobyte(16)];
+
+	ArenaParams params = {};
+	params.reserveSize = sizeof(buffer);
+	params.commitSize = Kilobyte(4);
+	params.pBackingBuffer = buffer;
+
+	Arena* pArena = arenaCreate(&params);
+	REQUIRE((void*)pArena == (void*)buffer);
+	REQUIRE(pArena->committed == sizeof(buffer));
+
+	uint8_t* p1 = (uint8_t*)arenaPush(pArena, Kilobyte(8), 8);
+	REQUIRE(p1 >= buffer);
+	REQUIRE(p1 + Kilobyte(8) <= buffer + sizeof(buffer));
+	memset(p1, 0xAB, Kilobyte(8));
+
+	// Does not fit anymore, so a normal block is chained behind the buffer
+	uint8_t* p2 = (uint8_t*)arenaPush(pArena, Kilobyte(12), 8);
+	REQUIRE(p2 != nullptr);
+	REQUIRE((p2 < buffer || p2 >= buffer + sizeof(buffer)));
+	REQUIRE(pArena->pCurrent != pArena);
+	REQUIRE(!(pArena->pCurrent->flags & ArenaFlag_External));
+
+	arenaClear(pArena);
+	REQUIRE(pArena->pCurrent == pArena);
+	REQUIRE(p1[0] == 0xAB);
+
+	arenaRelease(pArena);
+	REQUIRE(buffer[ARENA_HEADER_SIZE] == 0xAB);
+}
+
+TEST_CASE("Arena backing buffer validates its size", "[arena][backing]")
+{
+	alignas(8) static uint8_t buffer[64];
+
+	ArenaParams params = {};
+	params.pBackingBuffer = buffer;
+	REQUIRE(arenaCreate(&params) == nullptr);
+
+	params.reserveSize = sizeof(buffer);
+	REQUIRE(arenaCreate(&params) == nullptr);
+}
+
+TEST_CASE("Arena prefault commits whole blocks", "[arena][flags]")
+{
+	ArenaParams params = {};
+	params.reserveSize = Kilobyte(256);
+	params.commitSize = Kilobyte(4);
+	params.flags = ArenaFlag_Prefault;
+
+	Arena* pArena = arenaCreate(&params);
+	REQUIRE(pArena != nullptr);
+	REQUIRE(pArena->committed == pArena->reserved);
+
+	arenaPush(pArena, Kilobyte(300), 8);
+	REQUIRE(pArena->pCurrent != pArena);
+	REQUIRE(pArena->pCurrent->committed == pArena->pCurrent->reserved);
+
+	arenaRelease(pArena);
+}
+
+TEST_CASE("Arena large pages fall back when unavailable", "[arena][flags]")
+{
+	ArenaParams params = {};
+	params.reserveSize = Megabyte(4);
+	params.flags = ArenaFlag_LargePages;
+
+	Arena* pArena = arenaCreate(&params);
+	REQUIRE(pArena != nullptr);
+
+	uint8_t* p = (uint8_t*)arenaPush(pArena, Megabyte(1), 64);
+	REQUIRE(p != nullptr);
+	memset(p, 1, Megabyte(1));
+
+	// Either large pages, committed in full, or normal pages without the flag
+	if (pArena->flags & ArenaFlag_LargePages)
+		REQUIRE(pArena->committed == pArena->reserved);
+
+	arenaRelease(pArena);
+}
+
+TEST_CASE("Arena pop decommits past the threshold", "[arena][pop][commit]")
+{
+	ArenaParams params = {};
+	params.reserveSize = Megabyte(4);
+	params.commitSize = Kilobyte(64);
+	params.decommitThreshold = Kilobyte(256);
+
+	Arena* pArena = arenaCreate(&params);
+	uint64_t start = arenaGetPos(pArena);
+
+	uint8_t* p = (uint8_t*)arenaPush(pArena, Megabyte(2), 8);
+	memset(p, 0xCD, Megabyte(2));
+	REQUIRE(pArena->committed >= Megabyte(2));
+
+	// Popping inside the threshold keeps the high water mark committed
+	arenaPopTo(pArena, start + Kilobyte(128));
+	REQUIRE(pArena->committed == Kilobyte(256));
+
+	// Recommitted pages come back usable and zeroed
+	uint8_t* pAgain = (uint8_t*)arenaPush(pArena, Megabyte(1), 8);
+	REQUIRE(pAgain[Megabyte(1) - 1] == 0);
+	memset(pAgain, 1, Megabyte(1));
+
+	arenaRelease(pArena);
+}
+
+TEST_CASE("Arena never decommit keeps pages committed", "[arena][pop][commit]")
+{
+	ArenaParams params = {};
+	params.reserveSize = Megabyte(4);
+	params.decommitThreshold = ARENA_NEVER_DECOMMIT;
+
+	Arena* pArena = arenaCreate(&params);
+	arenaPush(pArena, Megabyte(2), 8);
+	uint64_t committed = pArena->committed;
+
+	arenaClear(pArena);
+	REQUIRE(pArena->committed == committed);
+
+	arenaRelease(pArena);
+}
+
+TEST_CASE("Arena stats track usage, peak and blocks", "[arena][stats]")
+{
+	ArenaParams params = {};
+	params.reserveSize = Kilobyte(64);
+	params.commitSize = Kilobyte(4);
+	params.pName = "StatsTest";
+
+	Arena* pArena = arenaCreate(&params);
+
+	ArenaStats stats;
+	arenaGetStats(pArena, &stats);
+	REQUIRE(strcmp(stats.pName, "StatsTest") == 0);
+	REQUIRE(stats.arenaCount == 1);
+	REQUIRE(stats.usedBytes == 0);
+	REQUIRE(stats.blockCount == 1);
+	REQUIRE(stats.reservedBytes == Kilobyte(64));
+
+	arenaPush(pArena, Kilobyte(16), 8);
+	arenaPush(pArena, Kilobyte(60), 8);
+	arenaGetStats(pArena, &stats);
+	REQUIRE(stats.usedBytes >= Kilobyte(76));
+	REQUIRE(stats.blockCount == 2);
+	REQUIRE(stats.commitCount >= 3);
+
+	uint64_t peak = stats.usedBytes;
+	arenaClear(pArena);
+	arenaGetStats(pArena, &stats);
+	REQUIRE(stats.usedBytes == 0);
+	REQUIRE(stats.peakBytes == peak);
+	REQUIRE(stats.blockCount == 1);
+
+	arenaRelease(pArena);
+}
+
+TEST_CASE("Arena tag stats sum arenas sharing a tag", "[arena][stats]")
+{
+	ArenaParams params = {};
+	params.pName = "TagTest";
+	Arena* pFirst = arenaCreate(&params);
+	Arena* pSecond = arenaCreate(&params);
+	arenaPush(pFirst, 1000, 8);
+	arenaPush(pSecond, 500, 8);
+
+	ArenaStats tags[32];
+	uint32_t tagCount = arenaGetTagStats(tags, 32);
+	const ArenaStats* pTag = nullptr;
+	for (uint32_t i = 0; i < tagCount; ++i)
+	{
+		if (strcmp(tags[i].pName, "TagTest") == 0)
+			pTag = &tags[i];
+	}
+	REQUIRE(pTag != nullptr);
+	REQUIRE(pTag->arenaCount == 2);
+	REQUIRE(pTag->usedBytes == 1500);
+
+	arenaRelease(pSecond);
+	tagCount = arenaGetTagStats(tags, 32);
+	for (uint32_t i = 0; i < tagCount; ++i)
+	{
+		if (strcmp(tags[i].pName, "TagTest") == 0)
+			REQUIRE(tags[i].arenaCount == 1);
+	}
+
+	REQUIRE(arenaGetTagStats(tags, 1) == 1);
+	arenaRelease(pFirst);
+}
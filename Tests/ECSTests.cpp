@@ -0,0 +1,90 @@
+#include "catch_amalgamated.hpp"
+#include "Runtime/ECS.h"
+#include "Runtime/JobSystem.h"
+
+struct EcsTestCounter
+{
+	uint32_t value;
+};
+
+static ECS_COMPONENT_DECLARE(EcsTestCounter);
+
+static void incrementCounterSystem(ecs_iter_t* it)
+{
+	EcsTestCounter* pCounters = ecs_field(it, EcsTestCounter, 0);
+	for (int32_t i = 0; i < it->count; ++i)
+		pCounters[i].value++;
+}
+
+TEST_CASE("initECSJobHooks installs the task hooks after the OS API is set", "[ecs]")
+{
+	// What initEntityComponentSystem() does, later ecs_os_set_api() calls are ignored
+	ecs_os_set_api_defaults();
+	ecs_os_api_t api = ecs_os_api;
+	ecs_os_set_api(&api);
+
+	ecs_os_api_task_new_t pDefaultTaskNew = ecs_os_api.task_new_;
+	ecs_os_api_task_join_t pDefaultTaskJoin = ecs_os_api.task_join_;
+
+	JobSystemDesc desc = {};
+	desc.workerCount = 4;
+	JobSystem* pJobs = jobSystemCreate(&desc);
+	REQUIRE(pJobs != nullptr);
+
+	initECSJobHooks(pJobs);
+	REQUIRE(ecs_os_api.task_new_ != pDefaultTaskNew);
+	REQUIRE(ecs_os_api.task_join_ != pDefaultTaskJoin);
+
+	// Installing twice keeps the defaults to restore
+	initECSJobHooks(pJobs);
+
+	ecs_world_t* pWorld = ecs_init();
+	ECS_COMPONENT_DEFINE(pWorld, EcsTestCounter);
+
+	const uint32_t entityCount = 1000;
+	EcsTestCounter counter = {};
+	for (uint32_t i = 0; i < entityCount; ++i)
+	{
+		ecs_entity_t entity = ecs_new(pWorld);
+		ecs_set(pWorld, entity, EcsTestCounter, counter);
+	}
+
+	ecs_id_t phase[] = {ecs_dependson(EcsOnUpdate), 0};
+	ecs_entity_desc_t entityDesc = {};
+	entityDesc.name = "IncrementCounterSystem";
+	entityDesc.add = phase;
+
+	ecs_system_desc_t systemDesc = {};
+	systemDesc.entity = ecs_entity_init(pWorld, &entityDesc);
+	systemDesc.query.terms[0].id = ecs_id(EcsTestCounter);
+	systemDesc.callback = incrementCounterSystem;
+	systemDesc.multi_threaded = true;
+	REQUIRE(ecs_system_init(pWorld, &systemDesc) != 0);
+
+	// The task threads run as jobs, every entity is still updated once per frame
+	ecs_set_task_threads(pWorld, 2);
+	ecs_progress(pWorld, 0.016f);
+	ecs_progress(pWorld, 0.016f);
+
+	uint32_t total = 0;
+	ecs_query_desc_t queryDesc = {};
+	queryDesc.terms[0].id = ecs_id(EcsTestCounter);
+	ecs_query_t* pQuery = ecs_query_init(pWorld, &queryDesc);
+	ecs_iter_t it = ecs_query_iter(pWorld, pQuery);
+	while (ecs_query_next(&it))
+	{
+		const EcsTestCounter* pCounters = ecs_field(&it, EcsTestCounter, 0);
+		for (int32_t i = 0; i < it.count; ++i)
+			total += pCounters[i].value;
+	}
+	ecs_query_fini(pQuery);
+	REQUIRE(total == entityCount * 2);
+
+	ecs_fini(pWorld);
+
+	initECSJobHooks(NULL);
+	REQUIRE(ecs_os_api.task_new_ == pDefaultTaskNew);
+	REQUIRE(ecs_os_api.task_join_ == pDefaultTaskJoin);
+
+	jobSystemDestroy(pJobs);
+}
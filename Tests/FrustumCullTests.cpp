@@ -0,0 +1,84 @@
+#include "catch_amalgamated.hpp"
+#include "Core/FrustumCull.h"
+
+#include <math.h>
+
+// Identity clip space: -1 <= x, y <= 1 and 0 <= z <= 1
+static const float gIdentity[16] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+									0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+
+TEST_CASE("FrustumCull extracts normalized planes", "[cull]")
+{
+	// Scale x by 2 so the left and right planes need normalizing
+	float viewProjection[16];
+	for (int i = 0; i < 16; ++i)
+		viewProjection[i] = gIdentity[i];
+	viewProjection[0] = 2.0f;
+
+	Frustum frustum = {};
+	extractFrustumPlanes(&frustum, viewProjection);
+
+	for (int p = 0; p < 6; ++p)
+	{
+		float length = sqrtf(frustum.planeX[p] * frustum.planeX[p] +
+							 frustum.planeY[p] * frustum.planeY[p] +
+							 frustum.planeZ[p] * frustum.planeZ[p]);
+		REQUIRE(fabsf(length - 1.0f) < 1e-5f);
+	}
+
+	// Left plane is x >= -0.5
+	REQUIRE(fabsf(frustum.planeX[0] - 1.0f) < 1e-5f);
+	REQUIRE(fabsf(frustum.planeW[0] - 0.5f) < 1e-5f);
+}
+
+TEST_CASE("FrustumCull keeps inside and touching spheres", "[cull]")
+{
+	Frustum frustum = {};
+	extractFrustumPlanes(&frustum, gIdentity);
+
+	// Inside, far left, touching right, behind near, past far, straddling top
+	float x[6] = {0.0f, -3.0f, 1.5f, 0.0f, 0.0f, 0.0f};
+	float y[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.2f};
+	float z[6] = {0.5f, 0.5f, 0.5f, -0.5f, 2.0f, 0.5f};
+	float radius[6] = {0.1f, 1.0f, 0.6f, 0.25f, 0.5f, 0.3f};
+	uint8_t visible[6] = {};
+
+	uint32_t visibleCount = cullSpheres(&frustum, x, y, z, radius, 6, visible);
+
+	REQUIRE(visibleCount == 3);
+	REQUIRE(visible[0] == 1);
+	REQUIRE(visible[1] == 0);
+	REQUIRE(visible[2] == 1);
+	REQUIRE(visible[3] == 0);
+	REQUIRE(visible[4] == 0);
+	REQUIRE(visible[5] == 1);
+}
+
+TEST_CASE("FrustumCull SIMD and remainder paths agree", "[cull]")
+{
+	Frustum frustum = {};
+	extractFrustumPlanes(&frustum, gIdentity);
+
+	// 11 spheres walking across the right plane, covers SIMD steps and remainder
+	const uint32_t count = 11;
+	float x[count], y[count], z[count], radius[count];
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		x[i] = (float)i * 0.25f;
+		y[i] = 0.0f;
+		z[i] = 0.5f;
+		radius[i] = 0.1f;
+	}
+
+	uint8_t visible[count] = {};
+	uint32_t visibleCount = cullSpheres(&frustum, x, y, z, radius, count, visible);
+
+	uint32_t expected = 0;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		uint8_t inside = x[i] - radius[i] <= 1.0f ? 1 : 0;
+		REQUIRE(visible[i] == inside);
+		expected += inside;
+	}
+	REQUIRE(visibleCount == expected);
+}
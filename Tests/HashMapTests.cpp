@@ -504,3 +504,111 @@ TEST_CASE("HashMap case sensitive keys", "[hashmap]")
 	hashMapDestroy(pMap);
 	arenaRelease(pArena);
 }
+
+TEST_CASE("HashMap value pointers survive growth", "[hashmap]")
+{
+	Arena* pArena = arenaCreate();
+	HashMap* pMap = hashMapCreate(pArena, sizeof(int));
+
+	hashMapInsert(pMap, "anchor", 7);
+	int* pAnchor = hashMapGet<int>(pMap, "anchor");
+	REQUIRE(pAnchor != nullptr);
+
+	char keyBuffer[64];
+	for (int i = 0; i < 1000; i++)
+	{
+		snprintf(keyBuffer, sizeof(keyBuffer), "grow_%d", i);
+		hashMapInsert(pMap, keyBuffer, i);
+	}
+
+	REQUIRE(hashMapGet<int>(pMap, "anchor") == pAnchor);
+	REQUIRE(*pAnchor == 7);
+
+	hashMapDestroy(pMap);
+	arenaRelease(pArena);
+}
+
+TEST_CASE("HashMap churn keeps lookups consistent", "[hashmap][stress]")
+{
+	Arena* pArena = arenaCreate();
+	HashMap* pMap = hashMapCreate(pArena, sizeof(int));
+
+	char keyBuffer[64];
+	for (int round = 0; round < 10; round++)
+	{
+		for (int i = 0; i < 500; i++)
+		{
+			snprintf(keyBuffer, sizeof(keyBuffer), "churn_%d", i);
+			hashMapInsert(pMap, keyBuffer, i + round);
+		}
+
+		for (int i = 0; i < 500; i += 3)
+		{
+			snprintf(keyBuffer, sizeof(keyBuffer), "churn_%d", i);
+			hashMapRemove(pMap, keyBuffer);
+		}
+
+		for (int i = 0; i < 500; i++)
+		{
+			snprintf(keyBuffer, sizeof(keyBuffer), "churn_%d", i);
+			int* pValue = hashMapGet<int>(pMap, keyBuffer);
+			if (i % 3 == 0)
+			{
+				REQUIRE(pValue == nullptr);
+			}
+			else
+			{
+				REQUIRE(pValue != nullptr);
+				REQUIRE(*pValue == i + round);
+			}
+		}
+	}
+
+	REQUIRE(hashMapCount(pMap) == 500 - 167);
+
+	hashMapDestroy(pMap);
+	arenaRelease(pArena);
+}
+
+TEST_CASE("HashedKey literals are hashed at compile time", "[hashmap][hashed]")
+{
+	constexpr HashedKey key = hashedKey("player.dds");
+	static_assert(key.length == 10, "Literal length excludes terminator");
+	static_assert(key.hash == hashString("player.dds", 10), "Literal hash must match runtime hash");
+	static_assert(hashString("", 0) != 0, "Zero hash is reserved for empty slots");
+
+	HashedKey runtimeKey = hashedKeyFromString("player.dds");
+	REQUIRE(runtimeKey.hash == key.hash);
+	REQUIRE(runtimeKey.length == key.length);
+	REQUIRE(HASHED_KEY("player.dds").hash == key.hash);
+}
+
+TEST_CASE("HashMap hashed and string APIs agree", "[hashmap][hashed]")
+{
+	Arena* pArena = arenaCreate();
+	HashMap* pMap = hashMapCreate(pArena, sizeof(int));
+
+	hashMapInsert(pMap, "enemy.dds", 1);
+	hashMapInsertHashed(pMap, HASHED_KEY("player.dds"), 2);
+
+	REQUIRE(hashMapCount(pMap) == 2);
+	REQUIRE(*hashMapGetHashed<int>(pMap, HASHED_KEY("enemy.dds")) == 1);
+	REQUIRE(*hashMapGet<int>(pMap, "player.dds") == 2);
+	REQUIRE(hashMapContainsHashed(pMap, HASHED_KEY("player.dds")));
+	REQUIRE(hashMapGetHashed<int>(pMap, HASHED_KEY("missing.dds")) == nullptr);
+
+	// Interned key is a separate copy of the caller's string
+	char keyBuffer[] = "enemy.dds";
+	const char* pInterned = hashMapGetKey(pMap, hashedKeyFromString(keyBuffer));
+	REQUIRE(pInterned != nullptr);
+	REQUIRE(pInterned != keyBuffer);
+	REQUIRE(strcmp(pInterned, "enemy.dds") == 0);
+
+	hashMapRemoveHashed(pMap, HASHED_KEY("enemy.dds"));
+	REQUIRE(!hashMapContains(pMap, "enemy.dds"));
+	REQUIRE(hashMapGetKey(pMap, HASHED_KEY("enemy.dds")) == nullptr);
+	REQUIRE(hashMapCount(pMap) == 1);
+
+	hashMapDestroy(pMap);
+	arenaRelease(pArena);
+}
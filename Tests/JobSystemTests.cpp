@@ -0,0 +1,192 @@
+#include "catch_amalgamated.hpp"
+#include "Runtime/JobSystem.h"
+#include "Utilities/Threading/Atomics.h"
+
+#include <thread>
+#include <vector>
+
+static void incrementJob(void* pData)
+{
+	tfrg_atomic32_add_relaxed((tfrg_atomic32_t*)pData, 1);
+}
+
+TEST_CASE("JobSystem runs every job before the counter reaches zero", "[jobs]")
+{
+	JobSystemDesc desc = {};
+	desc.workerCount = 4;
+	JobSystem* pJobs = jobSystemCreate(&desc);
+	REQUIRE(pJobs != nullptr);
+	REQUIRE(jobSystemGetWorkerCount(pJobs) == 4);
+	REQUIRE(jobSystemGetThreadIndex(pJobs) == 0);
+
+	uint32_t total = 0;
+	std::vector<JobDesc> jobs(10000, JobDesc{incrementJob, &total, JobFlag_None});
+
+	JobCounter counter = {};
+	jobRun(pJobs, jobs.data(), (uint32_t)jobs.size(), &counter);
+	jobWait(pJobs, &counter);
+
+	REQUIRE(jobIsDone(&counter));
+	REQUIRE(tfrg_atomic32_load_relaxed((tfrg_atomic32_t*)&total) == 10000);
+
+	jobSystemDestroy(pJobs);
+}
+
+TEST_CASE("JobSystem without workers runs jobs in jobWait", "[jobs]")
+{
+	JobSystemDesc desc = {};
+	desc.workerCount = 0;
+	JobSystem* pJobs = jobSystemCreate(&desc);
+	REQUIRE(pJobs != nullptr);
+
+	uint32_t total = 0;
+	JobDesc job = {incrementJob, &total, JobFlag_None};
+	JobCounter counter = {};
+	for (uint32_t i = 0; i < 100; ++i)
+		jobRun(pJobs, &job, 1, &counter);
+
+	REQUIRE(!jobIsDone(&counter));
+	jobWait(pJobs, &counter);
+	REQUIRE(total == 100);
+
+	jobSystemDestroy(pJobs);
+}
+
+struct ChainData
+{
+	uint32_t stage;
+	uint32_t orderOk;
+};
+
+static void firstStageJob(void* pData)
+{
+	tfrg_atomic32_add_relaxed((tfrg_atomic32_t*)&((ChainData*)pData)->stage, 1);
+}
+
+static void secondStageJob(void* pData)
+{
+	ChainData* pChain = (ChainData*)pData;
+	if (tfrg_atomic32_load_relaxed((tfrg_atomic32_t*)&pChain->stage) == 64)
+		tfrg_atomic32_add_relaxed((tfrg_atomic32_t*)&pChain->orderOk, 1);
+}
+
+TEST_CASE("JobSystem runs dependent jobs after their dependency", "[jobs]")
+{
+	JobSystem* pJobs = jobSystemCreate();
+	REQUIRE(pJobs != nullptr);
+
+	ChainData chain = {};
+	std::vector<JobDesc> first(64, JobDesc{firstStageJob, &chain, JobFlag_None});
+	std::vector<JobDesc> second(16, JobDesc{secondStageJob, &chain, JobFlag_None});
+
+	JobCounter firstCounter = {};
+	JobCounter secondCounter = {};
+	jobRun(pJobs, first.data(), 64, &firstCounter);
+	jobRunAfter(pJobs, &firstCounter, second.data(), 16, &secondCounter);
+	jobWait(pJobs, &secondCounter);
+
+	REQUIRE(jobIsDone(&firstCounter));
+	REQUIRE(chain.orderOk == 16);
+
+	// A dependency that is already done releases the jobs right away
+	chain.orderOk = 0;
+	JobCounter laterCounter = {};
+	jobRunAfter(pJobs, &firstCounter, second.data(), 16, &laterCounter);
+	jobWait(pJobs, &laterCounter);
+	REQUIRE(chain.orderOk == 16);
+
+	jobSystemDestroy(pJobs);
+}
+
+struct NestedData
+{
+	JobSystem* pJobs;
+	uint32_t leaves;
+};
+
+static void nestedJob(void* pData)
+{
+	NestedData* pNested = (NestedData*)pData;
+	JobDesc leaf = {incrementJob, &pNested->leaves, JobFlag_None};
+	std::vector<JobDesc> leaves(32, leaf);
+
+	// Waiting inside a job helps instead of blocking the worker
+	JobCounter counter = {};
+	jobRun(pNested->pJobs, leaves.data(), 32, &counter);
+	jobWait(pNested->pJobs, &counter);
+}
+
+TEST_CASE("JobSystem jobs can wait on jobs they spawn", "[jobs]")
+{
+	JobSystemDesc desc = {};
+	desc.workerCount = 2;
+	JobSystem* pJobs = jobSystemCreate(&desc);
+
+	NestedData nested = {pJobs, 0};
+	std::vector<JobDesc> jobs(64, JobDesc{nestedJob, &nested, JobFlag_None});
+	JobCounter counter = {};
+	jobRun(pJobs, jobs.data(), 64, &counter);
+	jobWait(pJobs, &counter);
+
+	REQUIRE(nested.leaves == 64 * 32);
+
+	jobSystemDestroy(pJobs);
+}
+
+TEST_CASE("JobSystem accepts jobs from outside threads", "[jobs][threads]")
+{
+	JobSystemDesc desc = {};
+	desc.workerCount = 2;
+	JobSystem* pJobs = jobSystemCreate(&desc);
+
+	uint32_t total = 0;
+	uint32_t outsideIndex = 0;
+	std::thread outside(
+		[&]()
+		{
+			outsideIndex = jobSystemGetThreadIndex(pJobs);
+			std::vector<JobDesc> jobs(5000, JobDesc{incrementJob, &total, JobFlag_None});
+			JobCounter counter = {};
+			jobRun(pJobs, jobs.data(), (uint32_t)jobs.size(), &counter);
+			jobWait(pJobs, &counter);
+		});
+	outside.join();
+
+	REQUIRE(outsideIndex == UINT32_MAX);
+	REQUIRE(total == 5000);
+
+	jobSystemDestroy(pJobs);
+}
+
+static void blockingJob(void* pData)
+{
+	// Spins until the main thread lets go, a waiter running this would hang
+	while (tfrg_atomic32_load_acquire((tfrg_atomic32_t*)pData) == 0)
+		std::this_thread::yield();
+}
+
+TEST_CASE("JobSystem keeps blocking jobs away from waiting threads", "[jobs]")
+{
+	JobSystemDesc desc = {};
+	desc.workerCount = 1;
+	JobSystem* pJobs = jobSystemCreate(&desc);
+
+	uint32_t release = 0;
+	JobDesc blocking = {blockingJob, &release, JobFlag_Blocking};
+	JobCounter blockingCounter = {};
+	jobRun(pJobs, &blocking, 1, &blockingCounter);
+
+	// The main thread only helps with regular jobs while it waits. The worker
+	// is stuck in the blocking job, so the main thread runs all of these
+	uint32_t total = 0;
+	std::vector<JobDesc> jobs(100, JobDesc{incrementJob, &total, JobFlag_None});
+	JobCounter counter = {};
+	jobRun(pJobs, jobs.data(), 100, &counter);
+	jobWait(pJobs, &counter);
+	REQUIRE(total == 100);
+
+	tfrg_atomic32_store_release((tfrg_atomic32_t*)&release, 1);
+	jobWait(pJobs, &blockingCounter);
+
+	jobSystemDestroy(pJobs);
+}
@@ -0,0 +1,152 @@
+#include "catch_amalgamated.hpp"
+#include "Runtime/Memory/Arena.h"
+#include "Runtime/Memory/Pool.h"
+
+#include <thread>
+#include <vector>
+
+TEST_CASE("Pool reuses freed chunks", "[pool]")
+{
+	Arena* pArena = arenaCreate();
+	PoolParams params = {};
+	params.chunkSize = 24;
+	Pool* pPool = poolCreate(pArena, &params);
+	REQUIRE(pPool != nullptr);
+	REQUIRE(pPool->chunkSize == 24);
+
+	void* pFirst = poolAlloc(pPool);
+	void* pSecond = poolAlloc(pPool);
+	REQUIRE(pFirst != nullptr);
+	REQUIRE(pSecond != nullptr);
+	REQUIRE(pFirst != pSecond);
+
+	poolFree(pPool, pFirst);
+	uint64_t posBefore = arenaGetPos(pArena);
+	REQUIRE(poolAlloc(pPool) == pFirst);
+	REQUIRE(arenaGetPos(pArena) == posBefore);
+
+	arenaRelease(pArena);
+}
+
+TEST_CASE("Pool reports live, peak and free counts", "[pool]")
+{
+	Arena* pArena = arenaCreate();
+	PoolParams params = {};
+	params.chunkSize = 32;
+	params.chunksPerBlock = 4;
+	Pool* pPool = poolCreate(pArena, &params);
+
+	void* pChunks[6];
+	for (uint32_t i = 0; i < 6; ++i)
+		pChunks[i] = poolAlloc(pPool);
+
+	PoolStats stats;
+	poolGetStats(pPool, &stats);
+	REQUIRE(stats.liveCount == 6);
+	REQUIRE(stats.peakCount == 6);
+	REQUIRE(stats.blockCount == 2);
+	REQUIRE(stats.freeCount == 2);
+	REQUIRE(stats.reservedBytes == 8 * 32);
+
+	for (uint32_t i = 0; i < 4; ++i)
+		poolFree(pPool, pChunks[i]);
+
+	poolGetStats(pPool, &stats);
+	REQUIRE(stats.liveCount == 2);
+	REQUIRE(stats.peakCount == 6);
+	REQUIRE(stats.freeCount == 6);
+
+	arenaRelease(pArena);
+}
+
+TEST_CASE("Pool chunks honor alignment", "[pool]")
+{
+	Arena* pArena = arenaCreate();
+	PoolParams params = {};
+	params.chunkSize = 20;
+	params.chunkAlign = 32;
+	Pool* pPool = poolCreate(pArena, &params);
+	REQUIRE(pPool->chunkSize == 32);
+
+	for (uint32_t i = 0; i < 100; ++i)
+		REQUIRE(((uintptr_t)poolAlloc(pPool) & 31) == 0);
+
+	params.chunkAlign = 24;
+	REQUIRE(poolCreate(pArena, &params) == nullptr);
+
+	arenaRelease(pArena);
+}
+
+TEST_CASE("Pool magazines hand out unique chunks across threads", "[pool][threads]")
+{
+	ArenaParams arenaParams = {};
+	arenaParams.flags = ArenaFlag_Atomic;
+	Arena* pArena = arenaCreate(&arenaParams);
+
+	PoolParams params = {};
+	params.chunkSize = sizeof(uint64_t);
+	params.flags = PoolFlag_ThreadMagazines;
+	Pool* pPool = poolCreate(pArena, &params);
+	REQUIRE(pPool != nullptr);
+
+	const uint32_t threadCount = 4;
+	const uint32_t perThread = 2000;
+	std::vector<uint64_t*> chunks[threadCount];
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < threadCount; ++t)
+	{
+		threads.emplace_back(
+			[&, t]()
+			{
+				// Churn first so chunks move between magazines and the shared list
+				for (uint32_t round = 0; round < 4; ++round)
+				{
+					for (uint32_t i = 0; i < perThread; ++i)
+						chunks[t].push_back((uint64_t*)poolAlloc(pPool));
+					for (uint32_t i = 0; i < perThread / 2; ++i)
+					{
+						poolFree(pPool, chunks[t].back());
+						chunks[t].pop_back();
+					}
+				}
+				for (uint64_t* pChunk : chunks[t])
+					*pChunk = t;
+			});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+
+	uint64_t total = 0;
+	for (uint32_t t = 0; t < threadCount; ++t)
+	{
+		for (uint64_t* pChunk : chunks[t])
+			REQUIRE(*pChunk == t);
+		total += chunks[t].size();
+	}
+
+	PoolStats stats;
+	poolGetStats(pPool, &stats);
+	REQUIRE(stats.liveCount == total);
+	REQUIRE(stats.peakCount >= total);
+
+	arenaRelease(pArena);
+}
+
+TEST_CASE("PoolSet rounds up to power of two size classes", "[pool]")
+{
+	Arena* pArena = arenaCreate();
+	PoolSet* pSet = poolSetCreate(pArena);
+	REQUIRE(pSet != nullptr);
+
+	REQUIRE(poolSetGetPool(pSet, 1)->chunkSize == 64);
+	REQUIRE(poolSetGetPool(pSet, 64)->chunkSize == 64);
+	REQUIRE(poolSetGetPool(pSet, 65)->chunkSize == 128);
+	REQUIRE(poolSetGetPool(pSet, 1000)->chunkSize == 1024);
+
+	void* pBlock = poolSetAlloc(pSet, 700);
+	REQUIRE(((uintptr_t)pBlock & 63) == 0);
+	poolSetFree(pSet, pBlock, 700);
+	REQUIRE(poolSetAlloc(pSet, 1024) == pBlock);
+
+	arenaRelease(pArena);
+}
@@ -0,0 +1,59 @@
+#include "catch_amalgamated.hpp"
+#include "Core/RadixSort.h"
+
+TEST_CASE("RadixSort sorts keys and carries values", "[radixsort]")
+{
+	const uint32_t count = 1000;
+	uint64_t keys[count];
+	uint32_t values[count];
+	uint64_t tempKeys[count];
+	uint32_t tempValues[count];
+
+	// Spread keys over every byte so all passes run
+	uint64_t state = 0x9E3779B97F4A7C15ull;
+	uint64_t original[count];
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		keys[i] = state;
+		original[i] = state;
+		values[i] = i;
+	}
+
+	radixSort64(keys, values, tempKeys, tempValues, count);
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		REQUIRE(keys[i] == original[values[i]]);
+		if (i > 0)
+			REQUIRE(keys[i - 1] <= keys[i]);
+	}
+}
+
+TEST_CASE("RadixSort is stable for equal keys", "[radixsort]")
+{
+	uint64_t keys[6] = {3ull << 56, 1, 3ull << 56, 1, 2, 1};
+	uint32_t values[6] = {0, 1, 2, 3, 4, 5};
+	uint64_t tempKeys[6];
+	uint32_t tempValues[6];
+
+	radixSort64(keys, values, tempKeys, tempValues, 6);
+
+	uint32_t expected[6] = {1, 3, 5, 4, 0, 2};
+	for (uint32_t i = 0; i < 6; ++i)
+		REQUIRE(values[i] == expected[i]);
+}
+
+TEST_CASE("RadixSort handles trivial input", "[radixsort][edge]")
+{
+	uint64_t key = 42;
+	uint32_t value = 7;
+	radixSort64(&key, &value, nullptr, nullptr, 1);
+	REQUIRE(key == 42);
+	REQUIRE(value == 7);
+
+	radixSort64(nullptr, nullptr, nullptr, nullptr, 0);
+	REQUIRE(true);
+}
@@ -1,6 +1,7 @@
 #include "catch_amalgamated.hpp"
 #include "Runtime/Memory/Arena.h"
 #include "Core/SlotMap.h"
+#include "Runtime/Memory/Pool.h"
 
 TEST_CASE("SlotMap template API works", "[slotmap][template]")
 {
@@ -602,3 +603,225 @@ TEST_CASE("SlotMap invalid typed handles", "[slotmap][handles]")
 	REQUIRE(!handleIsValid(mat.id));
 	REQUIRE(!handleIsValid(shader.id));
 }
+
+TEST_CASE("SlotMap pooled storage is reclaimed on growth", "[slotmap][pool]")
+{
+	Arena* pArena = arenaCreate();
+	PoolSet* pPools = poolSetCreate(pArena);
+	// 16 uint64_t values sit in their own size class, apart from the index arrays
+	SlotMap* pMap = slotMapCreate(pArena, sizeof(uint64_t), alignof(uint64_t), 16, pPools);
+	REQUIRE(pMap != nullptr);
+
+	void* pOldValues = pMap->pValues;
+	uint32_t handles[17];
+	for (uint64_t i = 0; i < 17; ++i)
+		handles[i] = slotMapInsert(pMap, i);
+
+	REQUIRE(slotMapCapacity(pMap) == 32);
+	for (uint64_t i = 0; i < 17; ++i)
+		REQUIRE(*slotMapGet<uint64_t>(pMap, handles[i]) == i);
+
+	// The 16 slot value array went back to its size class
+	SlotMap* pOther = slotMapCreate(pArena, sizeof(uint64_t), alignof(uint64_t), 16, pPools);
+	REQUIRE(pOther->pValues == pOldValues);
+
+	slotMapDestroy(pMap);
+	REQUIRE(slotMapCapacity(pMap) == 0);
+	REQUIRE(slotMapGet<uint64_t>(pMap, handles[0]) == nullptr);
+
+	arenaRelease(pArena);
+}
+
+TEST_CASE("SlotMap reserve grows once and keeps handles", "[slotmap][batch]")
+{
+	Arena* pArena = arenaCreate();
+	SlotMap* pMap = slotMapCreate(pArena, sizeof(uint32_t), alignof(uint32_t), 4);
+
+	uint32_t first = slotMapInsert(pMap, 7u);
+	REQUIRE(slotMapReserve(pMap, 1000));
+	REQUIRE(slotMapCapacity(pMap) == 1024);
+	REQUIRE(*slotMapGet<uint32_t>(pMap, first) == 7);
+
+	// Smaller requests leave the capacity alone
+	REQUIRE(slotMapReserve(pMap, 10));
+	REQUIRE(slotMapCapacity(pMap) == 1024);
+
+	arenaRelease(pArena);
+}
+
+TEST_CASE("SlotMap batch insert, get and remove", "[slotmap][batch]")
+{
+	Arena* pArena = arenaCreate();
+	SlotMap* pMap = slotMapCreate(pArena, sizeof(uint64_t), alignof(uint64_t), 8);
+
+	const uint32_t count = 500;
+	uint64_t values[count];
+	uint32_t handles[count];
+	for (uint32_t i = 0; i < count; ++i)
+		values[i] = (uint64_t)i * 3;
+
+	REQUIRE(slotMapInsertN(pMap, values, count, handles) == count);
+	REQUIRE(slotMapCount(pMap) == count);
+	REQUIRE(slotMapCapacity(pMap) == 512);
+
+	uint64_t* pResolved[count];
+	REQUIRE(slotMapGetN(pMap, handles, count, pResolved) == count);
+	for (uint32_t i = 0; i < count; ++i)
+		REQUIRE(*pResolved[i] == (uint64_t)i * 3);
+
+	// Remove every other element, then the stale handles no longer resolve
+	uint32_t evenHandles[count / 2];
+	for (uint32_t i = 0; i < count / 2; ++i)
+		evenHandles[i] = handles[i * 2];
+	REQUIRE(slotMapRemoveN(pMap, evenHandles, count / 2) == count / 2);
+	REQUIRE(slotMapRemoveN(pMap, evenHandles, count / 2) == 0);
+	REQUIRE(slotMapCount(pMap) == count / 2);
+
+	REQUIRE(slotMapGetN(pMap, handles, count, pResolved) == count / 2);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (i % 2 == 0)
+			REQUIRE(pResolved[i] == nullptr);
+		else
+			REQUIRE(*pResolved[i] == (uint64_t)i * 3);
+	}
+
+	arenaRelease(pArena);
+}
+
+TEST_CASE("SlotMap iteration visits every element with its handle", "[slotmap][batch]")
+{
+	Arena* pArena = arenaCreate();
+	SlotMap* pMap = slotMapCreate(pArena, sizeof(uint32_t), alignof(uint32_t), 16);
+
+	uint32_t handles[10];
+	for (uint32_t i = 0; i < 10; ++i)
+		handles[i] = slotMapInsert(pMap, i);
+	slotMapRemove(pMap, handles[3]);
+	slotMapRemove(pMap, handles[8]);
+
+	uint32_t visited = 0;
+	uint32_t sum = 0;
+	slotMapForEach<uint32_t>(pMap,
+							 [&](uint32_t& value, uint32_t handle)
+							 {
+								 REQUIRE(slotMapGet<uint32_t>(pMap, handle) == &value);
+								 sum += value;
+								 visited++;
+							 });
+	REQUIRE(visited == 8);
+	REQUIRE(sum == 45 - 3 - 8);
+
+	uint32_t* pValues = slotMapValues<uint32_t>(pMap);
+	for (uint32_t i = 0; i < slotMapCount(pMap); ++i)
+		REQUIRE(slotMapGet<uint32_t>(pMap, slotMapHandleAt(pMap, i)) == &pValues[i]);
+
+	arenaRelease(pArena);
+}
+
+TEST_CASE("SlotMap retires a slot whose generation would wrap", "[slotmap][generation]")
+{
+	Arena* pArena = arenaCreate();
+	SlotMap* pMap = slotMapCreate(pArena, sizeof(int), alignof(int), 4);
+
+	int value = 1;
+	uint32_t first = slotMapInsert(pMap, value);
+	uint32_t handle = first;
+	for (uint32_t i = 0; i < HANDLE_GENERATION_MASK; i++)
+	{
+		slotMapRemove(pMap, handle);
+		handle = slotMapInsert(pMap, value);
+		REQUIRE(handleIndex(handle) == handleIndex(first));
+	}
+	REQUIRE(handleGeneration(handle) == HANDLE_GENERATION_MASK);
+
+	// Reusing the slot now would hand out generation 0 again and revive first
+	slotMapRemove(pMap, handle);
+	REQUIRE(slotMapRetiredCount(pMap) == 1);
+
+	uint32_t next = slotMapInsert(pMap, value);
+	REQUIRE(handleIndex(next) != handleIndex(first));
+	REQUIRE(!slotMapIsValid(pMap, first));
+	REQUIRE(!slotMapIsValid(pMap, handle));
+	REQUIRE(slotMapGet<int>(pMap, next) != nullptr);
+
+	// The retired slot still takes up capacity
+	for (uint32_t i = 0; i < 3; i++)
+		slotMapInsert(pMap, value);
+	REQUIRE(slotMapCount(pMap) == 4);
+	REQUIRE(slotMapCapacity(pMap) == 8);
+
+	arenaRelease(pArena);
+}
+
+TEST_CASE("Handle64 make and extract", "[handle]")
+{
+	uint64_t handle = handle64Make(0xFFFFFFFE, 0x12345678);
+	REQUIRE(handle64Index(handle) == 0xFFFFFFFE);
+	REQUIRE(handle64Generation(handle) == 0x12345678);
+	REQUIRE(handle64IsValid(handle));
+	REQUIRE(!handle64IsValid(HANDLE64_INVALID_ID));
+}
+
+TEST_CASE("SlotMap64 keeps reusing slots past 256 generations", "[slotmap][handle64]")
+{
+	Arena* pArena = arenaCreate();
+	SlotMap64* pMap = slotMapCreate64(pArena, sizeof(int), alignof(int), 4);
+	REQUIRE(pMap != nullptr);
+
+	int value = 5;
+	uint64_t first = slotMapInsert(pMap, value);
+	uint64_t handle = first;
+	for (uint32_t i = 0; i < 1000; i++)
+	{
+		slotMapRemove(pMap, handle);
+		handle = slotMapInsert(pMap, value);
+	}
+
+	REQUIRE(handle64Index(handle) == handle64Index(first));
+	REQUIRE(handle64Generation(handle) == 1000);
+	REQUIRE(slotMapRetiredCount(pMap) == 0);
+	REQUIRE(!slotMapIsValid(pMap, first));
+	REQUIRE(*slotMapGet<int>(pMap, handle) == 5);
+
+	// Jump close to the end of the generation range to check the retirement
+	pMap->pGenerations[handle64Index(handle)] = 0xFFFFFFFF;
+	handle = handle64Make(handle64Index(handle), 0xFFFFFFFF);
+	REQUIRE(slotMapIsValid(pMap, handle));
+	slotMapRemove(pMap, handle);
+	REQUIRE(slotMapRetiredCount(pMap) == 1);
+	REQUIRE(handle64Index(slotMapInsert(pMap, value)) != handle64Index(first));
+
+	arenaRelease(pArena);
+}
+
+TEST_CASE("SlotMap64 batch and iteration helpers", "[slotmap][handle64][batch]")
+{
+	Arena* pArena = arenaCreate();
+	SlotMap64* pMap = slotMapCreate64(pArena, sizeof(uint32_t), alignof(uint32_t), 8);
+
+	uint32_t values[100];
+	uint64_t handles[100];
+	for (uint32_t i = 0; i < 100; ++i)
+		values[i] = i;
+	REQUIRE(slotMapInsertN(pMap, values, 100, handles) == 100);
+
+	uint32_t* pResolved[100];
+	REQUIRE(slotMapGetN(pMap, handles, 100, pResolved) == 100);
+	REQUIRE(*pResolved[42] == 42);
+
+	REQUIRE(slotMapRemoveN(pMap, handles, 50) == 50);
+
+	uint32_t sum = 0;
+	slotMapForEach<uint32_t>(pMap,
+							 [&](uint32_t& v, uint64_t handle)
+							 {
+								 REQUIRE(slotMapGet<uint32_t>(pMap, handle) == &v);
+								 sum += v;
+							 });
+	REQUIRE(sum == (50 + 99) * 50 / 2);
+	REQUIRE(slotMapGet<uint32_t>(pMap, slotMapHandleAt(pMap, 0)) != nullptr);
+
+	slotMapDestroy(pMap);
+	arenaRelease(pArena);
+}
@@ -0,0 +1,142 @@
+#include "catch_amalgamated.hpp"
+#include "Runtime/Trace.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+// Events of the calling test, other tests may have recorded before
+static std::vector<TraceEvent> snapshotEvents()
+{
+	std::vector<TraceEvent> events(traceSnapshot(nullptr, 0));
+	events.resize(traceSnapshot(events.data(), (uint32_t)events.size()));
+	return events;
+}
+
+static uint32_t countNamed(const std::vector<TraceEvent>& events, const char* pName)
+{
+	uint32_t count = 0;
+	for (const TraceEvent& event : events)
+		count += strcmp(event.pName, pName) == 0 ? 1 : 0;
+	return count;
+}
+
+TEST_CASE("Trace scopes record nested events", "[trace]")
+{
+	traceSetEnabled(true);
+	traceClear();
+	{
+		ENGINE_PROFILE_SCOPE("outer");
+		{
+			ENGINE_PROFILE_SCOPE("inner");
+		}
+	}
+
+	std::vector<TraceEvent> events = snapshotEvents();
+	REQUIRE(events.size() == 2);
+
+	// Scopes are recorded when they end, inner first
+	REQUIRE(strcmp(events[0].pName, "inner") == 0);
+	REQUIRE(strcmp(events[1].pName, "outer") == 0);
+	REQUIRE(events[0].threadIndex == events[1].threadIndex);
+	REQUIRE(events[1].startNs <= events[0].startNs);
+	REQUIRE(events[0].endNs <= events[1].endNs);
+	REQUIRE(events[0].startNs <= events[0].endNs);
+}
+
+TEST_CASE("Trace records nothing while disabled", "[trace]")
+{
+	traceClear();
+	traceSetEnabled(false);
+	{
+		ENGINE_PROFILE_SCOPE("disabled");
+	}
+	traceSetEnabled(true);
+
+	REQUIRE(traceSnapshot(nullptr, 0) == 0);
+	REQUIRE(traceIsEnabled());
+}
+
+TEST_CASE("Trace ring keeps the newest events", "[trace]")
+{
+	traceSetEnabled(true);
+	traceClear();
+
+	static const char* kNames[2] = {"old", "new"};
+	for (uint32_t i = 0; i < TRACE_RING_CAPACITY + 100; ++i)
+	{
+		ENGINE_PROFILE_SCOPE(kNames[i >= 100 ? 1 : 0]);
+	}
+
+	// One slot stays free for the event being written
+	std::vector<TraceEvent> events = snapshotEvents();
+	REQUIRE(events.size() == TRACE_RING_CAPACITY - 1);
+	REQUIRE(countNamed(events, "old") == 0);
+	REQUIRE(countNamed(events, "new") == TRACE_RING_CAPACITY - 1);
+}
+
+TEST_CASE("Trace gives every thread its own ring", "[trace]")
+{
+	traceSetEnabled(true);
+	traceClear();
+
+	const uint32_t threadCount = 4;
+	const uint32_t scopesPerThread = 1000;
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < threadCount; ++t)
+	{
+		threads.emplace_back([]() {
+			traceSetThreadName("Trace Worker");
+			for (uint32_t i = 0; i < scopesPerThread; ++i)
+			{
+				ENGINE_PROFILE_SCOPE("worker");
+			}
+		});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+
+	std::vector<TraceEvent> events = snapshotEvents();
+	REQUIRE(countNamed(events, "worker") == threadCount * scopesPerThread);
+
+	std::vector<uint32_t> perThread(TRACE_MAX_THREADS, 0);
+	for (const TraceEvent& event : events)
+		perThread[event.threadIndex]++;
+
+	uint32_t workerThreads = 0;
+	for (uint32_t t = 0; t < TRACE_MAX_THREADS; ++t)
+	{
+		if (perThread[t] == 0)
+			continue;
+		REQUIRE(perThread[t] == scopesPerThread);
+		REQUIRE(strcmp(traceGetThreadName(t), "Trace Worker") == 0);
+		workerThreads++;
+	}
+	REQUIRE(workerThreads == threadCount);
+}
+
+TEST_CASE("Trace writes Chrome trace JSON", "[trace]")
+{
+	traceSetEnabled(true);
+	traceClear();
+	{
+		ENGINE_PROFILE_SCOPE("exported");
+	}
+
+	const char* pPath = "trace_test.json";
+	REQUIRE(traceWriteChromeJson(pPath));
+
+	FILE* pFile = fopen(pPath, "r");
+	REQUIRE(pFile != nullptr);
+	std::vector<char> text(1 << 16, 0);
+	size_t size = fread(text.data(), 1, text.size() - 1, pFile);
+	fclose(pFile);
+	remove(pPath);
+
+	REQUIRE(size > 0);
+	REQUIRE(strstr(text.data(), "\"traceEvents\"") != nullptr);
+	REQUIRE(strstr(text.data(), "\"name\":\"exported\"") != nullptr);
+	REQUIRE(strstr(text.data(), "\"ph\":\"X\"") != nullptr);
+	REQUIRE(strstr(text.data(), "\"thread_name\"") != nullptr);
+}
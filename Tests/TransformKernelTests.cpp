@@ -0,0 +1,110 @@
+#include "catch_amalgamated.hpp"
+#include "Core/TransformKernel.h"
+
+#include <math.h>
+
+struct TRSTestData
+{
+	float values[9][64];
+	TRSInputs inputs;
+};
+
+static void initTRSTestData(TRSTestData* pData, uint32_t count, float angleRange)
+{
+	uint32_t state = 0x12345678u;
+	for (uint32_t c = 0; c < 9; ++c)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			float unit = (float)(state & 0xFFFFFF) / (float)0xFFFFFF; // [0, 1]
+
+			if (c >= 3 && c < 6)
+				pData->values[c][i] = (unit * 2.0f - 1.0f) * angleRange;
+			else if (c >= 6)
+				pData->values[c][i] = 0.1f + unit * 4.0f;
+			else
+				pData->values[c][i] = (unit * 2.0f - 1.0f) * 100.0f;
+		}
+	}
+
+	pData->inputs.pPositionX = pData->values[0];
+	pData->inputs.pPositionY = pData->values[1];
+	pData->inputs.pPositionZ = pData->values[2];
+	pData->inputs.pRotationX = pData->values[3];
+	pData->inputs.pRotationY = pData->values[4];
+	pData->inputs.pRotationZ = pData->values[5];
+	pData->inputs.pScaleX = pData->values[6];
+	pData->inputs.pScaleY = pData->values[7];
+	pData->inputs.pScaleZ = pData->values[8];
+}
+
+TEST_CASE("TransformKernel matches the scalar reference", "[transform]")
+{
+	// 63 covers full SIMD steps plus a scalar remainder
+	const uint32_t count = 63;
+	static TRSTestData data;
+	initTRSTestData(&data, count, 20.0f);
+
+	static float simd[count * 16];
+	static float scalar[count * 16];
+	composeTRSMatrices(&data.inputs, simd, count);
+	composeTRSMatricesScalar(&data.inputs, scalar, count);
+
+	for (uint32_t i = 0; i < count * 16; ++i)
+	{
+		float tolerance = 1e-4f * (1.0f + fabsf(scalar[i]));
+		REQUIRE(fabsf(simd[i] - scalar[i]) <= tolerance);
+	}
+}
+
+TEST_CASE("TransformKernel builds translation and scale", "[transform]")
+{
+	const uint32_t count = 4;
+	float px[count] = {1.0f, 2.0f, 3.0f, 4.0f};
+	float py[count] = {-1.0f, -2.0f, -3.0f, -4.0f};
+	float pz[count] = {0.5f, 0.25f, 0.0f, 8.0f};
+	float rot[count] = {0.0f, 0.0f, 0.0f, 0.0f};
+	float sx[count] = {1.0f, 2.0f, 3.0f, 4.0f};
+	float sy[count] = {5.0f, 6.0f, 7.0f, 8.0f};
+	float sz[count] = {1.0f, 1.0f, 0.5f, 0.25f};
+
+	TRSInputs inputs = {px, py, pz, rot, rot, rot, sx, sy, sz};
+	float matrices[count * 16];
+	composeTRSMatrices(&inputs, matrices, count);
+
+	for (uint32_t e = 0; e < count; ++e)
+	{
+		const float* m = matrices + e * 16;
+		REQUIRE(fabsf(m[0] - sx[e]) < 1e-5f);
+		REQUIRE(fabsf(m[5] - sy[e]) < 1e-5f);
+		REQUIRE(fabsf(m[10] - sz[e]) < 1e-5f);
+		REQUIRE(m[12] == px[e]);
+		REQUIRE(m[13] == py[e]);
+		REQUIRE(m[14] == pz[e]);
+		REQUIRE(m[15] == 1.0f);
+		REQUIRE(fabsf(m[1]) < 1e-5f);
+		REQUIRE(m[3] == 0.0f);
+	}
+}
+
+TEST_CASE("TransformKernel rotates about Z", "[transform]")
+{
+	float zero[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+	float ones[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+	float angles[4] = {1.5707963f, 3.1415927f, -1.5707963f, 0.7853982f};
+
+	TRSInputs inputs = {zero, zero, zero, zero, zero, angles, ones, ones, ones};
+	float matrices[4 * 16];
+	composeTRSMatrices(&inputs, matrices, 4);
+
+	// First column is the rotated X axis
+	for (uint32_t e = 0; e < 4; ++e)
+	{
+		REQUIRE(fabsf(matrices[e * 16 + 0] - cosf(angles[e])) < 1e-5f);
+		REQUIRE(fabsf(matrices[e * 16 + 1] - sinf(angles[e])) < 1e-5f);
+		REQUIRE(fabsf(matrices[e * 16 + 4] + sinf(angles[e])) < 1e-5f);
+	}
+}
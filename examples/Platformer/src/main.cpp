@@ -1,6 +1,7 @@
 #include "Runtime/EngineApp.h"
 #include "Runtime/ECS.h"
 #include "Runtime/AssetCache.h"
+#include "Runtime/Physics.h"
 #include "Runtime/Memory/Arena.h"
 #include "Utilities/Interfaces/ILog.h"
 #include "Resources/ResourceLoader/Interfaces/IResourceLoader.h"
@@ -10,7 +11,7 @@
 #include "../../../thirdparty/The-Forge/Common_3/Graphics/FSL/defaults.h"
 #include "../../../Shaders/FSL/Global.srt.h"
 
-#include "JoltHelpers.h"
+#include <string.h>
 
 struct Camera
 {
@@ -20,6 +21,8 @@ struct Camera
 struct Object
 {
 	mat4 worldMat;
+	uint32_t textureSlot;
+	uint32_t padding[3];
 };
 
 class MyGame : public EngineApp
@@ -36,20 +39,12 @@ private:
 
 	ecs_entity_t quadEntity = 0;
 	ecs_entity_t cubeEntity = 0;
+	ecs_entity_t floorEntity = 0;
 	Camera cameraData = {};
 
 	Sampler* pSpriteSampler = NULL;
 
-	JPH::TempAllocatorImpl* pTempAllocator = nullptr;
-	JPH::JobSystemThreadPool* pJobSystem = nullptr;
-	JPH::PhysicsSystem* pPhysicsSystem = nullptr;
-	JPH::BodyID floorBodyID;
-	JPH::BodyID heroBodyID;
-	JPH::BodyID cubeBodyID;
-
-	BPLayerInterfaceImpl broad_phase_layer_interface;
-	ObjectVsBroadPhaseLayerFilterImpl object_vs_broadphase_layer_filter;
-	ObjectLayerPairFilterImpl object_vs_object_layer_filter;
+	PhysicsWorld* pPhysics = NULL;
 
 public:
 	bool Init() override
@@ -60,42 +55,36 @@ public:
 		ArenaParams arenaParams = {};
 		arenaParams.reserveSize = Megabyte(128);
 		arenaParams.commitSize = Megabyte(1);
+		arenaParams.pName = "Assets";
 		pAssetArena = arenaCreate(&arenaParams);
 		if (!pAssetArena)
 			return false;
 
-		pAssetCache = createAssetCache(pAssetArena, pRenderer);
+		pAssetCache = createAssetCache(pAssetArena, pRenderer, gDataBufferCount);
 		if (!pAssetCache)
 			return false;
 
-		JPH::RegisterDefaultAllocator();
-		JPH::Factory::sInstance = new JPH::Factory();
-		JPH::RegisterTypes();
-
-		pTempAllocator = new JPH::TempAllocatorImpl(10 * 1024 * 1024);
-
-		pJobSystem = new JPH::JobSystemThreadPool(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers,
-												  2);
-
-		pPhysicsSystem = CreatePhysicsSystem(broad_phase_layer_interface,
-											 object_vs_broadphase_layer_filter,
-											 object_vs_object_layer_filter);
-
-		floorBodyID = CreateFloor(pPhysicsSystem, 50.0f, 1.0f, 50.0f, -2.0f);
-
-		heroBodyID = CreateDynamicBox(pPhysicsSystem, 0.5f, 0.5f, 0.5f, -2.0f, 5.0f, 0.0f);
-
-		JPH::BoxShapeSettings cube_shape_settings(JPH::Vec3(1.0f, 1.0f, 1.0f));
-		JPH::ShapeSettings::ShapeResult cube_shape_result = cube_shape_settings.Create();
-		JPH::ShapeRefC cube_shape = cube_shape_result.Get();
-
-		JPH::BodyCreationSettings cube_settings(cube_shape, JPH::RVec3(2.0_r, 0.0_r, 0.0_r),
-												JPH::Quat::sIdentity(), JPH::EMotionType::Static,
-												Layers::NON_MOVING);
+		PhysicsWorldDesc physicsDesc = {};
+		physicsDesc.pJobSystem = getJobSystem();
+		physicsDesc.maxBodies = 1024;
+		pPhysics = createPhysicsWorld(pWorld, &physicsDesc);
+		if (!pPhysics)
+			return false;
 
-		JPH::Body* cube = pPhysicsSystem->GetBodyInterface().CreateBody(cube_settings);
-		pPhysicsSystem->GetBodyInterface().AddBody(cube->GetID(), JPH::EActivation::DontActivate);
-		cubeBodyID = cube->GetID();
+		// The floor has no mesh, only a transform for its body
+		TransformDesc floorTransform = {};
+		floorTransform.position = vec3(0.0f, -2.0f, 0.0f);
+		floorTransform.rotation = vec3(0.0f, 0.0f, 0.0f);
+		floorTransform.scale = vec3(1.0f, 1.0f, 1.0f);
+		floorEntity = createTransformEntity(&floorTransform);
+
+		RigidBodyDesc floorBody = {};
+		floorBody.motion = RigidBodyMotion_Static;
+		floorBody.shape = RigidBodyShape_Box;
+		floorBody.halfExtents[0] = 50.0f;
+		floorBody.halfExtents[1] = 1.0f;
+		floorBody.halfExtents[2] = 50.0f;
+		addRigidBody(pPhysics, floorEntity, &floorBody);
 
 		SamplerDesc samplerDesc = {};
 		samplerDesc.mMinFilter = FILTER_LINEAR;
@@ -112,6 +101,14 @@ public:
 
 	void Exit() override
 	{
+		// Bodies go before their entities
+		if (pPhysics)
+		{
+			destroyPhysicsWorld(pPhysics);
+			pPhysics = NULL;
+		}
+		LOGF(LogLevel::eINFO, "Physics shut down");
+
 		if (quadEntity && pWorld)
 		{
 			ecs_delete(pWorld, quadEntity);
@@ -122,6 +119,11 @@ public:
 			ecs_delete(pWorld, cubeEntity);
 			cubeEntity = 0;
 		}
+		if (floorEntity && pWorld)
+		{
+			ecs_delete(pWorld, floorEntity);
+			floorEntity = 0;
+		}
 		LOGF(LogLevel::eINFO, "Entities destroyed");
 
 		if (pSpriteSampler)
@@ -145,35 +147,6 @@ public:
 
 		LOGF(LogLevel::eINFO, "Platformer shutting down");
 
-		if (pPhysicsSystem)
-		{
-			pPhysicsSystem->GetBodyInterface().RemoveBody(heroBodyID);
-			pPhysicsSystem->GetBodyInterface().DestroyBody(heroBodyID);
-			pPhysicsSystem->GetBodyInterface().RemoveBody(floorBodyID);
-			pPhysicsSystem->GetBodyInterface().DestroyBody(floorBodyID);
-			pPhysicsSystem->GetBodyInterface().RemoveBody(cubeBodyID);
-			pPhysicsSystem->GetBodyInterface().DestroyBody(cubeBodyID);
-			delete pPhysicsSystem;
-			pPhysicsSystem = nullptr;
-		}
-
-		if (pJobSystem)
-		{
-			delete pJobSystem;
-			pJobSystem = nullptr;
-		}
-
-		if (pTempAllocator)
-		{
-			delete pTempAllocator;
-			pTempAllocator = nullptr;
-		}
-
-		JPH::UnregisterTypes();
-		delete JPH::Factory::sInstance;
-		JPH::Factory::sInstance = nullptr;
-		LOGF(LogLevel::eINFO, "Jolt shut down");
-
 		EngineApp::Exit();
 	}
 
@@ -182,32 +155,30 @@ public:
 		if (!EngineApp::Load(pReloadDesc))
 			return false;
 
-		if (!handleIsValid(spriteTexture.id))
+		// The persistent set is new after a shader reload, the cache refills its texture table
+		if (!pReloadDesc || pReloadDesc->mType & RELOAD_TYPE_SHADER)
 		{
-			spriteTexture = loadTexture(pAssetCache, "Sprite.tex");
-		}
+			bindAssetCacheTextures(pAssetCache, pDescriptorSetPersistent,
+								   SRT_RES_IDX(SrtData, Persistent, gTextures));
 
-		if (!handleIsValid(cubeTexture.id))
-		{
-			cubeTexture = loadTexture(pAssetCache, "CubeTexture.tex");
+			if (pSpriteSampler)
+			{
+				DescriptorData params[1] = {};
+				params[0].mIndex = SRT_RES_IDX(SrtData, Persistent, gSpriteSampler);
+				params[0].ppSamplers = &pSpriteSampler;
+				for (uint32_t i = 0; i < gDataBufferCount; ++i)
+					updateDescriptorSet(pRenderer, i, pDescriptorSetPersistent, 1, params);
+			}
 		}
 
-		if (handleIsValid(spriteTexture.id) && handleIsValid(cubeTexture.id) && pSpriteSampler)
+		if (!handleIsValid(spriteTexture.id) || !handleIsValid(cubeTexture.id))
 		{
-			TextureData* pSpriteTexData = getTexture(pAssetCache, spriteTexture);
-			TextureData* pCubeTexData = getTexture(pAssetCache, cubeTexture);
-
-			if (pSpriteTexData && pCubeTexData)
-			{
-				DescriptorData params[3] = {};
-				params[0].mIndex = SRT_RES_IDX(SrtData, Persistent, gSpriteTexture);
-				params[0].ppTextures = &pSpriteTexData->pTexture;
-				params[1].mIndex = SRT_RES_IDX(SrtData, Persistent, gCubeTexture);
-				params[1].ppTextures = &pCubeTexData->pTexture;
-				params[2].mIndex = SRT_RES_IDX(SrtData, Persistent, gSpriteSampler);
-				params[2].ppSamplers = &pSpriteSampler;
-				updateDescriptorSet(pRenderer, 0, pDescriptorSetPersistent, 3, params);
-			}
+			// Both files stream in parallel, we only wait once for the pair
+			const char* texturePaths[2] = {"Sprite.tex", "CubeTexture.tex"};
+			TextureHandle textures[2] = {};
+			loadTextures(pAssetCache, texturePaths, 2, textures);
+			spriteTexture = textures[0];
+			cubeTexture = textures[1];
 		}
 
 		if (!handleIsValid(cubeMesh.id) && pWorld)
@@ -224,13 +195,26 @@ public:
 					cubeEntityDesc.pIndexBuffer = pCubeMeshData->pIndexBuffer;
 					cubeEntityDesc.vertexCount = pCubeMeshData->vertexCount;
 					cubeEntityDesc.indexCount = pCubeMeshData->indexCount;
+					cubeEntityDesc.indexSize = pCubeMeshData->indexSize;
 					cubeEntityDesc.vertexStride = pCubeMeshData->vertexStride;
+					memcpy(cubeEntityDesc.boundsMin, pCubeMeshData->boundsMin, sizeof(cubeEntityDesc.boundsMin));
+					memcpy(cubeEntityDesc.boundsMax, pCubeMeshData->boundsMax, sizeof(cubeEntityDesc.boundsMax));
 					cubeEntityDesc.pPipeline = pCubePipeline;
+					cubeEntityDesc.pInstancedPipeline = pInstancedCubePipeline;
+					cubeEntityDesc.textureSlot = getTextureSlot(cubeTexture);
 					cubeEntityDesc.position = vec3(2.0f, 0.0f, 0.0f);
 					cubeEntityDesc.rotation = vec3(0, 0, 0);
 					cubeEntityDesc.scale = vec3(1.0f, 1.0f, 1.0f);
 
 					cubeEntity = createMeshEntity(&cubeEntityDesc);
+
+					RigidBodyDesc cubeBody = {};
+					cubeBody.motion = RigidBodyMotion_Static;
+					cubeBody.shape = RigidBodyShape_Box;
+					cubeBody.halfExtents[0] = 1.0f;
+					cubeBody.halfExtents[1] = 1.0f;
+					cubeBody.halfExtents[2] = 1.0f;
+					addRigidBody(pPhysics, cubeEntity, &cubeBody);
 				}
 			}
 		}
@@ -249,13 +233,26 @@ public:
 					entityDesc.pIndexBuffer = pQuadMeshData->pIndexBuffer;
 					entityDesc.vertexCount = pQuadMeshData->vertexCount;
 					entityDesc.indexCount = pQuadMeshData->indexCount;
+					entityDesc.indexSize = pQuadMeshData->indexSize;
 					entityDesc.vertexStride = pQuadMeshData->vertexStride;
+					memcpy(entityDesc.boundsMin, pQuadMeshData->boundsMin, sizeof(entityDesc.boundsMin));
+					memcpy(entityDesc.boundsMax, pQuadMeshData->boundsMax, sizeof(entityDesc.boundsMax));
 					entityDesc.pPipeline = pPipeline;
-					entityDesc.position = vec3(-2.0f, 0.0f, 0.0f);
+					entityDesc.pInstancedPipeline = pInstancedPipeline;
+					entityDesc.textureSlot = getTextureSlot(spriteTexture);
+					entityDesc.position = vec3(-2.0f, 5.0f, 0.0f);
 					entityDesc.rotation = vec3(0, 0, 0);
 					entityDesc.scale = vec3(1.0f, 1.0f, 1.0f);
 
 					quadEntity = createMeshEntity(&entityDesc);
+
+					RigidBodyDesc heroBody = {};
+					heroBody.motion = RigidBodyMotion_Dynamic;
+					heroBody.shape = RigidBodyShape_Box;
+					heroBody.halfExtents[0] = 0.5f;
+					heroBody.halfExtents[1] = 0.5f;
+					heroBody.halfExtents[2] = 0.5f;
+					addRigidBody(pPhysics, quadEntity, &heroBody);
 				}
 			}
 		}
@@ -264,65 +261,53 @@ public:
 		return true;
 	}
 
-	void Unload(ReloadDesc* pReloadDesc) override { EngineApp::Unload(pReloadDesc); }
+	void Unload(ReloadDesc* pReloadDesc) override
+	{
+		// The persistent set goes away with the shaders
+		if (!pReloadDesc || pReloadDesc->mType & RELOAD_TYPE_SHADER)
+			bindAssetCacheTextures(pAssetCache, NULL, 0);
+
+		EngineApp::Unload(pReloadDesc);
+	}
 
 	void Update(float deltaTime) override
 	{
-		if (pPhysicsSystem)
-		{
-			const float cDeltaTime = deltaTime > 0.0f ? deltaTime : 1.0f / 60.0f;
-			pPhysicsSystem->Update(cDeltaTime, 1, pTempAllocator, pJobSystem);
-
-			JPH::RVec3 heroPhysicsPos =
-				pPhysicsSystem->GetBodyInterface().GetCenterOfMassPosition(heroBodyID);
-			heroPosition = vec3((float)heroPhysicsPos.GetX(), (float)heroPhysicsPos.GetY(),
-								(float)heroPhysicsPos.GetZ());
-		}
+		updateAssetCache(pAssetCache);
 
 		float windowWidth = (float)pSwapChain->ppRenderTargets[0]->mWidth;
 		float windowHeight = (float)pSwapChain->ppRenderTargets[0]->mHeight;
 
-		if (pPhysicsSystem)
+		if (quadEntity)
 		{
 			float moveSpeed = 5.0f;
 
-			JPH::Vec3 currentVel = pPhysicsSystem->GetBodyInterface().GetLinearVelocity(heroBodyID);
+			vec3 currentVel = getRigidBodyLinearVelocity(pPhysics, quadEntity);
 
-			JPH::Vec3 newVel(0, currentVel.GetY(), 0);
+			vec3 newVel(0.0f, currentVel.getY(), 0.0f);
 			if (inputGetValue(0, K_W))
-				newVel.SetZ(-moveSpeed);
+				newVel.setZ(-moveSpeed);
 			if (inputGetValue(0, K_S))
-				newVel.SetZ(newVel.GetZ() + moveSpeed);
+				newVel.setZ(newVel.getZ() + moveSpeed);
 			if (inputGetValue(0, K_A))
-				newVel.SetX(moveSpeed);
+				newVel.setX(moveSpeed);
 			if (inputGetValue(0, K_D))
-				newVel.SetX(newVel.GetX() - moveSpeed);
+				newVel.setX(newVel.getX() - moveSpeed);
 
 			if (inputGetValue(0, K_SPACE))
 			{
-				if (fabs(currentVel.GetY()) < 0.5f)
+				if (fabs(currentVel.getY()) < 0.5f)
 				{
 					float jumpVelocity = 7.0f;
-					newVel.SetY(jumpVelocity);
+					newVel.setY(jumpVelocity);
 				}
 			}
 
-			pPhysicsSystem->GetBodyInterface().SetLinearVelocity(heroBodyID, newVel);
+			setRigidBodyLinearVelocity(pPhysics, quadEntity, newVel);
 		}
 
-		TransformDesc quadTransform = {};
-		quadTransform.position = heroPosition;
-		quadTransform.rotation = vec3(0, 0, 0);
-		quadTransform.scale = vec3(1.0f, 1.0f, 1.0f);
-		updateTransform(quadEntity, &quadTransform);
-
-		TransformDesc cubeTransform = {};
-		cubeTransform.position = vec3(2.0f, 0.0f, 0.0f);
-		cubeTransform.rotation = vec3(0.0f, 0.0f, 0.0f);
-		cubeTransform.scale = vec3(1.0f, 1.0f, 1.0f);
-		updateTransform(cubeEntity, &cubeTransform);
-
-		EngineApp::Update(deltaTime);
+		// Steps at a fixed rate and writes the hero and other moving bodies
+		// back into their TransformComponent before the ECS runs
+		updatePhysicsWorld(pPhysics, deltaTime);
 
 		// Camera
 		float aspect = windowWidth / windowHeight;
@@ -359,6 +344,14 @@ public:
 		view.mCamera = viewMat4;
 
 		cameraData.projView = projection * view;
+
+		// Cull against the camera this frame is drawn with
+		setCullingCamera(&cameraData.projView.mCamera);
+		EngineApp::Update(deltaTime);
+
+		// The render thread is idle until Draw(), which records frame gFrameIndex
+		beginAssetCacheFrame(pAssetCache, gFrameIndex, pFrameFences[gFrameIndex]);
+
 		uploadPerFrameData(&cameraData, sizeof(cameraData));
 
 		uint32_t entityCount = getRenderDataCount();
@@ -368,6 +361,7 @@ public:
 
 			Object objectData = {};
 			objectData.worldMat = renderData.modelMatrix;
+			objectData.textureSlot = renderData.textureSlot;
 
 			uploadPerObjectData(renderData.descriptorSetIndex, &objectData, sizeof(objectData));
 		}
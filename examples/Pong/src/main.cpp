@@ -16,6 +16,8 @@ struct Camera
 struct Object
 {
 	mat4 worldMat;
+	uint32_t textureSlot;
+	uint32_t padding[3];
 };
 
 class MyGame : public EngineApp
@@ -35,6 +37,8 @@ private:
 	vec2 ballPosition = vec2(0, 0);
 	vec2 ballVelocity = vec2(0, 0);
 
+	bool traceKeyDown = false;
+
 public:
 	bool Init() override
 	{
@@ -123,6 +127,7 @@ public:
 				entityDesc.vertexCount = quadVertexCount;
 				entityDesc.vertexStride = vertexStride;
 				entityDesc.pPipeline = pPipeline;
+				entityDesc.pInstancedPipeline = pInstancedPipeline;
 				entityDesc.position = vec3(0, 0, 0);
 				entityDesc.rotation = vec3(0, 0, 0);
 				entityDesc.scale = vec3(1, 1, 1);
@@ -177,6 +182,12 @@ public:
 		rightWallTransform.scale = vec3(wallThickness / 0.4f, rightWallHeight / 0.4f, 1.0f);
 		updateTransform(rightWallEntity, &rightWallTransform);
 
+		// F11 dumps the CPU trace of the last frames
+		bool traceKey = inputGetValue(0, K_F11);
+		if (traceKey && !traceKeyDown)
+			requestTraceDump();
+		traceKeyDown = traceKey;
+
 		// Movement
 		float paddleSpeed = 300.0f;
 
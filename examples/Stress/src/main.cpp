@@ -0,0 +1,513 @@
+/*
+ * Stress example
+ * main.cpp
+ *
+ * Spawns a grid of quads, moves every one of them each frame and records
+ * the frame time with its phases, then writes percentiles to a JSON file
+ * and quits. Run before and after an engine change to compare.
+ *
+ * Usage: Stress [--preset 1k|10k|100k] [--entities n] [--frames n] [--warmup n]
+ *               [--output file] [--ecs-threads n] [--render-threads n] [--pipelined]
+ *               [--headless]
+ *
+ * --headless runs the engine without a window or renderer, see
+ * EngineApp::setHeadless, so the simulation side can be measured on
+ * machines without a GPU.
+ */
+
+#include "Runtime/EngineApp.h"
+#include "Runtime/ECS.h"
+#include "Runtime/Memory/Arena.h"
+#include "Utilities/Interfaces/ILog.h"
+#include "Resources/ResourceLoader/Interfaces/IResourceLoader.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STRESS_DEFAULT_ENTITIES 10000
+#define STRESS_DEFAULT_FRAMES 600
+#define STRESS_DEFAULT_WARMUP 60
+#define STRESS_DEFAULT_OUTPUT "stress_results.json"
+#define STRESS_GRID_SPACING 4.0f  ///< World units between quad centers
+#define STRESS_ORBIT_RADIUS 1.0f  ///< Every quad circles its grid cell
+#define STRESS_HEADLESS_DT 0.016f ///< Fixed step, headless frames are not paced
+
+struct StressOptions
+{
+	uint32_t entityCount;
+	uint32_t frameCount;  ///< Recorded frames, after the warmup
+	uint32_t warmupCount; ///< Frames run before recording starts
+	uint32_t ecsThreads;
+	uint32_t renderThreads;
+	bool pipelined;
+	bool headless;
+	const char* pOutputPath;
+};
+
+/**
+	Milliseconds of one recorded frame.
+*/
+struct StressSample
+{
+	float frameMs; ///< Update and Draw together
+	float moveMs;  ///< updateTransform on every entity
+	float ecsProgressMs;
+	float transformMs;
+	float fillRenderDataMs;
+	float recordMs;
+	float submitMs;
+};
+
+static StressOptions gOptions = {
+	STRESS_DEFAULT_ENTITIES, STRESS_DEFAULT_FRAMES, STRESS_DEFAULT_WARMUP, 1, 1, false, false,
+	STRESS_DEFAULT_OUTPUT,
+};
+
+static uint32_t parseCount(const char* pText)
+{
+	return (uint32_t)strtoul(pText, NULL, 10);
+}
+
+// Runs before the log is up, errors go to stderr
+static bool parseOptions(int argc, const char** argv, StressOptions* pOptions)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const char* pArg = argv[i];
+		const char* pValue = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if (strcmp(pArg, "--pipelined") == 0)
+		{
+			pOptions->pipelined = true;
+			continue;
+		}
+		if (strcmp(pArg, "--headless") == 0)
+		{
+			pOptions->headless = true;
+			continue;
+		}
+		if (!pValue)
+		{
+			fprintf(stderr, "Stress: missing value for %s\n", pArg);
+			return false;
+		}
+
+		if (strcmp(pArg, "--preset") == 0)
+		{
+			if (strcmp(pValue, "1k") == 0)
+				pOptions->entityCount = 1000;
+			else if (strcmp(pValue, "10k") == 0)
+				pOptions->entityCount = 10000;
+			else if (strcmp(pValue, "100k") == 0)
+				pOptions->entityCount = 100000;
+			else
+			{
+				fprintf(stderr, "Stress: unknown preset %s, use 1k, 10k or 100k\n", pValue);
+				return false;
+			}
+		}
+		else if (strcmp(pArg, "--entities") == 0)
+			pOptions->entityCount = parseCount(pValue);
+		else if (strcmp(pArg, "--frames") == 0)
+			pOptions->frameCount = parseCount(pValue) ? parseCount(pValue) : 1;
+		else if (strcmp(pArg, "--warmup") == 0)
+			pOptions->warmupCount = parseCount(pValue);
+		else if (strcmp(pArg, "--output") == 0)
+			pOptions->pOutputPath = pValue;
+		else if (strcmp(pArg, "--ecs-threads") == 0)
+			pOptions->ecsThreads = parseCount(pValue);
+		else if (strcmp(pArg, "--render-threads") == 0)
+			pOptions->renderThreads = parseCount(pValue);
+		else
+		{
+			fprintf(stderr, "Stress: unknown option %s\n", pArg);
+			return false;
+		}
+		i++;
+	}
+	return true;
+}
+
+static float elapsedMs(uint64_t startNs)
+{
+	return (float)((double)(ecs_os_now() - startNs) / 1e6);
+}
+
+///////////////////////////////////////////
+// Scene
+
+/**
+	Entities of the stress scene and the samples recorded so far.
+
+	Everything goes through the free ECS functions, the app only owns the
+	world and the quad buffer.
+*/
+struct StressScene
+{
+	Arena* pArena;
+	ecs_entity_t* pEntities;
+	uint32_t entityCount;
+	uint32_t gridWidth;
+	float time;
+
+	StressSample* pSamples;
+	uint32_t sampleCount;
+	uint32_t frameIndex; ///< Frames run, warmup included
+};
+
+static bool createStressScene(StressScene* pScene, ecs_world_t* pWorld,
+							  const MeshEntityDesc* pMeshDesc, uint32_t entityCount,
+							  uint32_t frameCount)
+{
+	memset(pScene, 0, sizeof(StressScene));
+
+	ArenaParams arenaParams = {};
+	arenaParams.pName = "Stress";
+	pScene->pArena = arenaCreate(&arenaParams);
+	if (!pScene->pArena)
+	{
+		LOGF(LogLevel::eERROR, "Stress: Failed to create the scene arena");
+		return false;
+	}
+
+	pScene->pEntities = arenaPushArray<ecs_entity_t>(pScene->pArena, entityCount);
+	pScene->pSamples = arenaPushArray<StressSample>(pScene->pArena, frameCount);
+	pScene->gridWidth = (uint32_t)ceilf(sqrtf((float)entityCount));
+	if (pScene->gridWidth == 0)
+		pScene->gridWidth = 1;
+
+	uint64_t startNs = ecs_os_now();
+	for (uint32_t i = 0; i < entityCount; ++i)
+	{
+		pScene->pEntities[i] = createMeshEntity(pWorld, pMeshDesc);
+		if (!pScene->pEntities[i])
+			return false;
+	}
+	pScene->entityCount = entityCount;
+
+	LOGF(LogLevel::eINFO, "Stress: Spawned %u entities in %.2f ms", entityCount,
+		 elapsedMs(startNs));
+	return true;
+}
+
+static void destroyStressScene(StressScene* pScene)
+{
+	arenaRelease(pScene->pArena);
+	memset(pScene, 0, sizeof(StressScene));
+}
+
+static float stressSceneExtent(const StressScene* pScene)
+{
+	return (float)pScene->gridWidth * STRESS_GRID_SPACING;
+}
+
+// Every entity gets a new transform, the worst case for TransformSystem
+static void moveStressScene(StressScene* pScene, ecs_world_t* pWorld, float deltaTime)
+{
+	pScene->time += deltaTime;
+
+	TransformDesc transform = {};
+	transform.scale = vec3(1, 1, 1);
+
+	for (uint32_t i = 0; i < pScene->entityCount; ++i)
+	{
+		float phase = pScene->time * 2.0f + (float)i * 0.37f;
+		float x = ((float)(i % pScene->gridWidth) + 0.5f) * STRESS_GRID_SPACING;
+		float y = ((float)(i / pScene->gridWidth) + 0.5f) * STRESS_GRID_SPACING;
+
+		transform.position = vec3(x + cosf(phase) * STRESS_ORBIT_RADIUS,
+								  y + sinf(phase) * STRESS_ORBIT_RADIUS, 0);
+		transform.rotation = vec3(0, 0, phase);
+		updateTransform(pWorld, pScene->pEntities[i], &transform);
+	}
+}
+
+/**
+	Stores a frame once the warmup is over.
+
+	@return True once every recorded frame is in
+*/
+static bool addStressSample(StressScene* pScene, const StressSample* pSample)
+{
+	pScene->frameIndex++;
+	if (pScene->frameIndex <= gOptions.warmupCount)
+		return false;
+
+	if (pScene->sampleCount < gOptions.frameCount)
+		pScene->pSamples[pScene->sampleCount++] = *pSample;
+	return pScene->sampleCount >= gOptions.frameCount;
+}
+
+///////////////////////////////////////////
+// Report
+
+static int compareFloats(const void* pA, const void* pB)
+{
+	float a = *(const float*)pA;
+	float b = *(const float*)pB;
+	return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+// Nearest rank on sorted values
+static float percentile(const float* pSorted, uint32_t count, float fraction)
+{
+	uint32_t rank = (uint32_t)ceilf(fraction * (float)count);
+	rank = rank < 1 ? 1 : (rank > count ? count : rank);
+	return pSorted[rank - 1];
+}
+
+static void writePhase(FILE* pFile, Arena* pScratch, const StressScene* pScene,
+					   const char* pName, size_t offset, bool last)
+{
+	uint32_t count = pScene->sampleCount;
+	float* pValues = arenaPushArray<float>(pScratch, count);
+
+	double sum = 0.0;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		pValues[i] = *(const float*)((const uint8_t*)&pScene->pSamples[i] + offset);
+		sum += pValues[i];
+	}
+	qsort(pValues, count, sizeof(float), compareFloats);
+
+	fprintf(pFile,
+			"\t\t\"%s\": { \"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, "
+			"\"max\": %.4f }%s\n",
+			pName, sum / (double)count, percentile(pValues, count, 0.50f),
+			percentile(pValues, count, 0.90f), percentile(pValues, count, 0.99f),
+			pValues[count - 1], last ? "" : ",");
+}
+
+static bool writeStressReport(const StressScene* pScene, const char* pMode)
+{
+	if (pScene->sampleCount == 0)
+		return false;
+
+	FILE* pFile = fopen(gOptions.pOutputPath, "w");
+	if (!pFile)
+	{
+		LOGF(LogLevel::eERROR, "Stress: Failed to open %s", gOptions.pOutputPath);
+		return false;
+	}
+
+	fprintf(pFile,
+			"{\n\t\"mode\": \"%s\",\n\t\"entities\": %u,\n\t\"frames\": %u,\n\t\"warmup\": %u,\n"
+			"\t\"ecsThreads\": %u,\n\t\"renderThreads\": %u,\n\t\"pipelined\": %s,\n"
+			"\t\"unit\": \"ms\",\n\t\"phases\": {\n",
+			pMode, pScene->entityCount, pScene->sampleCount, gOptions.warmupCount,
+			gOptions.ecsThreads, gOptions.renderThreads, gOptions.pipelined ? "true" : "false");
+
+	// Sorted copies live in the scene arena until the report is written
+	uint64_t scratchPos = arenaGetPos(pScene->pArena);
+	writePhase(pFile, pScene->pArena, pScene, "frame", offsetof(StressSample, frameMs), false);
+	writePhase(pFile, pScene->pArena, pScene, "move", offsetof(StressSample, moveMs), false);
+	writePhase(pFile, pScene->pArena, pScene, "ecsProgress",
+			   offsetof(StressSample, ecsProgressMs), false);
+	writePhase(pFile, pScene->pArena, pScene, "transform", offsetof(StressSample, transformMs),
+			   false);
+	writePhase(pFile, pScene->pArena, pScene, "fillRenderData",
+			   offsetof(StressSample, fillRenderDataMs), false);
+	writePhase(pFile, pScene->pArena, pScene, "record", offsetof(StressSample, recordMs), false);
+	writePhase(pFile, pScene->pArena, pScene, "submit", offsetof(StressSample, submitMs), true);
+	arenaPopTo(pScene->pArena, scratchPos);
+
+	fprintf(pFile, "\t}\n}\n");
+	fclose(pFile);
+
+	LOGF(LogLevel::eINFO, "Stress: Wrote %u frames of %u entities to %s", pScene->sampleCount,
+		 pScene->entityCount, gOptions.pOutputPath);
+	return true;
+}
+
+///////////////////////////////////////////
+// App
+
+class StressApp : public EngineApp
+{
+private:
+	Buffer* pQuadBuffer = NULL;
+	StressScene scene = {};
+	bool sceneCreated = false;
+	bool reportWritten = false;
+	bool reportFailed = false;
+	uint64_t frameStartNs = 0;
+	float lastMoveMs = 0.0f;
+
+public:
+	StressApp()
+	{
+		// Thread counts, pipelining and headless are read by EngineApp::Init()
+		setEcsThreadCount(gOptions.ecsThreads);
+		setRenderThreadCount(gOptions.renderThreads);
+		setPipelinedRendering(gOptions.pipelined);
+		setHeadless(gOptions.headless);
+	}
+
+	bool succeeded() const { return reportWritten && !reportFailed; }
+
+	bool Init() override
+	{
+		// Frame times are meaningless when capped at the refresh rate
+		mSettings.mVSyncEnabled = false;
+
+		if (!EngineApp::Init())
+			return false;
+
+		LOGF(LogLevel::eINFO, "Stress: %u entities, %u frames after %u warmup frames",
+			 gOptions.entityCount, gOptions.frameCount, gOptions.warmupCount);
+		return true;
+	}
+
+	void Exit() override
+	{
+		if (sceneCreated)
+		{
+			for (uint32_t i = 0; i < scene.entityCount; ++i)
+				ecs_delete(pWorld, scene.pEntities[i]);
+			destroyStressScene(&scene);
+			sceneCreated = false;
+		}
+
+		if (pQuadBuffer)
+		{
+			removeResource(pQuadBuffer);
+			pQuadBuffer = NULL;
+		}
+		EngineApp::Exit();
+	}
+
+	bool Load(ReloadDesc* pReloadDesc) override
+	{
+		if (!EngineApp::Load(pReloadDesc))
+			return false;
+
+		if (!sceneCreated && pWorld)
+		{
+			struct Vertex
+			{
+				float position[3];
+				float color[3];
+			};
+
+			// One mesh and pipeline, so every quad lands in the same instanced batch
+			MeshEntityDesc entityDesc = {};
+			entityDesc.vertexCount = 6;
+			entityDesc.vertexStride = sizeof(Vertex);
+
+			// Headless, FillRenderDataSystem still packs quads without GPU buffers
+			if (!isHeadless())
+			{
+				float halfSize = 0.5f;
+				Vertex quadVerts[] = {
+					{{-halfSize, -halfSize, 0.0f}, {1.0f, 0.6f, 0.2f}},
+					{{halfSize, -halfSize, 0.0f}, {1.0f, 0.6f, 0.2f}},
+					{{-halfSize, halfSize, 0.0f}, {1.0f, 0.6f, 0.2f}},
+					{{-halfSize, halfSize, 0.0f}, {1.0f, 0.6f, 0.2f}},
+					{{halfSize, -halfSize, 0.0f}, {1.0f, 0.6f, 0.2f}},
+					{{halfSize, halfSize, 0.0f}, {1.0f, 0.6f, 0.2f}},
+				};
+				pQuadBuffer = createMeshBuffer(quadVerts, sizeof(quadVerts));
+				if (!pQuadBuffer || !pPipeline)
+					return false;
+
+				entityDesc.pVertexBuffer = pQuadBuffer;
+				entityDesc.pPipeline = pPipeline;
+				entityDesc.pInstancedPipeline = pInstancedPipeline;
+			}
+			entityDesc.position = vec3(0, 0, 0);
+			entityDesc.rotation = vec3(0, 0, 0);
+			entityDesc.scale = vec3(1, 1, 1);
+
+			sceneCreated = createStressScene(&scene, pWorld, &entityDesc, gOptions.entityCount,
+											 gOptions.frameCount);
+			if (!sceneCreated)
+				return false;
+		}
+		return true;
+	}
+
+	void Unload(ReloadDesc* pReloadDesc) override { EngineApp::Unload(pReloadDesc); }
+
+	void Update(float deltaTime) override
+	{
+		frameStartNs = ecs_os_now();
+
+		moveStressScene(&scene, pWorld, deltaTime);
+		lastMoveMs = elapsedMs(frameStartNs);
+
+		EngineApp::Update(deltaTime);
+
+		float extent = stressSceneExtent(&scene);
+		CameraMatrix projection = CameraMatrix::orthographic(0.0f, extent, extent, 0.0f, -1.0f,
+															 1.0f);
+		uploadPerFrameData(&projection, sizeof(projection));
+	}
+
+	void Draw() override
+	{
+		EngineApp::Draw();
+
+		// Pipelined, the render phases are the previous frame's, see FrameTimings
+		const FrameTimings& timings = getFrameTimings();
+		StressSample sample = {};
+		sample.frameMs = elapsedMs(frameStartNs);
+		sample.moveMs = lastMoveMs;
+		sample.ecsProgressMs = timings.ecsProgressMs;
+		sample.transformMs = timings.transformMs;
+		sample.fillRenderDataMs = timings.fillRenderDataMs;
+		sample.recordMs = timings.recordMs;
+		sample.submitMs = timings.submitMs;
+
+		if (!reportWritten && addStressSample(&scene, &sample))
+		{
+			reportFailed = !writeStressReport(&scene, isHeadless() ? "headless" : "windowed");
+			reportWritten = true;
+			mSettings.mQuit = true;
+		}
+	}
+
+	const char* GetName() override { return "Stress"; }
+};
+
+// The Forge's entry point becomes stressWindowedMain, main() picks the mode
+#define main stressWindowedMain
+DEFINE_APPLICATION_MAIN(StressApp)
+#undef main
+
+///////////////////////////////////////////
+// Headless
+
+// Same bootstrap as a headless engineInit(), see initHeadlessApp
+static int runHeadless()
+{
+	StressApp* pApp = new StressApp();
+	if (!initHeadlessApp(pApp, "Stress"))
+	{
+		delete pApp;
+		return 1;
+	}
+
+	while (!pApp->mSettings.mQuit)
+	{
+		pApp->Update(STRESS_HEADLESS_DT);
+		pApp->Draw();
+	}
+
+	int exitCode = pApp->succeeded() ? 0 : 1;
+	exitHeadlessApp(pApp);
+	delete pApp;
+	return exitCode;
+}
+
+int main(int argc, char** argv)
+{
+	if (!parseOptions(argc, (const char**)argv, &gOptions))
+		return 1;
+
+	if (gOptions.headless)
+		return runHeadless();
+	return stressWindowedMain(argc, argv);
+}
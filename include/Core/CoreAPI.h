@@ -7,7 +7,9 @@
 #ifndef _CORE_API_H_
 #define _CORE_API_H_
 
-#ifdef CORE_EXPORTS
+#if !defined(_WIN32)
+#define CORE_API __attribute__((visibility("default")))
+#elif defined(CORE_EXPORTS)
 #define CORE_API __declspec(dllexport)
 #else
 #ifdef CORE_STATIC
@@ -0,0 +1,62 @@
+/*
+ * FrustumCull.h
+ *
+ * View frustum extraction and batched bounding sphere tests.
+ */
+
+#ifndef _FRUSTUMCULL_H_
+#define _FRUSTUMCULL_H_
+
+#include <stdint.h>
+
+/**
+	Six normalized frustum planes in world space.
+
+	Each plane is (a, b, c, d) with the normal pointing into the frustum, so
+	a point p is inside when a * p.x + b * p.y + c * p.z + d >= 0. Stored as
+	structure of arrays so four spheres can be tested against one plane per
+	SIMD step.
+*/
+struct Frustum
+{
+	float planeX[6];
+	float planeY[6];
+	float planeZ[6];
+	float planeW[6];
+};
+
+/**
+	Extracts the frustum planes from a view projection matrix.
+
+	Uses the Gribb/Hartmann method on a column major matrix that maps to a
+	0..1 clip depth, as The Forge projections do. Reverse Z projections work
+	as is, near and far simply swap.
+
+	@param pFrustum Receives the planes
+	@param pViewProjection Column major view projection matrix, 16 floats
+*/
+void extractFrustumPlanes(Frustum* pFrustum, const float* pViewProjection);
+
+/**
+	Tests a batch of world space bounding spheres against a frustum.
+
+	Uses SSE2 on x86 and NEON on ARM to test four spheres per step, falling
+	back to scalar code for the remainder and on other targets. A sphere is
+	culled when it lies entirely behind any plane, which is conservative
+	near the frustum corners.
+
+	@param pFrustum Frustum from extractFrustumPlanes
+	@param pCenterX Sphere centers x, count floats
+	@param pCenterY Sphere centers y, count floats
+	@param pCenterZ Sphere centers z, count floats
+	@param pRadius Sphere radii, count floats
+	@param count Number of spheres
+	@param pVisible Receives 1 for every visible sphere and 0 for culled ones
+
+	@return Number of visible spheres
+*/
+uint32_t cullSpheres(const Frustum* pFrustum, const float* pCenterX, const float* pCenterY,
+					 const float* pCenterZ, const float* pRadius, uint32_t count,
+					 uint8_t* pVisible);
+
+#endif // _FRUSTUMCULL_H_
@@ -7,7 +7,10 @@
  *   - LSB 0-23  (24 bits): Slot index
  *   - MSB 24-31 (8 bits):  Generation
  *
- * Only 255 generations, but should be enough.
+ * Only 256 generations per slot. Maps with heavy churn can opt into 64-bit
+ * handles instead:
+ *   - LSB 0-31  (32 bits): Slot index
+ *   - MSB 32-63 (32 bits): Generation
  */
 
 #ifndef _HANDLE_H_
@@ -21,6 +24,12 @@
 #define HANDLE_GENERATION_MASK 0xFF
 #define HANDLE_INVALID_ID 0xFFFFFFFF
 
+#define HANDLE64_INDEX_BITS 32
+#define HANDLE64_GENERATION_BITS 32
+#define HANDLE64_INDEX_MASK 0xFFFFFFFFull
+#define HANDLE64_GENERATION_MASK 0xFFFFFFFFull
+#define HANDLE64_INVALID_ID 0xFFFFFFFFFFFFFFFFull
+
 ///////////////////////////////////////////
 // Typed Handle Wrappers
 
@@ -176,6 +185,119 @@ inline bool handleIsValid(uint32_t id)
 	return id != HANDLE_INVALID_ID;
 }
 
+///////////////////////////////////////////
+// 64-bit Handles
+
+/**
+	Extracts the slot index from a 64-bit handle.
+
+	@param id Handle to extract index from
+
+	@return Slot index, the lower 32 bits
+
+	@see handle64Make
+*/
+inline uint32_t handle64Index(uint64_t id)
+{
+	return (uint32_t)(id & HANDLE64_INDEX_MASK);
+}
+
+/**
+	Extracts the generation counter from a 64-bit handle.
+
+	@param id Handle to extract generation from
+
+	@return Generation counter, the upper 32 bits
+
+	@see handle64Make
+*/
+inline uint32_t handle64Generation(uint64_t id)
+{
+	return (uint32_t)(id >> HANDLE64_INDEX_BITS);
+}
+
+/**
+	Creates a 64-bit handle from an index and generation counter.
+
+	@param index Slot index
+	@param generation Generation counter
+
+	@return Packed handle value
+
+	Example:
+	@code
+	uint64_t handle = handle64Make(1234, 70000);
+	assert(handle64Index(handle) == 1234);
+	assert(handle64Generation(handle) == 70000);
+	@endcode
+
+	@see handle64Index
+	@see handle64Generation
+*/
+inline uint64_t handle64Make(uint32_t index, uint32_t generation)
+{
+	return (uint64_t)index | ((uint64_t)generation << HANDLE64_INDEX_BITS);
+}
+
+/**
+	Checks if a 64-bit handle has a valid format.
+
+	@param id Handle to check
+
+	@return true if handle is not HANDLE64_INVALID_ID, false otherwise
+
+	@see handleIsValid
+*/
+inline bool handle64IsValid(uint64_t id)
+{
+	return id != HANDLE64_INVALID_ID;
+}
+
+///////////////////////////////////////////
+// Handle Traits
+
+/**
+	Handle layout for templates that work with either handle width.
+
+	Specialized for uint32_t and uint64_t, the two handle types.
+
+	@see SlotMap64
+*/
+template <typename HandleType>
+struct HandleTraits;
+
+template <>
+struct HandleTraits<uint32_t>
+{
+	static const uint32_t MAX_SLOTS = HANDLE_INDEX_MASK; ///< Keeps clear of HANDLE_INVALID_ID
+	static const uint32_t MAX_GENERATION = HANDLE_GENERATION_MASK;
+	static const uint32_t INVALID = HANDLE_INVALID_ID;
+
+	static uint32_t index(uint32_t id) { return handleIndex(id); }
+	static uint32_t generation(uint32_t id) { return handleGeneration(id); }
+	static uint32_t make(uint32_t index, uint32_t generation)
+	{
+		return handleMake(index, generation);
+	}
+	static bool isValid(uint32_t id) { return handleIsValid(id); }
+};
+
+template <>
+struct HandleTraits<uint64_t>
+{
+	static const uint32_t MAX_SLOTS = 0xFFFFFFFF; ///< Index UINT32_MAX is never handed out
+	static const uint32_t MAX_GENERATION = 0xFFFFFFFF;
+	static const uint64_t INVALID = HANDLE64_INVALID_ID;
+
+	static uint32_t index(uint64_t id) { return handle64Index(id); }
+	static uint32_t generation(uint64_t id) { return handle64Generation(id); }
+	static uint64_t make(uint32_t index, uint32_t generation)
+	{
+		return handle64Make(index, generation);
+	}
+	static bool isValid(uint64_t id) { return handle64IsValid(id); }
+};
+
 ///////////////////////////////////////////
 // Invalid Handle Constants
 
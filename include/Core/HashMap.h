@@ -2,20 +2,27 @@
  * HashMap.h
  *
  * Hash map for string key to value storage.
- * TODO : Replace with arena implementation.
+ * Open addressing (Robin Hood) table that lives entirely in an arena.
  */
 
 #ifndef _HASHMAP_H_
 #define _HASHMAP_H_
 
+#include "Core/HashedKey.h"
 #include <stdint.h>
 
 struct Arena;
+struct HashMapEntry;
 
 /**
 	Hash map structure.
 
-	Currently just a wrapper around std::map implementation.
+	Open addressing table using Robin Hood probing with backward shift
+	deletion, so there are no tombstones. Each slot stores the precomputed
+	key hash, which is compared before touching the entry. Entries hold the
+	interned key and the value, and are recycled through a free list.
+
+	All memory comes from the arena passed to hashMapCreate().
 
 	@see hashMapCreate
 	@see hashMapInsert
@@ -23,8 +30,15 @@ struct Arena;
 */
 struct HashMap
 {
-	void* pImpl;		///< Backend implementation (std::map)
-	uint32_t valueSize; ///< Size of each value in bytes
+	Arena* pArena;
+
+	uint32_t* pHashes;		   ///< Key hash per slot (0 = empty slot)
+	HashMapEntry** ppEntries;  ///< Entry per slot
+	HashMapEntry* pFreeList;   ///< Removed entries available for reuse
+
+	uint32_t capacity;		   ///< Number of slots (power of 2)
+	uint32_t count;			   ///< Current number of key-value pairs
+	uint32_t valueSize;		   ///< Size of each value in bytes
 };
 
 ///////////////////////////////////////////
@@ -34,19 +48,25 @@ struct HashMap
 	Creates a new hash map.
 
 	Allocates and initializes a hash map with the specified value size.
+	All memory is allocated from the provided arena.
 
 	@param pArena Arena to allocate from
 	@param valueSize Size of each stored value in bytes
 
 	@return Pointer to the created hash map, or nullptr on failure
 
+	@note Values are 16 byte aligned
+
 	@see hashMapInsert
 	@see hashMapGet
 */
 HashMap* hashMapCreate(Arena* pArena, uint32_t valueSize);
 
 /**
-	Destroys a hash map and frees all memory.
+	Destroys a hash map.
+
+	Resets the map to an empty state. The memory itself belongs to the arena
+	and is reclaimed when the arena is popped, cleared or released.
 
 	@param pHashMap Hash map to destroy
 
@@ -56,6 +76,8 @@ void hashMapDestroy(HashMap* pHashMap);
 
 void hashMapInsertImpl(HashMap* pHashMap, const char* key, const void* pValue);
 void* hashMapGetImpl(HashMap* pHashMap, const char* key);
+void hashMapInsertHashedImpl(HashMap* pHashMap, HashedKey key, const void* pValue);
+void* hashMapGetHashedImpl(HashMap* pHashMap, HashedKey key);
 
 /**
 	Checks if a key exists in the hash map.
@@ -92,6 +114,50 @@ void hashMapRemove(HashMap* pHashMap, const char* key);
 */
 uint32_t hashMapCount(HashMap* pHashMap);
 
+/**
+	Checks if a prehashed key exists in the hash map.
+
+	Same as hashMapContains but skips hashing the key.
+
+	@param pHashMap Hash map to check
+	@param key Prehashed key to look up
+
+	@return true if key exists, false otherwise
+
+	@see hashMapContains
+	@see HASHED_KEY
+*/
+bool hashMapContainsHashed(HashMap* pHashMap, HashedKey key);
+
+/**
+	Removes a prehashed key from the hash map.
+
+	Same as hashMapRemove but skips hashing the key.
+
+	@param pHashMap Hash map to remove from
+	@param key Prehashed key to remove
+
+	@note Safe to call with non-existent key (no-op)
+
+	@see hashMapRemove
+*/
+void hashMapRemoveHashed(HashMap* pHashMap, HashedKey key);
+
+/**
+	Gets the map's interned copy of a key.
+
+	Useful when something needs to remember the key of an entry (for removal
+	later) without keeping its own copy of the string.
+
+	@param pHashMap Hash map to query
+	@param key Prehashed key to look up
+
+	@return Interned key string, or nullptr if the key is not in the map
+
+	@note The returned string is valid until the key is removed
+*/
+const char* hashMapGetKey(HashMap* pHashMap, HashedKey key);
+
 ///////////////////////////////////////////
 // Template Helpers
 
@@ -107,6 +173,7 @@ uint32_t hashMapCount(HashMap* pHashMap);
 	@param value Value to insert (passed by const reference)
 
 	@note The value is copied into the hash map's internal storage
+	@note The key is interned in the arena, the caller's string is not kept
 
 	Example:
 	@code
@@ -156,4 +223,50 @@ inline T* hashMapGet(HashMap* pHashMap, const char* key)
 	return (T*)hashMapGetImpl(pHashMap, key);
 }
 
+/**
+	Inserts a key value pair using a prehashed key.
+
+	Same as hashMapInsert but skips hashing the key.
+
+	@tparam T Type of value to insert
+	@param pHashMap Hash map to insert into
+	@param key Prehashed key (string will be copied)
+	@param value Value to insert
+
+	@see hashMapInsert
+	@see HASHED_KEY
+*/
+template <typename T>
+inline void hashMapInsertHashed(HashMap* pHashMap, HashedKey key, const T& value)
+{
+	hashMapInsertHashedImpl(pHashMap, key, &value);
+}
+
+/**
+	Retrieves a pointer to a value using a prehashed key.
+
+	Same as hashMapGet but skips hashing the key. With HASHED_KEY the hash
+	is computed at compile time, so a lookup only costs the probe and a
+	single string compare.
+
+	@tparam T Type of value to retrieve
+	@param pHashMap Hash map to get from
+	@param key Prehashed key to look up
+
+	@return Pointer to the value, or nullptr if key not found
+
+	Example:
+	@code
+	TextureHandle* pHandle = hashMapGetHashed<TextureHandle>(pMap, HASHED_KEY("player.dds"));
+	@endcode
+
+	@see hashMapGet
+	@see HASHED_KEY
+*/
+template <typename T>
+inline T* hashMapGetHashed(HashMap* pHashMap, HashedKey key)
+{
+	return (T*)hashMapGetHashedImpl(pHashMap, key);
+}
+
 #endif // _HASHMAP_H_
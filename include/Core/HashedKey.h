@@ -0,0 +1,118 @@
+/*
+ * HashedKey.h
+ *
+ * String keys with a precomputed hash.
+ * Literals are hashed at compile time, so lookups never touch the string
+ * unless the hash matches.
+ */
+
+#ifndef _HASHEDKEY_H_
+#define _HASHEDKEY_H_
+
+#include <stdint.h>
+
+/**
+	String key paired with its precomputed hash.
+
+	Used by the hashed lookup functions (hashMapGetHashed, loadTextureHashed)
+	to skip hashing and string construction on every call. The string is
+	still kept for comparison when two keys share a hash.
+
+	@note pKey is not copied, it must outlive the HashedKey
+
+	@see HASHED_KEY
+	@see hashedKey
+*/
+struct HashedKey
+{
+	const char* pKey; ///< Key string (not owned)
+	uint32_t length;  ///< Key length without terminator
+	uint32_t hash;	  ///< FNV-1a hash of the key, never 0
+};
+
+/**
+	Hashes a string of known length with 32-bit FNV-1a.
+
+	Zero is reserved to mark empty hash map slots, so a zero hash is
+	remapped to 1. Every hashed key in the engine (hash maps, asset path
+	hashes) goes through this function so the values always agree.
+
+	@param str String to hash
+	@param length Number of characters to hash
+
+	@return Hash of the string, never 0
+*/
+constexpr uint32_t hashString(const char* str, uint32_t length)
+{
+	uint32_t hash = 2166136261u;
+	for (uint32_t i = 0; i < length; ++i)
+	{
+		hash ^= (uint8_t)str[i];
+		hash *= 16777619u;
+	}
+
+	return hash ? hash : 1;
+}
+
+/**
+	Builds a HashedKey from a null terminated string at runtime.
+
+	@param str String key
+
+	@return HashedKey referencing str
+
+	@see hashedKey
+*/
+constexpr HashedKey hashedKeyFromString(const char* str)
+{
+	uint32_t length = 0;
+	while (str[length])
+		++length;
+
+	return HashedKey{str, length, hashString(str, length)};
+}
+
+/**
+	Builds a HashedKey from a string literal.
+
+	Can be evaluated at compile time. Use HASHED_KEY to guarantee it.
+
+	@tparam N Size of the literal including the terminator
+	@param str String literal
+
+	@return HashedKey referencing the literal
+
+	Example:
+	@code
+	static constexpr HashedKey kPlayerTexture = hashedKey("player.dds");
+	TextureHandle tex = loadTextureHashed(pCache, kPlayerTexture);
+	@endcode
+
+	@see HASHED_KEY
+*/
+template <uint32_t N>
+constexpr HashedKey hashedKey(const char (&str)[N])
+{
+	return HashedKey{str, N - 1, hashString(str, N - 1)};
+}
+
+/**
+	Creates a HashedKey from a string literal with the hash computed at
+	compile time.
+
+	@param literal String literal
+
+	Example:
+	@code
+	int* pValue = hashMapGetHashed<int>(pMap, HASHED_KEY("score"));
+	@endcode
+
+	@see hashedKey
+*/
+#define HASHED_KEY(literal)                                                                        \
+	([]() {                                                                                        \
+		constexpr HashedKey _key = hashedKey(literal);                                             \
+		return _key;                                                                               \
+	}())
+
+#endif // _HASHEDKEY_H_
@@ -0,0 +1,44 @@
+/*
+ * RadixSort.h
+ *
+ * LSD radix sort for 64-bit keys with a 32-bit payload.
+ */
+
+#ifndef _RADIXSORT_H_
+#define _RADIXSORT_H_
+
+#include <stdint.h>
+
+/**
+	Sorts 64-bit keys in ascending order, carrying a 32-bit value with each key.
+
+	Least significant digit radix sort with 8-bit digits (eight passes). The
+	sort is stable, and passes where every key has the same digit are
+	skipped, so keys that leave some bytes constant stay cheap. Runs in
+	linear time, which beats comparison sorts for the few thousand draw
+	keys sorted every frame.
+
+	The result ends up in pKeys/pValues. The temp arrays are scratch space
+	and hold garbage afterwards.
+
+	@param pKeys Keys to sort
+	@param pValues Value per key, usually the index of the sorted item
+	@param pTempKeys Scratch array of count keys
+	@param pTempValues Scratch array of count values
+	@param count Number of keys
+
+	Example:
+	@code
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		pKeys[i] = items[i].sortKey;
+		pValues[i] = i;
+	}
+	radixSort64(pKeys, pValues, pTempKeys, pTempValues, count);
+	// pValues now holds the item indices in key order
+	@endcode
+*/
+void radixSort64(uint64_t* pKeys, uint32_t* pValues, uint64_t* pTempKeys, uint32_t* pTempValues,
+				 uint32_t count);
+
+#endif // _RADIXSORT_H_
@@ -11,12 +11,18 @@
 #include <stdint.h>
 
 struct Arena;
+struct PoolSet;
 
 /**
 	Generational slot map structure.
 
 	A slot map is a data structure for handles of types.
 
+	Every remove bumps the generation of the slot, so old handles stop
+	resolving. A slot whose generation reached the most a handle can hold
+	is retired instead of reused, since its next handle would match a
+	stale one.
+
 	@see slotMapCreate
 	@see slotMapInsert
 	@see slotMapGet
@@ -24,6 +30,7 @@ struct Arena;
 struct SlotMap
 {
 	Arena* pArena;
+	PoolSet* pStoragePools;     ///< Backs the arrays when set, nullptr pushes them onto pArena
 
 	void* pValues;              ///< Dense array of values
 	uint32_t* pIndices;         ///< Sparse to dense index mapping
@@ -33,10 +40,30 @@ struct SlotMap
 	uint32_t capacity;          ///< Maximum number of slots
 	uint32_t count;             ///< Current number of elements
 	uint32_t freeHead;          ///< Head of free list
+	uint32_t nextSlot;          ///< Slots below this were handed out at least once
+	uint32_t retiredCount;      ///< Slots whose generation ran out, never reused
+	uint32_t maxGeneration;     ///< Highest generation the handle width holds
+	uint32_t maxCapacity;       ///< Highest slot count the handle width can address
 	uint32_t valueSize;         ///< Size of each value in bytes
 	uint32_t valueAlign;        ///< Alignment requirement for values
 };
 
+/**
+	Slot map with 64-bit handles.
+
+	Same storage as SlotMap, but handles carry a 32 bit index and a 32 bit
+	generation, so a slot is reused four billion times before it retires
+	instead of 256. Opt in for maps with heavy churn, such as streamed
+	assets. Every SlotMap function works on it, and the helpers below have
+	overloads taking and returning uint64_t handles.
+
+	@see slotMapCreate64
+	@see HandleTraits
+*/
+struct SlotMap64 : SlotMap
+{
+};
+
 ///////////////////////////////////////////
 // Core API
 
@@ -50,17 +77,64 @@ struct SlotMap
 	@param valueSize Size of each stored value in bytes
 	@param valueAlign Alignment requirement for values
 	@param initialCapacity Initial number of slots to allocate
+	@param pStoragePools Optional pools for the arrays. Arena backed arrays
+	are stranded every time the map grows, pooled ones are freed back to
+	their size class and reused by the next map that reaches that size
 
 	@return Pointer to the created slot map, or nullptr on failure
 
-	@note Minimum alignment is 8 bytes
+	@note Minimum alignment is 8 bytes, pooled storage allows at most 64
 
 	@see slotMapInsert
 	@see slotMapCount
 	@see slotMapCapacity
+	@see slotMapDestroy
 */
 SlotMap* slotMapCreate(Arena* pArena, uint32_t valueSize, uint32_t valueAlign,
-					   uint32_t initialCapacity);
+					   uint32_t initialCapacity, PoolSet* pStoragePools = nullptr);
+
+/**
+	Creates a new slot map with 64-bit handles.
+
+	Same parameters as slotMapCreate.
+
+	@return Pointer to the created slot map, or nullptr on failure
+
+	@see slotMapCreate
+	@see SlotMap64
+*/
+SlotMap64* slotMapCreate64(Arena* pArena, uint32_t valueSize, uint32_t valueAlign,
+						   uint32_t initialCapacity, PoolSet* pStoragePools = nullptr);
+
+/**
+	Returns the slot map arrays to their pools.
+
+	Only needed for maps created with storage pools, arena backed arrays
+	are released with the arena. The map is empty with zero capacity
+	afterwards, and must not be inserted into again.
+
+	@param pSlotMap Slot map to destroy
+
+	@see slotMapCreate
+*/
+void slotMapDestroy(SlotMap* pSlotMap);
+
+/**
+	Grows the slot map to hold at least capacity elements.
+
+	Call before a large batch of inserts, such as a level load, so the arrays
+	are copied once instead of on every doubling.
+
+	@param pSlotMap Slot map to grow
+	@param capacity Number of elements the map should hold without growing
+
+	@return true if the map can hold capacity elements, false on failure
+
+	@note Never shrinks, handles stay valid
+
+	@see slotMapInsertN
+*/
+bool slotMapReserve(SlotMap* pSlotMap, uint32_t capacity);
 
 
 ///////////////////////////////////////////
@@ -70,6 +144,21 @@ uint32_t slotMapInsertImpl(SlotMap* pSlotMap, const void* pValue);
 void* slotMapGetImpl(SlotMap* pSlotMap, uint32_t handle);
 void slotMapRemoveImpl(SlotMap* pSlotMap, uint32_t handle);
 bool slotMapIsValidImpl(SlotMap* pSlotMap, uint32_t handle);
+uint32_t slotMapInsertNImpl(SlotMap* pSlotMap, const void* pValues, uint32_t count,
+							uint32_t* pOutHandles);
+uint32_t slotMapGetNImpl(SlotMap* pSlotMap, const uint32_t* pHandles, uint32_t count,
+						 void** ppOutValues);
+uint32_t slotMapRemoveNImpl(SlotMap* pSlotMap, const uint32_t* pHandles, uint32_t count);
+
+uint64_t slotMapInsert64Impl(SlotMap64* pSlotMap, const void* pValue);
+void* slotMapGet64Impl(SlotMap64* pSlotMap, uint64_t handle);
+void slotMapRemove64Impl(SlotMap64* pSlotMap, uint64_t handle);
+bool slotMapIsValid64Impl(SlotMap64* pSlotMap, uint64_t handle);
+uint32_t slotMapInsertN64Impl(SlotMap64* pSlotMap, const void* pValues, uint32_t count,
+							  uint64_t* pOutHandles);
+uint32_t slotMapGetN64Impl(SlotMap64* pSlotMap, const uint64_t* pHandles, uint32_t count,
+						   void** ppOutValues);
+uint32_t slotMapRemoveN64Impl(SlotMap64* pSlotMap, const uint64_t* pHandles, uint32_t count);
 
 
 ///////////////////////////////////////////
@@ -100,6 +189,21 @@ uint32_t slotMapCount(SlotMap* pSlotMap);
 */
 uint32_t slotMapCapacity(SlotMap* pSlotMap);
 
+/**
+	Gets the number of retired slots.
+
+	Retired slots still take up space in the sparse arrays but are never
+	handed out again. A steadily rising count means the map churns hard
+	enough to want 64-bit handles.
+
+	@param pSlotMap Slot map to query
+
+	@return Number of retired slots, or 0 if pSlotMap is nullptr
+
+	@see SlotMap64
+*/
+uint32_t slotMapRetiredCount(SlotMap* pSlotMap);
+
 ///////////////////////////////////////////
 // Template Helpers
 
@@ -218,4 +322,257 @@ inline bool slotMapIsValid(SlotMap* pSlotMap, uint32_t handle)
 	return slotMapIsValidImpl(pSlotMap, handle);
 }
 
+/**
+	Return type of the 64-bit handle overloads.
+
+	Only defined for SlotMap64, so the overloads drop out for a SlotMap or
+	a nullptr argument instead of making those calls ambiguous.
+*/
+template <typename MapType, typename R>
+struct SlotMap64Result
+{
+};
+
+template <typename R>
+struct SlotMap64Result<SlotMap64, R>
+{
+	typedef R Type;
+};
+
+/**
+	64-bit handle overloads of the helpers above.
+
+	@see SlotMap64
+*/
+template <typename T, typename MapType>
+inline typename SlotMap64Result<MapType, uint64_t>::Type slotMapInsert(MapType* pSlotMap,
+																		const T& value)
+{
+	return slotMapInsert64Impl(pSlotMap, &value);
+}
+
+template <typename T, typename MapType>
+inline typename SlotMap64Result<MapType, T*>::Type slotMapGet(MapType* pSlotMap, uint64_t handle)
+{
+	return (T*)slotMapGet64Impl(pSlotMap, handle);
+}
+
+template <typename MapType>
+inline typename SlotMap64Result<MapType, void>::Type slotMapRemove(MapType* pSlotMap,
+																	uint64_t handle)
+{
+	slotMapRemove64Impl(pSlotMap, handle);
+}
+
+template <typename MapType>
+inline typename SlotMap64Result<MapType, bool>::Type slotMapIsValid(MapType* pSlotMap,
+																	 uint64_t handle)
+{
+	return slotMapIsValid64Impl(pSlotMap, handle);
+}
+
+///////////////////////////////////////////
+// Batch Helpers
+
+/**
+	Inserts many values with a single reserve.
+
+	@tparam T Type of value to insert
+	@param pSlotMap Slot map to insert into
+	@param pValues Array of count values
+	@param count Number of values
+	@param pOutHandles Optional array of count handles, in the order of pValues
+
+	@return Number of values inserted, either count or 0 if the map could not grow
+
+	@see slotMapReserve
+	@see slotMapRemoveN
+*/
+template <typename T>
+inline uint32_t slotMapInsertN(SlotMap* pSlotMap, const T* pValues, uint32_t count,
+							   uint32_t* pOutHandles)
+{
+	return slotMapInsertNImpl(pSlotMap, pValues, count, pOutHandles);
+}
+
+/**
+	Resolves many handles in one pass.
+
+	Prefetches the sparse entries and values of handles further down the
+	array, so scattered lookups overlap their cache misses instead of
+	paying for them one at a time.
+
+	@tparam T Type of value to retrieve
+	@param pSlotMap Slot map to get from
+	@param pHandles Array of count handles
+	@param count Number of handles
+	@param ppOutValues Receives a pointer per handle, nullptr for invalid handles
+
+	@return Number of handles that resolved to a value
+
+	Example:
+	@code
+	Entity* pEntities[64];
+	slotMapGetN(pMap, handles, 64, pEntities);
+	for (uint32_t i = 0; i < 64; i++) {
+		if (pEntities[i])
+			pEntities[i]->position.x += velocity.x * deltaTime;
+	}
+	@endcode
+
+	@note Pointers are invalidated by the next insert or remove
+
+	@see slotMapGet
+*/
+template <typename T>
+inline uint32_t slotMapGetN(SlotMap* pSlotMap, const uint32_t* pHandles, uint32_t count,
+							T** ppOutValues)
+{
+	return slotMapGetNImpl(pSlotMap, pHandles, count, (void**)ppOutValues);
+}
+
+/**
+	Removes many values in one pass.
+
+	@param pSlotMap Slot map to remove from
+	@param pHandles Array of count handles, invalid and stale ones are skipped
+	@param count Number of handles
+
+	@return Number of values removed
+
+	@see slotMapRemove
+*/
+inline uint32_t slotMapRemoveN(SlotMap* pSlotMap, const uint32_t* pHandles, uint32_t count)
+{
+	return slotMapRemoveNImpl(pSlotMap, pHandles, count);
+}
+
+/**
+	64-bit handle overloads of the batch helpers above.
+
+	@see SlotMap64
+*/
+template <typename T, typename MapType>
+inline typename SlotMap64Result<MapType, uint32_t>::Type
+slotMapInsertN(MapType* pSlotMap, const T* pValues, uint32_t count, uint64_t* pOutHandles)
+{
+	return slotMapInsertN64Impl(pSlotMap, pValues, count, pOutHandles);
+}
+
+template <typename T, typename MapType>
+inline typename SlotMap64Result<MapType, uint32_t>::Type
+slotMapGetN(MapType* pSlotMap, const uint64_t* pHandles, uint32_t count, T** ppOutValues)
+{
+	return slotMapGetN64Impl(pSlotMap, pHandles, count, (void**)ppOutValues);
+}
+
+template <typename MapType>
+inline typename SlotMap64Result<MapType, uint32_t>::Type
+slotMapRemoveN(MapType* pSlotMap, const uint64_t* pHandles, uint32_t count)
+{
+	return slotMapRemoveN64Impl(pSlotMap, pHandles, count);
+}
+
+///////////////////////////////////////////
+// Iteration
+
+/**
+	Gets the dense value array.
+
+	The first slotMapCount values are live and packed with no holes, so a
+	plain loop over them is the fastest way to touch every element.
+
+	@tparam T Type of the stored values
+	@param pSlotMap Slot map to query
+
+	@return The dense array, or nullptr if pSlotMap is nullptr
+
+	@note Order changes on remove, and the array moves when the map grows
+
+	@see slotMapHandleAt
+	@see slotMapForEach
+*/
+template <typename T>
+inline T* slotMapValues(SlotMap* pSlotMap)
+{
+	return pSlotMap ? (T*)pSlotMap->pValues : nullptr;
+}
+
+/**
+	Gets the handle of a dense element.
+
+	@param pSlotMap Slot map to query
+	@param denseIndex Index into slotMapValues, below slotMapCount
+
+	@return Handle of the element, valid until it is removed
+
+	@see slotMapValues
+*/
+inline uint32_t slotMapHandleAt(SlotMap* pSlotMap, uint32_t denseIndex)
+{
+	uint32_t sparseIndex = pSlotMap->pErase[denseIndex];
+	return handleMake(sparseIndex, pSlotMap->pGenerations[sparseIndex]);
+}
+
+/**
+	Gets the 64-bit handle of a dense element.
+
+	@see slotMapHandleAt
+*/
+template <typename MapType>
+inline typename SlotMap64Result<MapType, uint64_t>::Type slotMapHandleAt(MapType* pSlotMap,
+																		  uint32_t denseIndex)
+{
+	uint32_t sparseIndex = pSlotMap->pErase[denseIndex];
+	return handle64Make(sparseIndex, pSlotMap->pGenerations[sparseIndex]);
+}
+
+/**
+	Calls fn(value, handle) for every element in dense order.
+
+	@tparam T Type of the stored values
+	@tparam Fn Callable taking (T&, uint32_t), or (T&, uint64_t) for a SlotMap64
+	@param pSlotMap Slot map to iterate
+	@param fn Function to call
+
+	Example:
+	@code
+	slotMapForEach<Entity>(pMap, [&](Entity& entity, uint32_t handle) {
+		entity.position.x += entity.velocity.x * deltaTime;
+	});
+	@endcode
+
+	@note Do not insert or remove while iterating, collect the handles and
+	use slotMapRemoveN afterwards
+
+	@see slotMapValues
+*/
+template <typename T, typename HandleType, typename Fn>
+inline void slotMapForEachImpl(SlotMap* pSlotMap, Fn& fn)
+{
+	if (!pSlotMap)
+		return;
+
+	T* pValues = (T*)pSlotMap->pValues;
+	const uint32_t* pErase = pSlotMap->pErase;
+	for (uint32_t i = 0; i < pSlotMap->count; i++)
+	{
+		uint32_t sparseIndex = pErase[i];
+		fn(pValues[i],
+		   HandleTraits<HandleType>::make(sparseIndex, pSlotMap->pGenerations[sparseIndex]));
+	}
+}
+
+template <typename T, typename Fn>
+inline void slotMapForEach(SlotMap* pSlotMap, Fn fn)
+{
+	slotMapForEachImpl<T, uint32_t>(pSlotMap, fn);
+}
+
+template <typename T, typename Fn, typename MapType>
+inline typename SlotMap64Result<MapType, void>::Type slotMapForEach(MapType* pSlotMap, Fn fn)
+{
+	slotMapForEachImpl<T, uint64_t>(pSlotMap, fn);
+}
+
 #endif // _SLOTMAP_H_
@@ -0,0 +1,60 @@
+/*
+ * TransformKernel.h
+ *
+ * Batched translation * rotation * scale matrix composition.
+ * Works on structure of arrays input, four entities per SIMD step.
+ */
+
+#ifndef _TRANSFORMKERNEL_H_
+#define _TRANSFORMKERNEL_H_
+
+#include <stdint.h>
+
+/**
+	Structure of arrays input for composeTRSMatrices.
+
+	Every pointer references count floats, one per entity. Rotations are
+	Euler angles in radians, applied in Z * Y * X order (the same as
+	mat4::rotationZYX).
+*/
+struct TRSInputs
+{
+	const float* pPositionX;
+	const float* pPositionY;
+	const float* pPositionZ;
+	const float* pRotationX;
+	const float* pRotationY;
+	const float* pRotationZ;
+	const float* pScaleX;
+	const float* pScaleY;
+	const float* pScaleZ;
+};
+
+/**
+	Composes T * R * S world matrices for a batch of entities.
+
+	Uses SSE2 on x86 and NEON on ARM to build four matrices per step, with
+	a vectorized sin/cos, and falls back to composeTRSMatricesScalar for the
+	remainder and on other targets.
+
+	Matrices are written column major, 16 floats each, so the output can
+	be an array of mat4.
+
+	@param pInputs Input arrays, each holding count floats
+	@param pOutMatrices Receives count matrices (16 * count floats)
+	@param count Number of entities
+
+	@see composeTRSMatricesScalar
+*/
+void composeTRSMatrices(const TRSInputs* pInputs, float* pOutMatrices, uint32_t count);
+
+/**
+	Scalar reference for composeTRSMatrices.
+
+	@param pInputs Input arrays, each holding count floats
+	@param pOutMatrices Receives count matrices (16 * count floats)
+	@param count Number of entities
+*/
+void composeTRSMatricesScalar(const TRSInputs* pInputs, float* pOutMatrices, uint32_t count);
+
+#endif // _TRANSFORMKERNEL_H_
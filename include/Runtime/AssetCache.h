@@ -8,14 +8,38 @@
 #define _ASSETCACHE_H_
 
 #include "Core/Handle.h"
-#include "Utilities/ThirdParty/OpenSource/bstrlib/bstrlib.h"
+#include "Core/HashedKey.h"
 #include <stdint.h>
 
+#define ASSET_CACHE_DEFAULT_GPU_BUDGET (256ull * 1024 * 1024) ///< Bytes before unused assets go
+#define ASSET_CACHE_MAX_BINDLESS_TEXTURES 1024 ///< Matches gTextures in Global.srt.h
+#define ASSET_CACHE_MAX_FRAMES 4 ///< Upper bound on frames in flight
+
 struct Arena;
 struct Renderer;
 struct SlotMap;
+struct Pool;
+struct PoolSet;
+struct HashMap;
 struct Texture;
 struct Buffer;
+struct DescriptorSet;
+struct Fence;
+struct TextureLoadRequest;
+struct RetiredAsset;
+
+/**
+	Texture streaming state.
+
+	@see loadTextureAsync
+	@see updateAssetCache
+*/
+enum TextureState : uint32_t
+{
+	TextureState_Pending = 0, ///< Still loading, pTexture is the placeholder
+	TextureState_Ready,		  ///< Loaded, pTexture is the real texture
+	TextureState_Failed,	  ///< Load failed, pTexture stays the placeholder
+};
 
 /**
 	Texture resource data.
@@ -25,11 +49,17 @@ struct Buffer;
 */
 struct TextureData
 {
-	Texture* pTexture; ///< Texture pointer
+	Texture* pTexture; ///< Texture pointer (placeholder while pending)
 	uint32_t width;	   ///< Texture width in pixels
 	uint32_t height;   ///< Texture height in pixels
-	uint32_t pathHash; ///< Hash of file path
-	uint32_t refCount; ///< Reference count for automatic cleanup
+	uint32_t pathHash; ///< Hash of file path (hashString)
+	uint32_t refCount; ///< Reference count, unused at zero
+	uint32_t state;	   ///< TextureState
+	const char* pPath; ///< Interned cache key, used to remove the cache entry
+	uint64_t gpuBytes; ///< Estimated GPU memory, 0 while pending
+	uint64_t lruStamp; ///< When the last reference was dropped, orders eviction
+	uint32_t lruOlder; ///< Previous unused texture handle, HANDLE_INVALID_ID at the oldest
+	uint32_t lruNewer; ///< Next unused texture handle, HANDLE_INVALID_ID at the newest
 };
 
 /**
@@ -43,16 +73,64 @@ struct MeshData
 	Buffer* pIndexBuffer;  ///< Index buffer
 	uint32_t vertexCount;  ///< Number of vertices
 	uint32_t indexCount;   ///< Number of indices
+	uint32_t indexSize;	   ///< Bytes per index (2 or 4)
 	uint32_t vertexStride; ///< Size of each vertex in bytes
-	uint32_t pathHash;	   ///< Hash of file path
-	uint32_t refCount;	   ///< Reference count for automatic cleanup
+	uint32_t pathHash;	   ///< Hash of file path (hashString), 0 for procedural meshes
+	uint32_t refCount;	   ///< Reference count, unused at zero
+	const char* pPath;	   ///< Interned cache key, nullptr for procedural meshes
+	float boundsMin[3];	   ///< Object space AABB minimum, used for culling
+	float boundsMax[3];	   ///< Object space AABB maximum
+	uint64_t gpuBytes;	   ///< Vertex and index buffer size
+	uint64_t lruStamp;	   ///< When the last reference was dropped, orders eviction
+	uint32_t lruOlder;	   ///< Previous unused mesh handle, HANDLE_INVALID_ID at the oldest
+	uint32_t lruNewer;	   ///< Next unused mesh handle, HANDLE_INVALID_ID at the newest
+};
+
+/**
+	Unused assets of one type, oldest first.
+
+	Linked through the lruOlder and lruNewer handles of the entries, so
+	taking an entry out when it is loaded again is O(1).
+*/
+struct AssetLruList
+{
+	uint32_t oldest; ///< Evicted first, HANDLE_INVALID_ID when empty
+	uint32_t newest; ///< Released last
+	uint32_t count;	 ///< Entries in the list
+};
+
+/**
+	Asset cache counters.
+
+	@see getAssetCacheStats
+*/
+struct AssetCacheStats
+{
+	uint64_t hits;			///< Loads served from the cache, including unused assets
+	uint64_t misses;		///< Loads that had to go to disk
+	uint64_t evictions;		///< Unused assets freed to stay within the budget
+	uint64_t residentBytes; ///< Estimated GPU memory of every loaded asset
+	uint64_t unusedBytes;	///< Part of residentBytes held by unused assets
+	uint64_t budgetBytes;	///< Budget set with setAssetCacheBudget
+	uint32_t unusedCount;	///< Unused assets waiting in the LRU lists
 };
 
 /**
 	Asset cache structure.
 
-	Centralized system for loading, caching, and managing game assets. Uses
-	bstring from The Forge for path handling and caching.
+	Centralized system for loading, caching, and managing game assets. Paths
+	are cached in arena hash maps keyed by their precomputed hash.
+
+	Dropping the last reference to a loaded asset does not free it. The
+	asset moves to an LRU list and stays resident, so loading it again,
+	for example when a level is reloaded, is a cache hit. Unused assets
+	are only evicted, oldest first, once the resident GPU memory goes over
+	the budget.
+
+	Frames in flight may still draw with an asset when it goes, so its
+	buffers and textures are retired into the current frame and only
+	freed once that frame has finished on the GPU, see
+	beginAssetCacheFrame.
 
 	@see createAssetCache
 	@see loadTexture
@@ -63,19 +141,35 @@ struct AssetCache
 	Arena* pArena;		 ///< Arena for allocations
 	Renderer* pRenderer; ///< The renderer
 
-	SlotMap* pTextures; ///< Texture storage (handle -> TextureData)
-	SlotMap* pMeshes;	///< Mesh storage (handle -> MeshData)
-
-	struct
-	{
-		bstring key;
-		TextureHandle value;
-	}* pTextureCache; ///< Path -> TextureHandle
-	struct
-	{
-		bstring key;
-		MeshHandle value;
-	}* pMeshCache; ///< Path -> MeshHandle
+	PoolSet* pStoragePools; ///< Backs the slot map arrays
+	SlotMap* pTextures;		///< Texture storage (handle -> TextureData)
+	SlotMap* pMeshes;		///< Mesh storage (handle -> MeshData)
+
+	HashMap* pTextureCache; ///< Path -> TextureHandle
+	HashMap* pMeshCache;	///< Path -> MeshHandle
+
+	TextureLoadRequest* pPendingTextures; ///< Textures still streaming in
+	Pool* pTextureRequestPool;			  ///< Recycles request records
+	uint32_t pendingTextureCount;		  ///< Number of pending texture loads
+	TextureHandle placeholderTexture;	  ///< Texture shown while loading
+
+	AssetLruList unusedTextures; ///< Textures without references
+	AssetLruList unusedMeshes;	 ///< Cached meshes without references
+	uint64_t lruClock;			 ///< Stamps released entries
+	AssetCacheStats stats;		 ///< Counters and memory totals
+
+	DescriptorSet* pBindlessSet; ///< Holds the bindless texture array, nullptr until bound
+	uint32_t bindlessIndex;		 ///< Descriptor index of the array in pBindlessSet
+	Texture** ppSlotTextures;	 ///< What each bindless slot holds once every set caught up
+	Texture* pFallbackTexture;	 ///< 1x1 white, shown when a slot has nothing else
+
+	/// Slots each frame's set still has to write, one bit per slot
+	uint32_t dirtySlots[ASSET_CACHE_MAX_FRAMES][ASSET_CACHE_MAX_BINDLESS_TEXTURES / 32];
+
+	RetiredAsset* pRetired[ASSET_CACHE_MAX_FRAMES]; ///< Freed when that frame index comes around
+	Pool* pRetiredPool;								///< Recycles retire records
+	uint32_t frameCount;							///< Frames in flight
+	uint32_t frameIndex;							///< Frame removed resources retire into
 };
 
 ///////////////////////////////////////////
@@ -88,12 +182,14 @@ struct AssetCache
 
 	@param pArena Arena to allocate from
 	@param pRenderer Renderer for resource creation
+	@param frameCount Number of frames in flight, at most ASSET_CACHE_MAX_FRAMES
 
 	@return Pointer to the created asset cache, or nullptr on failure
 
 	@see shutdownAssetCache
+	@see beginAssetCacheFrame
 */
-AssetCache* createAssetCache(Arena* pArena, Renderer* pRenderer);
+AssetCache* createAssetCache(Arena* pArena, Renderer* pRenderer, uint32_t frameCount);
 
 /**
 	Shuts down the asset cache and frees all resources.
@@ -102,10 +198,72 @@ AssetCache* createAssetCache(Arena* pArena, Renderer* pRenderer);
 
 	@param pCache Asset cache to shutdown
 
+	@warning The GPU must be idle, retired resources are freed without
+			 waiting on their frames
+
 	@see createAssetCache
 */
 void shutdownAssetCache(AssetCache* pCache);
 
+/**
+	Starts a frame on one of the frame indices.
+
+	Waits for the fence of the last submit that used frameIndex, if the
+	GPU has not finished it yet. Then writes the bindless slot changes
+	into set frameIndex of the bound descriptor set, frees the resources
+	retired while that frame was current and makes frameIndex current.
+	Call once per frame with the index of the frame about to be recorded.
+
+	@param pCache Asset cache
+	@param frameIndex Frame slot, always below the cache's frameCount
+	@param pFence Fence signaled by the last submit of frameIndex, nullptr
+				  before the first one
+
+	@note Nothing is freed before the first call, assets removed until then
+		  wait for it
+
+	@see createAssetCache
+*/
+void beginAssetCacheFrame(AssetCache* pCache, uint32_t frameIndex, Fence* pFence);
+
+///////////////////////////////////////////
+// Residency
+
+/**
+	Sets how much GPU memory the cache may keep resident.
+
+	Evicts unused assets right away if the cache is already over the new
+	budget. Assets that are still referenced are never evicted, so the
+	resident size can exceed the budget when they alone do.
+
+	@param pCache Asset cache
+	@param budgetBytes Budget in bytes, ASSET_CACHE_DEFAULT_GPU_BUDGET by default
+
+	@note A budget of 0 frees every asset as soon as its last reference goes
+
+	@see purgeAssetCache
+*/
+void setAssetCacheBudget(AssetCache* pCache, uint64_t budgetBytes);
+
+/**
+	Evicts every unused asset.
+
+	Call on level transitions to hand the memory back right away.
+
+	@param pCache Asset cache
+
+	@return Number of assets evicted
+*/
+uint32_t purgeAssetCache(AssetCache* pCache);
+
+/**
+	Gets the cache counters.
+
+	@param pCache Asset cache
+	@param pOutStats Receives the counters
+*/
+void getAssetCacheStats(const AssetCache* pCache, AssetCacheStats* pOutStats);
+
 ///////////////////////////////////////////
 // Texture Loading
 
@@ -120,6 +278,8 @@ void shutdownAssetCache(AssetCache* pCache);
 	@return Handle to the loaded texture, or HANDLE_INVALID_ID on failure
 
 	@note Supports DDS
+	@note Blocks until this texture is loaded. Prefer loadTextureAsync or
+	loadTextures when loading many textures.
 
 	Example:
 	@code
@@ -134,6 +294,179 @@ void shutdownAssetCache(AssetCache* pCache);
 */
 TextureHandle loadTexture(AssetCache* pCache, const char* path);
 
+/**
+	Loads a texture from a prehashed file path.
+
+	Same as loadTexture, but the cache probe uses the precomputed hash and
+	does not build any strings. Use with HASHED_KEY for paths that are looked
+	up every frame.
+
+	@param pCache Asset cache
+	@param path Prehashed file path, must be null terminated
+
+	@return Handle to the loaded texture, or HANDLE_INVALID_ID on failure
+
+	Example:
+	@code
+	TextureHandle tex = loadTextureHashed(pCache, HASHED_KEY("Sprite.tex"));
+	@endcode
+
+	@see loadTexture
+	@see HASHED_KEY
+*/
+TextureHandle loadTextureHashed(AssetCache* pCache, HashedKey path);
+
+/**
+	Starts loading a texture without blocking.
+
+	Returns a handle right away. Until the load completes the texture is in
+	TextureState_Pending and its pTexture is the placeholder texture (or the
+	cache's 1x1 white fallback if none is set). Completion is picked up by
+	updateAssetCache().
+
+	@param pCache Asset cache
+	@param path File path to the texture
+
+	@return Handle to the texture, or HANDLE_INVALID_ID on failure
+
+	@note Cached paths return the existing handle, pending or not
+
+	Example:
+	@code
+	TextureHandle tex = loadTextureAsync(pCache, "level1/rock.tex");
+
+	// Each frame
+	updateAssetCache(pCache);
+	if (isTextureReady(pCache, tex)) {
+		// The slot switches to the real texture as each frame's set catches
+		// up in beginAssetCacheFrame, nothing to rebind
+	}
+	@endcode
+
+	@see updateAssetCache
+	@see setPlaceholderTexture
+*/
+TextureHandle loadTextureAsync(AssetCache* pCache, const char* path);
+
+/**
+	Starts loading a texture from a prehashed path without blocking.
+
+	@param pCache Asset cache
+	@param path Prehashed file path, must be null terminated
+
+	@return Handle to the texture, or HANDLE_INVALID_ID on failure
+
+	@see loadTextureAsync
+*/
+TextureHandle loadTextureAsyncHashed(AssetCache* pCache, HashedKey path);
+
+/**
+	Loads a batch of textures.
+
+	Submits every request to the resource loader before waiting on any of
+	them, so file I/O and uploads overlap. Returns once all are loaded.
+
+	@param pCache Asset cache
+	@param ppPaths Array of file paths
+	@param count Number of paths
+	@param pOutHandles Receives one handle per path, HANDLE_INVALID_ID on failure
+
+	Example:
+	@code
+	const char* paths[] = {"Sprite.tex", "CubeTexture.tex"};
+	TextureHandle handles[2];
+	loadTextures(pCache, paths, 2, handles);
+	@endcode
+
+	@see loadTextureAsync
+*/
+void loadTextures(AssetCache* pCache, const char** ppPaths, uint32_t count,
+				  TextureHandle* pOutHandles);
+
+/**
+	Polls pending texture loads.
+
+	Checks the sync token of every pending texture and swaps finished ones
+	from the placeholder to the real texture. Call once per frame.
+
+	@param pCache Asset cache
+
+	@see loadTextureAsync
+*/
+void updateAssetCache(AssetCache* pCache);
+
+/**
+	Checks if a texture has finished loading.
+
+	@param pCache Asset cache
+	@param handle Texture handle
+
+	@return true if the texture is in TextureState_Ready
+
+	@see loadTextureAsync
+*/
+bool isTextureReady(AssetCache* pCache, TextureHandle handle);
+
+/**
+	Sets the texture shown while other textures are streaming in.
+
+	@param pCache Asset cache
+	@param handle Loaded texture to use as placeholder
+
+	@note Only affects textures requested after this call. Unloading the
+	placeholder moves everything still showing it to the current one, or to
+	the fallback texture
+
+	@see loadTextureAsync
+*/
+void setPlaceholderTexture(AssetCache* pCache, TextureHandle handle);
+
+///////////////////////////////////////////
+// Bindless Textures
+
+/**
+	Points the cache at the bindless texture array.
+
+	Every texture the cache holds lives in the descriptor at its handle
+	index, see getTextureSlot. Binding writes all current textures once,
+	pending ones as the placeholder. After that only changes touch the
+	array: a request writes the placeholder, a finished load writes the
+	texture, and an evicted texture gets the placeholder back. Draws select
+	their texture by slot through per instance data, nothing is rebound per
+	material.
+
+	Submitted frames may still read the array, so it is never written in
+	place. The descriptor set holds one set per frame in flight, and
+	beginAssetCacheFrame writes the changes into a frame's set once the GPU
+	is done with it. Draws bind the set of the frame being recorded.
+
+	@param pCache Asset cache
+	@param pDescriptorSet Set holding the array, usually EngineApp's persistent
+						  set, with one set per frame in flight
+	@param descriptorIndex Index of the array, SRT_RES_IDX(SrtData, Persistent, gTextures)
+
+	@note Call again whenever the set is recreated, nullptr stops the updates
+	@note The cache never holds more than ASSET_CACHE_MAX_BINDLESS_TEXTURES
+	textures, so every slot fits the array
+
+	@see getTextureSlot
+*/
+void bindAssetCacheTextures(AssetCache* pCache, DescriptorSet* pDescriptorSet,
+							uint32_t descriptorIndex);
+
+/**
+	Gets the bindless array slot of a texture.
+
+	@param handle Texture handle
+	@return Slot in gTextures, 0 for an invalid handle
+
+	@see bindAssetCacheTextures
+*/
+inline uint32_t getTextureSlot(TextureHandle handle)
+{
+	return handleIsValid(handle.id) ? handleIndex(handle.id) : 0;
+}
+
 /**
 	Gets texture data from a handle.
 
@@ -149,14 +482,20 @@ TextureHandle loadTexture(AssetCache* pCache, const char* path);
 TextureData* getTexture(AssetCache* pCache, TextureHandle handle);
 
 /**
-	Unloads a texture by handle.
+	Releases a reference to a texture.
 
-	Frees the texture resources and invalidates the handle.
+	When the last reference goes, the texture becomes unused and is kept
+	until the budget needs its memory. Unused textures that are still
+	loading finish streaming in. Failed loads are freed right away.
 
 	@param pCache Asset cache
 	@param handle Texture handle to unload
 
+	@note Treat the handle as invalid afterwards, it only resolves until
+	the texture is evicted
+
 	@see loadTexture
+	@see setAssetCacheBudget
 */
 void unloadTexture(AssetCache* pCache, TextureHandle handle);
 
@@ -166,18 +505,38 @@ void unloadTexture(AssetCache* pCache, TextureHandle handle);
 /**
 	Loads a mesh from a file path.
 
-	Loads the mesh if not already cached, or returns the cached handle.
+	Loads the mesh if not already cached, or returns the cached handle. The
+	file must be a cooked .mesh file (see MeshFileHeader), produced offline
+	from glTF by tools/MeshCooker. The file is memory mapped and its vertex
+	and index blocks are uploaded directly, without a heap copy.
 
 	@param pCache Asset cache
-	@param path File path to the mesh (e.g., "assets/cube.obj")
+	@param path Path to the mesh, relative to RD_MESHES (e.g., "cube.mesh")
 
 	@return Handle to the loaded mesh, or HANDLE_INVALID_ID on failure
 
+	@note Blocks until the upload is complete
+
 	@see getMesh
 	@see unloadMesh
 */
 MeshHandle loadMesh(AssetCache* pCache, const char* path);
 
+/**
+	Loads a mesh from a prehashed file path.
+
+	Same as loadMesh, but the cache probe uses the precomputed hash.
+
+	@param pCache Asset cache
+	@param path Prehashed file path, must be null terminated
+
+	@return Handle to the loaded mesh, or HANDLE_INVALID_ID on failure
+
+	@see loadMesh
+	@see HASHED_KEY
+*/
+MeshHandle loadMeshHashed(AssetCache* pCache, HashedKey path);
+
 /**
 	Gets mesh data from a handle.
 
@@ -193,16 +552,20 @@ MeshHandle loadMesh(AssetCache* pCache, const char* path);
 MeshData* getMesh(AssetCache* pCache, MeshHandle handle);
 
 /**
-	Unloads a mesh by handle.
+	Releases a reference to a mesh.
 
-	Frees the mesh resources and invalidates the handle.
+	When the last reference goes, a mesh loaded from a file becomes unused
+	and is kept until the budget needs its memory. Procedural meshes have
+	no path to be found again by and are freed right away.
 
 	@param pCache Asset cache
 	@param handle Mesh handle to unload
 
-	@note Handle becomes invalid after this call
+	@note Treat the handle as invalid afterwards, it only resolves until
+	the mesh is evicted
 
 	@see loadMesh
+	@see setAssetCacheBudget
 */
 void unloadMesh(AssetCache* pCache, MeshHandle handle);
 
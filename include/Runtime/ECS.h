@@ -9,15 +9,21 @@
 #include "Game/ThirdParty/OpenSource/flecs/flecs.h"
 #include "Graphics/Interfaces/IGraphics.h"
 #include "Utilities/Math/MathTypes.h"
+#include "Utilities/Threading/Atomics.h"
+#include "Core/FrustumCull.h"
 
 struct MeshComponent;
 struct TransformComponent;
+struct WorldMatrixComponent;
 struct MaterialComponent;
 struct RenderableTag;
 struct RenderContext;
+struct Arena;
+struct JobSystem;
 
 extern ECS_COMPONENT_DECLARE(MeshComponent);
 extern ECS_COMPONENT_DECLARE(TransformComponent);
+extern ECS_COMPONENT_DECLARE(WorldMatrixComponent);
 extern ECS_COMPONENT_DECLARE(MaterialComponent);
 extern ECS_COMPONENT_DECLARE(RenderableTag);
 extern ECS_COMPONENT_DECLARE(RenderContext);
@@ -28,7 +34,6 @@ extern ECS_COMPONENT_DECLARE(RenderContext);
 	Stores GPU mesh data for renderable entities.
 
 	Contains mesh metadata required to render.
-	The descriptorSetIndex maps to a per object uniform buffer slot.
 
 	@see
 */
@@ -38,8 +43,10 @@ struct MeshComponent
 	Buffer* pIndexBuffer;
 	uint32_t vertexCount;
 	uint32_t indexCount;
+	uint32_t indexSize;
 	uint32_t vertexStride;
-	uint32_t descriptorSetIndex;
+	float boundsCenter[3]; ///< Object space bounding sphere center
+	float boundsRadius;	   ///< Object space bounding sphere radius, negative when unknown
 };
 
 /**
@@ -47,17 +54,37 @@ struct MeshComponent
 
 	Defines transformation data for entities.
 
-	This component stores both transformation, usually for some entity.
+	This component stores the local position, rotation, and scale. The
+	composed matrix lives in WorldMatrixComponent, so flecs keeps the
+	inputs and the output in separate columns and neither loop drags the
+	other's bytes through the cache.
 
-	@see
+	The transform is relative to the parent when the entity has a
+	(ChildOf, parent) pair and the parent is a transform node itself.
+
+	@see WorldMatrixComponent
 */
 struct TransformComponent
 {
-	mat4 worldMatrix;
 	vec3 position;
-	vec3 rotation;
+	vec3 rotation; ///< Euler angles in radians, applied Z * Y * X
 	vec3 scale;
-	bool dirty;
+	bool dirty; ///< Set when the inputs change, TransformSystem clears it
+	uint32_t worldChangedFrame; ///< Frame stamp of the last world matrix update, read by children
+};
+
+/**
+	@struct WorldMatrixComponent
+
+	World matrix composed by TransformSystem from TransformComponent, or
+	by HierarchySystem as parent world * local for child entities.
+
+	@see TransformSystem
+	@see HierarchySystem
+*/
+struct WorldMatrixComponent
+{
+	mat4 worldMatrix;
 };
 
 /**
@@ -66,13 +93,17 @@ struct TransformComponent
 	Specifies which graphics pipeline to use when rendering an entity.
 
 	Defined the pipeline to use for rendering the entity per MaterialComponent.
-	Good for reusing the same pipeline across multiple entities.
+	Good for reusing the same pipeline across multiple entities. The texture
+	is a slot in the bindless texture array, so entities with different
+	textures still share pipelines and instanced batches.
 
-	@see
+	@see getTextureSlot
 */
 struct MaterialComponent
 {
 	Pipeline* pPipeline;
+	Pipeline* pInstancedPipeline; ///< Optional, draws the entity in an instanced batch
+	uint32_t textureSlot;		  ///< Bindless texture slot, see getTextureSlot
 };
 
 /**
@@ -80,13 +111,15 @@ struct MaterialComponent
 
 	Controls whether an entity is included in rendering.
 
-	This tag component marks entities as renderable. Just a simple flecs tag.
+	This tag component marks entities as renderable. Only entities that are
+	both visible and inFrustum reach the render data array.
 
-	@see
+	@see CullingSystem
 */
 struct RenderableTag
 {
-	bool visible;
+	bool visible;	///< Set by game code, hidden entities are never drawn
+	bool inFrustum; ///< Written by CullingSystem every frame
 };
 
 /**
@@ -110,9 +143,70 @@ struct MeshRenderData
 	Buffer* pIndexBuffer;
 	uint32_t vertexCount;
 	uint32_t indexCount;
+	uint32_t indexSize;
 	uint32_t vertexStride;
-	uint32_t descriptorSetIndex;
+	uint32_t descriptorSetIndex; ///< Per object data slot for this frame, assigned in fill order
 	Pipeline* pPipeline;
+	Pipeline* pInstancedPipeline;
+	uint32_t textureSlot; ///< Bindless texture slot, MaterialComponent::textureSlot
+	uint64_t sortKey;	  ///< Draw order key, see computeRenderSortKey
+};
+
+/**
+	@struct InstanceData
+
+	One entry of the per frame instance buffer.
+
+	Read by the instanced pipelines as a per instance vertex stream, the
+	model matrix as four columns followed by the bindless texture slot.
+*/
+struct InstanceData
+{
+	mat4 modelMatrix;
+	uint32_t textureSlot;
+	uint32_t padding[3]; ///< Keeps the stride a multiple of 16 bytes
+};
+
+/**
+	@struct InstanceBatch
+
+	A group of render data entries drawn with one instanced draw call.
+
+	Entries that share an instanced pipeline, vertex buffer and index buffer
+	are merged into a batch. Their model matrices are laid out contiguously
+	in the per frame instance buffer starting at firstInstance.
+
+	@see buildInstanceBatches
+*/
+struct InstanceBatch
+{
+	Pipeline* pPipeline;
+	Buffer* pVertexBuffer;
+	Buffer* pIndexBuffer;
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	uint32_t indexSize;
+	uint32_t vertexStride;
+	uint32_t firstInstance; ///< Index of the first entry in the sorted render data
+	uint32_t instanceCount; ///< Number of entries in the batch
+};
+
+/**
+	@struct SystemTimeSpan
+
+	Wall clock time one system took in the current frame.
+
+	Multi threaded systems are called once per table on several threads.
+	Every call widens [startNs, endNs] with an atomic min and max, so the
+	span runs from the first call starting to the last one returning, the
+	time the system adds to the frame. Times come from ecs_os_now().
+
+	@see getSystemTimeSpanMs
+*/
+struct SystemTimeSpan
+{
+	tfrg_atomic64_t startNs; ///< 0 until the system first ran this frame
+	tfrg_atomic64_t endNs;
 };
 
 /**
@@ -125,7 +219,14 @@ struct MeshRenderData
 	update and draw	phases. The pRenderDataArray is populated by FillRenderDataSystem
 	and consumed by EngineApp::Draw().
 
-	@warning renderDataCount is reset to 0 each frame by FillRenderDataSystem
+	@warning renderDataCount is reset to 0 each frame by EngineApp::Update()
+	@note pRenderDataArray is a tf_malloc allocation grown by reserveRenderData
+	before ecs_progress(), do not cache the pointer across ecs_progress()
+	@note FillRenderDataSystem runs multi threaded and claims slots with an
+	atomic add on renderDataCount, so the count can exceed maxRenderData when
+	the reservation was too small. Clamp it before reading the array.
+	@note EngineApp points pRenderDataArray at the simulation half of its double
+	buffered render data before every ecs_progress(), never at the half being drawn
 
 	@see
 */
@@ -136,33 +237,101 @@ struct RenderContext
 	uint32_t frameIndex;
 
 	MeshRenderData* pRenderDataArray;
-	uint32_t renderDataCount;
+	tfrg_atomic32_t renderDataCount; ///< Slots claimed this frame, see the note above
 	uint32_t maxRenderData;
+
+	Frustum cullFrustum; ///< World space camera frustum used by CullingSystem
+	bool cullingEnabled; ///< False keeps every entity, for example before a camera exists
+	tfrg_atomic32_t culledCount; ///< Entities rejected by CullingSystem this frame
+
+	Arena* pFrameArena; ///< Transient arena of this frame, see EngineApp::getFrameArena
+
+	SystemTimeSpan transformTime;	   ///< TransformSystem this frame
+	SystemTimeSpan fillRenderDataTime; ///< FillRenderDataSystem this frame
 };
 
 /**
 	Transform system that updates world matrices from local transform data.
 
-	This system runs during the EcsOnUpdate phase and processes all entities
-	with TransformComponent. When the dirty flag is true, it rebuilds the
-	matrices.
+	This system runs during the EcsOnUpdate phase and processes all root
+	entities with TransformComponent and WorldMatrixComponent, that is every
+	entity without a transform parent. When the dirty flag is true, it
+	rebuilds the matrices.
+
+	Entities are handled in chunks of 64. The dirty flags of a chunk are
+	packed into a bitmask without branching, clean chunks are skipped, and
+	the dirty entities are gathered into structure of arrays form and
+	composed four at a time by composeTRSMatrices.
 
-	@param it Flecs iterator containing entities with TransformComponent
+	@param it Flecs iterator containing entities with Transform and WorldMatrix components
+
+	@note Multi threaded, every entity only touches its own component
 
 	@see
 */
 void TransformSystem(ecs_iter_t* it);
 
+/**
+	Hierarchy system that propagates world matrices down ChildOf relationships.
+
+	Runs after TransformSystem in the EcsOnUpdate phase and processes every
+	entity whose ChildOf parent has a WorldMatrixComponent. The query uses
+	flecs cascade, so tables are visited breadth first by depth and a parent
+	is always up to date before its children are read.
+
+	All entities in a table share one parent. If the parent's world matrix
+	changed this frame (worldChangedFrame) the whole table is recomposed,
+	otherwise only the dirty entities are, using the same 64 entity chunks as
+	TransformSystem. Subtrees that did not move are skipped without touching
+	their matrices.
+
+	@param it Flecs iterator with the child Transform and WorldMatrix
+	components and the parent's WorldMatrix and Transform
+
+	@note Single threaded, the cascade order must hold across tables
+
+	@see TransformSystem
+*/
+void HierarchySystem(ecs_iter_t* it);
+
+/**
+	Visibility culling system that runs between the transform systems and
+	FillRenderDataSystem.
+
+	Runs in the EcsOnValidate phase. Each entity's object space bounding
+	sphere (MeshComponent::boundsCenter/boundsRadius) is moved to world space
+	with its world matrix, using the largest axis scale for the radius, and
+	then tested four at a time against RenderContext::cullFrustum by
+	cullSpheres. The result is written to RenderableTag::inFrustum and the
+	rejected entities, including hidden ones, are added to
+	RenderContext::culledCount.
+
+	Entities without bounds, and every entity while cullingEnabled is false,
+	are kept.
+
+	@param it Flecs iterator with WorldMatrix, Mesh and Renderable components
+
+	@note Multi threaded, every entity only writes its own tag and the count
+	is one atomic add per table
+
+	@see cullSpheres
+*/
+void CullingSystem(ecs_iter_t* it);
+
 /**
 	Render data collection system that prepares CPU-side render information.
 
-	This system processes all entities with both TransformComponent and
-	MeshComponent. It copies data from components into the RenderContext's
+	This system processes all entities with WorldMatrixComponent,
+	MeshComponent, MaterialComponent and RenderableTag. Entities that are
+	visible and survived CullingSystem are copied into the RenderContext's
 	pRenderDataArray, which is later consumed by EngineApp::Draw().
 
 	@param it Flecs iterator containing entities with Transform and Mesh components
 
-	@warning Temporary limit of 1000 entities
+	@note Multi threaded. Each table range claims its slots with one atomic
+	add, the array must be reserved up front with reserveRenderData
+
+	@see reserveRenderData
 
 	@see
 */
@@ -183,11 +352,17 @@ struct MeshEntityDesc
 	Buffer* pIndexBuffer;
 	uint32_t vertexCount;
 	uint32_t indexCount;
+	uint32_t indexSize;
 	uint32_t vertexStride;
 	Pipeline* pPipeline;
+	Pipeline* pInstancedPipeline; ///< Optional instanced variant of pPipeline
+	uint32_t textureSlot;		  ///< Bindless texture slot, getTextureSlot(handle)
 	vec3 position;
 	vec3 rotation;
 	vec3 scale;
+	ecs_entity_t parent; ///< Optional transform parent, 0 for a root entity
+	float boundsMin[3];	 ///< Object space AABB (MeshData::boundsMin), all zero disables culling
+	float boundsMax[3];	 ///< Object space AABB (MeshData::boundsMax)
 };
 
 /**
@@ -208,18 +383,121 @@ struct TransformDesc
 	vec3 scale;
 };
 
+/**
+	Builds the 64-bit draw order key for a render data entry.
+
+	Sorting render data by this key groups draws by the state they bind, so
+	redundant state changes can be skipped while recording. Most significant
+	bits first:
+
+	@code
+	[63]    1 when the entry has no instanced pipeline (instanced entries first)
+	[62:48] pipeline hash (the instanced pipeline when set)
+	[47:32] vertex buffer and index buffer hash
+	[31:16] depth, world space translation z, near to far
+	[15:0]  per object descriptor slot
+	@endcode
+
+	The per object descriptor is unique per entity, so it only breaks ties.
+	Hashes can collide, consumers still compare the real pointers.
+
+	@param pData Render data entry with its pipelines, buffers and model matrix filled
+	@return Sort key, lower keys are drawn first
+
+	@see buildInstanceBatches
+*/
+RUNTIME_API uint64_t computeRenderSortKey(const MeshRenderData* pData);
+
+/**
+	Groups sorted render data into instanced batches.
+
+	Expects pRenderData sorted by MeshRenderData::sortKey, which places the
+	entries with an instanced pipeline first, grouped by (pipeline, vertex
+	buffer, index buffer). Each run of matching entries becomes one
+	InstanceBatch. Entries without an instanced pipeline follow the
+	instanced range and are drawn individually.
+
+	@param pRenderData Render data array sorted by sortKey
+	@param count Number of entries in pRenderData
+	@param pBatches Receives the batches, must hold at least count entries
+	@param pInstancedCount Receives the number of instanced entries
+
+	@return Number of batches written to pBatches
+
+	@see InstanceBatch
+*/
+RUNTIME_API uint32_t buildInstanceBatches(MeshRenderData* pRenderData, uint32_t count,
+										  InstanceBatch* pBatches, uint32_t* pInstancedCount);
+
+/**
+	Makes room in the render data array before FillRenderDataSystem runs.
+
+	FillRenderDataSystem may run on several threads and cannot grow the
+	array, so the engine reserves space for every mesh entity before
+	ecs_progress(). Grows by doubling with tf_realloc.
+
+	@param pCtx Render context whose pRenderDataArray is grown
+	@param count Number of entries the array must hold
+
+	@return True if the array holds at least count entries
+
+	@see FillRenderDataSystem
+*/
+RUNTIME_API bool reserveRenderData(RenderContext* pCtx, uint32_t count);
+
+/**
+	Clears a system time span before the next ecs_progress().
+
+	@param pSpan Span to clear
+
+	@see SystemTimeSpan
+*/
+RUNTIME_API void resetSystemTimeSpan(SystemTimeSpan* pSpan);
+
+/**
+	Gets the length of a system time span.
+
+	@param pSpan Span filled by the last ecs_progress()
+
+	@return Milliseconds, 0 if the system did not run
+*/
+RUNTIME_API float getSystemTimeSpanMs(const SystemTimeSpan* pSpan);
+
 /**
 	Initializes the ECS world with rendering components and systems.
 
 	Registers all ECS components and systems with the Flecs world. It also
 	creates the singleton RenderContext and allocates the render data array.
+	The built in systems are multi threaded, they use the task threads set
+	with ecs_set_task_threads().
 
 	@param world Pointer to the Flecs ECS world to initialize
 
-	@see
+	@see initECSJobHooks
 */
 RUNTIME_API void initECS(ecs_world_t* world);
 
+/**
+	Routes flecs task threads onto a job system.
+
+	Installs the ecs_os_api task hooks, so the per frame workers flecs starts
+	after ecs_set_task_threads() run as JobFlag_Blocking jobs on the job
+	system's workers instead of on threads of their own. The rest of the OS
+	API, including the allocator set by initEntityComponentSystem(), is kept.
+
+	@param pJobSystem Job system to run the flecs tasks on, nullptr restores
+	the default hooks
+
+	@note Call after initEntityComponentSystem() and before ecs_init(), and
+	keep the task thread count at or below jobSystemGetWorkerCount(), the
+	tasks wait on each other at sync points
+	@note The hooks are written into ecs_os_api directly, ecs_os_set_api()
+	does nothing once the OS API is set
+
+	@see initECS
+*/
+RUNTIME_API void initECSJobHooks(JobSystem* pJobSystem);
+
 /**
 	Creates a mesh entity with all required rendering components.
 
@@ -237,6 +515,39 @@ RUNTIME_API void initECS(ecs_world_t* world);
 */
 RUNTIME_API ecs_entity_t createMeshEntity(ecs_world_t* world, const MeshEntityDesc* pDesc);
 
+/**
+	Creates a transform only entity, useful as a pivot for child entities.
+
+	@param world Pointer to the Flecs ECS world
+	@param pDesc Local transform of the entity
+	@param parent Optional transform parent, 0 for a root entity
+
+	@return Entity ID of the created entity
+
+	@note Game code should use EngineApp::createTransformEntity() instead
+
+	@see setParent
+*/
+RUNTIME_API ecs_entity_t createTransformEntity(ecs_world_t* world, const TransformDesc* pDesc,
+											   ecs_entity_t parent);
+
+/**
+	Attaches an entity to a transform parent, or detaches it.
+
+	Adds a (ChildOf, parent) pair, so the entity's transform becomes relative
+	to the parent and deleting the parent deletes the child. The child is
+	marked dirty so its world matrix is rebuilt on the next update.
+
+	@param world Pointer to the Flecs ECS world
+	@param child Entity to attach
+	@param parent New parent with a TransformComponent, 0 to make child a root
+
+	@note Game code should use EngineApp::setParent() instead
+
+	@see HierarchySystem
+*/
+RUNTIME_API void setParent(ecs_world_t* world, ecs_entity_t child, ecs_entity_t parent);
+
 /**
 	Updates an entity's transform component with new position, rotation, and scale.
 
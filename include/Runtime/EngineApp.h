@@ -14,6 +14,60 @@
 #include "Game/ThirdParty/OpenSource/flecs/flecs.h"
 #include "Runtime/ECS.h"
 
+struct RenderBindState;
+struct RenderWorkerPool;
+struct RenderRecordJob;
+struct RenderFrameThread;
+struct FrameArena;
+struct JobSystem;
+struct PipelineRegistry;
+
+/**
+	@struct RenderStats
+
+	Per frame counters for the ECS render pass.
+
+	Filled by EngineApp::Draw() while recording and shown in the profiler
+	overlay. A bind counts as skipped when the state it would set is already
+	bound, which is what sorting the render data by sortKey is for.
+
+	@see computeRenderSortKey
+*/
+struct RenderStats
+{
+	uint32_t drawCalls;			///< Draw calls recorded, one per instanced batch or entity
+	uint32_t instancedBatches;	///< Draw calls that were instanced batches
+	uint32_t pipelineBinds;		///< cmdBindPipeline calls
+	uint32_t descriptorBinds;	///< cmdBindDescriptorSet calls
+	uint32_t vertexBufferBinds; ///< cmdBindVertexBuffer calls
+	uint32_t indexBufferBinds;	///< cmdBindIndexBuffer calls
+	uint32_t bindsSkipped;		///< Binds avoided because the state was already bound
+	uint32_t visibleEntities;	///< Entities that reached the render data array
+	uint32_t culledEntities;	///< Entities rejected by CullingSystem or hidden
+};
+
+/**
+	@struct FrameTimings
+
+	CPU time of the per frame phases, in milliseconds.
+
+	Update() fills the simulation phases and the Draw() that records the
+	frame fills the render phases. With pipelined rendering the render
+	phases belong to the frame before and are read safely once the base
+	Update() has returned, the render thread is idle until the next Draw().
+
+	@see getFrameTimings
+*/
+struct FrameTimings
+{
+	float ecsProgressMs;	///< ecs_progress(), every system of the frame
+	float transformMs;		///< TransformSystem, first table started to last one done
+	float fillRenderDataMs; ///< FillRenderDataSystem, same as transformMs
+	float acquireMs;		///< Swapchain acquire and the wait on the frame's fence
+	float recordMs;			///< Sorting, batching and command recording, UI included
+	float submitMs;			///< Resource update flush, queue submit and present
+};
+
 /**
 	@class EngineApp
 
@@ -96,6 +150,11 @@ public:
 		Processes input, updates game state, and advances ECS systems by calling
 		ecs_progress(). Game specific updating logic should go here as well.
 
+		FillRenderDataSystem writes into the simulation side of the double
+		buffered render data. After ecs_progress() the filled buffer is handed
+		to the renderer (see publishRenderData), so pRenderDataArray and
+		getRenderDataCount() describe this frame once the base Update returns.
+
 		@param deltaTime Time elapsed since last frame in seconds
 
 		@note Called by The Forge every frame before Draw()
@@ -107,7 +166,11 @@ public:
 	/**
 		Renders the current frame to the screen.
 
-		All visuals are to be made in this virtual method.
+		All visuals are to be made in this virtual method. With pipelined
+		rendering enabled this only hands the frame to the render thread, so
+		the next Update() simulates while this frame is recorded and submitted.
+
+		@see setPipelinedRendering
 
 		@see
 	*/
@@ -122,6 +185,158 @@ public:
 	*/
 	virtual const char* GetName() override { return "EngineApp"; }
 
+	/**
+		Sets how many threads record the ECS render pass.
+
+		With more than one thread, Draw() splits the sorted draws into chunks
+		and records each chunk into its own command list as a job on the
+		engine job system. Every chunk has its own command pool per frame, and
+		all lists are submitted together in one queueSubmit. The drawing
+		thread records the first chunk itself and helps with the others while
+		it waits, so a count of 4 runs 3 jobs.
+
+		@param count Number of recording jobs, clamped to [1, MAX_RENDER_THREADS]
+
+		@note Must be called before Init(), usually from the derived constructor
+		@note Small scenes are recorded on the main thread regardless
+
+		@see MAX_RENDER_THREADS
+	*/
+	void setRenderThreadCount(uint32_t count);
+
+	static const uint32_t MAX_RENDER_THREADS = 8; ///< Upper bound for setRenderThreadCount
+
+	/**
+		Sets how many threads flecs uses to run multi threaded systems.
+
+		Calls ecs_set_task_threads() on the world, the tasks run on the
+		engine job system through initECSJobHooks(). TransformSystem and
+		FillRenderDataSystem are multi threaded, so transform updates and
+		render extraction split their entities across the threads. A count of
+		1 runs every system on the calling thread.
+
+		@param count Number of ECS threads, values below 1 are treated as 1
+
+		@note Can be called before Init() or at any time after it
+		@note Clamped to the job system's worker count
+
+		@see initECS
+		@see getJobSystem
+	*/
+	void setEcsThreadCount(uint32_t count);
+
+	/**
+		Moves frame recording and submission onto a dedicated render thread.
+
+		Draw() then returns immediately and the render thread draws the
+		published render data while the game thread runs the next Update().
+		The threads meet once per frame in publishRenderData, right after
+		ecs_progress(), so simulation of frame N+1 overlaps Draw() of frame N.
+
+		@param enabled True to render on a dedicated thread
+
+		@note Must be called before Init(), usually from the derived constructor
+		@warning GPU uploads and reads of pRenderDataArray must happen after the
+				 base Update() returns, when the render thread is idle
+
+		@see waitForRenderThread
+	*/
+	void setPipelinedRendering(bool enabled);
+
+	/**
+		Runs the engine without a window, swapchain or renderer.
+
+		Init() only creates the job system, the frame arenas and the ECS
+		world, so a dedicated server or a tool simulates the same world a
+		client would. Update() still runs every system and fills the render
+		data, which nothing draws. Load(), Unload() and Draw() do nothing.
+
+		@param enabled True to skip every graphics subsystem
+
+		@note Must be called before Init(), usually from the derived constructor
+		@warning pRenderer stays nullptr, so createMeshBuffer, the AssetCache
+				 and anything else that creates GPU resources is unavailable
+		@note Implies a disabled overlay and no pipelined rendering
+
+		@see setOverlayEnabled
+		@see engineInit
+	*/
+	void setHeadless(bool enabled);
+
+	/**
+		Returns whether the engine runs without a renderer.
+
+		@see setHeadless
+	*/
+	bool isHeadless() const { return headless; }
+
+	/**
+		Sets whether the font system, the UI and the CPU and GPU profilers run.
+
+		They make up most of the startup time after the renderer, and an
+		app that draws no overlay has no use for them. With the overlay off
+		the profiler, render stats and memory text are not drawn.
+
+		@param enabled False to skip the overlay subsystems, true by default
+
+		@note Must be called before Init(), usually from the derived constructor
+		@warning Games that add UI components need the overlay enabled
+
+		@see setHeadless
+	*/
+	void setOverlayEnabled(bool enabled);
+
+	/**
+		Blocks until the render thread has finished the frame it is drawing.
+
+		Does nothing when pipelined rendering is disabled. Call it before
+		touching resources the renderer may be using outside the usual
+		Update() handoff.
+
+		@see setPipelinedRendering
+	*/
+	void waitForRenderThread();
+
+	/**
+		Writes the CPU trace of the last frames at the start of the next Update().
+
+		The trace rings always hold the most recent ENGINE_PROFILE_SCOPE events
+		of every thread, so a dump taken right after a hitch shows what stalled.
+		The file is "<GetName()>_trace_<n>.json" in the working directory, in
+		Chrome trace format.
+
+		@note Safe to call from any thread, for example from a key handler or a
+			  debug UI button
+
+		@see traceWriteChromeJson
+	*/
+	void requestTraceDump();
+
+	/**
+		Gets the job system shared by the ECS, physics and the render pass.
+
+		Created at the start of Init() with one worker per core minus the
+		main thread, and destroyed at the end of Exit().
+
+		@return The engine job system, nullptr outside Init() and Exit()
+
+		@see jobRun
+	*/
+	JobSystem* getJobSystem() const { return pJobSystem; }
+
+	/**
+		Gets the registry the engine pipelines are created through.
+
+		Games that create their own pipelines should go through it too, so
+		they share the on disk pipeline cache and survive render target
+		reloads without being rebuilt.
+
+		@return The pipeline registry, nullptr outside Init() and Exit()
+
+		@see acquirePipeline
+	*/
+	PipelineRegistry* getPipelineRegistry() const { return pPipelineRegistry; }
+
 protected:
 	Renderer* pRenderer;
 	Queue* pGraphicsQueue;
@@ -131,16 +346,43 @@ protected:
 	RenderTarget* pDepthBuffer;
 	Semaphore* pImageAcquiredSemaphore;
 
+	// Every pipeline samples the bindless texture array, the cube pipelines
+	// only differ in blend and depth state
 	Shader* pShader;
 	Pipeline* pPipeline;
-	Shader* pCubeShader;
 	Pipeline* pCubePipeline;
 
+	Shader* pInstancedShader;
+	Pipeline* pInstancedPipeline;
+	Pipeline* pInstancedCubePipeline;
+
 	ecs_world_t* pWorld;
 	ecs_query_t* pRenderQuery;
 
-	MeshRenderData* pRenderDataArray;
-	uint32_t maxRenderDataCount;
+	MeshRenderData* pRenderDataArray; ///< Published render data, read by Draw()
+	uint32_t maxRenderDataCount;	  ///< Capacity of pRenderDataArray
+
+	InstanceBatch* pInstanceBatches;
+	uint32_t instanceBatchCount;
+
+	// Scratch for sorting the render data, gpuRenderCapacity entries each
+	uint64_t* pSortKeys;
+	uint64_t* pSortTempKeys;
+	uint32_t* pSortIndices;
+	uint32_t* pSortTempIndices;
+	MeshRenderData* pSortedRenderData;
+
+	RenderStats gRenderStats;
+	FrameTimings gFrameTimings;
+
+	static const uint32_t MIN_ITEMS_PER_RENDER_JOB = 64; ///< Smaller chunks record on one thread
+	static const uint32_t MAX_MEMORY_OVERLAY_TAGS = 8;	///< Arena tags listed in the overlay
+
+	uint32_t renderThreadCount;
+	RenderWorkerPool* pRenderWorkers;
+
+	JobSystem* pJobSystem;
+	PipelineRegistry* pPipelineRegistry;
 
 	ProfileToken gGpuProfileToken;
 	FontDrawDesc gFrameTimeDraw;
@@ -150,15 +392,48 @@ protected:
 
 	static const uint32_t gDataBufferCount = 2;
 
+	// Signaled by the last submit of each frame index, nullptr before the first.
+	// Written by drawFrame(), only read between the base Update() and Draw()
+	Fence* pFrameFences[gDataBufferCount];
+
+	// Render data is double buffered, FillRenderDataSystem fills one buffer
+	// while Draw() reads the other
+	MeshRenderData* pRenderDataBuffers[gDataBufferCount];
+	uint32_t renderDataCapacities[gDataBufferCount];
+	uint32_t renderDataCounts[gDataBufferCount];
+	uint32_t culledCounts[gDataBufferCount]; ///< RenderContext::culledCount per published buffer
+	uint32_t simDataIndex; ///< Buffer FillRenderDataSystem writes during ecs_progress()
+
+	uint32_t ecsThreadCount;
+
+	bool pipelinedRendering;
+	RenderFrameThread* pRenderThread;
+
+	bool headless;		 ///< No renderer, see setHeadless
+	bool overlayEnabled; ///< Fonts, UI and profilers are initialized, see setOverlayEnabled
+
+	tfrg_atomic32_t traceDumpRequested; ///< Set by requestTraceDump, handled by the next Update()
+	uint32_t traceDumpCount;			///< Numbers the dump files
+
+	// One arena per render data buffer, recycled once the GPU finished the frame
+	FrameArena* pFrameArena;
+
 	DescriptorSet* pDescriptorSetPersistent;
 
 	Buffer* pUniformBufferPerFrame[gDataBufferCount];
 	DescriptorSet* pDescriptorSetPerFrame;
 
-	static const uint32_t MAX_OBJECTS = 100;
-	Buffer* pUniformBufferPerObject[gDataBufferCount][MAX_OBJECTS];
+	Buffer* pInstanceBuffer[gDataBufferCount];
+
+	// Command lists for the parallel render pass, [frame][recording thread]
+	CmdPool* pRecordCmdPools[gDataBufferCount][MAX_RENDER_THREADS];
+	Cmd* pRecordCmds[gDataBufferCount][MAX_RENDER_THREADS];
+
+	static const uint32_t PER_OBJECT_DATA_STRIDE = 256; ///< Constant buffer offset alignment
+	Buffer* pPerObjectBuffer[gDataBufferCount];
 	DescriptorSet* pDescriptorSetPerObject;
-	uint32_t nextObjectBufferIndex;
+
+	uint32_t gpuRenderCapacity; ///< Entries per frame in the instance and per object buffers
 
 	/**
 		Uploads per frame uniform data to the GPU.
@@ -177,11 +452,14 @@ protected:
 	/**
 		Uploads per object uniform data to the GPU.
 
-		Copies data to a specific object's uniform buffer for the current frame.
+		Copies data into the object's slot of the current frame's per object
+		ring buffer. The buffer is persistently mapped, so this is a plain
+		memcpy with no map/unmap per object. Slots are handed out linearly
+		each frame by FillRenderDataSystem (MeshRenderData::descriptorSetIndex).
 
-		@param objectIndex Index of the object buffer slot
+		@param objectIndex Per object slot for this frame
 		@param pData Pointer to data to upload
-		@param size Size of data in bytes
+		@param size Size of data in bytes, at most PER_OBJECT_DATA_STRIDE
 
 		@see
 	*/
@@ -237,22 +515,23 @@ protected:
 	/**
 		Creates the graphics pipeline with loaded shaders.
 
-		Configures and creates the graphics pipeline state.
-		This is called internally by Load().
-
+		Configures the graphics pipeline state and acquires the pipelines
+		from the pipeline registry, which only builds the ones whose state
+		is new. This is called internally by Load().
 
-		@see
+		@see acquirePipeline
 	*/
 	void createPipeline();
 
 	/**
-		Destroys the graphics pipeline.
+		Releases the graphics pipelines.
 
-		Releases the pipeline object and GPU resources.
+		Drops the references to the registry pipelines. They stay alive
+		until Load() finds they are no longer needed, or the shaders go.
 
 		@note Called internally by Unload()
 
-		@see
+		@see flushUnusedPipelines
 	*/
 	void destroyPipeline();
 
@@ -276,9 +555,9 @@ protected:
 		Creates a mesh entity with all required rendering components.
 
 		Creates a new ECS entity with MeshComponent, TransformComponent,
-		MaterialComponent, and RenderableTag. This is the primary way to add
-		renderable objects to the scene. The function automatically allocates
-		a descriptor set slot for the entity.
+		WorldMatrixComponent, MaterialComponent, and RenderableTag. This is the primary way to add
+		renderable objects to the scene. Per object data slots are assigned
+		each frame, so there is no limit on the number of entities.
 
 		Example:
 
@@ -288,6 +567,7 @@ protected:
 		desc.vertexCount = 6;
 		desc.vertexStride = sizeof(Vertex);
 		desc.pPipeline = pPipeline;
+		desc.pInstancedPipeline = pInstancedPipeline; // Optional, batches draws
 		desc.position = vec3(0.0f, 0.0f, 0.0f);
 		desc.rotation = vec3(0.0f, 0.0f, 0.0f);
 		desc.scale = vec3(1.0f, 1.0f, 1.0f);
@@ -316,11 +596,61 @@ protected:
 	*/
 	void updateTransform(ecs_entity_t entity, const TransformDesc* pDesc);
 
+	/**
+		Creates an entity with only a transform, to group or pivot children.
+
+		@param pDesc Local transform of the entity
+		@param parent Optional transform parent, 0 for a root entity
+
+		@return Entity ID of the created entity
+
+		@see setParent
+	*/
+	ecs_entity_t createTransformEntity(const TransformDesc* pDesc, ecs_entity_t parent = 0);
+
+	/**
+		Attaches an entity to a transform parent.
+
+		The child's transform becomes relative to the parent's world matrix,
+		and HierarchySystem keeps it in sync when the parent moves. Mesh
+		entities can also be parented at creation with MeshEntityDesc::parent.
+
+		Example:
+
+		@code
+		ecs_entity_t pivot = createTransformEntity(&pivotDesc);
+		ecs_entity_t moon = createMeshEntity(&moonDesc);
+		setParent(moon, pivot); // Rotating the pivot now orbits the moon around it
+		@endcode
+
+		@param child Entity to attach
+		@param parent New parent, 0 to detach and make child a root
+
+		@see
+	*/
+	void setParent(ecs_entity_t child, ecs_entity_t parent);
+
+	/**
+		Sets the camera CullingSystem tests entities against.
+
+		Entities whose bounding sphere is outside the frustum are skipped by
+		FillRenderDataSystem, so they cost neither extraction nor draws.
+		Culling stays off until a camera is set. Call it before the base
+		Update() with the view projection the frame will be drawn with.
+
+		@param pViewProjection Column major view projection matrix, nullptr
+		turns culling off and draws every visible entity
+
+		@see CullingSystem
+		@see RenderStats
+	*/
+	void setCullingCamera(const mat4* pViewProjection);
+
 	/**
 		Returns the number of entities prepared for rendering this frame.
 
-		Queries the RenderContext to get the current count of entities in the
-		render data array.
+		Returns the count of the render data published by the last Update(),
+		which is the data pRenderDataArray points at.
 
 		@return Number of entities currently in the render data array
 
@@ -342,7 +672,105 @@ protected:
 	*/
 	ecs_world_t* getWorld() { return pWorld; }
 
+	/**
+		Returns the render pass counters of the last recorded frame.
+
+		@return Draw and bind counts from the last Draw()
+
+		@see RenderStats
+	*/
+	const RenderStats& getRenderStats() const { return gRenderStats; }
+
+	/**
+		Returns the CPU time of each phase of the last frame.
+
+		@return Phase timings from the last Update() and Draw()
+
+		@see FrameTimings
+	*/
+	const FrameTimings& getFrameTimings() const { return gFrameTimings; }
+
+	/**
+		Returns the transient arena of the current frame.
+
+		Memory pushed here lives until the GPU has finished drawing the
+		frame, then the arena is cleared when its slot comes around again.
+		There is nothing to free. The arena is ArenaFlag_Atomic, so ECS
+		systems (through RenderContext::pFrameArena), render extraction and
+		the per object upload code can all push into it concurrently.
+
+		Example:
+
+		@code
+		EngineApp::Update(deltaTime);
+		Object* pObjects = arenaPushArrayNoZero<Object>(getFrameArena(), getRenderDataCount());
+		@endcode
+
+		@return Arena for the frame Update() is building
+
+		@note Switches to the next frame's arena at the start of the base
+		Update(), allocate after calling it for data this frame draws
+
+		@see FrameArena
+	*/
+	Arena* getFrameArena();
+
 private:
+	/**
+		Records and submits one frame.
+
+		The body of Draw(). Runs on the render thread when pipelined rendering
+		is enabled, otherwise directly inside Draw().
+	*/
+	void drawFrame();
+
+	/**
+		Records the profiler, render stats and memory text and the Forge UI.
+
+		Part of drawFrame(), skipped when the overlay is disabled.
+
+		@param cmd Command list recorded last in the frame
+		@param pRenderTarget Swapchain image the overlay is drawn over
+
+		@see setOverlayEnabled
+	*/
+	void drawOverlay(Cmd* cmd, RenderTarget* pRenderTarget);
+
+	/**
+		Hands the render data filled this frame to the renderer.
+
+		The explicit handoff between simulation and rendering. Waits until the
+		render thread is done with the previous frame, then swaps the buffers
+		so Draw() reads the one just filled and the next ecs_progress() fills
+		the other. FillRenderDataSystem never writes a buffer Draw() can read.
+
+		@note Called internally by Update()
+	*/
+	void publishRenderData();
+
+	/**
+		Starts the render thread when pipelined rendering is enabled.
+
+		@return True if the thread started or is not needed
+
+		@note Called internally by Init()
+	*/
+	bool initRenderThread();
+
+	/**
+		Finishes the frame in flight and stops the render thread.
+
+		@note Called internally by Exit()
+	*/
+	void exitRenderThread();
+
+	/**
+		Entry point of the render thread.
+
+		@param pData RenderFrameThread to serve
+	*/
+	static void renderFrameThread(void* pData);
+
 	/**
 		Creates per frame uniform buffers for camera and scene data.
 
@@ -365,54 +793,201 @@ private:
 	void destroyPerFrameUniformBuffer();
 
 	/**
-		Creates perobject uniform buffers for transform data.
+		Creates the per frame instance buffers.
 
-		Each object gets its own buffer for transform matrices and material
-		parameters.
+		Each buffer holds one model matrix per render data slot and is bound
+		as a per instance vertex stream by the instanced pipelines. They are
+		persistently mapped so Draw() writes the matrices directly.
 
-		@param count Number of object buffers to create (up to MAX_OBJECTS)
+		@see drawInstanceBatches
+	*/
+	void createInstanceBuffers();
+
+	/**
+		Destroys the per frame instance buffers.
+
+		@note Called internally by Unload()
 
 		@see
 	*/
-	void createPerObjectBuffers(uint32_t count);
+	void destroyInstanceBuffers();
 
 	/**
-		Creates descriptor sets for per object uniform buffers.
+		Writes the model matrices of the instanced entries.
 
-		Creates descriptor set instances for the specified number of objects and
-		binding each to its corresponding uniform buffer. Watch for the MAX_OBJECTS
+		Copies the matrices into the current frame's instance buffer in sorted
+		order, so each batch reads instances [firstInstance, firstInstance +
+		instanceCount).
 
-		@param count Number of descriptor sets to create
+		@param instancedCount Number of instanced entries at the start of pRenderDataArray
 
-		@note Called internally by Load()
+		@see buildInstanceBatches
+	*/
+	void writeInstanceData(uint32_t instancedCount);
 
-		@see
+	/**
+		Records a range of the frame's draw items.
+
+		Items are the instanced batches followed by the individually drawn
+		entries, in sort order. Any contiguous range can be recorded on its
+		own command list, which is how the parallel render pass splits work.
+
+		@param cmd Command buffer to record into, with the render targets bound
+		@param firstItem First item to record
+		@param itemCount Number of items to record
+		@param instancedCount Number of instanced entries at the start of pRenderDataArray
+		@param pStats Receives the draw and bind counts of the range
+
+		@see RenderStats
+	*/
+	void recordRenderItems(Cmd* cmd, uint32_t firstItem, uint32_t itemCount,
+						   uint32_t instancedCount, RenderStats* pStats);
+
+	/**
+		Records one chunk of the parallel render pass.
+
+		Resets the job's command pool, binds the render targets with load
+		actions so earlier chunks are preserved, and records the job's items.
+
+		@param pJob Chunk to record
+
+		@note Called from the job system workers and the drawing thread
+	*/
+	void recordRenderJob(RenderRecordJob* pJob);
+
+	/**
+		Creates the render job table and the command pools of every job.
+
+		@return True if the jobs and pools are ready
+
+		@note Called internally by Init()
+	*/
+	bool initRenderWorkers();
+
+	/**
+		Frees the render job table and destroys the job command pools.
+
+		@note Called internally by Exit()
+	*/
+	void exitRenderWorkers();
+
+	/**
+		Job entry point of the parallel render pass.
+
+		@param pData RenderRecordJob to record
+	*/
+	static void runRenderRecordJob(void* pData);
+
+	/**
+		Binds the persistent and per frame descriptor sets.
+
+		All pipelines share one root signature, so the render pass binds these
+		once after its first pipeline instead of after every pipeline change.
+
+		@param cmd Command buffer to record into
+		@param pStats Receives the descriptor bind count
+	*/
+	void bindFrameDescriptorSets(Cmd* cmd, RenderStats* pStats);
+
+	/**
+		Sorts this frame's render data by MeshRenderData::sortKey.
+
+		Radix sorts the keys with an index payload, then gathers the entries
+		into key order. Per object slots travel with their entries, so data
+		uploaded by descriptorSetIndex stays valid.
+
+		@param count Number of entries in pRenderDataArray, at most gpuRenderCapacity
+
+		@see computeRenderSortKey
 	*/
-	void createPerObjectDescriptorSets(uint32_t count);
+	void sortRenderData(uint32_t count);
 
 	/**
-		Destroys per-object descriptor sets.
+		Grows the render data sort scratch arrays.
 
-		Releases all per object descriptor sets.
+		@param capacity Number of entries each array must hold
+
+		@return True if the arrays hold capacity entries
+	*/
+	bool allocateSortScratch(uint32_t capacity);
+
+	/**
+		Frees the render data sort scratch arrays.
+	*/
+	void freeSortScratch();
+
+	/**
+		Creates the per object ring buffers and their descriptor set.
+
+		Allocates one large persistently mapped uniform buffer per frame with
+		gpuRenderCapacity slots of PER_OBJECT_DATA_STRIDE bytes. Every slot gets
+		a descriptor pointing at its range of the buffer, so a draw only binds
+		the descriptor at (frame * gpuRenderCapacity + slot).
+
+		@note Called internally by Load() and ensureRenderCapacity()
+
+		@see
+	*/
+	void createPerObjectBuffers();
+
+	/**
+		Destroys the per object ring buffers and descriptor set.
 
 		@note Called internally by Unload()
 
 		@see
 	*/
-	void destroyPerObjectDescriptorSets();
+	void destroyPerObjectBuffers();
 
-public:
 	/**
-		Allocates a descriptor set slot for a new object.
+		Grows the GPU side render buffers to hold at least count entries.
+
+		Doubles the capacity of the instance buffers, the per object ring
+		buffers, the batch array, and the sort scratch. Growing waits for the graphics queue to
+		go idle, so it only happens when the scene outgrows every previous
+		frame.
 
-		Returns the next available descriptor set index for per object uniform
-		buffers.
+		@param count Number of render data entries this frame
 
-		@return Index of the allocated descriptor set
+		@note Called internally by Update()
 
 		@see
 	*/
-	uint32_t allocateObjectBufferSlot();
+	void ensureRenderCapacity(uint32_t count);
 };
 
+///////////////////////////////////////////
+// Headless
+
+/**
+	Starts an app without a window, the way WindowsMain would.
+
+	Sets up The Forge's memory, file system and log, then runs Init() and
+	Load(). The caller then drives the app with Update() and Draw() on its
+	own thread until mSettings.mQuit is set.
+
+	@param pApp App to start, setHeadless(true) already called
+	@param pAppName Name for the memory tracker, file system and log
+
+	@return False on failure, everything started has been torn down again
+
+	@note The caller owns pApp and deletes it after this fails or after
+	exitHeadlessApp
+
+	@see exitHeadlessApp
+*/
+RUNTIME_API bool initHeadlessApp(EngineApp* pApp, const char* pAppName);
+
+/**
+	Stops an app started with initHeadlessApp.
+
+	Unloads and exits the app, then tears down the log, file system and
+	memory in reverse order.
+
+	@param pApp App to stop
+
+	@see initHeadlessApp
+*/
+RUNTIME_API void exitHeadlessApp(EngineApp* pApp);
+
 #endif
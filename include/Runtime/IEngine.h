@@ -0,0 +1,112 @@
+/*
+ * IEngine.h
+ *
+ * Engine API for hosts that own the main loop, such as tools and
+ * dedicated servers. The host calls engineUpdate() and engineDraw() once
+ * per tick and never sees The Forge.
+ */
+
+#ifndef _IENGINE_H_
+#define _IENGINE_H_
+
+#include "Runtime/RuntimeAPI.h"
+#include <stdint.h>
+
+struct ecs_world_t;
+
+enum EngineFlags : uint32_t
+{
+	EngineFlag_None = 0,
+	EngineFlag_Headless = (1 << 0),	 ///< No window, swapchain or renderer, engineDraw does nothing
+	EngineFlag_NoOverlay = (1 << 1), ///< Skips fonts, UI and profilers for a faster startup
+};
+
+/**
+	@struct EngineDesc
+
+	Settings for engineInit().
+*/
+struct EngineDesc
+{
+	const char* pApplicationName; ///< Window title and log name, must outlive the engine
+	int32_t mWidth;				  ///< Window width, 1920 when 0 or less
+	int32_t mHeight;			  ///< Window height, 1080 when 0 or less
+	bool mFullScreen;
+	uint32_t flags;			 ///< EngineFlags
+	uint32_t ecsThreadCount; ///< See EngineApp::setEcsThreadCount, 0 keeps 1
+};
+
+/**
+	Starts the engine.
+
+	Headless engines run entirely on the calling thread. Windowed engines
+	open the window and run The Forge's platform loop on an engine thread
+	of their own, which only advances while the host is inside
+	engineUpdate() or engineDraw(). Either way the call returns once
+	EngineApp::Init() and the first EngineApp::Load() are done.
+
+	@param pDesc Engine settings
+
+	@return True if the engine is running, false if it failed to start or
+			already runs
+
+	@note Only one engine can run at a time
+	@note Windowed engines are only supported on Windows
+
+	@see engineShutdown
+*/
+RUNTIME_API bool engineInit(const EngineDesc* pDesc);
+
+/**
+	Stops the engine and releases everything engineInit() created.
+
+	@note Safe to call when engineInit() failed or never ran
+*/
+RUNTIME_API void engineShutdown();
+
+/**
+	Runs one simulation tick.
+
+	Calls EngineApp::Update(), which runs every ECS system and publishes
+	the render data. Blocks until the tick is done.
+
+	@param deltaTime Seconds since the previous tick, chosen by the host
+
+	@note Two updates in a row skip the draw in between, the host decides
+		  which ticks are drawn
+	@note While the window is minimized The Forge does not tick, the call
+		  then gives up after a short wait and the tick is dropped
+*/
+RUNTIME_API void engineUpdate(float deltaTime);
+
+/**
+	Draws the render data the last engineUpdate() published.
+
+	Does nothing in headless engines. Blocks until the frame is submitted,
+	or handed to the render thread with pipelined rendering. Like
+	engineUpdate(), the frame is dropped while the window is minimized.
+*/
+RUNTIME_API void engineDraw();
+
+/**
+	Returns whether the engine wants to stop.
+
+	@return True once the window was closed, a system requested to quit,
+			or when no engine runs
+*/
+RUNTIME_API bool engineShouldQuit();
+
+/**
+	Gets the world the engine simulates.
+
+	Hosts create and change entities through the free ECS functions, for
+	example createMeshEntity() and updateTransform().
+
+	@return The ECS world, nullptr when no engine runs
+
+	@warning Only use it between engine calls, the engine thread of a
+			 windowed engine owns it during engineUpdate() and engineDraw()
+*/
+RUNTIME_API ecs_world_t* engineGetWorld();
+
+#endif // _IENGINE_H_
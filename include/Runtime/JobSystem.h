@@ -0,0 +1,180 @@
+/*
+ * JobSystem.h
+ *
+ * Work stealing job system shared by every parallel workload in the engine.
+ */
+
+#ifndef _JOB_SYSTEM_H_
+#define _JOB_SYSTEM_H_
+
+#include "Runtime/RuntimeAPI.h"
+#include <stdint.h>
+
+#define JOB_SYSTEM_MAX_WORKERS 63	///< Worker threads, the creating thread takes slot 0
+#define JOB_DEQUE_CAPACITY 4096		///< Jobs per thread deque, overflow goes to the shared queue
+
+struct JobSystem;
+
+/**
+	Job entry point.
+
+	@param pData User data from JobDesc
+*/
+typedef void (*JobFunc)(void* pData);
+
+/**
+	Job flags.
+
+	Blocking jobs, like the flecs workers that wait for the pipeline to sync,
+	are only picked up by idle workers. A thread helping out inside jobWait
+	could otherwise end up stuck behind a job that waits on it.
+*/
+enum JobFlags : uint32_t
+{
+	JobFlag_None = 0,
+	JobFlag_Blocking = (1 << 0), ///< May wait on other threads, never run from inside jobWait
+};
+
+/**
+	A job to run.
+
+	@see jobRun
+*/
+struct JobDesc
+{
+	JobFunc pFunc;
+	void* pData;
+	uint32_t flags; ///< JobFlags
+};
+
+/**
+	Counts unfinished jobs.
+
+	jobRun adds the number of jobs to the counter and every finished job
+	takes one off, so a counter reaching zero means the whole batch is done.
+	Jobs queued with jobRunAfter wait on the counter and are released when
+	it drops to zero.
+
+	Zero initialize before first use, and keep it alive until it reads zero.
+
+	@code
+	JobCounter counter = {};
+	jobRun(pJobSystem, jobs, jobCount, &counter);
+	jobWait(pJobSystem, &counter);
+	@endcode
+*/
+struct JobCounter
+{
+	uint32_t value; ///< Jobs still running or queued
+	uint32_t lock;	///< Guards pWaiters
+	void* pWaiters; ///< Jobs queued with jobRunAfter, internal
+};
+
+/**
+	Job system creation parameters.
+*/
+struct JobSystemDesc
+{
+	uint32_t workerCount; ///< Worker threads (0 = one per core minus the creating thread)
+};
+
+///////////////////////////////////////////
+// Job system
+
+/**
+	Creates a job system and starts its workers.
+
+	The calling thread becomes thread 0, with its own deque, and helps out
+	whenever it waits on a counter. Each worker owns a deque it pushes to
+	and pops from at the bottom, idle workers steal from the top of the
+	others. Threads that are not part of the system can submit and wait,
+	their jobs go to a shared queue.
+
+	@param pDesc Optional creation parameters, nullptr for the defaults
+
+	@return The job system, or nullptr on failure
+
+	@see jobSystemDestroy
+*/
+RUNTIME_API JobSystem* jobSystemCreate(const JobSystemDesc* pDesc = nullptr);
+
+/**
+	Stops the workers and frees the job system.
+
+	@param pJobSystem Job system to destroy, nullptr is ignored
+
+	@note Every counter must have reached zero, queued jobs are dropped
+*/
+RUNTIME_API void jobSystemDestroy(JobSystem* pJobSystem);
+
+/**
+	Gets the number of worker threads, not counting the creating thread.
+
+	@param pJobSystem Job system to query
+
+	@return Worker count, 0 if pJobSystem is nullptr
+*/
+RUNTIME_API uint32_t jobSystemGetWorkerCount(const JobSystem* pJobSystem);
+
+/**
+	Gets the slot of the calling thread.
+
+	@param pJobSystem Job system to query
+
+	@return 0 for the creating thread, 1 to workerCount for workers, and
+	UINT32_MAX for any other thread
+*/
+RUNTIME_API uint32_t jobSystemGetThreadIndex(const JobSystem* pJobSystem);
+
+///////////////////////////////////////////
+// Jobs
+
+/**
+	Queues jobs.
+
+	@param pJobSystem Job system to run on
+	@param pJobs Array of count jobs, copied before the call returns
+	@param count Number of jobs
+	@param pCounter Optional counter, incremented by count up front
+
+	@see jobWait
+*/
+RUNTIME_API void jobRun(JobSystem* pJobSystem, const JobDesc* pJobs, uint32_t count,
+						JobCounter* pCounter);
+
+/**
+	Queues jobs to run once another counter reaches zero.
+
+	@param pJobSystem Job system to run on
+	@param pDependency Counter the jobs wait on, runs them right away if already zero
+	@param pJobs Array of count jobs, copied before the call returns
+	@param count Number of jobs
+	@param pCounter Optional counter, incremented by count up front
+
+	@note The dependency must not be reused for new jobs until the waiting
+	jobs were released
+*/
+RUNTIME_API void jobRunAfter(JobSystem* pJobSystem, JobCounter* pDependency, const JobDesc* pJobs,
+							 uint32_t count, JobCounter* pCounter);
+
+/**
+	Waits for a counter to reach zero, running jobs in the meantime.
+
+	Safe to call from inside a job. Jobs flagged JobFlag_Blocking are never
+	picked up while waiting.
+
+	@param pJobSystem Job system the jobs run on
+	@param pCounter Counter to wait on
+*/
+RUNTIME_API void jobWait(JobSystem* pJobSystem, JobCounter* pCounter);
+
+/**
+	Checks a counter without waiting.
+
+	@param pCounter Counter to check
+
+	@return true once every job counted by pCounter has finished
+*/
+RUNTIME_API bool jobIsDone(const JobCounter* pCounter);
+
+#endif // _JOB_SYSTEM_H_
@@ -55,6 +55,9 @@ RUNTIME_API void arenaRelease(Arena* pArena);
 	@return Pointer to allocated memory, or nullptr on failure
 
 	@note Memory is NOT zero initialized
+	@note Thread safe only for arenas created with ArenaFlag_Atomic. Those
+	claim size plus the worst case alignment padding with one fetch add, so
+	heavily aligned pushes waste a little more space
 
 	@see arenaPushStruct
 	@see arenaPushArray
@@ -81,10 +84,16 @@ RUNTIME_API uint64_t arenaGetPos(Arena* pArena);
 	Rewinds the allocation position to a previously saved point.
 	Use when you want to save a position and want to return to it later.
 
+	Chained blocks past the position are released. Committed pages in the
+	remaining block that lie past both the position and decommitThreshold
+	are decommitted, the rest stay committed for the next pushes.
+
 	@param pArena Arena to reset
 	@param targetPos Target position (see arenaGetPos)
 
 	@note All pointers allocated after this position become invalid
+	@note Never thread safe, ArenaFlag_Atomic arenas must not be pushed to
+	while they are popped
 
 	@see arenaGetPos
 	@see arenaPop
@@ -143,6 +152,85 @@ RUNTIME_API ArenaTemp arenaTempBegin(Arena* pArena);
 */
 RUNTIME_API void arenaTempEnd(ArenaTemp temp);
 
+/**
+	Begins a temporary scope on one of the calling thread's scratch arenas.
+
+	Every thread lazily gets its own ARENA_SCRATCH_COUNT arenas, released
+	when the thread exits, so worker threads can use scratch memory without
+	any locking. Pass the arenas the caller is already allocating results
+	into as conflicts, and a scratch arena that is not one of them is
+	returned. That keeps a function that takes an output arena from
+	popping its caller's data when both happen to use scratch.
+
+	@param ppConflicts Arenas the scratch must not alias, may be nullptr
+	@param conflictCount Number of entries in ppConflicts
+
+	@return Temp scope on a scratch arena, its pArena is nullptr when every
+	scratch arena conflicts or creation failed
+
+	@see arenaScratchEnd
+	@see ScopedArenaScratch
+
+	Example:
+	@code
+	Mesh* buildMesh(Arena* pOutArena)
+	{
+		ArenaTemp scratch = arenaScratchBegin(&pOutArena, 1);
+		Vertex* pTemp = arenaPushArrayNoZero<Vertex>(scratch.pArena, 4096);
+		// ... build into pTemp, copy the result into pOutArena
+		arenaScratchEnd(scratch);
+	}
+	@endcode
+*/
+RUNTIME_API ArenaTemp arenaScratchBegin(Arena* const* ppConflicts = nullptr,
+										uint32_t conflictCount = 0);
+
+/**
+	Ends a scratch scope from arenaScratchBegin.
+
+	@param scratch Scope returned by arenaScratchBegin
+
+	@see arenaScratchBegin
+*/
+RUNTIME_API void arenaScratchEnd(ArenaTemp scratch);
+
+///////////////////////////////////////////
+// Statistics
+
+/**
+	Gets the memory usage of one arena.
+
+	@param pArena Arena to query, any thread may be pushing to it
+	@param pOutStats Receives the statistics, with arenaCount set to 1
+
+	@see arenaGetTagStats
+*/
+RUNTIME_API void arenaGetStats(Arena* pArena, ArenaStats* pOutStats);
+
+/**
+	Gets the memory usage of every live arena, summed per tag.
+
+	Arenas register themselves in arenaCreate, so this covers scratch,
+	frame and subsystem arenas on every thread. Tags are compared by
+	string, all arenas named "Assets" end up in one entry.
+
+	@param pOutStats Receives one entry per tag
+	@param maxCount Size of pOutStats, further tags are dropped
+
+	@return Number of entries written
+
+	Example:
+	@code
+	ArenaStats tags[16];
+	uint32_t tagCount = arenaGetTagStats(tags, 16);
+	for (uint32_t i = 0; i < tagCount; ++i)
+		LOGF(eINFO, "%s: %llu bytes used", tags[i].pName, tags[i].usedBytes);
+	@endcode
+
+	@see ArenaParams::pName
+*/
+RUNTIME_API uint32_t arenaGetTagStats(ArenaStats* pOutStats, uint32_t maxCount);
+
 ///////////////////////////////////////////
 // Template Helpers
 
@@ -264,6 +352,36 @@ struct ScopedArenaTemp
 	ScopedArenaTemp& operator=(const ScopedArenaTemp&) = delete;
 };
 
+/**
+	RAII wrapper for thread local scratch scopes.
+
+	@see arenaScratchBegin
+
+	Example:
+	@code
+	{
+		ScopedArenaScratch scratch(&pOutArena, 1);
+		char* pTempBuffer = arenaPushArrayNoZero<char>(scratch.pArena, 1024);
+		// ... use temp buffer
+	} // Automatically freed here
+	@endcode
+*/
+struct ScopedArenaScratch
+{
+	ArenaTemp temp;
+	Arena* pArena; ///< Scratch arena to allocate from, nullptr when none was free
+
+	ScopedArenaScratch(Arena* const* ppConflicts = nullptr, uint32_t conflictCount = 0)
+	: temp(arenaScratchBegin(ppConflicts, conflictCount))
+	, pArena(temp.pArena)
+	{
+	}
+	~ScopedArenaScratch() { arenaScratchEnd(temp); }
+
+	ScopedArenaScratch(const ScopedArenaScratch&) = delete;
+	ScopedArenaScratch& operator=(const ScopedArenaScratch&) = delete;
+};
+
 /**
 	Creates a scoped temporary arena with RAII cleanup.
 
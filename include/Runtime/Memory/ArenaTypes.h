@@ -14,19 +14,34 @@
 #define Kilobyte(n) ((n) * 1024)
 #define Megabyte(n) (Kilobyte(n) * 1024)
 
-#define ARENA_HEADER_SIZE 128			   ///< Size of Arena header in bytes
-#define ARENA_DEFAULT_RESERVE Megabyte(64) ///< Default virtual reservation (64MB)
-#define ARENA_DEFAULT_COMMIT Kilobyte(64)  ///< Default commit granularity (64KB)
+#define ARENA_HEADER_SIZE 128						  ///< Size of Arena header in bytes
+#define ARENA_DEFAULT_RESERVE Megabyte(64)			  ///< Default virtual reservation (64MB)
+#define ARENA_DEFAULT_COMMIT Kilobyte(64)			  ///< Default commit granularity (64KB)
+#define ARENA_DEFAULT_DECOMMIT_THRESHOLD Megabyte(16) ///< Committed bytes kept by pops
+#define ARENA_NEVER_DECOMMIT UINT64_MAX				  ///< Keeps every page committed
+
+#define ARENA_SCRATCH_COUNT 2 ///< Scratch arenas per thread, see arenaScratchBegin
 
 /**
 	Arena allocator flags.
 
-	Allows to chain arena blocks to allow growth.
+	Allows to chain arena blocks to allow growth. ArenaFlag_Atomic makes
+	arenaPush safe to call from several threads at once.
+
+	ArenaFlag_LargePages backs every block with large pages, which are
+	committed in full up front. Without OS support (on Windows the user
+	needs SeLockMemoryPrivilege) the arena logs a warning and falls back
+	to normal pages. ArenaFlag_Prefault commits and touches every block
+	when it is created, so the first pushes never page fault.
 */
 enum ArenaFlags : uint32_t
 {
 	ArenaFlag_None = 0,
 	ArenaFlag_NoChain = (1 << 0),
+	ArenaFlag_Atomic = (1 << 1),	 ///< Lock free fetch add bump allocation for shared arenas
+	ArenaFlag_LargePages = (1 << 2), ///< 2MB pages, fewer TLB misses in big long lived arenas
+	ArenaFlag_Prefault = (1 << 3),	 ///< Commit and touch whole blocks up front
+	ArenaFlag_External = (1 << 4),	 ///< Set on a block living in pBackingBuffer, never freed
 };
 
 /**
@@ -39,16 +54,26 @@ enum ArenaFlags : uint32_t
 */
 struct Arena
 {
-	Arena* pPrev;		  ///< Previous block in chain via linked list
-	Arena* pCurrent;	  ///< Current active block for allocation
-	uint32_t flags;		  ///< ArenaFlags controlling behavior
-	uint32_t _pad;		  ///< Padding
-	uint64_t commitSize;  ///< How much memory to commit at a time
-	uint64_t reserveSize; ///< How much virtual memory to reserve per block
-	uint64_t basePos;	  ///< Global offset of this block in the arena chain
-	uint64_t pos;		  ///< Current position within this current block
-	uint64_t committed;	  ///< Total bytes committed in physical memory
-	uint64_t reserved;	  ///< Total bytes reserved in virtual address
+	Arena* pPrev;				///< Previous block in chain via linked list
+	Arena* pCurrent;			///< Current active block for allocation
+	uint32_t flags;				///< ArenaFlags controlling behavior
+	uint32_t chainLock;			///< Guards chaining of ArenaFlag_Atomic arenas, first block only
+	uint64_t commitSize;		///< How much memory to commit at a time
+	uint64_t reserveSize;		///< How much virtual memory to reserve per block
+	uint64_t basePos;			///< Global offset of this block in the arena chain
+	uint64_t pos;				///< Current position within this current block
+	uint64_t committed;			///< Total bytes committed in physical memory
+	uint64_t reserved;			///< Total bytes reserved in virtual address
+	uint64_t decommitThreshold; ///< High water mark, pops decommit what lies past it
+
+	// Registry and statistics, first block only
+	const char* pName;		///< Tag for memory reports, nullptr when untagged
+	Arena* pRegistryNext;	///< Next arena in the global registry
+	Arena* pRegistryPrev;	///< Previous arena in the global registry
+	uint64_t peakUsed;		///< Highest used byte count seen by arenaPopTo
+	uint32_t blockCount;	///< Blocks in the chain
+	uint32_t commitCount;	///< platformCommitMemory calls
+	uint32_t decommitCount; ///< platformDecommitMemory calls
 };
 static_assert(sizeof(Arena) <= 128, "Arena header must fit in 128 bytes");
 
@@ -56,13 +81,43 @@ static_assert(sizeof(Arena) <= 128, "Arena header must fit in 128 bytes");
 	Arena creation parameters.
 
 	Specifies the configuration for a new arena.
+
+	pBackingBuffer places the first block inside caller owned memory, such
+	as a preallocated or memory mapped region. It must be 8 byte aligned,
+	writable and reserveSize bytes long. The arena never frees it, chained
+	blocks are reserved as usual.
 */
 struct ArenaParams
 {
-	uint32_t flags;		  ///< ArenaFlags
-	uint64_t reserveSize; ///< Virtual memory reservation size per block (0 = default)
-	uint64_t commitSize;  ///< Physical memory commit (0 = default)
-	void* pBackingBuffer; ///< Optional preallocated buffer (nullptr = allocate new)
+	uint32_t flags;				///< ArenaFlags
+	uint64_t reserveSize;		///< Virtual memory reservation size per block (0 = default)
+	uint64_t commitSize;		///< Physical memory commit (0 = default)
+	void* pBackingBuffer;		///< Optional preallocated buffer (nullptr = allocate new)
+	uint64_t decommitThreshold; ///< Bytes a block keeps committed when popped (0 = default)
+	const char* pName;			///< Report tag, must outlive the arena (nullptr = untagged)
+};
+
+/**
+	Memory usage of one arena, or of every arena sharing a tag.
+
+	Used bytes exclude block headers. Usage only shrinks in arenaPopTo, so
+	sampling the peak there and on every query keeps it exact without
+	touching arenaPush.
+
+	@see arenaGetStats
+	@see arenaGetTagStats
+*/
+struct ArenaStats
+{
+	const char* pName;		 ///< Tag, "Untagged" for arenas created without one
+	uint32_t arenaCount;	 ///< Arenas counted
+	uint32_t blockCount;	 ///< Blocks across their chains
+	uint64_t usedBytes;		 ///< Bytes pushed and not popped
+	uint64_t peakBytes;		 ///< Highest usedBytes seen
+	uint64_t committedBytes; ///< Physical memory committed
+	uint64_t reservedBytes;	 ///< Virtual address space reserved
+	uint32_t commitCount;	 ///< platformCommitMemory calls
+	uint32_t decommitCount;	 ///< platformDecommitMemory calls
 };
 
 /**
@@ -0,0 +1,106 @@
+/*
+ * FrameArena.h
+ *
+ * Per frame arenas recycled on GPU fences.
+ */
+
+#ifndef _FRAMEARENA_H_
+#define _FRAMEARENA_H_
+
+#include "Runtime/Memory/ArenaTypes.h"
+#include "Runtime/RuntimeAPI.h"
+
+struct Renderer;
+struct Fence;
+
+#define FRAME_ARENA_MAX_FRAMES 4 ///< Upper bound on frames in flight
+
+/**
+	Ring of arenas, one per frame in flight.
+
+	Transient CPU data for a frame is pushed into that frame's arena and
+	stays valid until the GPU has finished the frame that consumed it. The
+	arena is only cleared when it comes around again and the fence recorded
+	for it with frameArenaSetFence has signaled, so nothing has to track
+	the lifetime of individual allocations.
+
+	The arenas are created with ArenaFlag_Atomic, so multi threaded ECS
+	systems and render jobs can push into the current arena at once.
+
+	@see frameArenaCreate
+	@see frameArenaBegin
+*/
+struct FrameArena
+{
+	Arena* pArenas[FRAME_ARENA_MAX_FRAMES];
+	Fence* pFences[FRAME_ARENA_MAX_FRAMES]; ///< Fence of the last GPU frame that used each arena
+	uint32_t frameCount;
+	uint32_t currentIndex; ///< Arena returned by frameArenaGet
+};
+
+/**
+	Creates a frame arena ring.
+
+	@param frameCount Number of frames in flight, at most FRAME_ARENA_MAX_FRAMES
+	@param pParams Parameters for every arena, or nullptr for defaults.
+	ArenaFlag_Atomic is always added
+
+	@return The ring, or nullptr on failure
+
+	@see frameArenaRelease
+*/
+RUNTIME_API FrameArena* frameArenaCreate(uint32_t frameCount, const ArenaParams* pParams = nullptr);
+
+/**
+	Releases every arena in the ring.
+
+	@param pFrameArena Ring to release
+
+	@warning The GPU must be idle, pending fences are not waited on
+*/
+RUNTIME_API void frameArenaRelease(FrameArena* pFrameArena);
+
+/**
+	Starts a frame on one of the arenas.
+
+	Waits for the fence recorded for that arena, if the GPU has not finished
+	with it yet, then clears it and makes it current.
+
+	@param pFrameArena Ring to advance
+	@param pRenderer Renderer owning the recorded fences
+	@param frameIndex Frame slot, always below frameCount
+
+	@return The cleared arena for this frame
+
+	@see frameArenaSetFence
+*/
+RUNTIME_API Arena* frameArenaBegin(FrameArena* pFrameArena, Renderer* pRenderer,
+								   uint32_t frameIndex);
+
+/**
+	Records the fence that signals when the GPU is done with a frame's data.
+
+	Call after the submit that consumes the data allocated in frameIndex,
+	with the fence of its GpuCmdRing element.
+
+	@param pFrameArena Ring to update
+	@param frameIndex Frame slot the submitted frame's data lives in
+	@param pFence Fence signaled by that submit
+
+	@see frameArenaBegin
+*/
+RUNTIME_API void frameArenaSetFence(FrameArena* pFrameArena, uint32_t frameIndex, Fence* pFence);
+
+/**
+	Returns the arena of the current frame.
+
+	@param pFrameArena Ring to query
+
+	@return Arena made current by the last frameArenaBegin
+*/
+inline Arena* frameArenaGet(const FrameArena* pFrameArena)
+{
+	return pFrameArena ? pFrameArena->pArenas[pFrameArena->currentIndex] : nullptr;
+}
+
+#endif // _FRAMEARENA_H_
@@ -18,7 +18,8 @@
 	physical RAM until platformCommitMemory() is called on the reserved region.
 
 	On Windows: Uses VirtualAlloc with MEM_RESERVE
-	On macOS: TODO
+	On Linux: Uses mmap with PROT_NONE and MAP_NORESERVE
+	On macOS: Uses mmap with PROT_NONE
 
 	@param size Size in bytes to reserve
 
@@ -38,7 +39,8 @@ void* platformReserveMemory(uint64_t size);
 	making the memory accessible for read/write operations.
 
 	On Windows: Uses VirtualAlloc with MEM_COMMIT
-	On macOS: TODO
+	On Linux and macOS: Uses mprotect to make the pages read/write, they are
+	backed on first touch
 
 	@param pMemory Pointer within a reserved region that's page aligned
 	@param size Number of bytes to commit, rounded to page size
@@ -59,7 +61,8 @@ bool platformCommitMemory(void* pMemory, uint64_t size);
 	address space reserved.
 
 	On Windows: Uses VirtualFree with MEM_DECOMMIT
-	On macOS: TODO
+	On Linux: Uses madvise with MADV_DONTNEED, then mprotect to PROT_NONE
+	On macOS: Maps fresh PROT_NONE pages over the range
 
 	@param pMemory Pointer to committed memory that's page aligned
 	@param size Number of bytes to decommit, rounded to page size
@@ -76,10 +79,10 @@ void platformDecommitMemory(void* pMemory, uint64_t size);
 	Frees both the virtual address space and any committed physical pages.
 
 	On Windows: Uses VirtualFree with MEM_RELEASE
-	On macOS: TODO
+	On Linux and macOS: Uses munmap
 
 	@param pMemory Pointer to the base of the reserved region
-	@param size Size of the region
+	@param size Size of the region, ignored on Windows but required elsewhere
 
 	@note This releases the entire reservation, not partial regions
 
@@ -94,10 +97,44 @@ void platformReleaseMemory(void* pMemory, uint64_t size = 0);
 
 	Usually values:
 	- Windows: 4096 bytes
-	- macOS: TODO
+	- Linux: 4096 bytes on x86_64, 4096 to 65536 on ARM
+	- macOS: 4096 bytes on Intel, 16384 on Apple silicon
 
 	@return Page size in bytes
 */
 uint64_t platformGetPageSize();
 
+/**
+	Returns the large page size, if large pages can be allocated.
+
+	On Windows: GetLargePageMinimum, after enabling SeLockMemoryPrivilege
+	On Linux: 2MB huge pages
+	On macOS: 2MB superpages on x86_64, 0 on Apple silicon
+
+	@return Large page size in bytes, or 0 when unsupported
+
+	@see platformAllocateLargePages
+*/
+uint64_t platformGetLargePageSize();
+
+/**
+	Reserves and commits a region backed by large pages.
+
+	Large pages cannot be committed piecemeal, so the whole region is
+	committed at once. Release it with platformReleaseMemory.
+
+	On Windows: Uses VirtualAlloc with MEM_LARGE_PAGES
+	On Linux: Uses mmap with MAP_HUGETLB, or transparent huge pages through
+	madvise(MADV_HUGEPAGE) when no huge pages are reserved
+	On macOS: Uses mmap with VM_FLAGS_SUPERPAGE_SIZE_2MB
+
+	@param size Size in bytes, a multiple of platformGetLargePageSize()
+
+	@return Pointer to the committed region, or nullptr on failure
+
+	@see platformGetLargePageSize
+	@see platformReleaseMemory
+*/
+void* platformAllocateLargePages(uint64_t size);
+
 #endif // _PLATFORMMEMORY_H_
@@ -0,0 +1,228 @@
+/*
+ * Pool.h
+ *
+ * Fixed size chunk allocator on top of Arena blocks.
+ */
+
+#ifndef _POOL_H_
+#define _POOL_H_
+
+#include "Runtime/Memory/ArenaTypes.h"
+#include "Runtime/RuntimeAPI.h"
+
+#define POOL_MAX_THREADS 64					 ///< Threads with a magazine, the rest lock
+#define POOL_MAGAZINE_SIZE 32				 ///< Chunks cached per thread and pool
+#define POOL_DEFAULT_BLOCK_SIZE Kilobyte(64) ///< Bytes carved from the arena at a time
+
+#define POOL_SIZE_CLASS_MIN_SHIFT 6 ///< Smallest PoolSet size class (64 bytes)
+#define POOL_SIZE_CLASS_COUNT 21	///< PoolSet size classes, 64 bytes to 64MB
+
+/**
+	Pool allocator flags.
+*/
+enum PoolFlags : uint32_t
+{
+	PoolFlag_None = 0,
+	PoolFlag_ThreadMagazines = (1 << 0), ///< Per thread chunk caches, safe to use from any thread
+};
+
+/**
+	Per thread chunk cache.
+
+	Only the owning thread touches a magazine, so poolAlloc and poolFree
+	run without locks or atomics until the magazine runs empty or full.
+
+	@note Cache line aligned so neighbouring threads do not false share
+*/
+struct alignas(64) PoolMagazine
+{
+	void* pChunks[POOL_MAGAZINE_SIZE];
+	uint32_t count;
+};
+
+/**
+	Fixed size chunk allocator.
+
+	Chunks are carved out of blocks pushed onto the arena, and freed chunks
+	go onto an intrusive free list threaded through their first pointer, so
+	objects can be created and destroyed in any order without leaking arena
+	space. Memory goes back to the system only when the arena is released.
+
+	With PoolFlag_ThreadMagazines every thread allocates from and frees to
+	its own magazine, and only exchanges half a magazine with the shared
+	free list under a spin lock when it runs empty or full.
+
+	@see poolCreate
+	@see poolAlloc
+	@see poolFree
+*/
+struct Pool
+{
+	Arena* pArena;			  ///< Arena the blocks are pushed onto
+	void* pFreeList;		  ///< Shared list of freed chunks
+	uint8_t* pBlockCursor;	  ///< Next never used chunk in the newest block
+	uint8_t* pBlockEnd;		  ///< End of the newest block
+	PoolMagazine* pMagazines; ///< POOL_MAX_THREADS caches, nullptr without magazines
+
+	uint32_t chunkSize;		 ///< Bytes per chunk, a multiple of chunkAlign
+	uint32_t chunkAlign;	 ///< Alignment of every chunk
+	uint32_t chunksPerBlock; ///< Chunks carved per arena push
+	uint32_t flags;			 ///< PoolFlags
+	uint32_t lock;			 ///< Guards the shared list and carving when magazines are used
+	uint32_t blockCount;	 ///< Blocks pushed onto the arena so far
+
+	uint64_t liveCount;	  ///< Chunks handed out and not freed
+	uint64_t peakCount;	  ///< Highest liveCount seen
+	uint64_t totalChunks; ///< Chunks in all blocks, live or free
+};
+
+/**
+	Pool creation parameters.
+*/
+struct PoolParams
+{
+	uint32_t chunkSize;		 ///< Bytes per chunk, at least sizeof(void*)
+	uint32_t chunkAlign;	 ///< Chunk alignment (0 = 8)
+	uint32_t chunksPerBlock; ///< Chunks per arena push (0 = POOL_DEFAULT_BLOCK_SIZE worth)
+	uint32_t flags;			 ///< PoolFlags
+};
+
+/**
+	Pool usage statistics.
+
+	@see poolGetStats
+*/
+struct PoolStats
+{
+	uint64_t liveCount;		///< Chunks currently allocated
+	uint64_t peakCount;		///< Highest number of chunks allocated at once
+	uint64_t freeCount;		///< Chunks available without touching the arena
+	uint64_t reservedBytes; ///< Arena bytes owned by the pool
+	uint32_t blockCount;	///< Arena blocks carved so far
+	uint32_t chunkSize;		///< Bytes per chunk
+};
+
+/**
+	Set of power of two pools for variable sized blocks.
+
+	Backs containers that grow by doubling, so storage freed on growth is
+	handed to the next container that reaches the same size.
+
+	@see poolSetCreate
+	@see poolSetAlloc
+*/
+struct PoolSet
+{
+	Arena* pArena;						 ///< Arena every pool pushes onto
+	Pool* pPools[POOL_SIZE_CLASS_COUNT]; ///< Created on first use, nullptr before
+	uint32_t flags;						 ///< PoolFlags for every pool
+	uint32_t lock;						 ///< Guards pool creation
+};
+
+///////////////////////////////////////////
+// Pool
+
+/**
+	Creates a pool.
+
+	The pool header, and the magazines when requested, are pushed onto the
+	arena first.
+
+	@param pArena Arena to push blocks onto
+	@param pParams Chunk layout and flags
+
+	@return The pool, or nullptr on failure
+
+	@note The arena must not be popped below the pool, and with
+	PoolFlag_ThreadMagazines it must be ArenaFlag_Atomic if other code
+	pushes onto it from other threads
+
+	@see poolAlloc
+*/
+RUNTIME_API Pool* poolCreate(Arena* pArena, const PoolParams* pParams);
+
+/**
+	Allocates one chunk.
+
+	@param pPool Pool to allocate from
+
+	@return Chunk of chunkSize bytes, or nullptr if the arena is out of memory
+
+	@note Memory is NOT zero initialized
+
+	@see poolFree
+*/
+RUNTIME_API void* poolAlloc(Pool* pPool);
+
+/**
+	Returns a chunk to the pool.
+
+	@param pPool Pool the chunk came from
+	@param pChunk Chunk from poolAlloc, nullptr is ignored
+
+	@see poolAlloc
+*/
+RUNTIME_API void poolFree(Pool* pPool, void* pChunk);
+
+/**
+	Gets the pool usage statistics.
+
+	@param pPool Pool to query
+	@param pOutStats Receives the statistics
+
+	@note Chunks sitting in magazines count as free
+*/
+RUNTIME_API void poolGetStats(const Pool* pPool, PoolStats* pOutStats);
+
+///////////////////////////////////////////
+// PoolSet
+
+/**
+	Creates a set of size class pools.
+
+	@param pArena Arena every pool pushes onto
+	@param flags PoolFlags for every pool
+
+	@return The set, or nullptr on failure
+
+	@see poolSetAlloc
+*/
+RUNTIME_API PoolSet* poolSetCreate(Arena* pArena, uint32_t flags = PoolFlag_None);
+
+/**
+	Allocates a block of at least size bytes.
+
+	Rounds up to the next power of two size class, at least 64 bytes.
+	Blocks are 64 byte aligned.
+
+	@param pSet Set to allocate from
+	@param size Requested size in bytes
+
+	@return The block, or nullptr on failure
+
+	@see poolSetFree
+*/
+RUNTIME_API void* poolSetAlloc(PoolSet* pSet, uint64_t size);
+
+/**
+	Returns a block to its size class.
+
+	@param pSet Set the block came from
+	@param pBlock Block from poolSetAlloc, nullptr is ignored
+	@param size The size passed to poolSetAlloc
+
+	@see poolSetAlloc
+*/
+RUNTIME_API void poolSetFree(PoolSet* pSet, void* pBlock, uint64_t size);
+
+/**
+	Returns the pool serving a size, creating it if needed.
+
+	@param pSet Set to query
+	@param size Requested size in bytes
+
+	@return The size class pool, or nullptr if size is too large
+*/
+RUNTIME_API Pool* poolSetGetPool(PoolSet* pSet, uint64_t size);
+
+#endif // _POOL_H_
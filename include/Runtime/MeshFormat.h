@@ -0,0 +1,88 @@
+/*
+ * MeshFormat.h
+ *
+ * Binary mesh file layout shared by the runtime and the offline cooker
+ */
+
+#ifndef _MESHFORMAT_H_
+#define _MESHFORMAT_H_
+
+#include <stdint.h>
+
+#define MESH_FILE_MAGIC 0x4853454D // "MESH" little endian
+#define MESH_FILE_VERSION 1
+#define MESH_FILE_ALIGNMENT 16
+
+/**
+	Vertex attributes stored in a mesh file.
+
+	Attributes are interleaved in the order they are declared here, so a
+	position + texcoord mesh matches the engine's default vertex layout
+	(float3 position, float2 uv).
+*/
+enum MeshAttribute : uint32_t
+{
+	MeshAttribute_Position = 1 << 0,  ///< float3
+	MeshAttribute_Normal = 1 << 1,	  ///< float3
+	MeshAttribute_TexCoord0 = 1 << 2, ///< float2
+};
+
+/**
+	Header at the start of every .mesh file.
+
+	Produced offline by tools/MeshCooker. The vertex and index blocks are
+	already in their final GPU layout, so the runtime can memory map the
+	file and hand the blocks straight to the resource loader.
+
+	File layout:
+	@code
+	MeshFileHeader
+	[padding to MESH_FILE_ALIGNMENT]
+	vertex data (vertexCount * vertexStride bytes, interleaved)
+	[padding to MESH_FILE_ALIGNMENT]
+	index data (indexCount * indexSize bytes)
+	@endcode
+
+	@note All values are little endian
+
+	@see loadMesh
+*/
+struct MeshFileHeader
+{
+	uint32_t magic;		   ///< MESH_FILE_MAGIC
+	uint32_t version;	   ///< MESH_FILE_VERSION
+	uint32_t attributes;   ///< MeshAttribute flags
+	uint32_t vertexStride; ///< Size of each vertex in bytes
+	uint32_t vertexCount;  ///< Number of vertices
+	uint32_t indexCount;   ///< Number of indices, 0 for non indexed meshes
+	uint32_t indexSize;	   ///< Bytes per index (2 or 4)
+	uint32_t _pad;		   ///< Reserved, must be 0
+	uint64_t vertexOffset; ///< Byte offset of the vertex data from the file start
+	uint64_t indexOffset;  ///< Byte offset of the index data from the file start
+	float boundsMin[3];	   ///< Object space AABB minimum
+	float boundsMax[3];	   ///< Object space AABB maximum
+	uint32_t _reserved[2]; ///< Reserved, must be 0
+};
+static_assert(sizeof(MeshFileHeader) == 80, "MeshFileHeader layout is part of the file format");
+
+/**
+	Computes the vertex stride for a set of attributes.
+
+	@param attributes MeshAttribute flags
+
+	@return Size of one interleaved vertex in bytes
+*/
+inline uint32_t meshAttributeStride(uint32_t attributes)
+{
+	uint32_t stride = 0;
+	if (attributes & MeshAttribute_Position)
+		stride += 3 * sizeof(float);
+	if (attributes & MeshAttribute_Normal)
+		stride += 3 * sizeof(float);
+	if (attributes & MeshAttribute_TexCoord0)
+		stride += 2 * sizeof(float);
+
+	return stride;
+}
+
+#endif // _MESHFORMAT_H_
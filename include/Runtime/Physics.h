@@ -0,0 +1,262 @@
+/*
+ * Physics.h
+ *
+ * Jolt physics world driven at a fixed timestep and synced into the ECS.
+ */
+
+#ifndef _ENGINE_PHYSICS_H_
+#define _ENGINE_PHYSICS_H_
+
+#include "Runtime/RuntimeAPI.h"
+#include "Runtime/ECS.h"
+#include "Runtime/Memory/ArenaTypes.h"
+
+namespace JPH
+{
+	class PhysicsSystem;
+}
+
+struct PhysicsWorld;
+struct RigidBodyComponent;
+struct JobSystem;
+
+extern ECS_COMPONENT_DECLARE(RigidBodyComponent);
+
+#define PHYSICS_DEFAULT_FIXED_TIMESTEP (1.0f / 60.0f)
+#define PHYSICS_DEFAULT_MAX_STEPS 4		 ///< Fixed steps per frame before time is dropped
+#define PHYSICS_DEFAULT_MAX_BODIES 65536 ///< Bodies per world
+#define PHYSICS_DEFAULT_TEMP_ALLOCATOR_SIZE Megabyte(16)
+#define PHYSICS_DEFAULT_GRAVITY_Y (-9.81f) ///< Used unless PhysicsWorldDesc::customGravity is set
+
+#define PHYSICS_INVALID_BODY_ID 0xffffffffu ///< Matches JPH::BodyID::cInvalidBodyID
+
+/**
+	Collision layers.
+
+	Static bodies never test against each other, everything else collides.
+*/
+enum PhysicsLayer : uint16_t
+{
+	PhysicsLayer_Static = 0, ///< Static bodies
+	PhysicsLayer_Moving = 1, ///< Dynamic and kinematic bodies
+	PhysicsLayer_Count,
+};
+
+/**
+	Rigid body motion types, mirror JPH::EMotionType.
+*/
+enum RigidBodyMotion : uint8_t
+{
+	RigidBodyMotion_Static = 0,
+	RigidBodyMotion_Kinematic = 1,
+	RigidBodyMotion_Dynamic = 2,
+};
+
+/**
+	Collision shapes created by addRigidBody.
+*/
+enum RigidBodyShape : uint8_t
+{
+	RigidBodyShape_Box = 0,		///< Uses halfExtents
+	RigidBodyShape_Sphere = 1,	///< Uses radius
+	RigidBodyShape_Capsule = 2, ///< Uses radius and halfHeight, along Y
+};
+
+/**
+	@struct RigidBodyComponent
+
+	Links an entity to its Jolt body.
+
+	The body owns the simulated pose. After every updatePhysicsWorld the
+	pose of each moving body, interpolated between the last two fixed
+	steps, is written into the entity's TransformComponent, so render code
+	never talks to Jolt. TransformComponent::scale is left alone.
+
+	@note Physics entities must be root entities, the pose is in world space
+
+	@see addRigidBody
+	@see updatePhysicsWorld
+*/
+struct RigidBodyComponent
+{
+	uint32_t bodyId; ///< JPH::BodyID index and sequence, PHYSICS_INVALID_BODY_ID when none
+	RigidBodyMotion motion;
+};
+
+/**
+	Rigid body creation parameters.
+
+	The starting pose comes from the entity's TransformComponent.
+
+	@see addRigidBody
+*/
+struct RigidBodyDesc
+{
+	RigidBodyMotion motion;
+	RigidBodyShape shape;
+	float halfExtents[3]; ///< Box half size
+	float radius;		  ///< Sphere and capsule radius
+	float halfHeight;	  ///< Half the capsule cylinder height
+	float friction;		  ///< 0 uses the Jolt default
+	float restitution;
+	bool startAsleep; ///< Dynamic bodies only, skip activation until something touches them
+};
+
+/**
+	Physics world creation parameters.
+
+	Zeroed fields take the PHYSICS_DEFAULT_* values, only pJobSystem is
+	required.
+
+	@see createPhysicsWorld
+*/
+struct PhysicsWorldDesc
+{
+	JobSystem* pJobSystem; ///< Runs the simulation jobs, usually EngineApp::getJobSystem()
+	uint32_t maxBodies;
+	uint32_t maxBodyPairs;			///< 0 uses maxBodies
+	uint32_t maxContactConstraints; ///< 0 uses maxBodies
+	uint32_t maxStepsPerFrame;		///< Caps the catch up after a long frame
+	uint32_t collisionSteps;		///< Jolt collision sub steps per fixed step (0 = 1)
+	uint32_t tempAllocatorSize;		///< Bytes of Jolt scratch memory per world
+	float fixedTimeStep;			///< Seconds per simulation step
+	float gravity[3];				///< Only read with customGravity, zero is valid
+	bool customGravity;				///< Use gravity as given, false keeps the default
+};
+
+/**
+	Physics world statistics of the last updatePhysicsWorld.
+*/
+struct PhysicsStats
+{
+	uint32_t bodyCount;		 ///< Bodies in the world
+	uint32_t activeCount;	 ///< Bodies awake after the last step
+	uint32_t stepCount;		 ///< Fixed steps run by the last update
+	uint32_t writebackCount; ///< Transforms written by the last update
+	float interpolation;	 ///< Blend factor between the last two steps, in [0, 1)
+};
+
+///////////////////////////////////////////
+// World
+
+/**
+	Creates a physics world bound to an ECS world.
+
+	The first world initializes Jolt (allocator, factory and type
+	registration), the last destroyPhysicsWorld shuts it down again. The
+	simulation jobs run on pDesc->pJobSystem. Registers RigidBodyComponent
+	with the ECS world.
+
+	@param world ECS world whose entities get rigid bodies
+	@param pDesc Creation parameters, pJobSystem must be set
+
+	@return The physics world, or nullptr on failure
+
+	@see destroyPhysicsWorld
+*/
+RUNTIME_API PhysicsWorld* createPhysicsWorld(ecs_world_t* world, const PhysicsWorldDesc* pDesc);
+
+/**
+	Destroys a physics world and every body in it.
+
+	@param pPhysics World to destroy, nullptr is ignored
+*/
+RUNTIME_API void destroyPhysicsWorld(PhysicsWorld* pPhysics);
+
+/**
+	Advances the simulation and syncs the ECS.
+
+	Adds deltaTime to an accumulator and runs as many fixed steps as fit,
+	at most maxStepsPerFrame, dropping the rest so a hitch does not spiral.
+	Then writes the poses of the bodies that moved into their
+	TransformComponent, blended between the previous and current step by
+	the leftover time. Only the active body list is walked, sleeping and
+	static bodies cost nothing.
+
+	Call once per frame before EngineApp::Update, so TransformSystem picks
+	up the dirty transforms in the same frame.
+
+	@param pPhysics World to update
+	@param deltaTime Frame time in seconds
+
+	@note Reads bodies through the no lock interfaces, do not touch the
+	bodies from other threads while this runs
+*/
+RUNTIME_API void updatePhysicsWorld(PhysicsWorld* pPhysics, float deltaTime);
+
+/**
+	Gets the statistics of the last update.
+
+	@param pPhysics World to query
+	@param pOutStats Receives the statistics
+*/
+RUNTIME_API void getPhysicsStats(const PhysicsWorld* pPhysics, PhysicsStats* pOutStats);
+
+/**
+	Gets the underlying Jolt system, for queries and constraints.
+
+	@param pPhysics World to query
+
+	@return The Jolt physics system
+*/
+RUNTIME_API JPH::PhysicsSystem* getPhysicsSystem(PhysicsWorld* pPhysics);
+
+///////////////////////////////////////////
+// Bodies
+
+/**
+	Creates a body for an entity and adds RigidBodyComponent.
+
+	@param pPhysics World to add the body to
+	@param entity Root entity with a TransformComponent
+	@param pDesc Shape and motion of the body
+
+	@return true on success, false if the entity has no transform, already
+	has a body, or the world is full
+*/
+RUNTIME_API bool addRigidBody(PhysicsWorld* pPhysics, ecs_entity_t entity,
+							  const RigidBodyDesc* pDesc);
+
+/**
+	Destroys the body of an entity and removes RigidBodyComponent.
+
+	@param pPhysics World the body lives in
+	@param entity Entity with a RigidBodyComponent
+
+	@note Call before deleting a physics entity, the body is not removed
+	automatically
+*/
+RUNTIME_API void removeRigidBody(PhysicsWorld* pPhysics, ecs_entity_t entity);
+
+/**
+	Moves a body without interpolating from its old pose.
+
+	@param pPhysics World the body lives in
+	@param entity Entity with a RigidBodyComponent
+	@param position New world space position
+	@param rotation New Euler angles in radians, same convention as TransformComponent
+*/
+RUNTIME_API void teleportRigidBody(PhysicsWorld* pPhysics, ecs_entity_t entity,
+								   const vec3& position, const vec3& rotation);
+
+/**
+	Gets the linear velocity of a body.
+
+	@param pPhysics World the body lives in
+	@param entity Entity with a RigidBodyComponent
+
+	@return Velocity in units per second, zero without a body
+*/
+RUNTIME_API vec3 getRigidBodyLinearVelocity(PhysicsWorld* pPhysics, ecs_entity_t entity);
+
+/**
+	Sets the linear velocity of a body and wakes it up.
+
+	@param pPhysics World the body lives in
+	@param entity Entity with a RigidBodyComponent
+	@param velocity Velocity in units per second
+*/
+RUNTIME_API void setRigidBodyLinearVelocity(PhysicsWorld* pPhysics, ecs_entity_t entity,
+											const vec3& velocity);
+
+#endif // _ENGINE_PHYSICS_H_
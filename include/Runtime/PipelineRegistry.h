@@ -0,0 +1,146 @@
+/*
+ * PipelineRegistry.h
+ *
+ * Shared pipeline state objects keyed by their state, backed by a driver
+ * pipeline cache that persists between runs.
+ */
+
+#ifndef _PIPELINE_REGISTRY_H_
+#define _PIPELINE_REGISTRY_H_
+
+#include "Runtime/RuntimeAPI.h"
+#include <stdint.h>
+
+#define PIPELINE_REGISTRY_MAX_PIPELINES 256 ///< Distinct pipelines per registry
+#define PIPELINE_REGISTRY_DEFAULT_CACHE_FILE "Engine.cache" ///< In RD_PIPELINE_CACHE
+
+struct Renderer;
+struct Pipeline;
+struct PipelineDesc;
+struct PipelineCache;
+struct PipelineRegistry;
+
+/**
+	Pipeline registry counters.
+
+	@see getPipelineRegistryStats
+*/
+struct PipelineRegistryStats
+{
+	uint32_t hits;			 ///< acquirePipeline calls served by an existing pipeline
+	uint32_t misses;		 ///< acquirePipeline calls that created a pipeline
+	uint32_t pipelineCount;	 ///< Pipelines alive, referenced or not
+	uint32_t unusedCount;	 ///< Pipelines without references, dropped by flushUnusedPipelines
+	uint64_t cacheLoadBytes; ///< Size of the driver cache read at creation, 0 on a cold start
+};
+
+///////////////////////////////////////////
+// Lifecycle
+
+/**
+	Creates a pipeline registry.
+
+	Reads the driver pipeline cache written by the previous run, if any,
+	and creates every pipeline of the registry against it. On a warm start
+	the driver skips most of the shader and PSO compilation.
+
+	@param pRenderer Renderer to create pipelines with
+	@param pCacheFileName File in RD_PIPELINE_CACHE, nullptr for
+	PIPELINE_REGISTRY_DEFAULT_CACHE_FILE
+
+	@return The registry, or nullptr on failure
+
+	@see destroyPipelineRegistry
+*/
+RUNTIME_API PipelineRegistry* createPipelineRegistry(Renderer* pRenderer,
+													 const char* pCacheFileName = nullptr);
+
+/**
+	Saves the driver cache and destroys every pipeline of the registry.
+
+	@param pRegistry Registry to destroy, nullptr is ignored
+
+	@note The GPU must be done with the pipelines
+*/
+RUNTIME_API void destroyPipelineRegistry(PipelineRegistry* pRegistry);
+
+/**
+	Writes the driver pipeline cache to disk.
+
+	destroyPipelineRegistry saves as well. Saving once the first frame's
+	pipelines exist keeps the work of a run that never exits cleanly.
+
+	@param pRegistry Registry whose cache to save
+
+	@return true if the cache was written
+*/
+RUNTIME_API bool savePipelineCache(PipelineRegistry* pRegistry);
+
+///////////////////////////////////////////
+// Pipelines
+
+/**
+	Gets a pipeline for a description, creating it on first use.
+
+	The key is a hash of the state that makes pipelines differ: shader,
+	vertex layout, render target and depth formats, sample count, topology,
+	and the blend, depth and rasterizer states. Descriptions with the same
+	state share one Pipeline, and every call adds a reference.
+
+	@param pRegistry Registry to look in
+	@param pDesc Pipeline to create, pCache is filled in by the registry
+
+	@return The shared pipeline, or nullptr if it could not be created
+
+	@note State structs are compared as bytes, zero initialize them so
+	padding does not cause misses
+
+	@see releasePipeline
+*/
+RUNTIME_API Pipeline* acquirePipeline(PipelineRegistry* pRegistry, const PipelineDesc* pDesc);
+
+/**
+	Drops a reference taken by acquirePipeline.
+
+	The pipeline stays alive without references, so releasing everything
+	before a reload and acquiring it again afterwards only rebuilds the
+	pipelines whose state actually changed.
+
+	@param pRegistry Registry the pipeline came from
+	@param pPipeline Pipeline to release, nullptr is ignored
+
+	@see flushUnusedPipelines
+*/
+RUNTIME_API void releasePipeline(PipelineRegistry* pRegistry, Pipeline* pPipeline);
+
+/**
+	Destroys every pipeline without references.
+
+	@param pRegistry Registry to flush
+
+	@return Number of pipelines destroyed
+
+	@note The GPU must be done with the pipelines, and it must run before
+	a shader they were built from is removed
+*/
+RUNTIME_API uint32_t flushUnusedPipelines(PipelineRegistry* pRegistry);
+
+/**
+	Gets the driver pipeline cache, for pipelines created outside the registry.
+
+	@param pRegistry Registry to query
+
+	@return The cache, nullptr if the renderer has none
+*/
+RUNTIME_API PipelineCache* getPipelineCache(PipelineRegistry* pRegistry);
+
+/**
+	Gets the registry counters.
+
+	@param pRegistry Registry to query
+	@param pOutStats Receives the counters
+*/
+RUNTIME_API void getPipelineRegistryStats(const PipelineRegistry* pRegistry,
+										  PipelineRegistryStats* pOutStats);
+
+#endif // _PIPELINE_REGISTRY_H_
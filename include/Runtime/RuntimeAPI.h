@@ -7,7 +7,9 @@
 #ifndef _RUNTIME_API_H_
 #define _RUNTIME_API_H_
 
-#ifdef RUNTIME_EXPORTS
+#if !defined(_WIN32)
+#define RUNTIME_API __attribute__((visibility("default")))
+#elif defined(RUNTIME_EXPORTS)
 #define RUNTIME_API __declspec(dllexport)
 #else
 #ifdef RUNTIME_STATIC
@@ -0,0 +1,179 @@
+/*
+ * Trace.h
+ *
+ * CPU instrumentation scopes recorded into per thread ring buffers, with
+ * a Chrome trace exporter and an optional Tracy backend.
+ */
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include "Runtime/RuntimeAPI.h"
+#include <stdint.h>
+
+/*
+	Build flags.
+
+	ENGINE_PROFILE_ENABLED 0 compiles every ENGINE_PROFILE_SCOPE out.
+	ENGINE_PROFILE_TRACY forwards the scopes to the Tracy client instead of
+	the ring buffers, the include path must then contain tracy/Tracy.hpp.
+*/
+#ifndef ENGINE_PROFILE_ENABLED
+#define ENGINE_PROFILE_ENABLED 1
+#endif
+
+#define TRACE_RING_CAPACITY 16384 ///< Slots per thread, the newest capacity - 1 events are kept
+#define TRACE_MAX_THREADS 128	  ///< Threads that can record, later ones are ignored
+
+/**
+	A finished scope.
+
+	@see traceSnapshot
+*/
+struct TraceEvent
+{
+	const char* pName;		///< Scope name, a string literal
+	uint64_t startNs;		///< traceNowNs() when the scope was entered
+	uint64_t endNs;			///< traceNowNs() when the scope was left
+	uint32_t threadIndex;	///< Recording thread, see traceGetThreadName
+};
+
+/**
+	Returns the trace clock.
+
+	@return Nanoseconds on a monotonic clock shared by every thread
+*/
+RUNTIME_API uint64_t traceNowNs();
+
+/**
+	Starts or stops recording.
+
+	Recording is on from startup, so the rings always hold the last
+	TRACE_RING_CAPACITY - 1 scopes of every thread when a stall needs a
+	dump. The slot the writer fills next is never reported.
+
+	@param enabled False makes ENGINE_PROFILE_SCOPE record nothing
+*/
+RUNTIME_API void traceSetEnabled(bool enabled);
+
+/**
+	Returns whether scopes are recorded.
+*/
+RUNTIME_API bool traceIsEnabled();
+
+/**
+	Names the calling thread in exported traces.
+
+	@param pName Thread name, must outlive the trace (nullptr keeps "Thread N")
+*/
+RUNTIME_API void traceSetThreadName(const char* pName);
+
+/**
+	Gets the name of a recording thread.
+
+	@param threadIndex TraceEvent::threadIndex
+
+	@return The name set with traceSetThreadName, or nullptr
+*/
+RUNTIME_API const char* traceGetThreadName(uint32_t threadIndex);
+
+/**
+	Enters a scope, used by ENGINE_PROFILE_SCOPE.
+
+	@return Start time, 0 while recording is off
+*/
+RUNTIME_API uint64_t traceBeginScope();
+
+/**
+	Leaves a scope and records it into the calling thread's ring.
+
+	Only the owning thread writes its ring. The event is published with
+	one release store, so recording never takes a lock.
+
+	@param pName Scope name, must outlive the trace
+	@param startNs Value returned by traceBeginScope, 0 records nothing
+*/
+RUNTIME_API void traceEndScope(const char* pName, uint64_t startNs);
+
+/**
+	Copies the recorded events of every thread.
+
+	Safe while other threads keep recording. Events a thread overwrote
+	during the copy are dropped.
+
+	@param pEvents Destination, nullptr only counts
+	@param maxEvents Capacity of pEvents
+
+	@return Events written, or the number available when pEvents is nullptr
+
+	@note Events are grouped by thread, oldest first within a thread
+*/
+RUNTIME_API uint32_t traceSnapshot(TraceEvent* pEvents, uint32_t maxEvents);
+
+/**
+	Forgets everything recorded so far, later snapshots start from here.
+*/
+RUNTIME_API void traceClear();
+
+/**
+	Writes the recorded events as Chrome trace event JSON.
+
+	The file opens in chrome://tracing, Perfetto, and Tracy through its
+	import-chrome tool.
+
+	@param pPath Output file
+
+	@return True if the file was written
+
+	@note Returns false with ENGINE_PROFILE_TRACY, the capture lives in Tracy
+*/
+RUNTIME_API bool traceWriteChromeJson(const char* pPath);
+
+#if ENGINE_PROFILE_ENABLED && defined(ENGINE_PROFILE_TRACY)
+
+#include "tracy/Tracy.hpp"
+
+#define ENGINE_PROFILE_SCOPE(name) ZoneScopedN(name)
+
+#elif ENGINE_PROFILE_ENABLED
+
+/**
+	Records the enclosing block as one TraceEvent.
+
+	@see ENGINE_PROFILE_SCOPE
+*/
+struct TraceScope
+{
+	const char* pName;
+	uint64_t startNs;
+
+	TraceScope(const char* pScopeName) : pName(pScopeName), startNs(traceBeginScope()) {}
+	~TraceScope() { traceEndScope(pName, startNs); }
+};
+
+#define ENGINE_PROFILE_CONCAT_INNER(a, b) a##b
+#define ENGINE_PROFILE_CONCAT(a, b) ENGINE_PROFILE_CONCAT_INNER(a, b)
+
+/**
+	Times the rest of the enclosing block.
+
+	@code
+	void TransformSystem(ecs_iter_t* it)
+	{
+		ENGINE_PROFILE_SCOPE("TransformSystem");
+		...
+	}
+	@endcode
+
+	@param name String literal shown in the trace
+*/
+#define ENGINE_PROFILE_SCOPE(name) \
+	TraceScope ENGINE_PROFILE_CONCAT(traceScope_, __LINE__)(name)
+
+#else
+
+#define ENGINE_PROFILE_SCOPE(name) ((void)0)
+
+#endif
+
+#endif // _TRACE_H_
@@ -0,0 +1,146 @@
+/*
+ * FrustumCull.cpp
+ *
+ */
+
+#include "Core/FrustumCull.h"
+#include <math.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define CULL_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define CULL_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+void extractFrustumPlanes(Frustum* pFrustum, const float* pViewProjection)
+{
+	if (!pFrustum || !pViewProjection)
+		return;
+
+	// Row r of a column major matrix is m[r], m[4 + r], m[8 + r], m[12 + r]
+	const float* m = pViewProjection;
+	float rows[4][4];
+	for (int r = 0; r < 4; ++r)
+	{
+		rows[r][0] = m[0 + r];
+		rows[r][1] = m[4 + r];
+		rows[r][2] = m[8 + r];
+		rows[r][3] = m[12 + r];
+	}
+
+	// left, right, bottom, top, near (z >= 0), far (z <= w)
+	float planes[6][4];
+	for (int c = 0; c < 4; ++c)
+	{
+		planes[0][c] = rows[3][c] + rows[0][c];
+		planes[1][c] = rows[3][c] - rows[0][c];
+		planes[2][c] = rows[3][c] + rows[1][c];
+		planes[3][c] = rows[3][c] - rows[1][c];
+		planes[4][c] = rows[2][c];
+		planes[5][c] = rows[3][c] - rows[2][c];
+	}
+
+	for (int p = 0; p < 6; ++p)
+	{
+		float length = sqrtf(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] +
+							 planes[p][2] * planes[p][2]);
+		float inverseLength = length > 0.0f ? 1.0f / length : 0.0f;
+
+		pFrustum->planeX[p] = planes[p][0] * inverseLength;
+		pFrustum->planeY[p] = planes[p][1] * inverseLength;
+		pFrustum->planeZ[p] = planes[p][2] * inverseLength;
+		pFrustum->planeW[p] = planes[p][3] * inverseLength;
+	}
+}
+
+static uint32_t cullSpheresRange(const Frustum* pFrustum, const float* pCenterX,
+								 const float* pCenterY, const float* pCenterZ,
+								 const float* pRadius, uint32_t first, uint32_t count,
+								 uint8_t* pVisible)
+{
+	uint32_t visibleCount = 0;
+	for (uint32_t i = first; i < first + count; ++i)
+	{
+		bool inside = true;
+		for (int p = 0; p < 6; ++p)
+		{
+			float distance = pFrustum->planeX[p] * pCenterX[i] + pFrustum->planeY[p] * pCenterY[i] +
+							 pFrustum->planeZ[p] * pCenterZ[i] + pFrustum->planeW[p];
+			inside = inside && distance >= -pRadius[i];
+		}
+
+		pVisible[i] = inside ? 1 : 0;
+		visibleCount += inside ? 1 : 0;
+	}
+
+	return visibleCount;
+}
+
+uint32_t cullSpheres(const Frustum* pFrustum, const float* pCenterX, const float* pCenterY,
+					 const float* pCenterZ, const float* pRadius, uint32_t count,
+					 uint8_t* pVisible)
+{
+	if (!pFrustum || !pCenterX || !pCenterY || !pCenterZ || !pRadius || !pVisible)
+		return 0;
+
+	uint32_t visibleCount = 0;
+	uint32_t i = 0;
+
+#if CULL_SIMD_SSE2
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(pCenterX + i);
+		__m128 y = _mm_loadu_ps(pCenterY + i);
+		__m128 z = _mm_loadu_ps(pCenterZ + i);
+		__m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(pRadius + i));
+
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = 0; p < 6; ++p)
+		{
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(pFrustum->planeX[p]), x),
+						   _mm_mul_ps(_mm_set1_ps(pFrustum->planeY[p]), y)),
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(pFrustum->planeZ[p]), z),
+						   _mm_set1_ps(pFrustum->planeW[p])));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+		for (uint32_t lane = 0; lane < 4; ++lane)
+			pVisible[i + lane] = (uint8_t)((mask >> lane) & 1);
+		visibleCount += (uint32_t)((mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) +
+								   ((mask >> 3) & 1));
+	}
+#elif CULL_SIMD_NEON
+	for (; i + 4 <= count; i += 4)
+	{
+		float32x4_t x = vld1q_f32(pCenterX + i);
+		float32x4_t y = vld1q_f32(pCenterY + i);
+		float32x4_t z = vld1q_f32(pCenterZ + i);
+		float32x4_t negRadius = vnegq_f32(vld1q_f32(pRadius + i));
+
+		uint32x4_t inside = vdupq_n_u32(0xFFFFFFFFu);
+		for (int p = 0; p < 6; ++p)
+		{
+			float32x4_t distance = vdupq_n_f32(pFrustum->planeW[p]);
+			distance = vmlaq_n_f32(distance, x, pFrustum->planeX[p]);
+			distance = vmlaq_n_f32(distance, y, pFrustum->planeY[p]);
+			distance = vmlaq_n_f32(distance, z, pFrustum->planeZ[p]);
+			inside = vandq_u32(inside, vcgeq_f32(distance, negRadius));
+		}
+
+		uint32x4_t bits = vshrq_n_u32(inside, 31);
+		pVisible[i + 0] = (uint8_t)vgetq_lane_u32(bits, 0);
+		pVisible[i + 1] = (uint8_t)vgetq_lane_u32(bits, 1);
+		pVisible[i + 2] = (uint8_t)vgetq_lane_u32(bits, 2);
+		pVisible[i + 3] = (uint8_t)vgetq_lane_u32(bits, 3);
+		visibleCount += vaddvq_u32(bits);
+	}
+#endif
+
+	visibleCount += cullSpheresRange(pFrustum, pCenterX, pCenterY, pCenterZ, pRadius, i,
+									 count - i, pVisible);
+	return visibleCount;
+}
@@ -4,53 +4,204 @@
  */
 
 #include "Core/HashMap.h"
+#include "Runtime/Memory/Arena.h"
 #include "Utilities/Interfaces/ILog.h"
-#include <map>
-#include <string>
-#include <cstring>
+#include <string.h>
 
-// Temporary std::map-based implementation
-// TODO: Replace with arena-based hash table
-struct HashMapImpl
+#define HASHMAP_INITIAL_CAPACITY 16
+#define HASHMAP_VALUE_ALIGN 16
+
+/**
+	Stored key-value pair.
+
+	The value bytes follow the header directly. Entries never move once
+	allocated, so pointers returned by hashMapGet stay valid until the key
+	is removed. Removed entries are kept on a free list along with their
+	key buffer, which is reused when the next key fits.
+*/
+struct HashMapEntry
+{
+	HashMapEntry* pNextFree; ///< Free list link while unused
+	char* pKey;				 ///< Interned key string
+	uint32_t keyLength;		 ///< Key length without terminator
+	uint32_t keyCapacity;	 ///< Size of the pKey buffer in bytes
+	uint32_t hash;			 ///< Precomputed key hash
+	uint32_t _pad;			 ///< Padding so values are 16 byte aligned
+};
+static_assert(sizeof(HashMapEntry) % HASHMAP_VALUE_ALIGN == 0,
+			  "HashMapEntry header must keep values aligned");
+
+static inline void* hashMapEntryValue(HashMapEntry* pEntry)
 {
-	std::map<std::string, uint8_t*> map;
-	uint32_t valueSize;
-	uint32_t count;
+	return (uint8_t*)pEntry + sizeof(HashMapEntry);
+}
 
-	HashMapImpl(uint32_t vs)
-	: valueSize(vs)
-	, count(0)
+static inline uint32_t hashMapProbeDistance(const HashMap* pHashMap, uint32_t slot, uint32_t hash)
+{
+	uint32_t mask = pHashMap->capacity - 1;
+	return (slot - (hash & mask)) & mask;
+}
+
+static uint32_t hashMapFindSlot(const HashMap* pHashMap, const char* key, uint32_t keyLength,
+								uint32_t hash)
+{
+	uint32_t mask = pHashMap->capacity - 1;
+	uint32_t slot = hash & mask;
+
+	for (uint32_t distance = 0;; ++distance)
 	{
+		uint32_t slotHash = pHashMap->pHashes[slot];
+
+		// Robin Hood invariant: once we pass an entry closer to its home slot
+		// than we are, the key cannot be further along.
+		if (slotHash == 0 || hashMapProbeDistance(pHashMap, slot, slotHash) < distance)
+			return UINT32_MAX;
+
+		if (slotHash == hash)
+		{
+			HashMapEntry* pEntry = pHashMap->ppEntries[slot];
+			if (pEntry->keyLength == keyLength && memcmp(pEntry->pKey, key, keyLength) == 0)
+				return slot;
+		}
+
+		slot = (slot + 1) & mask;
 	}
+}
+
+static void hashMapPlace(HashMap* pHashMap, uint32_t hash, HashMapEntry* pEntry)
+{
+	uint32_t mask = pHashMap->capacity - 1;
+	uint32_t slot = hash & mask;
+	uint32_t distance = 0;
 
-	~HashMapImpl()
+	for (;;)
 	{
-		for (auto& pair : map)
+		uint32_t slotHash = pHashMap->pHashes[slot];
+		if (slotHash == 0)
+		{
+			pHashMap->pHashes[slot] = hash;
+			pHashMap->ppEntries[slot] = pEntry;
+			return;
+		}
+
+		// Take the slot from entries that are closer to their home slot.
+		uint32_t slotDistance = hashMapProbeDistance(pHashMap, slot, slotHash);
+		if (slotDistance < distance)
 		{
-			delete[] pair.second;
+			HashMapEntry* pDisplaced = pHashMap->ppEntries[slot];
+			pHashMap->pHashes[slot] = hash;
+			pHashMap->ppEntries[slot] = pEntry;
+
+			hash = slotHash;
+			pEntry = pDisplaced;
+			distance = slotDistance;
 		}
+
+		slot = (slot + 1) & mask;
+		distance++;
 	}
-};
+}
 
-HashMap* hashMapCreate(Arena* pArena, uint32_t valueSize)
+static bool hashMapAllocSlots(HashMap* pHashMap, uint32_t capacity)
 {
-	(void)pArena;
+	uint32_t* pHashes = arenaPushArray<uint32_t>(pHashMap->pArena, capacity);
+	HashMapEntry** ppEntries = arenaPushArrayNoZero<HashMapEntry*>(pHashMap->pArena, capacity);
+
+	if (!pHashes || !ppEntries)
+		return false;
 
-	if (valueSize == 0)
+	pHashMap->pHashes = pHashes;
+	pHashMap->ppEntries = ppEntries;
+	pHashMap->capacity = capacity;
+	return true;
+}
+
+static bool hashMapGrow(HashMap* pHashMap)
+{
+	// Old slot arrays stay in the arena.
+	uint32_t* pOldHashes = pHashMap->pHashes;
+	HashMapEntry** ppOldEntries = pHashMap->ppEntries;
+	uint32_t oldCapacity = pHashMap->capacity;
+
+	if (!hashMapAllocSlots(pHashMap, oldCapacity * 2))
+	{
+		LOGF(eERROR, "HashMap: Failed to grow capacity from %u to %u", oldCapacity,
+			 oldCapacity * 2);
+		return false;
+	}
+
+	for (uint32_t i = 0; i < oldCapacity; ++i)
+	{
+		if (pOldHashes[i] != 0)
+			hashMapPlace(pHashMap, pOldHashes[i], ppOldEntries[i]);
+	}
+
+	return true;
+}
+
+static HashMapEntry* hashMapAllocEntry(HashMap* pHashMap, const char* key, uint32_t keyLength,
+									   uint32_t hash)
+{
+	HashMapEntry* pEntry = pHashMap->pFreeList;
+	if (pEntry)
+	{
+		pHashMap->pFreeList = pEntry->pNextFree;
+	}
+	else
+	{
+		pEntry = (HashMapEntry*)arenaPush(pHashMap->pArena,
+										  sizeof(HashMapEntry) + pHashMap->valueSize,
+										  HASHMAP_VALUE_ALIGN);
+		if (!pEntry)
+			return nullptr;
+
+		pEntry->pKey = nullptr;
+		pEntry->keyCapacity = 0;
+	}
+
+	// Intern the key, reusing the previous key buffer when it is large enough.
+	if (keyLength + 1 > pEntry->keyCapacity)
+	{
+		char* pKey = arenaPushArrayNoZero<char>(pHashMap->pArena, keyLength + 1);
+		if (!pKey)
+		{
+			pEntry->pNextFree = pHashMap->pFreeList;
+			pHashMap->pFreeList = pEntry;
+			return nullptr;
+		}
+
+		pEntry->pKey = pKey;
+		pEntry->keyCapacity = keyLength + 1;
+	}
+
+	memcpy(pEntry->pKey, key, keyLength + 1);
+	pEntry->pNextFree = nullptr;
+	pEntry->keyLength = keyLength;
+	pEntry->hash = hash;
+	return pEntry;
+}
+
+HashMap* hashMapCreate(Arena* pArena, uint32_t valueSize)
+{
+	if (!pArena || valueSize == 0)
 		return nullptr;
 
-	HashMap* pHashMap = new HashMap();
+	HashMap* pHashMap = arenaPushStruct<HashMap>(pArena);
 	if (!pHashMap)
 		return nullptr;
 
-	pHashMap->pImpl = new HashMapImpl(valueSize);
-	if (!pHashMap->pImpl)
+	pHashMap->pArena = pArena;
+	pHashMap->pFreeList = nullptr;
+	pHashMap->count = 0;
+	pHashMap->valueSize = valueSize;
+
+	if (!hashMapAllocSlots(pHashMap, HASHMAP_INITIAL_CAPACITY))
 	{
-		delete pHashMap;
+		LOGF(eERROR, "HashMap: Failed to allocate slots for capacity %u",
+			 HASHMAP_INITIAL_CAPACITY);
 		return nullptr;
 	}
 
-	pHashMap->valueSize = valueSize;
 	return pHashMap;
 }
 
@@ -59,76 +210,131 @@ void hashMapDestroy(HashMap* pHashMap)
 	if (!pHashMap)
 		return;
 
-	if (pHashMap->pImpl)
-	{
-		HashMapImpl* pImpl = (HashMapImpl*)pHashMap->pImpl;
-		delete pImpl;
-	}
-
-	delete pHashMap;
+	// Memory belongs to the arena, just leave the map in an empty state.
+	memset(pHashMap->pHashes, 0, sizeof(uint32_t) * pHashMap->capacity);
+	pHashMap->pFreeList = nullptr;
+	pHashMap->count = 0;
 }
 
-void hashMapInsertImpl(HashMap* pHashMap, const char* key, const void* pValue)
+void hashMapInsertHashedImpl(HashMap* pHashMap, HashedKey key, const void* pValue)
 {
-	if (!pHashMap || !key || !pValue)
+	if (!pHashMap || !key.pKey || !pValue)
 		return;
 
-	HashMapImpl* pImpl = (HashMapImpl*)pHashMap->pImpl;
-
-	auto it = pImpl->map.find(key);
-	if (it != pImpl->map.end())
+	uint32_t slot = hashMapFindSlot(pHashMap, key.pKey, key.length, key.hash);
+	if (slot != UINT32_MAX)
 	{
-		std::memcpy(it->second, pValue, pImpl->valueSize);
+		memcpy(hashMapEntryValue(pHashMap->ppEntries[slot]), pValue, pHashMap->valueSize);
+		return;
 	}
-	else
+
+	// Keep the load factor at or below 75%.
+	if ((pHashMap->count + 1) * 4 > pHashMap->capacity * 3)
 	{
-		uint8_t* pStorage = new uint8_t[pImpl->valueSize];
-		std::memcpy(pStorage, pValue, pImpl->valueSize);
+		if (!hashMapGrow(pHashMap))
+			return;
+	}
 
-		pImpl->map[key] = pStorage;
-		pImpl->count++;
+	HashMapEntry* pEntry = hashMapAllocEntry(pHashMap, key.pKey, key.length, key.hash);
+	if (!pEntry)
+	{
+		LOGF(eERROR, "HashMap: Failed to allocate entry for key '%s'", key.pKey);
+		return;
 	}
+
+	memcpy(hashMapEntryValue(pEntry), pValue, pHashMap->valueSize);
+	hashMapPlace(pHashMap, key.hash, pEntry);
+	pHashMap->count++;
 }
 
-void* hashMapGetImpl(HashMap* pHashMap, const char* key)
+void* hashMapGetHashedImpl(HashMap* pHashMap, HashedKey key)
 {
-	if (!pHashMap || !key)
+	if (!pHashMap || !key.pKey)
+		return nullptr;
+
+	uint32_t slot = hashMapFindSlot(pHashMap, key.pKey, key.length, key.hash);
+	if (slot == UINT32_MAX)
 		return nullptr;
 
-	HashMapImpl* pImpl = (HashMapImpl*)pHashMap->pImpl;
+	return hashMapEntryValue(pHashMap->ppEntries[slot]);
+}
+
+bool hashMapContainsHashed(HashMap* pHashMap, HashedKey key)
+{
+	return hashMapGetHashedImpl(pHashMap, key) != nullptr;
+}
+
+void hashMapRemoveHashed(HashMap* pHashMap, HashedKey key)
+{
+	if (!pHashMap || !key.pKey)
+		return;
+
+	uint32_t slot = hashMapFindSlot(pHashMap, key.pKey, key.length, key.hash);
+	if (slot == UINT32_MAX)
+		return;
+
+	HashMapEntry* pEntry = pHashMap->ppEntries[slot];
+	pEntry->pNextFree = pHashMap->pFreeList;
+	pHashMap->pFreeList = pEntry;
+
+	// Backward shift deletion. Pull following entries one slot closer to
+	// their home until we hit an empty slot or an entry already at home.
+	uint32_t mask = pHashMap->capacity - 1;
+	uint32_t next = (slot + 1) & mask;
 
-	auto it = pImpl->map.find(key);
-	if (it != pImpl->map.end())
+	while (pHashMap->pHashes[next] != 0 &&
+		   hashMapProbeDistance(pHashMap, next, pHashMap->pHashes[next]) != 0)
 	{
-		return it->second;
+		pHashMap->pHashes[slot] = pHashMap->pHashes[next];
+		pHashMap->ppEntries[slot] = pHashMap->ppEntries[next];
+		slot = next;
+		next = (next + 1) & mask;
 	}
 
-	return nullptr;
+	pHashMap->pHashes[slot] = 0;
+	pHashMap->ppEntries[slot] = nullptr;
+	pHashMap->count--;
 }
 
-bool hashMapContains(HashMap* pHashMap, const char* key)
+const char* hashMapGetKey(HashMap* pHashMap, HashedKey key)
 {
-	if (!pHashMap || !key)
-		return false;
+	if (!pHashMap || !key.pKey)
+		return nullptr;
 
-	HashMapImpl* pImpl = (HashMapImpl*)pHashMap->pImpl;
-	return pImpl->map.find(key) != pImpl->map.end();
+	uint32_t slot = hashMapFindSlot(pHashMap, key.pKey, key.length, key.hash);
+	if (slot == UINT32_MAX)
+		return nullptr;
+
+	return pHashMap->ppEntries[slot]->pKey;
 }
 
-void hashMapRemove(HashMap* pHashMap, const char* key)
+void hashMapInsertImpl(HashMap* pHashMap, const char* key, const void* pValue)
 {
-	if (!pHashMap || !key)
+	if (!key)
 		return;
 
-	HashMapImpl* pImpl = (HashMapImpl*)pHashMap->pImpl;
+	hashMapInsertHashedImpl(pHashMap, hashedKeyFromString(key), pValue);
+}
 
-	auto it = pImpl->map.find(key);
-	if (it != pImpl->map.end())
-	{
-		delete[] it->second;
-		pImpl->map.erase(it);
-		pImpl->count--;
-	}
+void* hashMapGetImpl(HashMap* pHashMap, const char* key)
+{
+	if (!key)
+		return nullptr;
+
+	return hashMapGetHashedImpl(pHashMap, hashedKeyFromString(key));
+}
+
+bool hashMapContains(HashMap* pHashMap, const char* key)
+{
+	return hashMapGetImpl(pHashMap, key) != nullptr;
+}
+
+void hashMapRemove(HashMap* pHashMap, const char* key)
+{
+	if (!key)
+		return;
+
+	hashMapRemoveHashed(pHashMap, hashedKeyFromString(key));
 }
 
 uint32_t hashMapCount(HashMap* pHashMap)
@@ -136,6 +342,5 @@ uint32_t hashMapCount(HashMap* pHashMap)
 	if (!pHashMap)
 		return 0;
 
-	HashMapImpl* pImpl = (HashMapImpl*)pHashMap->pImpl;
-	return pImpl->count;
+	return pHashMap->count;
 }
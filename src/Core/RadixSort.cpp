@@ -0,0 +1,77 @@
+/*
+ * RadixSort.cpp
+ *
+ */
+
+#include "Core/RadixSort.h"
+#include <string.h>
+
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1u << RADIX_BITS)
+#define RADIX_PASSES (64 / RADIX_BITS)
+
+void radixSort64(uint64_t* pKeys, uint32_t* pValues, uint64_t* pTempKeys, uint32_t* pTempValues,
+				 uint32_t count)
+{
+	if (!pKeys || !pValues || !pTempKeys || !pTempValues || count < 2)
+		return;
+
+	uint32_t histograms[RADIX_PASSES][RADIX_BUCKETS];
+	memset(histograms, 0, sizeof(histograms));
+
+	// Build every histogram in a single read of the keys
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		uint64_t key = pKeys[i];
+		for (uint32_t pass = 0; pass < RADIX_PASSES; ++pass)
+			histograms[pass][(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+	}
+
+	uint64_t* pSrcKeys = pKeys;
+	uint32_t* pSrcValues = pValues;
+	uint64_t* pDstKeys = pTempKeys;
+	uint32_t* pDstValues = pTempValues;
+
+	for (uint32_t pass = 0; pass < RADIX_PASSES; ++pass)
+	{
+		uint32_t* pHistogram = histograms[pass];
+		uint32_t shift = pass * RADIX_BITS;
+
+		// All keys share this digit, the pass would not move anything
+		uint32_t firstDigit = (uint32_t)((pSrcKeys[0] >> shift) & (RADIX_BUCKETS - 1));
+		if (pHistogram[firstDigit] == count)
+			continue;
+
+		// Exclusive prefix sum turns counts into write offsets
+		uint32_t offset = 0;
+		for (uint32_t bucket = 0; bucket < RADIX_BUCKETS; ++bucket)
+		{
+			uint32_t bucketCount = pHistogram[bucket];
+			pHistogram[bucket] = offset;
+			offset += bucketCount;
+		}
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			uint64_t key = pSrcKeys[i];
+			uint32_t dst = pHistogram[(key >> shift) & (RADIX_BUCKETS - 1)]++;
+			pDstKeys[dst] = key;
+			pDstValues[dst] = pSrcValues[i];
+		}
+
+		uint64_t* pSwapKeys = pSrcKeys;
+		pSrcKeys = pDstKeys;
+		pDstKeys = pSwapKeys;
+
+		uint32_t* pSwapValues = pSrcValues;
+		pSrcValues = pDstValues;
+		pDstValues = pSwapValues;
+	}
+
+	// An odd number of executed passes leaves the result in the temp arrays
+	if (pSrcKeys != pKeys)
+	{
+		memcpy(pKeys, pSrcKeys, sizeof(uint64_t) * count);
+		memcpy(pValues, pSrcValues, sizeof(uint32_t) * count);
+	}
+}
@@ -5,25 +5,77 @@
 
 #include "Core/SlotMap.h"
 #include "Runtime/Memory/Arena.h"
+#include "Runtime/Memory/Pool.h"
 #include "Utilities/Interfaces/ILog.h"
 #include <assert.h>
 #include <string.h>
 
-static void slotMapGrow(SlotMap* pSlotMap)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SLOTMAP_PREFETCH(p) _mm_prefetch((const char*)(p), _MM_HINT_T0)
+#else
+#define SLOTMAP_PREFETCH(p) __builtin_prefetch((p))
+#endif
+
+// Batch calls look this many handles ahead. The sparse arrays are fetched at
+// twice the distance so the dense index is resident by the time the value
+// address is needed
+#define SLOTMAP_PREFETCH_DISTANCE 8
+
+static void* slotMapAllocStorage(SlotMap* pSlotMap, uint64_t size, uint32_t align)
+{
+	if (pSlotMap->pStoragePools)
+		return poolSetAlloc(pSlotMap->pStoragePools, size);
+	return arenaPush(pSlotMap->pArena, size, align);
+}
+
+static void slotMapFreeStorage(SlotMap* pSlotMap, void* pStorage, uint64_t size)
+{
+	// Arena storage is stranded until the arena is cleared
+	if (pSlotMap->pStoragePools)
+		poolSetFree(pSlotMap->pStoragePools, pStorage, size);
+}
+
+static void slotMapFreeArrays(SlotMap* pSlotMap, void* pValues, uint32_t* pIndices,
+							  uint32_t* pGenerations, uint32_t* pErase, uint32_t capacity)
 {
-	uint32_t newCapacity = pSlotMap->capacity * 2;
+	slotMapFreeStorage(pSlotMap, pValues, (uint64_t)pSlotMap->valueSize * capacity);
+	slotMapFreeStorage(pSlotMap, pIndices, sizeof(uint32_t) * (uint64_t)capacity);
+	slotMapFreeStorage(pSlotMap, pGenerations, sizeof(uint32_t) * (uint64_t)capacity);
+	slotMapFreeStorage(pSlotMap, pErase, sizeof(uint32_t) * (uint64_t)capacity);
+}
 
-	void* pNewValues = arenaPush(pSlotMap->pArena, pSlotMap->valueSize * newCapacity,
-								 pSlotMap->valueAlign);
-	uint32_t* pNewIndices = arenaPushArray<uint32_t>(pSlotMap->pArena, newCapacity);
-	uint32_t* pNewGenerations = arenaPushArray<uint32_t>(pSlotMap->pArena, newCapacity);
-	uint32_t* pNewErase = arenaPushArray<uint32_t>(pSlotMap->pArena, newCapacity);
+static bool slotMapAllocArrays(SlotMap* pSlotMap, uint32_t capacity, void** ppValues,
+							   uint32_t** ppIndices, uint32_t** ppGenerations, uint32_t** ppErase)
+{
+	*ppValues = slotMapAllocStorage(pSlotMap, (uint64_t)pSlotMap->valueSize * capacity,
+									pSlotMap->valueAlign);
+	*ppIndices = (uint32_t*)slotMapAllocStorage(pSlotMap, sizeof(uint32_t) * (uint64_t)capacity,
+												alignof(uint32_t));
+	*ppGenerations = (uint32_t*)slotMapAllocStorage(
+		pSlotMap, sizeof(uint32_t) * (uint64_t)capacity, alignof(uint32_t));
+	*ppErase = (uint32_t*)slotMapAllocStorage(pSlotMap, sizeof(uint32_t) * (uint64_t)capacity,
+											  alignof(uint32_t));
+
+	if (*ppValues && *ppIndices && *ppGenerations && *ppErase)
+		return true;
+
+	slotMapFreeArrays(pSlotMap, *ppValues, *ppIndices, *ppGenerations, *ppErase, capacity);
+	return false;
+}
 
-	if (!pNewValues || !pNewIndices || !pNewGenerations || !pNewErase)
+static bool slotMapResize(SlotMap* pSlotMap, uint32_t newCapacity)
+{
+	void* pNewValues;
+	uint32_t* pNewIndices;
+	uint32_t* pNewGenerations;
+	uint32_t* pNewErase;
+	if (!slotMapAllocArrays(pSlotMap, newCapacity, &pNewValues, &pNewIndices, &pNewGenerations,
+							&pNewErase))
 	{
 		LOGF(eERROR, "SlotMap: Failed to grow capacity from %u to %u", pSlotMap->capacity,
 			 newCapacity);
-		return;
+		return false;
 	}
 
 	memcpy(pNewValues, pSlotMap->pValues, pSlotMap->valueSize * pSlotMap->count);
@@ -37,39 +89,62 @@ static void slotMapGrow(SlotMap* pSlotMap)
 		pNewGenerations[i] = 0;
 	}
 
+	slotMapFreeArrays(pSlotMap, pSlotMap->pValues, pSlotMap->pIndices, pSlotMap->pGenerations,
+					  pSlotMap->pErase, pSlotMap->capacity);
+
 	pSlotMap->pValues = pNewValues;
 	pSlotMap->pIndices = pNewIndices;
 	pSlotMap->pGenerations = pNewGenerations;
 	pSlotMap->pErase = pNewErase;
 	pSlotMap->capacity = newCapacity;
+	return true;
 }
 
-SlotMap* slotMapCreate(Arena* pArena, uint32_t valueSize, uint32_t valueAlign,
-					   uint32_t initialCapacity)
+static void slotMapGrow(SlotMap* pSlotMap)
 {
-	if (!pArena || valueSize == 0 || initialCapacity == 0)
-		return nullptr;
+	uint64_t newCapacity = (uint64_t)pSlotMap->capacity * 2;
+	if (newCapacity > pSlotMap->maxCapacity)
+		newCapacity = pSlotMap->maxCapacity;
 
-	SlotMap* pSlotMap = arenaPushStruct<SlotMap>(pArena);
-	if (!pSlotMap)
-		return nullptr;
+	if (newCapacity > pSlotMap->capacity)
+		slotMapResize(pSlotMap, (uint32_t)newCapacity);
+}
+
+/**
+	Fills in a slot map pushed by one of the create functions.
+
+	@return false if the arrays could not be allocated
+*/
+template <typename HandleType>
+static bool slotMapInit(SlotMap* pSlotMap, Arena* pArena, uint32_t valueSize, uint32_t valueAlign,
+						uint32_t initialCapacity, PoolSet* pStoragePools)
+{
+	typedef HandleTraits<HandleType> Traits;
+
+	if (initialCapacity > Traits::MAX_SLOTS)
+	{
+		LOGF(eERROR, "SlotMap: Capacity %u exceeds the %u slots a handle can address",
+			 initialCapacity, Traits::MAX_SLOTS);
+		return false;
+	}
 
 	pSlotMap->pArena = pArena;
+	pSlotMap->pStoragePools = pStoragePools;
 	pSlotMap->capacity = initialCapacity;
 	pSlotMap->count = 0;
 	pSlotMap->freeHead = UINT32_MAX;
+	pSlotMap->nextSlot = 0;
+	pSlotMap->retiredCount = 0;
+	pSlotMap->maxGeneration = Traits::MAX_GENERATION;
+	pSlotMap->maxCapacity = Traits::MAX_SLOTS;
 	pSlotMap->valueSize = valueSize;
 	pSlotMap->valueAlign = valueAlign >= 8 ? valueAlign : 8;
 
-	pSlotMap->pValues = arenaPush(pArena, valueSize * initialCapacity, pSlotMap->valueAlign);
-	pSlotMap->pIndices = arenaPushArray<uint32_t>(pArena, initialCapacity);
-	pSlotMap->pGenerations = arenaPushArray<uint32_t>(pArena, initialCapacity);
-	pSlotMap->pErase = arenaPushArray<uint32_t>(pArena, initialCapacity);
-
-	if (!pSlotMap->pValues || !pSlotMap->pIndices || !pSlotMap->pGenerations || !pSlotMap->pErase)
+	if (!slotMapAllocArrays(pSlotMap, initialCapacity, &pSlotMap->pValues, &pSlotMap->pIndices,
+							&pSlotMap->pGenerations, &pSlotMap->pErase))
 	{
 		LOGF(eERROR, "SlotMap: Failed to allocate arrays for capacity %u", initialCapacity);
-		return nullptr;
+		return false;
 	}
 
 	for (uint32_t i = 0; i < initialCapacity; i++)
@@ -78,25 +153,90 @@ SlotMap* slotMapCreate(Arena* pArena, uint32_t valueSize, uint32_t valueAlign,
 		pSlotMap->pGenerations[i] = 0;
 	}
 
-	return pSlotMap;
+	return true;
 }
 
-uint32_t slotMapInsertImpl(SlotMap* pSlotMap, const void* pValue)
+static bool slotMapCheckParams(Arena* pArena, uint32_t valueSize, uint32_t valueAlign,
+							   uint32_t initialCapacity, PoolSet* pStoragePools)
 {
-	if (!pSlotMap || !pValue)
-		return HANDLE_INVALID_ID;
+	if (!pArena || valueSize == 0 || initialCapacity == 0)
+		return false;
 
-	if (pSlotMap->count >= pSlotMap->capacity)
+	if (pStoragePools && valueAlign > 64)
 	{
-		slotMapGrow(pSlotMap);
-
-		if (pSlotMap->count >= pSlotMap->capacity)
-		{
-			LOGF(eERROR, "SlotMap: Failed to grow, insertion failed");
-			return HANDLE_INVALID_ID;
-		}
+		LOGF(eERROR, "SlotMap: Pooled storage is 64 byte aligned, %u requested", valueAlign);
+		return false;
 	}
 
+	return true;
+}
+
+SlotMap* slotMapCreate(Arena* pArena, uint32_t valueSize, uint32_t valueAlign,
+					   uint32_t initialCapacity, PoolSet* pStoragePools)
+{
+	if (!slotMapCheckParams(pArena, valueSize, valueAlign, initialCapacity, pStoragePools))
+		return nullptr;
+
+	SlotMap* pSlotMap = arenaPushStruct<SlotMap>(pArena);
+	if (!pSlotMap || !slotMapInit<uint32_t>(pSlotMap, pArena, valueSize, valueAlign,
+											initialCapacity, pStoragePools))
+		return nullptr;
+
+	return pSlotMap;
+}
+
+SlotMap64* slotMapCreate64(Arena* pArena, uint32_t valueSize, uint32_t valueAlign,
+						   uint32_t initialCapacity, PoolSet* pStoragePools)
+{
+	if (!slotMapCheckParams(pArena, valueSize, valueAlign, initialCapacity, pStoragePools))
+		return nullptr;
+
+	SlotMap64* pSlotMap = arenaPushStruct<SlotMap64>(pArena);
+	if (!pSlotMap || !slotMapInit<uint64_t>(pSlotMap, pArena, valueSize, valueAlign,
+											initialCapacity, pStoragePools))
+		return nullptr;
+
+	return pSlotMap;
+}
+
+void slotMapDestroy(SlotMap* pSlotMap)
+{
+	if (!pSlotMap || !pSlotMap->pValues)
+		return;
+
+	slotMapFreeArrays(pSlotMap, pSlotMap->pValues, pSlotMap->pIndices, pSlotMap->pGenerations,
+					  pSlotMap->pErase, pSlotMap->capacity);
+
+	pSlotMap->pValues = nullptr;
+	pSlotMap->pIndices = nullptr;
+	pSlotMap->pGenerations = nullptr;
+	pSlotMap->pErase = nullptr;
+	pSlotMap->capacity = 0;
+	pSlotMap->count = 0;
+	pSlotMap->freeHead = UINT32_MAX;
+	pSlotMap->nextSlot = 0;
+	pSlotMap->retiredCount = 0;
+}
+
+/**
+	Checks whether another insert fits without growing.
+
+	Retired slots count against the capacity, they are never handed out
+	again but still occupy their sparse entry.
+*/
+static inline bool slotMapHasFreeSlot(const SlotMap* pSlotMap)
+{
+	return pSlotMap->count + pSlotMap->retiredCount < pSlotMap->capacity;
+}
+
+/**
+	Inserts without checking capacity.
+
+	@note Caller guarantees slotMapHasFreeSlot
+*/
+template <typename HandleType>
+static HandleType slotMapInsertReserved(SlotMap* pSlotMap, const void* pValue)
+{
 	uint32_t sparseIndex;
 
 	if (pSlotMap->freeHead != UINT32_MAX)
@@ -106,17 +246,8 @@ uint32_t slotMapInsertImpl(SlotMap* pSlotMap, const void* pValue)
 	}
 	else
 	{
-		sparseIndex = pSlotMap->count;
-
-		if (sparseIndex >= pSlotMap->capacity)
-		{
-			slotMapGrow(pSlotMap);
-			if (sparseIndex >= pSlotMap->capacity)
-			{
-				LOGF(eERROR, "SlotMap: Out of sparse indices");
-				return HANDLE_INVALID_ID;
-			}
-		}
+		// Without free slots every slot below nextSlot is live or retired
+		sparseIndex = pSlotMap->nextSlot++;
 	}
 
 	uint32_t denseIndex = pSlotMap->count;
@@ -129,16 +260,39 @@ uint32_t slotMapInsertImpl(SlotMap* pSlotMap, const void* pValue)
 	memcpy(pDest, pValue, pSlotMap->valueSize);
 
 	uint32_t generation = pSlotMap->pGenerations[sparseIndex];
-	return handleMake(sparseIndex, generation);
+	return HandleTraits<HandleType>::make(sparseIndex, generation);
 }
 
-void* slotMapGetImpl(SlotMap* pSlotMap, uint32_t handle)
+template <typename HandleType>
+static HandleType slotMapInsertT(SlotMap* pSlotMap, const void* pValue)
+{
+	if (!pSlotMap || !pValue)
+		return HandleTraits<HandleType>::INVALID;
+
+	if (!slotMapHasFreeSlot(pSlotMap))
+	{
+		slotMapGrow(pSlotMap);
+
+		if (!slotMapHasFreeSlot(pSlotMap))
+		{
+			LOGF(eERROR, "SlotMap: Failed to grow, insertion failed");
+			return HandleTraits<HandleType>::INVALID;
+		}
+	}
+
+	return slotMapInsertReserved<HandleType>(pSlotMap, pValue);
+}
+
+template <typename HandleType>
+static void* slotMapGetT(SlotMap* pSlotMap, HandleType handle)
 {
-	if (!pSlotMap || !handleIsValid(handle))
+	typedef HandleTraits<HandleType> Traits;
+
+	if (!pSlotMap || !Traits::isValid(handle))
 		return nullptr;
 
-	uint32_t sparseIndex = handleIndex(handle);
-	uint32_t generation = handleGeneration(handle);
+	uint32_t sparseIndex = Traits::index(handle);
+	uint32_t generation = Traits::generation(handle);
 
 	if (sparseIndex >= pSlotMap->capacity)
 		return nullptr;
@@ -154,15 +308,18 @@ void* slotMapGetImpl(SlotMap* pSlotMap, uint32_t handle)
 	return (uint8_t*)pSlotMap->pValues + (denseIndex * pSlotMap->valueSize);
 }
 
-void slotMapRemoveImpl(SlotMap* pSlotMap, uint32_t handle)
+template <typename HandleType>
+static void slotMapRemoveT(SlotMap* pSlotMap, HandleType handle)
 {
+	typedef HandleTraits<HandleType> Traits;
+
 	// To keep the array dense, we copy over the last element into the removed
 	// slot, and remove the last element. Swap and Pop.
-	if (!pSlotMap || !handleIsValid(handle))
+	if (!pSlotMap || !Traits::isValid(handle))
 		return;
 
-	uint32_t sparseIndex = handleIndex(handle);
-	uint32_t generation = handleGeneration(handle);
+	uint32_t sparseIndex = Traits::index(handle);
+	uint32_t generation = Traits::generation(handle);
 
 	if (sparseIndex >= pSlotMap->capacity)
 		return;
@@ -190,18 +347,31 @@ void slotMapRemoveImpl(SlotMap* pSlotMap, uint32_t handle)
 
 	pSlotMap->count--;
 
-	pSlotMap->pGenerations[sparseIndex]++;
+	// The next generation would wrap around and match handles that are long
+	// gone, so the slot is retired. It keeps its last generation and an empty
+	// index, which no handle resolves against
+	if (generation >= pSlotMap->maxGeneration)
+	{
+		pSlotMap->pIndices[sparseIndex] = UINT32_MAX;
+		pSlotMap->retiredCount++;
+		return;
+	}
+
+	pSlotMap->pGenerations[sparseIndex] = generation + 1;
 	pSlotMap->pIndices[sparseIndex] = pSlotMap->freeHead;
 	pSlotMap->freeHead = sparseIndex;
 }
 
-bool slotMapIsValidImpl(SlotMap* pSlotMap, uint32_t handle)
+template <typename HandleType>
+static bool slotMapIsValidT(SlotMap* pSlotMap, HandleType handle)
 {
-	if (!pSlotMap || !handleIsValid(handle))
+	typedef HandleTraits<HandleType> Traits;
+
+	if (!pSlotMap || !Traits::isValid(handle))
 		return false;
 
-	uint32_t sparseIndex = handleIndex(handle);
-	uint32_t generation = handleGeneration(handle);
+	uint32_t sparseIndex = Traits::index(handle);
+	uint32_t generation = Traits::generation(handle);
 
 	if (sparseIndex >= pSlotMap->capacity)
 		return false;
@@ -214,6 +384,218 @@ bool slotMapIsValidImpl(SlotMap* pSlotMap, uint32_t handle)
 	return denseIndex != UINT32_MAX && denseIndex < pSlotMap->count;
 }
 
+bool slotMapReserve(SlotMap* pSlotMap, uint32_t capacity)
+{
+	if (!pSlotMap || !pSlotMap->pValues)
+		return false;
+
+	// Retired slots keep their sparse entries
+	uint64_t needed = (uint64_t)capacity + pSlotMap->retiredCount;
+	if (needed <= pSlotMap->capacity)
+		return true;
+
+	if (needed > pSlotMap->maxCapacity)
+	{
+		LOGF(eERROR, "SlotMap: Capacity %llu exceeds the %u slots a handle can address",
+			 (unsigned long long)needed, pSlotMap->maxCapacity);
+		return false;
+	}
+
+	// Keep doubling semantics so a reserve followed by a few inserts does not
+	// immediately pay for another copy
+	uint64_t newCapacity = pSlotMap->capacity;
+	while (newCapacity < needed)
+		newCapacity *= 2;
+	if (newCapacity > pSlotMap->maxCapacity)
+		newCapacity = needed;
+
+	return slotMapResize(pSlotMap, (uint32_t)newCapacity);
+}
+
+template <typename HandleType>
+static uint32_t slotMapInsertNT(SlotMap* pSlotMap, const void* pValues, uint32_t count,
+								HandleType* pOutHandles)
+{
+	if (!pSlotMap || !pValues || count == 0)
+		return 0;
+
+	uint64_t needed = (uint64_t)pSlotMap->count + count;
+	if (needed > UINT32_MAX || !slotMapReserve(pSlotMap, (uint32_t)needed))
+	{
+		LOGF(eERROR, "SlotMap: Failed to reserve %u slots, batch insertion failed", count);
+		return 0;
+	}
+
+	const uint8_t* pSrc = (const uint8_t*)pValues;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		HandleType handle = slotMapInsertReserved<HandleType>(pSlotMap, pSrc);
+		if (pOutHandles)
+			pOutHandles[i] = handle;
+		pSrc += pSlotMap->valueSize;
+	}
+
+	return count;
+}
+
+template <typename HandleType>
+static uint32_t slotMapGetNT(SlotMap* pSlotMap, const HandleType* pHandles, uint32_t count,
+							 void** ppOutValues)
+{
+	typedef HandleTraits<HandleType> Traits;
+
+	if (!pSlotMap || !pHandles || !ppOutValues)
+		return 0;
+
+	const uint32_t capacity = pSlotMap->capacity;
+	uint32_t found = 0;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		// Stage one pulls in the sparse entries for a handle further ahead, stage
+		// two uses the now cached dense index to pull in the value itself
+		if (i + 2 * SLOTMAP_PREFETCH_DISTANCE < count)
+		{
+			uint32_t ahead = Traits::index(pHandles[i + 2 * SLOTMAP_PREFETCH_DISTANCE]);
+			if (ahead < capacity)
+			{
+				SLOTMAP_PREFETCH(&pSlotMap->pGenerations[ahead]);
+				SLOTMAP_PREFETCH(&pSlotMap->pIndices[ahead]);
+			}
+		}
+		if (i + SLOTMAP_PREFETCH_DISTANCE < count)
+		{
+			uint32_t ahead = Traits::index(pHandles[i + SLOTMAP_PREFETCH_DISTANCE]);
+			if (ahead < capacity)
+			{
+				uint32_t denseAhead = pSlotMap->pIndices[ahead];
+				if (denseAhead < pSlotMap->count)
+					SLOTMAP_PREFETCH((uint8_t*)pSlotMap->pValues +
+									 (uint64_t)denseAhead * pSlotMap->valueSize);
+			}
+		}
+
+		void* pValue = slotMapGetT(pSlotMap, pHandles[i]);
+		ppOutValues[i] = pValue;
+		found += pValue ? 1 : 0;
+	}
+
+	return found;
+}
+
+template <typename HandleType>
+static uint32_t slotMapRemoveNT(SlotMap* pSlotMap, const HandleType* pHandles, uint32_t count)
+{
+	typedef HandleTraits<HandleType> Traits;
+
+	if (!pSlotMap || !pHandles)
+		return 0;
+
+	const uint32_t capacity = pSlotMap->capacity;
+	uint32_t removed = 0;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		// Only the sparse side is prefetched, the dense slot being removed and the
+		// last element moved into it depend on every earlier removal
+		if (i + SLOTMAP_PREFETCH_DISTANCE < count)
+		{
+			uint32_t ahead = Traits::index(pHandles[i + SLOTMAP_PREFETCH_DISTANCE]);
+			if (ahead < capacity)
+			{
+				SLOTMAP_PREFETCH(&pSlotMap->pGenerations[ahead]);
+				SLOTMAP_PREFETCH(&pSlotMap->pIndices[ahead]);
+			}
+		}
+
+		uint32_t countBefore = pSlotMap->count;
+		slotMapRemoveT(pSlotMap, pHandles[i]);
+		removed += countBefore - pSlotMap->count;
+	}
+
+	return removed;
+}
+
+///////////////////////////////////////////
+// Handle width entry points
+
+uint32_t slotMapInsertImpl(SlotMap* pSlotMap, const void* pValue)
+{
+	return slotMapInsertT<uint32_t>(pSlotMap, pValue);
+}
+
+void* slotMapGetImpl(SlotMap* pSlotMap, uint32_t handle)
+{
+	return slotMapGetT(pSlotMap, handle);
+}
+
+void slotMapRemoveImpl(SlotMap* pSlotMap, uint32_t handle)
+{
+	slotMapRemoveT(pSlotMap, handle);
+}
+
+bool slotMapIsValidImpl(SlotMap* pSlotMap, uint32_t handle)
+{
+	return slotMapIsValidT(pSlotMap, handle);
+}
+
+uint32_t slotMapInsertNImpl(SlotMap* pSlotMap, const void* pValues, uint32_t count,
+							uint32_t* pOutHandles)
+{
+	return slotMapInsertNT(pSlotMap, pValues, count, pOutHandles);
+}
+
+uint32_t slotMapGetNImpl(SlotMap* pSlotMap, const uint32_t* pHandles, uint32_t count,
+						 void** ppOutValues)
+{
+	return slotMapGetNT(pSlotMap, pHandles, count, ppOutValues);
+}
+
+uint32_t slotMapRemoveNImpl(SlotMap* pSlotMap, const uint32_t* pHandles, uint32_t count)
+{
+	return slotMapRemoveNT(pSlotMap, pHandles, count);
+}
+
+uint64_t slotMapInsert64Impl(SlotMap64* pSlotMap, const void* pValue)
+{
+	return slotMapInsertT<uint64_t>(pSlotMap, pValue);
+}
+
+void* slotMapGet64Impl(SlotMap64* pSlotMap, uint64_t handle)
+{
+	return slotMapGetT(pSlotMap, handle);
+}
+
+void slotMapRemove64Impl(SlotMap64* pSlotMap, uint64_t handle)
+{
+	slotMapRemoveT(pSlotMap, handle);
+}
+
+bool slotMapIsValid64Impl(SlotMap64* pSlotMap, uint64_t handle)
+{
+	return slotMapIsValidT(pSlotMap, handle);
+}
+
+uint32_t slotMapInsertN64Impl(SlotMap64* pSlotMap, const void* pValues, uint32_t count,
+							  uint64_t* pOutHandles)
+{
+	return slotMapInsertNT(pSlotMap, pValues, count, pOutHandles);
+}
+
+uint32_t slotMapGetN64Impl(SlotMap64* pSlotMap, const uint64_t* pHandles, uint32_t count,
+						   void** ppOutValues)
+{
+	return slotMapGetNT(pSlotMap, pHandles, count, ppOutValues);
+}
+
+uint32_t slotMapRemoveN64Impl(SlotMap64* pSlotMap, const uint64_t* pHandles, uint32_t count)
+{
+	return slotMapRemoveNT(pSlotMap, pHandles, count);
+}
+
+///////////////////////////////////////////
+// Queries
+
 uint32_t slotMapCount(SlotMap* pSlotMap)
 {
 	return pSlotMap ? pSlotMap->count : 0;
@@ -223,3 +605,8 @@ uint32_t slotMapCapacity(SlotMap* pSlotMap)
 {
 	return pSlotMap ? pSlotMap->capacity : 0;
 }
+
+uint32_t slotMapRetiredCount(SlotMap* pSlotMap)
+{
+	return pSlotMap ? pSlotMap->retiredCount : 0;
+}
@@ -0,0 +1,247 @@
+/*
+ * TransformKernel.cpp
+ *
+ */
+
+#include "Core/TransformKernel.h"
+#include <math.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define TRS_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define TRS_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+// pi / 2 split in three parts for Cody-Waite range reduction
+#define TRS_PIO2_1 1.5703125f
+#define TRS_PIO2_2 4.837512969970703125e-4f
+#define TRS_PIO2_3 7.54978995489188216e-8f
+#define TRS_2OPI 0.636619772367581343f
+
+// Writes one column major T * R * S matrix. Rotation is Rz * Ry * Rx.
+static inline void writeTRS(float* m, float px, float py, float pz, float sinX, float cosX,
+							float sinY, float cosY, float sinZ, float cosZ, float sx, float sy,
+							float sz)
+{
+	float czsy = cosZ * sinY;
+	float szsy = sinZ * sinY;
+
+	m[0] = cosZ * cosY * sx;
+	m[1] = sinZ * cosY * sx;
+	m[2] = -sinY * sx;
+	m[3] = 0.0f;
+
+	m[4] = (czsy * sinX - sinZ * cosX) * sy;
+	m[5] = (szsy * sinX + cosZ * cosX) * sy;
+	m[6] = cosY * sinX * sy;
+	m[7] = 0.0f;
+
+	m[8] = (czsy * cosX + sinZ * sinX) * sz;
+	m[9] = (szsy * cosX - cosZ * sinX) * sz;
+	m[10] = cosY * cosX * sz;
+	m[11] = 0.0f;
+
+	m[12] = px;
+	m[13] = py;
+	m[14] = pz;
+	m[15] = 1.0f;
+}
+
+static void composeTRSRange(const TRSInputs* pInputs, float* pOutMatrices, uint32_t first,
+							uint32_t count)
+{
+	for (uint32_t i = first; i < first + count; ++i)
+	{
+		float rx = pInputs->pRotationX[i];
+		float ry = pInputs->pRotationY[i];
+		float rz = pInputs->pRotationZ[i];
+
+		writeTRS(pOutMatrices + i * 16, pInputs->pPositionX[i], pInputs->pPositionY[i],
+				 pInputs->pPositionZ[i], sinf(rx), cosf(rx), sinf(ry), cosf(ry), sinf(rz), cosf(rz),
+				 pInputs->pScaleX[i], pInputs->pScaleY[i], pInputs->pScaleZ[i]);
+	}
+}
+
+void composeTRSMatricesScalar(const TRSInputs* pInputs, float* pOutMatrices, uint32_t count)
+{
+	if (!pInputs || !pOutMatrices)
+		return;
+
+	composeTRSRange(pInputs, pOutMatrices, 0, count);
+}
+
+#if TRS_SIMD_SSE2 || TRS_SIMD_NEON
+
+// ============================================================================
+// Four wide helpers
+// ============================================================================
+
+#if TRS_SIMD_SSE2
+typedef __m128 Float4;
+typedef __m128i Int4;
+
+static inline Float4 f4Load(const float* p) { return _mm_loadu_ps(p); }
+static inline Float4 f4Splat(float v) { return _mm_set1_ps(v); }
+static inline Float4 f4Add(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+static inline Float4 f4Sub(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+static inline Float4 f4Mul(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+static inline Int4 f4RoundToInt(Float4 a) { return _mm_cvtps_epi32(a); }
+static inline Float4 i4ToFloat(Int4 a) { return _mm_cvtepi32_ps(a); }
+static inline Int4 i4Splat(int32_t v) { return _mm_set1_epi32(v); }
+static inline Int4 i4Add(Int4 a, Int4 b) { return _mm_add_epi32(a, b); }
+static inline Int4 i4And(Int4 a, Int4 b) { return _mm_and_si128(a, b); }
+static inline Int4 i4ShiftLeft30(Int4 a) { return _mm_slli_epi32(a, 30); }
+static inline Int4 i4Equal(Int4 a, Int4 b) { return _mm_cmpeq_epi32(a, b); }
+static inline Float4 f4XorBits(Float4 a, Int4 bits)
+{
+	return _mm_xor_ps(a, _mm_castsi128_ps(bits));
+}
+static inline Float4 f4Select(Int4 mask, Float4 a, Float4 b)
+{
+	Float4 m = _mm_castsi128_ps(mask);
+	return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+}
+
+// Transposes four column vectors (one per entity lane) into four rows and
+// stores them 16 floats apart, one column of four consecutive matrices
+static inline void f4StoreColumn(float* pMatrices, uint32_t column, Float4 x, Float4 y, Float4 z,
+								 Float4 w)
+{
+	_MM_TRANSPOSE4_PS(x, y, z, w);
+	_mm_storeu_ps(pMatrices + 0 * 16 + column * 4, x);
+	_mm_storeu_ps(pMatrices + 1 * 16 + column * 4, y);
+	_mm_storeu_ps(pMatrices + 2 * 16 + column * 4, z);
+	_mm_storeu_ps(pMatrices + 3 * 16 + column * 4, w);
+}
+#else
+typedef float32x4_t Float4;
+typedef int32x4_t Int4;
+
+static inline Float4 f4Load(const float* p) { return vld1q_f32(p); }
+static inline Float4 f4Splat(float v) { return vdupq_n_f32(v); }
+static inline Float4 f4Add(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+static inline Float4 f4Sub(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+static inline Float4 f4Mul(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+static inline Int4 f4RoundToInt(Float4 a) { return vcvtnq_s32_f32(a); }
+static inline Float4 i4ToFloat(Int4 a) { return vcvtq_f32_s32(a); }
+static inline Int4 i4Splat(int32_t v) { return vdupq_n_s32(v); }
+static inline Int4 i4Add(Int4 a, Int4 b) { return vaddq_s32(a, b); }
+static inline Int4 i4And(Int4 a, Int4 b) { return vandq_s32(a, b); }
+static inline Int4 i4ShiftLeft30(Int4 a) { return vshlq_n_s32(a, 30); }
+static inline Int4 i4Equal(Int4 a, Int4 b) { return vreinterpretq_s32_u32(vceqq_s32(a, b)); }
+static inline Float4 f4XorBits(Float4 a, Int4 bits)
+{
+	return vreinterpretq_f32_s32(veorq_s32(vreinterpretq_s32_f32(a), bits));
+}
+static inline Float4 f4Select(Int4 mask, Float4 a, Float4 b)
+{
+	return vbslq_f32(vreinterpretq_u32_s32(mask), a, b);
+}
+
+static inline void f4StoreColumn(float* pMatrices, uint32_t column, Float4 x, Float4 y, Float4 z,
+								 Float4 w)
+{
+	float32x4x2_t xz = vzipq_f32(x, z);
+	float32x4x2_t yw = vzipq_f32(y, w);
+	float32x4x2_t lo = vzipq_f32(xz.val[0], yw.val[0]);
+	float32x4x2_t hi = vzipq_f32(xz.val[1], yw.val[1]);
+	vst1q_f32(pMatrices + 0 * 16 + column * 4, lo.val[0]);
+	vst1q_f32(pMatrices + 1 * 16 + column * 4, lo.val[1]);
+	vst1q_f32(pMatrices + 2 * 16 + column * 4, hi.val[0]);
+	vst1q_f32(pMatrices + 3 * 16 + column * 4, hi.val[1]);
+}
+#endif
+
+/**
+	Computes sin and cos of four angles.
+
+	Reduces to [-pi/4, pi/4] around the nearest multiple of pi/2, evaluates
+	the Cephes minimax polynomials, then swaps and negates by quadrant.
+	Accurate to a few ulp for the angle range transforms use.
+*/
+static inline void f4SinCos(Float4 x, Float4* pSin, Float4* pCos)
+{
+	Int4 quadrant = f4RoundToInt(f4Mul(x, f4Splat(TRS_2OPI)));
+	Float4 q = i4ToFloat(quadrant);
+
+	Float4 y = f4Sub(x, f4Mul(q, f4Splat(TRS_PIO2_1)));
+	y = f4Sub(y, f4Mul(q, f4Splat(TRS_PIO2_2)));
+	y = f4Sub(y, f4Mul(q, f4Splat(TRS_PIO2_3)));
+
+	Float4 y2 = f4Mul(y, y);
+
+	Float4 s = f4Splat(-1.9515295891e-4f);
+	s = f4Add(f4Mul(s, y2), f4Splat(8.3321608736e-3f));
+	s = f4Add(f4Mul(s, y2), f4Splat(-1.6666654611e-1f));
+	s = f4Add(f4Mul(f4Mul(s, y2), y), y);
+
+	Float4 c = f4Splat(2.443315711809948e-5f);
+	c = f4Add(f4Mul(c, y2), f4Splat(-1.388731625493765e-3f));
+	c = f4Add(f4Mul(c, y2), f4Splat(4.166664568298827e-2f));
+	c = f4Mul(f4Mul(c, y2), y2);
+	c = f4Add(f4Sub(c, f4Mul(y2, f4Splat(0.5f))), f4Splat(1.0f));
+
+	// Odd quadrants swap sin and cos, bit 1 of q (and q + 1) flips the sign
+	Int4 one = i4Splat(1);
+	Int4 two = i4Splat(2);
+	Int4 swap = i4Equal(i4And(quadrant, one), one);
+	Int4 sinSign = i4ShiftLeft30(i4And(quadrant, two));
+	Int4 cosSign = i4ShiftLeft30(i4And(i4Add(quadrant, one), two));
+
+	*pSin = f4XorBits(f4Select(swap, c, s), sinSign);
+	*pCos = f4XorBits(f4Select(swap, s, c), cosSign);
+}
+
+void composeTRSMatrices(const TRSInputs* pInputs, float* pOutMatrices, uint32_t count)
+{
+	if (!pInputs || !pOutMatrices)
+		return;
+
+	const Float4 zero = f4Splat(0.0f);
+	const Float4 one = f4Splat(1.0f);
+
+	uint32_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		Float4 sinX, cosX, sinY, cosY, sinZ, cosZ;
+		f4SinCos(f4Load(pInputs->pRotationX + i), &sinX, &cosX);
+		f4SinCos(f4Load(pInputs->pRotationY + i), &sinY, &cosY);
+		f4SinCos(f4Load(pInputs->pRotationZ + i), &sinZ, &cosZ);
+
+		Float4 sx = f4Load(pInputs->pScaleX + i);
+		Float4 sy = f4Load(pInputs->pScaleY + i);
+		Float4 sz = f4Load(pInputs->pScaleZ + i);
+
+		Float4 czsy = f4Mul(cosZ, sinY);
+		Float4 szsy = f4Mul(sinZ, sinY);
+
+		float* pOut = pOutMatrices + i * 16;
+
+		f4StoreColumn(pOut, 0, f4Mul(f4Mul(cosZ, cosY), sx), f4Mul(f4Mul(sinZ, cosY), sx),
+					  f4Mul(f4Sub(zero, sinY), sx), zero);
+
+		f4StoreColumn(pOut, 1, f4Mul(f4Sub(f4Mul(czsy, sinX), f4Mul(sinZ, cosX)), sy),
+					  f4Mul(f4Add(f4Mul(szsy, sinX), f4Mul(cosZ, cosX)), sy),
+					  f4Mul(f4Mul(cosY, sinX), sy), zero);
+
+		f4StoreColumn(pOut, 2, f4Mul(f4Add(f4Mul(czsy, cosX), f4Mul(sinZ, sinX)), sz),
+					  f4Mul(f4Sub(f4Mul(szsy, cosX), f4Mul(cosZ, sinX)), sz),
+					  f4Mul(f4Mul(cosY, cosX), sz), zero);
+
+		f4StoreColumn(pOut, 3, f4Load(pInputs->pPositionX + i), f4Load(pInputs->pPositionY + i),
+					  f4Load(pInputs->pPositionZ + i), one);
+	}
+
+	composeTRSRange(pInputs, pOutMatrices, i, count - i);
+}
+
+#else
+
+void composeTRSMatrices(const TRSInputs* pInputs, float* pOutMatrices, uint32_t count)
+{
+	composeTRSMatricesScalar(pInputs, pOutMatrices, count);
+}
+
+#endif
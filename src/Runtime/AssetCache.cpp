@@ -5,32 +5,471 @@
 
 #include "Runtime/AssetCache.h"
 #include "Runtime/Memory/Arena.h"
+#include "Runtime/Memory/Pool.h"
+#include "Runtime/Trace.h"
 #include "Core/SlotMap.h"
+#include "Core/HashMap.h"
 #include "Core/Handle.h"
-#include "Utilities/Math/BStringHashMap.h"
-#include "Utilities/ThirdParty/OpenSource/Nothings/stb_ds.h"
 #include "Utilities/Interfaces/ILog.h"
+#include "Runtime/MeshFormat.h"
 #include "Resources/ResourceLoader/Interfaces/IResourceLoader.h"
+#include "Resources/ResourceLoader/ThirdParty/OpenSource/tinyimageformat/tinyimageformat_query.h"
+#include "Utilities/Interfaces/IFileSystem.h"
 #include <math.h>
+#include <string.h>
+
+/**
+	In flight texture load.
+
+	The resource loader writes pTexture from its own thread, so requests are
+	allocated separately from the TextureData slot map (which moves values
+	around) and keep a stable address until the load completes.
+*/
+struct TextureLoadRequest
+{
+	TextureLoadRequest* pNext; ///< Next pending request
+	Texture* pTexture;		   ///< Written by the resource loader
+	SyncToken token;		   ///< Completion token from addResource
+	TextureHandle handle;	   ///< Owning texture, invalid if unloaded while pending
+};
+
+/**
+	Removed GPU resource waiting for the frames that may still use it.
+
+	Linked into the list of the frame that was current when the asset
+	went, and freed by beginAssetCacheFrame once that frame's fence has
+	signaled. Later frames of the same queue finish after it, so every
+	draw recorded before the removal is done by then.
+*/
+struct RetiredAsset
+{
+	RetiredAsset* pNext; ///< Next resource retired in the same frame
+	Texture* pTexture;	 ///< Retired texture, nullptr for buffers
+	Buffer* pBuffer;	 ///< Retired buffer, nullptr for textures
+};
+
+///////////////////////////////////////////
+// Residency
+
+static void initLruList(AssetLruList* pList)
+{
+	pList->oldest = HANDLE_INVALID_ID;
+	pList->newest = HANDLE_INVALID_ID;
+	pList->count = 0;
+}
+
+/**
+	Appends an entry that just lost its last reference to an LRU list.
+
+	TextureData and MeshData share the LRU fields, so one template links
+	both. Neighbours are found by handle, values move inside the slot map.
+*/
+template <typename T>
+static void pushUnused(AssetCache* pCache, SlotMap* pMap, AssetLruList* pList, uint32_t id,
+					   T* pData)
+{
+	pData->lruStamp = ++pCache->lruClock;
+	pData->lruOlder = pList->newest;
+	pData->lruNewer = HANDLE_INVALID_ID;
+
+	if (handleIsValid(pList->newest))
+		slotMapGet<T>(pMap, pList->newest)->lruNewer = id;
+	else
+		pList->oldest = id;
+
+	pList->newest = id;
+	pList->count++;
+	pCache->stats.unusedBytes += pData->gpuBytes;
+	pCache->stats.unusedCount++;
+}
+
+template <typename T>
+static void removeUnused(AssetCache* pCache, SlotMap* pMap, AssetLruList* pList, T* pData)
+{
+	if (handleIsValid(pData->lruOlder))
+		slotMapGet<T>(pMap, pData->lruOlder)->lruNewer = pData->lruNewer;
+	else
+		pList->oldest = pData->lruNewer;
+
+	if (handleIsValid(pData->lruNewer))
+		slotMapGet<T>(pMap, pData->lruNewer)->lruOlder = pData->lruOlder;
+	else
+		pList->newest = pData->lruOlder;
+
+	pData->lruOlder = HANDLE_INVALID_ID;
+	pData->lruNewer = HANDLE_INVALID_ID;
+	pList->count--;
+	pCache->stats.unusedBytes -= pData->gpuBytes;
+	pCache->stats.unusedCount--;
+}
+
+static uint64_t estimateTextureBytes(const Texture* pTexture)
+{
+	TinyImageFormat format = (TinyImageFormat)pTexture->mFormat;
+	uint64_t blockBits = TinyImageFormat_BitSizeOfBlock(format);
+	uint32_t blockWidth = TinyImageFormat_WidthOfBlock(format);
+	uint32_t blockHeight = TinyImageFormat_HeightOfBlock(format);
+
+	uint32_t width = pTexture->mWidth;
+	uint32_t height = pTexture->mHeight;
+	uint32_t depth = pTexture->mDepth ? pTexture->mDepth : 1;
+	uint32_t mipLevels = pTexture->mMipLevels ? pTexture->mMipLevels : 1;
+
+	uint64_t bytes = 0;
+	for (uint32_t mip = 0; mip < mipLevels; ++mip)
+	{
+		uint64_t blocksX = (width + blockWidth - 1) / blockWidth;
+		uint64_t blocksY = (height + blockHeight - 1) / blockHeight;
+		bytes += blocksX * blocksY * depth * blockBits / 8;
+
+		width = width > 1 ? width >> 1 : 1;
+		height = height > 1 ? height >> 1 : 1;
+		depth = depth > 1 ? depth >> 1 : 1;
+	}
+
+	return bytes * ((uint64_t)pTexture->mArraySizeMinusOne + 1);
+}
+
+/**
+	Stages a texture for its bindless slot.
+
+	Frames in flight still sample their set, so nothing is written here.
+	Each frame's set picks the change up in its next beginAssetCacheFrame,
+	once the GPU is done with the last frame that used it.
+
+	@param pCache Asset cache
+	@param id Handle id of the texture, its index is the slot
+	@param pTexture Texture to write, nullptr writes the fallback texture
+*/
+static void writeTextureSlot(AssetCache* pCache, uint32_t id, Texture* pTexture)
+{
+	uint32_t slot = handleIndex(id);
+	pCache->ppSlotTextures[slot] = pTexture ? pTexture : pCache->pFallbackTexture;
+
+	for (uint32_t i = 0; i < pCache->frameCount; ++i)
+		pCache->dirtySlots[i][slot / 32] |= 1u << (slot % 32);
+}
+
+static bool isSlotDirty(const uint32_t* pDirty, uint32_t slot)
+{
+	return (pDirty[slot / 32] & (1u << (slot % 32))) != 0;
+}
+
+/**
+	Writes the staged slots into one frame's bindless set.
+
+	Runs of neighbouring slots go out as one descriptor update.
+
+	@param frameIndex Set index to write, no frame on the GPU may use it
+*/
+static void flushTextureSlots(AssetCache* pCache, uint32_t frameIndex)
+{
+	if (!pCache->pBindlessSet)
+		return;
+
+	uint32_t* pDirty = pCache->dirtySlots[frameIndex];
+
+	uint32_t slot = 0;
+	while (slot < ASSET_CACHE_MAX_BINDLESS_TEXTURES)
+	{
+		// Words without changes are skipped whole
+		if (pDirty[slot / 32] == 0)
+		{
+			slot = (slot / 32 + 1) * 32;
+			continue;
+		}
+
+		uint32_t first = slot;
+		while (slot < ASSET_CACHE_MAX_BINDLESS_TEXTURES && isSlotDirty(pDirty, slot) &&
+			   pCache->ppSlotTextures[slot])
+		{
+			pDirty[slot / 32] &= ~(1u << (slot % 32));
+			slot++;
+		}
+
+		// Unchanged, or nothing to write since the slot was cleared
+		if (slot == first)
+		{
+			pDirty[slot / 32] &= ~(1u << (slot % 32));
+			slot++;
+			continue;
+		}
+
+		DescriptorData param = {};
+		param.mIndex = pCache->bindlessIndex;
+		param.mArrayOffset = first;
+		param.mCount = slot - first;
+		param.ppTextures = &pCache->ppSlotTextures[first];
+		updateDescriptorSet(pCache->pRenderer, frameIndex, pCache->pBindlessSet, 1, &param);
+	}
+}
+
+static Texture* getPlaceholder(AssetCache* pCache)
+{
+	TextureData* pPlaceholder = slotMapGet<TextureData>(pCache->pTextures,
+														pCache->placeholderTexture.id);
+	return pPlaceholder ? pPlaceholder->pTexture : pCache->pFallbackTexture;
+}
+
+/**
+	Moves everything still showing a texture off it before it is retired.
+
+	Pending and failed entries, and the slots they own, hold the placeholder
+	that was current when they were requested. Removing that texture hands
+	them the current placeholder, or the fallback once none is left.
+
+	@param pCache Asset cache
+	@param pDead Texture about to be retired
+*/
+static void replaceSlotTexture(AssetCache* pCache, Texture* pDead)
+{
+	Texture* pReplacement = getPlaceholder(pCache);
+	uint32_t textureCount = slotMapCount(pCache->pTextures);
+	TextureData* pTextureData = slotMapValues<TextureData>(pCache->pTextures);
+	for (uint32_t i = 0; i < textureCount; ++i)
+	{
+		if (pTextureData[i].state == TextureState_Ready || pTextureData[i].pTexture != pDead)
+			continue;
+
+		pTextureData[i].pTexture = pReplacement;
+		pTextureData[i].width = pReplacement->mWidth;
+		pTextureData[i].height = pReplacement->mHeight;
+	}
+
+	for (uint32_t slot = 0; slot < ASSET_CACHE_MAX_BINDLESS_TEXTURES; ++slot)
+	{
+		if (pCache->ppSlotTextures[slot] == pDead)
+			writeTextureSlot(pCache, slot, pReplacement);
+	}
+}
+
+/**
+	Hands a removed resource to the current frame, see RetiredAsset.
+
+	@param pTexture Texture to free, or nullptr
+	@param pBuffer Buffer to free, or nullptr
+*/
+static void retireResource(AssetCache* pCache, Texture* pTexture, Buffer* pBuffer)
+{
+	RetiredAsset* pRetired = (RetiredAsset*)poolAlloc(pCache->pRetiredPool);
+	if (!pRetired)
+	{
+		// Freeing it now could pull it out from under the GPU, leaking is the lesser evil
+		LOGF(eERROR, "AssetCache: Failed to allocate a retire record, leaking a resource");
+		return;
+	}
+
+	pRetired->pTexture = pTexture;
+	pRetired->pBuffer = pBuffer;
+	pRetired->pNext = pCache->pRetired[pCache->frameIndex];
+	pCache->pRetired[pCache->frameIndex] = pRetired;
+}
+
+static void freeRetiredAssets(AssetCache* pCache, uint32_t frameIndex)
+{
+	RetiredAsset* pRetired = pCache->pRetired[frameIndex];
+	while (pRetired)
+	{
+		RetiredAsset* pNext = pRetired->pNext;
+		if (pRetired->pTexture)
+			removeResource(pRetired->pTexture);
+		if (pRetired->pBuffer)
+			removeResource(pRetired->pBuffer);
+
+		poolFree(pCache->pRetiredPool, pRetired);
+		pRetired = pNext;
+	}
+
+	pCache->pRetired[frameIndex] = nullptr;
+}
+
+static void destroyTexture(AssetCache* pCache, TextureHandle handle, TextureData* pData);
+static void destroyMesh(AssetCache* pCache, MeshHandle handle, MeshData* pData);
+
+/**
+	Evicts unused assets, oldest first across both lists.
+
+	@param targetBytes Stops once the resident size is at or below this
+	@param all Evicts every unused asset regardless of targetBytes
+
+	@return Number of assets evicted
+*/
+static uint32_t evictUnusedAssets(AssetCache* pCache, uint64_t targetBytes, bool all)
+{
+	uint32_t evicted = 0;
+	while (all || pCache->stats.residentBytes > targetBytes)
+	{
+		TextureHandle texture = {pCache->unusedTextures.oldest};
+		MeshHandle mesh = {pCache->unusedMeshes.oldest};
+		TextureData* pTexture = slotMapGet<TextureData>(pCache->pTextures, texture.id);
+		MeshData* pMesh = slotMapGet<MeshData>(pCache->pMeshes, mesh.id);
+
+		if (pTexture && (!pMesh || pTexture->lruStamp < pMesh->lruStamp))
+		{
+			removeUnused(pCache, pCache->pTextures, &pCache->unusedTextures, pTexture);
+			destroyTexture(pCache, texture, pTexture);
+		}
+		else if (pMesh)
+		{
+			removeUnused(pCache, pCache->pMeshes, &pCache->unusedMeshes, pMesh);
+			destroyMesh(pCache, mesh, pMesh);
+		}
+		else
+		{
+			break;
+		}
+
+		evicted++;
+	}
+
+	pCache->stats.evictions += evicted;
+	return evicted;
+}
+
+static void enforceAssetBudget(AssetCache* pCache)
+{
+	uint64_t budget = pCache->stats.budgetBytes;
+	evictUnusedAssets(pCache, budget, budget == 0);
+}
+
+void setAssetCacheBudget(AssetCache* pCache, uint64_t budgetBytes)
+{
+	if (!pCache)
+		return;
+
+	pCache->stats.budgetBytes = budgetBytes;
+	enforceAssetBudget(pCache);
+}
+
+uint32_t purgeAssetCache(AssetCache* pCache)
+{
+	if (!pCache)
+		return 0;
+
+	return evictUnusedAssets(pCache, 0, true);
+}
+
+void getAssetCacheStats(const AssetCache* pCache, AssetCacheStats* pOutStats)
+{
+	if (!pCache || !pOutStats)
+		return;
+
+	*pOutStats = pCache->stats;
+}
 
 ///////////////////////////////////////////
 // Lifecycle
 
-AssetCache* createAssetCache(Arena* pArena, Renderer* pRenderer)
+/**
+	Creates the 1x1 white texture slots show when nothing else is left.
+
+	Slots never go empty, so the descriptors always hold a live texture
+	even without a placeholder or after the placeholder is unloaded.
+
+	@return The texture, or nullptr if it could not be created
+*/
+static Texture* createFallbackTexture()
+{
+	TextureDesc textureDesc = {};
+	textureDesc.mWidth = 1;
+	textureDesc.mHeight = 1;
+	textureDesc.mDepth = 1;
+	textureDesc.mArraySize = 1;
+	textureDesc.mMipLevels = 1;
+	textureDesc.mSampleCount = SAMPLE_COUNT_1;
+	textureDesc.mFormat = TinyImageFormat_R8G8B8A8_UNORM;
+	textureDesc.mStartState = RESOURCE_STATE_SHADER_RESOURCE;
+	textureDesc.mDescriptors = DESCRIPTOR_TYPE_TEXTURE;
+	textureDesc.pName = "AssetCacheFallback";
+
+	Texture* pTexture = nullptr;
+	TextureLoadDesc loadDesc = {};
+	loadDesc.pDesc = &textureDesc;
+	loadDesc.ppTexture = &pTexture;
+	SyncToken token = {};
+	addResource(&loadDesc, &token);
+	waitForToken(&token);
+	if (!pTexture)
+		return nullptr;
+
+	const uint32_t white = 0xFFFFFFFF;
+	TextureUpdateDesc updateDesc = {pTexture, 0, 1, 0, 1, RESOURCE_STATE_PIXEL_SHADER_RESOURCE};
+	beginUpdateResource(&updateDesc);
+	TextureSubresourceUpdate subresource = updateDesc.getSubresourceUpdateDesc(0, 0);
+	memcpy(subresource.pMappedData, &white, sizeof(white));
+	endUpdateResource(&updateDesc);
+	// Runs once at startup, nothing can sample it before it is filled
+	waitForAllResourceLoads();
+
+	return pTexture;
+}
+
+AssetCache* createAssetCache(Arena* pArena, Renderer* pRenderer, uint32_t frameCount)
 {
 	if (!pArena || !pRenderer)
 		return nullptr;
 
+	if (frameCount == 0 || frameCount > ASSET_CACHE_MAX_FRAMES)
+	{
+		LOGF(eERROR, "AssetCache: Frame count %u must be 1..%u", frameCount,
+			 ASSET_CACHE_MAX_FRAMES);
+		return nullptr;
+	}
+
+	Texture* pFallbackTexture = createFallbackTexture();
+	if (!pFallbackTexture)
+	{
+		LOGF(eERROR, "AssetCache: Failed to create the fallback texture");
+		return nullptr;
+	}
+
 	AssetCache* assetCache = arenaPushStruct<AssetCache>(pArena);
 	assetCache->pArena = pArena;
 	assetCache->pRenderer = pRenderer;
-
-	// Asset cache slotmaps
-	assetCache->pTextures = slotMapCreate(pArena, sizeof(TextureData), alignof(TextureData), 256);
-	assetCache->pMeshes = slotMapCreate(pArena, sizeof(MeshData), alignof(MeshData), 256);
-
-	assetCache->pTextureCache = NULL;
-	assetCache->pMeshCache = NULL;
+	assetCache->pFallbackTexture = pFallbackTexture;
+
+	// Asset cache slotmaps, pooled so growing them does not strand the old arrays
+	assetCache->pStoragePools = poolSetCreate(pArena);
+	assetCache->pTextures = slotMapCreate(pArena, sizeof(TextureData), alignof(TextureData), 256,
+										  assetCache->pStoragePools);
+	// Handle indices are bindless slots, the map must not outgrow the array
+	if (assetCache->pTextures)
+		assetCache->pTextures->maxCapacity = ASSET_CACHE_MAX_BINDLESS_TEXTURES;
+	assetCache->pMeshes = slotMapCreate(pArena, sizeof(MeshData), alignof(MeshData), 256,
+										assetCache->pStoragePools);
+
+	// Path -> handle caches
+	assetCache->pTextureCache = hashMapCreate(pArena, sizeof(TextureHandle));
+	assetCache->pMeshCache = hashMapCreate(pArena, sizeof(MeshHandle));
+
+	assetCache->pPendingTextures = nullptr;
+	PoolParams requestPoolParams = {};
+	requestPoolParams.chunkSize = sizeof(TextureLoadRequest);
+	requestPoolParams.chunkAlign = alignof(TextureLoadRequest);
+	assetCache->pTextureRequestPool = poolCreate(pArena, &requestPoolParams);
+	assetCache->pendingTextureCount = 0;
+	assetCache->placeholderTexture = INVALID_TEXTURE_HANDLE;
+
+	initLruList(&assetCache->unusedTextures);
+	initLruList(&assetCache->unusedMeshes);
+	assetCache->lruClock = 0;
+	assetCache->stats = {};
+	assetCache->stats.budgetBytes = ASSET_CACHE_DEFAULT_GPU_BUDGET;
+
+	assetCache->pBindlessSet = nullptr;
+	assetCache->bindlessIndex = 0;
+	assetCache->ppSlotTextures =
+		arenaPushArray<Texture*>(pArena, ASSET_CACHE_MAX_BINDLESS_TEXTURES);
+	memset(assetCache->dirtySlots, 0, sizeof(assetCache->dirtySlots));
+
+	PoolParams retiredPoolParams = {};
+	retiredPoolParams.chunkSize = sizeof(RetiredAsset);
+	retiredPoolParams.chunkAlign = alignof(RetiredAsset);
+	assetCache->pRetiredPool = poolCreate(pArena, &retiredPoolParams);
+	for (uint32_t i = 0; i < ASSET_CACHE_MAX_FRAMES; ++i)
+		assetCache->pRetired[i] = nullptr;
+	assetCache->frameCount = frameCount;
+	assetCache->frameIndex = 0;
 
 	return assetCache;
 }
@@ -40,14 +479,25 @@ void shutdownAssetCache(AssetCache* pCache)
 	if (!pCache)
 		return;
 
+	// Let in flight loads land so their textures can be released below
+	if (pCache->pPendingTextures)
+	{
+		waitForAllResourceLoads();
+		updateAssetCache(pCache);
+	}
+
+	// The GPU is idle, nothing waits for its frame anymore
+	for (uint32_t i = 0; i < pCache->frameCount; ++i)
+		freeRetiredAssets(pCache, i);
+
 	// Unload all textures
 	if (pCache->pTextures)
 	{
 		uint32_t textureCount = slotMapCount(pCache->pTextures);
-		TextureData* pTextureData = (TextureData*)pCache->pTextures->pValues;
+		TextureData* pTextureData = slotMapValues<TextureData>(pCache->pTextures);
 		for (uint32_t i = 0; i < textureCount; ++i)
 		{
-			if (pTextureData[i].pTexture)
+			if (pTextureData[i].state == TextureState_Ready && pTextureData[i].pTexture)
 				removeResource(pTextureData[i].pTexture);
 		}
 	}
@@ -56,7 +506,7 @@ void shutdownAssetCache(AssetCache* pCache)
 	if (pCache->pMeshes)
 	{
 		uint32_t meshCount = slotMapCount(pCache->pMeshes);
-		MeshData* pMeshData = (MeshData*)pCache->pMeshes->pValues;
+		MeshData* pMeshData = slotMapValues<MeshData>(pCache->pMeshes);
 		for (uint32_t i = 0; i < meshCount; ++i)
 		{
 			if (pMeshData[i].pVertexBuffer)
@@ -66,75 +516,304 @@ void shutdownAssetCache(AssetCache* pCache)
 		}
 	}
 
-	// Free bstring hashmaps and their keys
-	if (pCache->pTextureCache)
+	// Path caches live in the arena
+	hashMapDestroy(pCache->pTextureCache);
+	hashMapDestroy(pCache->pMeshCache);
+	slotMapDestroy(pCache->pTextures);
+	slotMapDestroy(pCache->pMeshes);
+
+	removeResource(pCache->pFallbackTexture);
+}
+
+void beginAssetCacheFrame(AssetCache* pCache, uint32_t frameIndex, Fence* pFence)
+{
+	ENGINE_PROFILE_SCOPE("beginAssetCacheFrame");
+
+	if (!pCache || frameIndex >= pCache->frameCount)
+		return;
+
+	// The last submit of this frame may still draw with what was retired in it
+	if (pFence)
 	{
-		for (ptrdiff_t i = 0; i < bhlen(pCache->pTextureCache); ++i)
-		{
-			bdestroy(&pCache->pTextureCache[i].key);
-		}
-		bhfree(pCache->pTextureCache);
+		FenceStatus fenceStatus;
+		getFenceStatus(pCache->pRenderer, pFence, &fenceStatus);
+		if (fenceStatus == FENCE_STATUS_INCOMPLETE)
+			waitForFences(pCache->pRenderer, 1, &pFence);
 	}
 
-	if (pCache->pMeshCache)
+	// Moves the set off retired textures before they are freed
+	flushTextureSlots(pCache, frameIndex);
+	freeRetiredAssets(pCache, frameIndex);
+	pCache->frameIndex = frameIndex;
+}
+
+///////////////////////////////////////////
+// Texture Loading
+
+static void completeTextureRequest(AssetCache* pCache, TextureLoadRequest* pRequest)
+{
+	// Unloaded while still in flight, nothing owns the texture anymore
+	if (!handleIsValid(pRequest->handle.id))
 	{
-		for (ptrdiff_t i = 0; i < bhlen(pCache->pMeshCache); ++i)
+		if (pRequest->pTexture)
+			removeResource(pRequest->pTexture);
+		return;
+	}
+
+	TextureData* pData = slotMapGet<TextureData>(pCache->pTextures, pRequest->handle.id);
+	if (!pData)
+		return;
+
+	if (!pRequest->pTexture)
+	{
+		LOGF(eWARNING, "AssetCache: Failed to load texture '%s'", pData->pPath);
+		pData->state = TextureState_Failed;
+		return;
+	}
+
+	pData->pTexture = pRequest->pTexture;
+	pData->width = pRequest->pTexture->mWidth;
+	pData->height = pRequest->pTexture->mHeight;
+	pData->state = TextureState_Ready;
+	writeTextureSlot(pCache, pRequest->handle.id, pData->pTexture);
+
+	pData->gpuBytes = estimateTextureBytes(pRequest->pTexture);
+	pCache->stats.residentBytes += pData->gpuBytes;
+	if (pData->refCount == 0)
+		pCache->stats.unusedBytes += pData->gpuBytes;
+
+	enforceAssetBudget(pCache);
+}
+
+static TextureLoadRequest* findTextureRequest(AssetCache* pCache, TextureHandle handle,
+											  TextureLoadRequest*** pppLink)
+{
+	TextureLoadRequest** ppLink = &pCache->pPendingTextures;
+	while (*ppLink)
+	{
+		if ((*ppLink)->handle.id == handle.id)
 		{
-			bdestroy(&pCache->pMeshCache[i].key);
+			*pppLink = ppLink;
+			return *ppLink;
 		}
-		bhfree(pCache->pMeshCache);
+		ppLink = &(*ppLink)->pNext;
 	}
+
+	return nullptr;
 }
 
-///////////////////////////////////////////
-// Texture Loading
+static void retireTextureRequest(AssetCache* pCache, TextureLoadRequest** ppLink)
+{
+	TextureLoadRequest* pRequest = *ppLink;
+	*ppLink = pRequest->pNext;
+
+	poolFree(pCache->pTextureRequestPool, pRequest);
+	pCache->pendingTextureCount--;
+}
+
+static void waitForTexture(AssetCache* pCache, TextureHandle handle)
+{
+	ENGINE_PROFILE_SCOPE("waitForTexture");
+
+	TextureLoadRequest** ppLink = nullptr;
+	TextureLoadRequest* pRequest = findTextureRequest(pCache, handle, &ppLink);
+	if (!pRequest)
+		return;
+
+	waitForToken(&pRequest->token);
+	completeTextureRequest(pCache, pRequest);
+	retireTextureRequest(pCache, ppLink);
+}
 
 TextureHandle loadTexture(AssetCache* pCache, const char* path)
 {
-	if (!pCache || !path)
+	if (!path)
 		return TextureHandle{HANDLE_INVALID_ID};
 
-	bstring pathStr = bconstfromcstr(path);
+	return loadTextureHashed(pCache, hashedKeyFromString(path));
+}
+
+TextureHandle loadTextureHashed(AssetCache* pCache, HashedKey path)
+{
+	TextureHandle handle = loadTextureAsyncHashed(pCache, path);
+	if (!handleIsValid(handle.id))
+		return handle;
+
+	// Only wait on this texture's token, other loads keep streaming
+	waitForTexture(pCache, handle);
+
+	TextureData* pData = slotMapGet<TextureData>(pCache->pTextures, handle.id);
+	if (!pData || pData->state != TextureState_Ready)
+	{
+		unloadTexture(pCache, handle);
+		return TextureHandle{HANDLE_INVALID_ID};
+	}
+
+	return handle;
+}
+
+TextureHandle loadTextureAsync(AssetCache* pCache, const char* path)
+{
+	if (!path)
+		return TextureHandle{HANDLE_INVALID_ID};
+
+	return loadTextureAsyncHashed(pCache, hashedKeyFromString(path));
+}
+
+TextureHandle loadTextureAsyncHashed(AssetCache* pCache, HashedKey path)
+{
+	ENGINE_PROFILE_SCOPE("loadTextureAsync");
+
+	if (!pCache || !path.pKey)
+		return TextureHandle{HANDLE_INVALID_ID};
 
 	// Check if already cached
-	if (bhgeti_unsafe(pCache->pTextureCache, pathStr) != -1)
+	TextureHandle* pCachedHandle = hashMapGetHashed<TextureHandle>(pCache->pTextureCache, path);
+	if (pCachedHandle)
 	{
-		TextureHandle cachedHandle = bhget(pCache->pTextureCache, pathStr);
-		TextureData* pCachedData = slotMapGet<TextureData>(pCache->pTextures, cachedHandle.id);
+		TextureData* pCachedData = slotMapGet<TextureData>(pCache->pTextures, pCachedHandle->id);
 		if (pCachedData)
 		{
+			if (pCachedData->refCount == 0)
+				removeUnused(pCache, pCache->pTextures, &pCache->unusedTextures, pCachedData);
 			pCachedData->refCount++;
 		}
-		return cachedHandle;
+		pCache->stats.hits++;
+		return *pCachedHandle;
 	}
 
-	Texture* pTexture = nullptr;
-	TextureLoadDesc loadDesc = {};
-	loadDesc.pFileName = path;
-	loadDesc.ppTexture = &pTexture;
-	addResource(&loadDesc, NULL);
+	pCache->stats.misses++;
 
-	waitForAllResourceLoads();
-
-	if (!pTexture)
+	TextureLoadRequest* pRequest = (TextureLoadRequest*)poolAlloc(pCache->pTextureRequestPool);
+	if (!pRequest)
 		return TextureHandle{HANDLE_INVALID_ID};
 
 	TextureData texData = {};
-	texData.pTexture = pTexture;
-	texData.width = pTexture->mWidth;
-	texData.height = pTexture->mHeight;
-	texData.pathHash = (uint32_t)stbds_hash_string(path, 0);
+	texData.pTexture = getPlaceholder(pCache);
+	texData.width = texData.pTexture->mWidth;
+	texData.height = texData.pTexture->mHeight;
+	texData.pathHash = path.hash;
 	texData.refCount = 1;
+	texData.state = TextureState_Pending;
+	texData.lruOlder = HANDLE_INVALID_ID;
+	texData.lruNewer = HANDLE_INVALID_ID;
 	uint32_t handleId = slotMapInsert(pCache->pTextures, texData);
 	TextureHandle handle = {handleId};
+	if (!handleIsValid(handleId))
+	{
+		LOGF(eERROR, "AssetCache: More than %u textures, '%s' not loaded",
+			 ASSET_CACHE_MAX_BINDLESS_TEXTURES, path.pKey);
+		poolFree(pCache->pTextureRequestPool, pRequest);
+		return handle;
+	}
+
+	// Draws using the slot see the placeholder until the load lands
+	writeTextureSlot(pCache, handleId, texData.pTexture);
 
-	// Cache path -> handle mapping
-	bstring keyCopy = bdynfromcstr(path);
-	bhput(pCache->pTextureCache, keyCopy, handle);
+	// Cache path -> handle mapping, the map interns the path
+	hashMapInsertHashed(pCache->pTextureCache, path, handle);
+	const char* pPath = hashMapGetKey(pCache->pTextureCache, path);
+	slotMapGet<TextureData>(pCache->pTextures, handleId)->pPath = pPath;
+
+	pRequest->pTexture = nullptr;
+	pRequest->token = 0;
+	pRequest->handle = handle;
+	pRequest->pNext = pCache->pPendingTextures;
+	pCache->pPendingTextures = pRequest;
+	pCache->pendingTextureCount++;
+
+	TextureLoadDesc loadDesc = {};
+	// The loader reads the name later, the caller's string may be gone by then
+	loadDesc.pFileName = pPath;
+	loadDesc.ppTexture = &pRequest->pTexture;
+	addResource(&loadDesc, &pRequest->token);
 
 	return handle;
 }
 
+void loadTextures(AssetCache* pCache, const char** ppPaths, uint32_t count,
+				  TextureHandle* pOutHandles)
+{
+	if (!pCache || !ppPaths || !pOutHandles)
+		return;
+
+	// Queue everything first so the loader works on all files at once
+	for (uint32_t i = 0; i < count; ++i)
+		pOutHandles[i] = loadTextureAsync(pCache, ppPaths[i]);
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (!handleIsValid(pOutHandles[i].id))
+			continue;
+
+		waitForTexture(pCache, pOutHandles[i]);
+
+		if (!isTextureReady(pCache, pOutHandles[i]))
+		{
+			unloadTexture(pCache, pOutHandles[i]);
+			pOutHandles[i] = INVALID_TEXTURE_HANDLE;
+		}
+	}
+}
+
+void updateAssetCache(AssetCache* pCache)
+{
+	ENGINE_PROFILE_SCOPE("updateAssetCache");
+
+	if (!pCache)
+		return;
+
+	TextureLoadRequest** ppLink = &pCache->pPendingTextures;
+	while (*ppLink)
+	{
+		TextureLoadRequest* pRequest = *ppLink;
+		if (!isTokenCompleted(&pRequest->token))
+		{
+			ppLink = &pRequest->pNext;
+			continue;
+		}
+
+		completeTextureRequest(pCache, pRequest);
+		retireTextureRequest(pCache, ppLink);
+	}
+}
+
+bool isTextureReady(AssetCache* pCache, TextureHandle handle)
+{
+	TextureData* pData = getTexture(pCache, handle);
+	return pData && pData->state == TextureState_Ready;
+}
+
+void setPlaceholderTexture(AssetCache* pCache, TextureHandle handle)
+{
+	if (!pCache)
+		return;
+
+	pCache->placeholderTexture = handle;
+}
+
+void bindAssetCacheTextures(AssetCache* pCache, DescriptorSet* pDescriptorSet,
+							uint32_t descriptorIndex)
+{
+	if (!pCache)
+		return;
+
+	pCache->pBindlessSet = pDescriptorSet;
+	pCache->bindlessIndex = descriptorIndex;
+	if (!pDescriptorSet)
+		return;
+
+	// A new set starts empty, fill in everything the cache holds so far
+	uint32_t textureCount = slotMapCount(pCache->pTextures);
+	TextureData* pTextureData = slotMapValues<TextureData>(pCache->pTextures);
+	for (uint32_t i = 0; i < textureCount; ++i)
+		writeTextureSlot(pCache, slotMapHandleAt(pCache->pTextures, i), pTextureData[i].pTexture);
+
+	// No frame has drawn with the new sets yet, they can all be written now
+	for (uint32_t i = 0; i < pCache->frameCount; ++i)
+		flushTextureSlots(pCache, i);
+}
+
 TextureData* getTexture(AssetCache* pCache, TextureHandle handle)
 {
 	if (!pCache)
@@ -159,65 +838,225 @@ void unloadTexture(AssetCache* pCache, TextureHandle handle)
 	if (pData->refCount > 0)
 		return;
 
-	removeResource(pData->pTexture);
+	// Failed loads are not worth keeping, everything else waits for the budget
+	if (pData->state == TextureState_Failed || !pData->pPath)
+	{
+		destroyTexture(pCache, handle, pData);
+		return;
+	}
 
-	slotMapRemove(pCache->pTextures, handle.id);
+	pushUnused(pCache, pCache->pTextures, &pCache->unusedTextures, handle.id, pData);
+	enforceAssetBudget(pCache);
+}
 
-	for (ptrdiff_t i = 0; i < bhlen(pCache->pTextureCache); ++i)
+static void destroyTexture(AssetCache* pCache, TextureHandle handle, TextureData* pData)
+{
+	Texture* pDead = pData->state == TextureState_Ready ? pData->pTexture : nullptr;
+
+	// A pending load finishes on the loader thread, release it once it lands
+	if (pData->state == TextureState_Pending)
 	{
-		if (pCache->pTextureCache[i].value.id == handle.id)
-		{
-			bdestroy(&pCache->pTextureCache[i].key);
-			bhdel(pCache->pTextureCache, pCache->pTextureCache[i].key);
-			break;
-		}
+		TextureLoadRequest** ppLink = nullptr;
+		TextureLoadRequest* pRequest = findTextureRequest(pCache, handle, &ppLink);
+		if (pRequest)
+			pRequest->handle = INVALID_TEXTURE_HANDLE;
+	}
+	else if (pData->state == TextureState_Ready)
+	{
+		retireResource(pCache, pData->pTexture, nullptr);
+	}
+
+	if (pData->pPath)
+	{
+		HashedKey key = {pData->pPath, (uint32_t)strlen(pData->pPath), pData->pathHash};
+		hashMapRemoveHashed(pCache->pTextureCache, key);
 	}
+
+	pCache->stats.residentBytes -= pData->gpuBytes;
+	slotMapRemove(pCache->pTextures, handle.id);
+
+	// Never leave a slot pointing at a removed texture. The entry is already
+	// gone from the map, so a removed placeholder hands its slot and every
+	// slot still showing it to the next placeholder or the fallback
+	writeTextureSlot(pCache, handle.id, getPlaceholder(pCache));
+	if (pDead)
+		replaceSlotTexture(pCache, pDead);
 }
 
 ///////////////////////////////////////////
 // Mesh Loading
 
+static bool validateMeshFile(const MeshFileHeader* pHeader, size_t fileSize)
+{
+	if (fileSize < sizeof(MeshFileHeader))
+		return false;
+
+	if (pHeader->magic != MESH_FILE_MAGIC || pHeader->version != MESH_FILE_VERSION)
+		return false;
+
+	if (pHeader->vertexCount == 0 || pHeader->vertexStride == 0)
+		return false;
+
+	if (pHeader->indexCount > 0 && pHeader->indexSize != 2 && pHeader->indexSize != 4)
+		return false;
+
+	uint64_t vertexBytes = (uint64_t)pHeader->vertexCount * pHeader->vertexStride;
+	uint64_t indexBytes = (uint64_t)pHeader->indexCount * pHeader->indexSize;
+	// Written so a huge offset or size cannot wrap around past the file size
+	if (pHeader->vertexOffset < sizeof(MeshFileHeader) || vertexBytes > fileSize ||
+		pHeader->vertexOffset > fileSize - vertexBytes)
+		return false;
+
+	if (indexBytes > 0 && (pHeader->indexOffset < sizeof(MeshFileHeader) ||
+						   indexBytes > fileSize || pHeader->indexOffset > fileSize - indexBytes))
+		return false;
+
+	return true;
+}
+
+/**
+	Inserts a mesh and accounts for its buffers.
+
+	Every mesh, loaded or procedural, goes through here.
+*/
+static MeshHandle insertMesh(AssetCache* pCache, MeshData* pData)
+{
+	pData->gpuBytes = (uint64_t)pData->vertexCount * pData->vertexStride +
+					  (uint64_t)pData->indexCount * pData->indexSize;
+	pData->lruOlder = HANDLE_INVALID_ID;
+	pData->lruNewer = HANDLE_INVALID_ID;
+
+	MeshHandle handle = {slotMapInsert(pCache->pMeshes, *pData)};
+	if (handleIsValid(handle.id))
+		pCache->stats.residentBytes += pData->gpuBytes;
+
+	return handle;
+}
+
 MeshHandle loadMesh(AssetCache* pCache, const char* path)
 {
-	if (!pCache || !path)
+	if (!path)
 		return MeshHandle{HANDLE_INVALID_ID};
 
-	bstring pathStr = bconstfromcstr(path);
+	return loadMeshHashed(pCache, hashedKeyFromString(path));
+}
+
+MeshHandle loadMeshHashed(AssetCache* pCache, HashedKey path)
+{
+	ENGINE_PROFILE_SCOPE("loadMesh");
+
+	if (!pCache || !path.pKey)
+		return MeshHandle{HANDLE_INVALID_ID};
 
 	// Check if already cached
-	if (bhgeti_unsafe(pCache->pMeshCache, pathStr) != -1)
+	MeshHandle* pCachedHandle = hashMapGetHashed<MeshHandle>(pCache->pMeshCache, path);
+	if (pCachedHandle)
 	{
-		MeshHandle cachedHandle = bhget(pCache->pMeshCache, pathStr);
-		MeshData* pCachedData = slotMapGet<MeshData>(pCache->pMeshes, cachedHandle.id);
+		MeshData* pCachedData = slotMapGet<MeshData>(pCache->pMeshes, pCachedHandle->id);
 		if (pCachedData)
 		{
+			if (pCachedData->refCount == 0)
+				removeUnused(pCache, pCache->pMeshes, &pCache->unusedMeshes, pCachedData);
 			pCachedData->refCount++;
 		}
-		return cachedHandle;
+		pCache->stats.hits++;
+		return *pCachedHandle;
+	}
+
+	pCache->stats.misses++;
+
+	FileStream stream = {};
+	if (!fsOpenStreamFromPath(RD_MESHES, path.pKey, FM_READ, &stream))
+	{
+		LOGF(eWARNING, "AssetCache: Failed to open mesh '%s'", path.pKey);
+		return MeshHandle{HANDLE_INVALID_ID};
+	}
+
+	// The cooked file is already in GPU layout, map it and upload in place
+	size_t fileSize = 0;
+	const void* pFileData = nullptr;
+	if (!fsStreamMemoryMap(&stream, &fileSize, &pFileData))
+	{
+		LOGF(eWARNING, "AssetCache: Failed to map mesh '%s'", path.pKey);
+		fsCloseStream(&stream);
+		return MeshHandle{HANDLE_INVALID_ID};
 	}
 
-	// TODO: Load mesh file (OBJ, GLTF, etc.)
+	const uint8_t* pBytes = (const uint8_t*)pFileData;
+	const MeshFileHeader* pHeader = (const MeshFileHeader*)pBytes;
+	if (!validateMeshFile(pHeader, fileSize))
+	{
+		LOGF(eWARNING, "AssetCache: '%s' is not a valid version %u mesh file", path.pKey,
+			 MESH_FILE_VERSION);
+		fsCloseStream(&stream);
+		return MeshHandle{HANDLE_INVALID_ID};
+	}
+
+	SyncToken token = {};
+
 	Buffer* pVertexBuffer = nullptr;
+	BufferLoadDesc vbDesc = {};
+	vbDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_VERTEX_BUFFER;
+	vbDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+	vbDesc.mDesc.mSize = (uint64_t)pHeader->vertexCount * pHeader->vertexStride;
+	vbDesc.pData = pBytes + pHeader->vertexOffset;
+	vbDesc.ppBuffer = &pVertexBuffer;
+	addResource(&vbDesc, &token);
+
 	Buffer* pIndexBuffer = nullptr;
-	uint32_t vertexCount = 0;
-	uint32_t indexCount = 0;
-	uint32_t vertexStride = 0;
+	if (pHeader->indexCount > 0)
+	{
+		BufferLoadDesc ibDesc = {};
+		ibDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_INDEX_BUFFER;
+		ibDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		ibDesc.mDesc.mSize = (uint64_t)pHeader->indexCount * pHeader->indexSize;
+		ibDesc.pData = pBytes + pHeader->indexOffset;
+		ibDesc.ppBuffer = &pIndexBuffer;
+		addResource(&ibDesc, &token);
+	}
+
+	// The loader reads from the mapping, keep it open until the copies land
+	waitForToken(&token);
+
+	uint32_t vertexCount = pHeader->vertexCount;
+	uint32_t indexCount = pHeader->indexCount;
+	uint32_t indexSize = pHeader->indexSize;
+	uint32_t vertexStride = pHeader->vertexStride;
+	float boundsMin[3];
+	float boundsMax[3];
+	memcpy(boundsMin, pHeader->boundsMin, sizeof(boundsMin));
+	memcpy(boundsMax, pHeader->boundsMax, sizeof(boundsMax));
+	fsCloseStream(&stream);
+
+	if (!pVertexBuffer || (indexCount > 0 && !pIndexBuffer))
+	{
+		LOGF(eWARNING, "AssetCache: Failed to upload mesh '%s'", path.pKey);
+		if (pVertexBuffer)
+			removeResource(pVertexBuffer);
+		if (pIndexBuffer)
+			removeResource(pIndexBuffer);
+		return MeshHandle{HANDLE_INVALID_ID};
+	}
 
 	MeshData meshData = {};
 	meshData.pVertexBuffer = pVertexBuffer;
 	meshData.pIndexBuffer = pIndexBuffer;
 	meshData.vertexCount = vertexCount;
 	meshData.indexCount = indexCount;
+	meshData.indexSize = indexSize;
 	meshData.vertexStride = vertexStride;
-	meshData.pathHash = (uint32_t)stbds_hash_string(path, 0);
+	meshData.pathHash = path.hash;
 	meshData.refCount = 1;
-	uint32_t handleId = slotMapInsert(pCache->pMeshes, meshData);
-	MeshHandle handle = {handleId};
+	memcpy(meshData.boundsMin, boundsMin, sizeof(boundsMin));
+	memcpy(meshData.boundsMax, boundsMax, sizeof(boundsMax));
+	MeshHandle handle = insertMesh(pCache, &meshData);
 
-	// Cache path -> handle mapping
-	bstring keyCopy = bdynfromcstr(path);
-	bhput(pCache->pMeshCache, keyCopy, handle);
+	// Cache path -> handle mapping, the map interns the path
+	hashMapInsertHashed(pCache->pMeshCache, path, handle);
+	slotMapGet<MeshData>(pCache->pMeshes, handle.id)->pPath =
+		hashMapGetKey(pCache->pMeshCache, path);
 
+	enforceAssetBudget(pCache);
 	return handle;
 }
 
@@ -245,29 +1084,52 @@ void unloadMesh(AssetCache* pCache, MeshHandle handle)
 	if (pData->refCount > 0)
 		return;
 
-	removeResource(pData->pVertexBuffer);
-	if (pData->pIndexBuffer)
-		removeResource(pData->pIndexBuffer);
+	// Procedural meshes cannot be asked for again, keeping them is pointless
+	if (!pData->pPath)
+	{
+		destroyMesh(pCache, handle, pData);
+		return;
+	}
 
-	slotMapRemove(pCache->pMeshes, handle.id);
+	pushUnused(pCache, pCache->pMeshes, &pCache->unusedMeshes, handle.id, pData);
+	enforceAssetBudget(pCache);
+}
 
-	// Remove from bstring hashmap cache
-	for (ptrdiff_t i = 0; i < bhlen(pCache->pMeshCache); ++i)
+static void destroyMesh(AssetCache* pCache, MeshHandle handle, MeshData* pData)
+{
+	// Draws recorded for frames still in flight may use the buffers
+	retireResource(pCache, nullptr, pData->pVertexBuffer);
+	if (pData->pIndexBuffer)
+		retireResource(pCache, nullptr, pData->pIndexBuffer);
+
+	if (pData->pPath)
 	{
-		if (pCache->pMeshCache[i].value.id == handle.id)
-		{
-			bdestroy(&pCache->pMeshCache[i].key);
-			bhdel(pCache->pMeshCache, pCache->pMeshCache[i].key);
-			break;
-		}
+		HashedKey key = {pData->pPath, (uint32_t)strlen(pData->pPath), pData->pathHash};
+		hashMapRemoveHashed(pCache->pMeshCache, key);
 	}
+
+	pCache->stats.residentBytes -= pData->gpuBytes;
+	slotMapRemove(pCache->pMeshes, handle.id);
 }
 
 ///////////////////////////////////////////
 // Procedural Generation
 
+// Symmetric object space AABB around the origin, used by the procedural meshes
+static void setMeshBounds(MeshData* pData, float halfX, float halfY, float halfZ)
+{
+	pData->boundsMin[0] = -halfX;
+	pData->boundsMin[1] = -halfY;
+	pData->boundsMin[2] = -halfZ;
+	pData->boundsMax[0] = halfX;
+	pData->boundsMax[1] = halfY;
+	pData->boundsMax[2] = halfZ;
+}
+
 MeshHandle createQuad(AssetCache* pCache, float width, float height)
 {
+	ENGINE_PROFILE_SCOPE("createQuad");
+
 	if (!pCache)
 		return MeshHandle{HANDLE_INVALID_ID};
 
@@ -286,6 +1148,8 @@ MeshHandle createQuad(AssetCache* pCache, float width, float height)
 
 	uint16_t indices[6] = {0, 1, 2, 2, 1, 3};
 
+	SyncToken token = {};
+
 	Buffer* pVertexBuffer = nullptr;
 	BufferLoadDesc vbDesc = {};
 	vbDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_VERTEX_BUFFER;
@@ -293,7 +1157,7 @@ MeshHandle createQuad(AssetCache* pCache, float width, float height)
 	vbDesc.mDesc.mSize = sizeof(vertices);
 	vbDesc.pData = vertices;
 	vbDesc.ppBuffer = &pVertexBuffer;
-	addResource(&vbDesc, NULL);
+	addResource(&vbDesc, &token);
 
 	Buffer* pIndexBuffer = nullptr;
 	BufferLoadDesc ibDesc = {};
@@ -302,9 +1166,10 @@ MeshHandle createQuad(AssetCache* pCache, float width, float height)
 	ibDesc.mDesc.mSize = sizeof(indices);
 	ibDesc.pData = indices;
 	ibDesc.ppBuffer = &pIndexBuffer;
-	addResource(&ibDesc, NULL);
+	addResource(&ibDesc, &token);
 
-	waitForAllResourceLoads();
+	// Only wait for these copies, other loads keep streaming
+	waitForToken(&token);
 
 	if (!pVertexBuffer || !pIndexBuffer)
 		return MeshHandle{HANDLE_INVALID_ID};
@@ -314,17 +1179,18 @@ MeshHandle createQuad(AssetCache* pCache, float width, float height)
 	meshData.pIndexBuffer = pIndexBuffer;
 	meshData.vertexCount = 4;
 	meshData.indexCount = 6;
+	meshData.indexSize = sizeof(uint16_t);
 	meshData.vertexStride = sizeof(Vertex);
 	meshData.pathHash = 0;
 	meshData.refCount = 1;
-	uint32_t handleId = slotMapInsert(pCache->pMeshes, meshData);
-	MeshHandle handle = {handleId};
-
-	return handle;
+	setMeshBounds(&meshData, halfW, halfH, 0.0f);
+	return insertMesh(pCache, &meshData);
 }
 
 MeshHandle createCube(AssetCache* pCache, float size)
 {
+	ENGINE_PROFILE_SCOPE("createCube");
+
 	if (!pCache)
 		return MeshHandle{HANDLE_INVALID_ID};
 
@@ -356,6 +1222,8 @@ MeshHandle createCube(AssetCache* pCache, float size)
 	uint16_t indices[36] = {0,	1,	2,	2,	3,	0,	4,	5,	6,	6,	7,	4,	8,	9,	10, 10, 11, 8,
 							12, 13, 14, 14, 15, 12, 16, 17, 18, 18, 19, 16, 20, 21, 22, 22, 23, 20};
 
+	SyncToken token = {};
+
 	Buffer* pVertexBuffer = nullptr;
 	BufferLoadDesc vbDesc = {};
 	vbDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_VERTEX_BUFFER;
@@ -363,7 +1231,7 @@ MeshHandle createCube(AssetCache* pCache, float size)
 	vbDesc.mDesc.mSize = sizeof(vertices);
 	vbDesc.pData = vertices;
 	vbDesc.ppBuffer = &pVertexBuffer;
-	addResource(&vbDesc, NULL);
+	addResource(&vbDesc, &token);
 
 	Buffer* pIndexBuffer = nullptr;
 	BufferLoadDesc ibDesc = {};
@@ -372,9 +1240,10 @@ MeshHandle createCube(AssetCache* pCache, float size)
 	ibDesc.mDesc.mSize = sizeof(indices);
 	ibDesc.pData = indices;
 	ibDesc.ppBuffer = &pIndexBuffer;
-	addResource(&ibDesc, NULL);
+	addResource(&ibDesc, &token);
 
-	waitForAllResourceLoads();
+	// Only wait for these copies, other loads keep streaming
+	waitForToken(&token);
 
 	if (!pVertexBuffer || !pIndexBuffer)
 		return MeshHandle{HANDLE_INVALID_ID};
@@ -384,17 +1253,18 @@ MeshHandle createCube(AssetCache* pCache, float size)
 	meshData.pIndexBuffer = pIndexBuffer;
 	meshData.vertexCount = 24;
 	meshData.indexCount = 36;
+	meshData.indexSize = sizeof(uint16_t);
 	meshData.vertexStride = sizeof(Vertex);
 	meshData.pathHash = 0;
 	meshData.refCount = 1;
-	uint32_t handleId = slotMapInsert(pCache->pMeshes, meshData);
-	MeshHandle handle = {handleId};
-
-	return handle;
+	setMeshBounds(&meshData, s, s, s);
+	return insertMesh(pCache, &meshData);
 }
 
 MeshHandle createSphere(AssetCache* pCache, float radius, uint32_t segments)
 {
+	ENGINE_PROFILE_SCOPE("createSphere");
+
 	// Referencing the Frank Luna D3D12 book
 	if (!pCache)
 		return MeshHandle{HANDLE_INVALID_ID};
@@ -461,6 +1331,8 @@ MeshHandle createSphere(AssetCache* pCache, float radius, uint32_t segments)
 		}
 	}
 
+	SyncToken token = {};
+
 	Buffer* pVertexBuffer = nullptr;
 	BufferLoadDesc vbDesc = {};
 	vbDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_VERTEX_BUFFER;
@@ -468,7 +1340,7 @@ MeshHandle createSphere(AssetCache* pCache, float radius, uint32_t segments)
 	vbDesc.mDesc.mSize = vertexCount * sizeof(Vertex);
 	vbDesc.pData = vertices;
 	vbDesc.ppBuffer = &pVertexBuffer;
-	addResource(&vbDesc, NULL);
+	addResource(&vbDesc, &token);
 
 	Buffer* pIndexBuffer = nullptr;
 	BufferLoadDesc ibDesc = {};
@@ -477,9 +1349,10 @@ MeshHandle createSphere(AssetCache* pCache, float radius, uint32_t segments)
 	ibDesc.mDesc.mSize = indexCount * sizeof(uint16_t);
 	ibDesc.pData = indices;
 	ibDesc.ppBuffer = &pIndexBuffer;
-	addResource(&ibDesc, NULL);
+	addResource(&ibDesc, &token);
 
-	waitForAllResourceLoads();
+	// Only wait for these copies, other loads keep streaming
+	waitForToken(&token);
 	if (!pVertexBuffer || !pIndexBuffer)
 		return MeshHandle{HANDLE_INVALID_ID};
 
@@ -488,11 +1361,10 @@ MeshHandle createSphere(AssetCache* pCache, float radius, uint32_t segments)
 	meshData.pIndexBuffer = pIndexBuffer;
 	meshData.vertexCount = vertexCount;
 	meshData.indexCount = indexCount;
+	meshData.indexSize = sizeof(uint16_t);
 	meshData.vertexStride = sizeof(Vertex);
 	meshData.pathHash = 0;
 	meshData.refCount = 1;
-	uint32_t handleId = slotMapInsert(pCache->pMeshes, meshData);
-	MeshHandle handle = {handleId};
-
-	return handle;
+	setMeshBounds(&meshData, radius, radius, radius);
+	return insertMesh(pCache, &meshData);
 }
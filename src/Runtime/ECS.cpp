@@ -3,94 +3,655 @@
  */
 
 #include "Runtime/ECS.h"
+#include "Runtime/JobSystem.h"
+#include "Runtime/Trace.h"
+#include "Core/TransformKernel.h"
 #include "Utilities/Interfaces/ILog.h"
 
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include "Utilities/Interfaces/IMemory.h"
+
 ECS_COMPONENT_DECLARE(MeshComponent);
 ECS_COMPONENT_DECLARE(TransformComponent);
+ECS_COMPONENT_DECLARE(WorldMatrixComponent);
 ECS_COMPONENT_DECLARE(MaterialComponent);
 ECS_COMPONENT_DECLARE(RenderableTag);
 ECS_COMPONENT_DECLARE(RenderContext);
 
+#define TRANSFORM_CHUNK_SIZE 64
+
+static_assert(sizeof(mat4) == 16 * sizeof(float), "composeTRSMatrices writes mat4 as 16 floats");
+
+static inline uint32_t countTrailingZeros64(uint64_t value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctzll(value);
+#endif
+}
+
+// Frame stamp written to TransformComponent::worldChangedFrame, 0 means never
+static inline uint32_t transformFrameStamp(ecs_iter_t* it)
+{
+	return (uint32_t)ecs_get_world_info(it->real_world)->frame_count_total + 1;
+}
+
+// Packs the dirty flags of a chunk into a bitmask without branching
+static inline uint64_t buildDirtyMask(const TransformComponent* pChunk, uint32_t chunkCount)
+{
+	uint64_t dirtyMask = 0;
+	for (uint32_t i = 0; i < chunkCount; i++)
+		dirtyMask |= (uint64_t)pChunk[i].dirty << i;
+	return dirtyMask;
+}
+
+// Gathers the masked entities of a chunk into structure of arrays form, clears
+// their dirty flags and stamps them. Returns the number of gathered entities.
+static uint32_t gatherTRSInputs(TransformComponent* pChunk, uint64_t mask, uint32_t stamp,
+								float inputs[9][TRANSFORM_CHUNK_SIZE], uint32_t* pIndices)
+{
+	uint32_t count = 0;
+	while (mask)
+	{
+		uint32_t i = countTrailingZeros64(mask);
+		mask &= mask - 1;
+
+		TransformComponent& transform = pChunk[i];
+		inputs[0][count] = transform.position.getX();
+		inputs[1][count] = transform.position.getY();
+		inputs[2][count] = transform.position.getZ();
+		inputs[3][count] = transform.rotation.getX();
+		inputs[4][count] = transform.rotation.getY();
+		inputs[5][count] = transform.rotation.getZ();
+		inputs[6][count] = transform.scale.getX();
+		inputs[7][count] = transform.scale.getY();
+		inputs[8][count] = transform.scale.getZ();
+		transform.dirty = false;
+		transform.worldChangedFrame = stamp;
+		pIndices[count++] = i;
+	}
+
+	return count;
+}
+
+// Widens the span to cover [startNs, endNs], called once per table from several threads
+static void recordSystemTimeSpan(SystemTimeSpan* pSpan, uint64_t startNs, uint64_t endNs)
+{
+	uint64_t first = tfrg_atomic64_load_relaxed(&pSpan->startNs);
+	while (first == 0 || startNs < first)
+	{
+		uint64_t prev = tfrg_atomic64_cas_relaxed(&pSpan->startNs, first, startNs);
+		if (prev == first)
+			break;
+		first = prev;
+	}
+
+	uint64_t last = tfrg_atomic64_load_relaxed(&pSpan->endNs);
+	while (endNs > last)
+	{
+		uint64_t prev = tfrg_atomic64_cas_relaxed(&pSpan->endNs, last, endNs);
+		if (prev == last)
+			break;
+		last = prev;
+	}
+}
+
+void resetSystemTimeSpan(SystemTimeSpan* pSpan)
+{
+	tfrg_atomic64_store_relaxed(&pSpan->startNs, 0);
+	tfrg_atomic64_store_relaxed(&pSpan->endNs, 0);
+}
+
+float getSystemTimeSpanMs(const SystemTimeSpan* pSpan)
+{
+	uint64_t startNs = tfrg_atomic64_load_relaxed((tfrg_atomic64_t*)&pSpan->startNs);
+	uint64_t endNs = tfrg_atomic64_load_relaxed((tfrg_atomic64_t*)&pSpan->endNs);
+	if (startNs == 0 || endNs < startNs)
+		return 0.0f;
+	return (float)((double)(endNs - startNs) / 1e6);
+}
+
+static void transformTable(ecs_iter_t* it);
+
 // Transform system
-// Updates world matrices from position/rotation/scale
+// Updates world matrices of root entities from position/rotation/scale
 void TransformSystem(ecs_iter_t* it)
+{
+	ENGINE_PROFILE_SCOPE("TransformSystem");
+
+	uint64_t startNs = ecs_os_now();
+	transformTable(it);
+
+	RenderContext* ctx = (RenderContext*)ecs_singleton_get(it->real_world, RenderContext);
+	if (ctx)
+		recordSystemTimeSpan(&ctx->transformTime, startNs, ecs_os_now());
+}
+
+static void transformTable(ecs_iter_t* it)
 {
 	TransformComponent* transforms = ecs_field(it, TransformComponent, 0);
+	WorldMatrixComponent* worlds = ecs_field(it, WorldMatrixComponent, 1);
+	uint32_t stamp = transformFrameStamp(it);
 
-	for (int i = 0; i < it->count; i++)
+	for (int chunkStart = 0; chunkStart < it->count; chunkStart += TRANSFORM_CHUNK_SIZE)
+	{
+		uint32_t chunkCount = (uint32_t)(it->count - chunkStart);
+		if (chunkCount > TRANSFORM_CHUNK_SIZE)
+			chunkCount = TRANSFORM_CHUNK_SIZE;
+
+		TransformComponent* pChunk = transforms + chunkStart;
+
+		uint64_t dirtyMask = buildDirtyMask(pChunk, chunkCount);
+		if (dirtyMask == 0)
+			continue;
+
+		float inputs[9][TRANSFORM_CHUNK_SIZE];
+		uint32_t indices[TRANSFORM_CHUNK_SIZE];
+		uint32_t dirtyCount = gatherTRSInputs(pChunk, dirtyMask, stamp, inputs, indices);
+
+		TRSInputs trs = {inputs[0], inputs[1], inputs[2], inputs[3], inputs[4],
+						 inputs[5], inputs[6], inputs[7], inputs[8]};
+
+		// A fully dirty chunk is composed straight into the world matrix column
+		WorldMatrixComponent* pWorlds = worlds + chunkStart;
+		if (dirtyCount == chunkCount)
+		{
+			composeTRSMatrices(&trs, (float*)pWorlds, dirtyCount);
+			continue;
+		}
+
+		mat4 matrices[TRANSFORM_CHUNK_SIZE];
+		composeTRSMatrices(&trs, (float*)matrices, dirtyCount);
+		for (uint32_t d = 0; d < dirtyCount; d++)
+			pWorlds[indices[d]].worldMatrix = matrices[d];
+	}
+}
+
+// Hierarchy system
+// Updates world matrices of child entities, one table per parent in breadth first order
+void HierarchySystem(ecs_iter_t* it)
+{
+	ENGINE_PROFILE_SCOPE("HierarchySystem");
+
+	TransformComponent* transforms = ecs_field(it, TransformComponent, 0);
+	WorldMatrixComponent* worlds = ecs_field(it, WorldMatrixComponent, 1);
+	const WorldMatrixComponent* pParentWorld = ecs_field(it, WorldMatrixComponent, 2);
+	const TransformComponent* pParentTransform = ecs_field(it, TransformComponent, 3);
+	uint32_t stamp = transformFrameStamp(it);
+
+	// ChildOf is part of the table type, so every entity in this table shares
+	// one parent. When that parent moved this frame the whole table follows.
+	bool parentChanged = pParentTransform->worldChangedFrame == stamp;
+	const mat4 parentWorld = pParentWorld->worldMatrix;
+
+	for (int chunkStart = 0; chunkStart < it->count; chunkStart += TRANSFORM_CHUNK_SIZE)
 	{
-		if (transforms[i].dirty)
+		uint32_t chunkCount = (uint32_t)(it->count - chunkStart);
+		if (chunkCount > TRANSFORM_CHUNK_SIZE)
+			chunkCount = TRANSFORM_CHUNK_SIZE;
+
+		TransformComponent* pChunk = transforms + chunkStart;
+
+		uint64_t mask = parentChanged ? (~0ull >> (TRANSFORM_CHUNK_SIZE - chunkCount))
+									  : buildDirtyMask(pChunk, chunkCount);
+		if (mask == 0)
+			continue;
+
+		float inputs[9][TRANSFORM_CHUNK_SIZE];
+		uint32_t indices[TRANSFORM_CHUNK_SIZE];
+		uint32_t count = gatherTRSInputs(pChunk, mask, stamp, inputs, indices);
+
+		TRSInputs trs = {inputs[0], inputs[1], inputs[2], inputs[3], inputs[4],
+						 inputs[5], inputs[6], inputs[7], inputs[8]};
+
+		mat4 matrices[TRANSFORM_CHUNK_SIZE];
+		composeTRSMatrices(&trs, (float*)matrices, count);
+
+		WorldMatrixComponent* pWorlds = worlds + chunkStart;
+		for (uint32_t d = 0; d < count; d++)
+			pWorlds[indices[d]].worldMatrix = parentWorld * matrices[d];
+	}
+}
+
+// Culling system
+// Tests world space bounding spheres against the camera frustum
+void CullingSystem(ecs_iter_t* it)
+{
+	ENGINE_PROFILE_SCOPE("CullingSystem");
+
+	WorldMatrixComponent* worlds = ecs_field(it, WorldMatrixComponent, 0);
+	MeshComponent* meshes = ecs_field(it, MeshComponent, 1);
+	RenderableTag* tags = ecs_field(it, RenderableTag, 2);
+
+	// Read through the real world, it->world is this thread's stage
+	RenderContext* ctx = (RenderContext*)ecs_singleton_get(it->real_world, RenderContext);
+	if (!ctx || !ctx->cullingEnabled)
+	{
+		uint32_t hiddenCount = 0;
+		for (int i = 0; i < it->count; i++)
+		{
+			tags[i].inFrustum = true;
+			hiddenCount += tags[i].visible ? 0 : 1;
+		}
+		if (ctx && hiddenCount)
+			tfrg_atomic32_add_relaxed(&ctx->culledCount, hiddenCount);
+		return;
+	}
+
+	uint32_t culledCount = 0;
+	for (int chunkStart = 0; chunkStart < it->count; chunkStart += TRANSFORM_CHUNK_SIZE)
+	{
+		uint32_t chunkCount = (uint32_t)(it->count - chunkStart);
+		if (chunkCount > TRANSFORM_CHUNK_SIZE)
+			chunkCount = TRANSFORM_CHUNK_SIZE;
+
+		// Move the bounding spheres to world space in structure of arrays form
+		float centerX[TRANSFORM_CHUNK_SIZE];
+		float centerY[TRANSFORM_CHUNK_SIZE];
+		float centerZ[TRANSFORM_CHUNK_SIZE];
+		float radius[TRANSFORM_CHUNK_SIZE];
+		for (uint32_t i = 0; i < chunkCount; i++)
 		{
-			mat4 T = mat4::translation(transforms[i].position);
-			mat4 R = mat4::rotationZYX(transforms[i].rotation);
-			mat4 S = mat4::scale(transforms[i].scale);
+			const float* m = (const float*)&worlds[chunkStart + i].worldMatrix;
+			const MeshComponent& mesh = meshes[chunkStart + i];
+			float cx = mesh.boundsCenter[0];
+			float cy = mesh.boundsCenter[1];
+			float cz = mesh.boundsCenter[2];
+			centerX[i] = m[0] * cx + m[4] * cy + m[8] * cz + m[12];
+			centerY[i] = m[1] * cx + m[5] * cy + m[9] * cz + m[13];
+			centerZ[i] = m[2] * cx + m[6] * cy + m[10] * cz + m[14];
+
+			float scaleX = m[0] * m[0] + m[1] * m[1] + m[2] * m[2];
+			float scaleY = m[4] * m[4] + m[5] * m[5] + m[6] * m[6];
+			float scaleZ = m[8] * m[8] + m[9] * m[9] + m[10] * m[10];
+			float maxScale = fmaxf(scaleX, fmaxf(scaleY, scaleZ));
 
-			transforms[i].worldMatrix = T * R * S;
-			transforms[i].dirty = false;
+			// Unknown bounds get a radius no plane can reject
+			radius[i] = mesh.boundsRadius < 0.0f ? FLT_MAX : mesh.boundsRadius * sqrtf(maxScale);
+		}
+
+		uint8_t inFrustum[TRANSFORM_CHUNK_SIZE];
+		cullSpheres(&ctx->cullFrustum, centerX, centerY, centerZ, radius, chunkCount, inFrustum);
+
+		RenderableTag* pTags = tags + chunkStart;
+		for (uint32_t i = 0; i < chunkCount; i++)
+		{
+			pTags[i].inFrustum = inFrustum[i] != 0;
+			culledCount += (pTags[i].visible && pTags[i].inFrustum) ? 0 : 1;
 		}
 	}
+
+	if (culledCount)
+		tfrg_atomic32_add_relaxed(&ctx->culledCount, culledCount);
 }
 
+static void fillRenderDataTable(ecs_iter_t* it, RenderContext* ctx,
+								const WorldMatrixComponent* worlds, const MeshComponent* meshes,
+								const MaterialComponent* materials, const RenderableTag* tags);
+
 // Fill render data system
 // Prepares data for GPU upload
 void FillRenderDataSystem(ecs_iter_t* it)
 {
+	ENGINE_PROFILE_SCOPE("FillRenderDataSystem");
+
 	//LOGF(LogLevel::eINFO, "FillRenderDataSystem called: %d entities, field_count=%d", it->count,
 	//	 it->field_count);
 
-	// 3 components
-	TransformComponent* transforms = ecs_field(it, TransformComponent, 0);
+	// 4 components
+	WorldMatrixComponent* worlds = ecs_field(it, WorldMatrixComponent, 0);
 	MeshComponent* meshes = ecs_field(it, MeshComponent, 1);
 	MaterialComponent* materials = ecs_field(it, MaterialComponent, 2);
+	const RenderableTag* tags = ecs_field(it, RenderableTag, 3);
 
-	RenderContext* ctx = (RenderContext*)ecs_singleton_get(it->world, RenderContext);
+	// Read through the real world, it->world is this thread's stage
+	RenderContext* ctx = (RenderContext*)ecs_singleton_get(it->real_world, RenderContext);
 	if (!ctx || !ctx->pRenderDataArray)
 	{
 		LOGF(LogLevel::eERROR, "FillRenderDataSystem: No render context! ctx=%p", ctx);
 		return;
 	}
 
-	// Fill render data for each entity
+	uint64_t startNs = ecs_os_now();
+	fillRenderDataTable(it, ctx, worlds, meshes, materials, tags);
+	recordSystemTimeSpan(&ctx->fillRenderDataTime, startNs, ecs_os_now());
+}
+
+static void fillRenderDataTable(ecs_iter_t* it, RenderContext* ctx,
+								const WorldMatrixComponent* worlds, const MeshComponent* meshes,
+								const MaterialComponent* materials, const RenderableTag* tags)
+{
+	uint32_t drawnCount = 0;
 	for (int i = 0; i < it->count; i++)
+		drawnCount += (tags[i].visible && tags[i].inFrustum) ? 1 : 0;
+
+	if (drawnCount == 0)
+		return;
+
+	// Claim a contiguous range for this table with one atomic add, no per
+	// entity contention between threads
+	uint32_t firstIndex = tfrg_atomic32_add_relaxed(&ctx->renderDataCount, drawnCount);
+	uint32_t count = drawnCount;
+	if (firstIndex >= ctx->maxRenderData)
+		count = 0;
+	else if (firstIndex + count > ctx->maxRenderData)
+		count = ctx->maxRenderData - firstIndex;
+
+	if (count < drawnCount)
+	{
+		LOGF(LogLevel::eWARNING, "FillRenderDataSystem: Dropped %u entities, reserve more render data",
+			 drawnCount - count);
+	}
+
+	// Fill render data for each entity that survived culling, packed
+	uint32_t renderIndex = firstIndex;
+	for (int i = 0; i < it->count && renderIndex < firstIndex + count; i++)
+	{
+		if (!tags[i].visible || !tags[i].inFrustum)
+			continue;
+
+		MeshRenderData& renderData = ctx->pRenderDataArray[renderIndex];
+
+		renderData.modelMatrix = worlds[i].worldMatrix;
+		renderData.pVertexBuffer = meshes[i].pVertexBuffer;
+		renderData.pIndexBuffer = meshes[i].pIndexBuffer;
+		renderData.vertexCount = meshes[i].vertexCount;
+		renderData.indexCount = meshes[i].indexCount;
+		renderData.indexSize = meshes[i].indexSize;
+		renderData.vertexStride = meshes[i].vertexStride;
+		renderData.descriptorSetIndex = renderIndex;
+		renderData.pPipeline = materials[i].pPipeline;
+		renderData.pInstancedPipeline = materials[i].pInstancedPipeline;
+		renderData.textureSlot = materials[i].textureSlot;
+		renderData.sortKey = computeRenderSortKey(&renderData);
+		renderIndex++;
+	}
+}
+
+bool reserveRenderData(RenderContext* pCtx, uint32_t count)
+{
+	if (!pCtx)
+		return false;
+
+	if (count <= pCtx->maxRenderData)
+		return true;
+
+	uint32_t newMax = pCtx->maxRenderData ? pCtx->maxRenderData : 256;
+	while (newMax < count)
+		newMax *= 2;
+
+	MeshRenderData* pGrown =
+		(MeshRenderData*)tf_realloc(pCtx->pRenderDataArray, newMax * sizeof(MeshRenderData));
+	if (!pGrown)
 	{
-		uint32_t renderIndex = ctx->renderDataCount;
-		if (renderIndex >= ctx->maxRenderData)
+		LOGF(LogLevel::eERROR, "reserveRenderData: Failed to grow render data to %d", newMax);
+		return false;
+	}
+
+	pCtx->pRenderDataArray = pGrown;
+	pCtx->maxRenderData = newMax;
+	return true;
+}
+
+// Fibonacci hashing, keeps the top bits of the product
+static inline uint64_t hashPointerBits(const void* ptr, uint32_t bits)
+{
+	return ((uint64_t)(uintptr_t)ptr * 0x9E3779B97F4A7C15ull) >> (64 - bits);
+}
+
+// Maps a float to an unsigned int with the same ordering
+static inline uint32_t sortableFloatBits(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+uint64_t computeRenderSortKey(const MeshRenderData* pData)
+{
+	if (!pData)
+		return UINT64_MAX;
+
+	Pipeline* pKeyPipeline = pData->pInstancedPipeline ? pData->pInstancedPipeline
+													   : pData->pPipeline;
+	uint64_t notInstanced = pData->pInstancedPipeline ? 0 : 1;
+	uint64_t pipelineBits = hashPointerBits(pKeyPipeline, 15);
+	uint64_t bufferBits =
+		hashPointerBits(pData->pVertexBuffer, 16) ^ hashPointerBits(pData->pIndexBuffer, 16);
+	uint64_t depthBits = sortableFloatBits(pData->modelMatrix.getTranslation().getZ()) >> 16;
+	uint64_t slotBits = pData->descriptorSetIndex & 0xFFFF;
+
+	return (notInstanced << 63) | (pipelineBits << 48) | (bufferBits << 32) | (depthBits << 16) |
+		   slotBits;
+}
+
+uint32_t buildInstanceBatches(MeshRenderData* pRenderData, uint32_t count,
+							  InstanceBatch* pBatches, uint32_t* pInstancedCount)
+{
+	if (pInstancedCount)
+		*pInstancedCount = 0;
+
+	if (!pRenderData || !pBatches || count == 0)
+		return 0;
+
+	uint32_t batchCount = 0;
+	uint32_t i = 0;
+	for (; i < count && pRenderData[i].pInstancedPipeline; ++i)
+	{
+		const MeshRenderData& data = pRenderData[i];
+		InstanceBatch* pLast = batchCount > 0 ? &pBatches[batchCount - 1] : NULL;
+
+		if (pLast && pLast->pPipeline == data.pInstancedPipeline &&
+			pLast->pVertexBuffer == data.pVertexBuffer && pLast->pIndexBuffer == data.pIndexBuffer)
 		{
-			LOGF(LogLevel::eWARNING, "FillRenderDataSystem: Render data buffer full!");
-			break;
+			pLast->instanceCount++;
+			continue;
 		}
 
-		ctx->pRenderDataArray[renderIndex].modelMatrix = transforms[i].worldMatrix;
-		ctx->pRenderDataArray[renderIndex].pVertexBuffer = meshes[i].pVertexBuffer;
-		ctx->pRenderDataArray[renderIndex].pIndexBuffer = meshes[i].pIndexBuffer;
-		ctx->pRenderDataArray[renderIndex].vertexCount = meshes[i].vertexCount;
-		ctx->pRenderDataArray[renderIndex].indexCount = meshes[i].indexCount;
-		ctx->pRenderDataArray[renderIndex].vertexStride = meshes[i].vertexStride;
-		ctx->pRenderDataArray[renderIndex].descriptorSetIndex = meshes[i].descriptorSetIndex;
-		ctx->pRenderDataArray[renderIndex].pPipeline = materials[i].pPipeline;
-		ctx->renderDataCount++;
+		InstanceBatch& batch = pBatches[batchCount++];
+		batch.pPipeline = data.pInstancedPipeline;
+		batch.pVertexBuffer = data.pVertexBuffer;
+		batch.pIndexBuffer = data.pIndexBuffer;
+		batch.vertexCount = data.vertexCount;
+		batch.indexCount = data.indexCount;
+		batch.indexSize = data.indexSize;
+		batch.vertexStride = data.vertexStride;
+		batch.firstInstance = i;
+		batch.instanceCount = 1;
+	}
+
+	if (pInstancedCount)
+		*pInstancedCount = i;
+
+	return batchCount;
+}
+
+// Job system the flecs task hooks submit to, set by initECSJobHooks
+static JobSystem* gpEcsJobSystem = nullptr;
+static ecs_os_api_task_new_t gDefaultTaskNew = nullptr;
+static ecs_os_api_task_join_t gDefaultTaskJoin = nullptr;
+
+/**
+	One flecs task running as a job, the thread handle flecs gets back.
+*/
+struct EcsTask
+{
+	ecs_os_thread_callback_t callback;
+	void* pParam;
+	void* pResult;
+	JobCounter counter;
+};
+
+static void ecsTaskJob(void* pData)
+{
+	EcsTask* pTask = (EcsTask*)pData;
+	pTask->pResult = pTask->callback(pTask->pParam);
+}
+
+static ecs_os_thread_t ecsTaskNew(ecs_os_thread_callback_t callback, void* pParam)
+{
+	EcsTask* pTask = (EcsTask*)tf_calloc(1, sizeof(EcsTask));
+	if (!pTask)
+	{
+		LOGF(LogLevel::eERROR, "Failed to allocate ECS task");
+		return 0;
+	}
+
+	pTask->callback = callback;
+	pTask->pParam = pParam;
+
+	// flecs workers wait for each other at sync points, so they must not be
+	// picked up by a thread that is itself waiting
+	JobDesc job = {ecsTaskJob, pTask, JobFlag_Blocking};
+	jobRun(gpEcsJobSystem, &job, 1, &pTask->counter);
+
+	return (ecs_os_thread_t)pTask;
+}
+
+static void* ecsTaskJoin(ecs_os_thread_t thread)
+{
+	EcsTask* pTask = (EcsTask*)thread;
+	if (!pTask)
+		return nullptr;
+
+	jobWait(gpEcsJobSystem, &pTask->counter);
+
+	void* pResult = pTask->pResult;
+	tf_free(pTask);
+	return pResult;
+}
 
-		//LOGF(LogLevel::eINFO,
-		//	 "FillRenderDataSystem: Added entity %d (descriptor %d), total count now %d", i,
-		//	 meshes[i].descriptorSetIndex, ctx->renderDataCount);
+void initECSJobHooks(JobSystem* pJobSystem)
+{
+	if (ecs_os_api.task_new_ != ecsTaskNew)
+	{
+		gDefaultTaskNew = ecs_os_api.task_new_;
+		gDefaultTaskJoin = ecs_os_api.task_join_;
 	}
+
+	// ecs_os_set_api() is ignored once initEntityComponentSystem() set the API,
+	// so the hooks are patched in place
+	gpEcsJobSystem = pJobSystem;
+	ecs_os_api.task_new_ = pJobSystem ? ecsTaskNew : gDefaultTaskNew;
+	ecs_os_api.task_join_ = pJobSystem ? ecsTaskJoin : gDefaultTaskJoin;
 }
 
 void initECS(ecs_world_t* world)
 {
 	ECS_COMPONENT_DEFINE(world, MeshComponent);
 	ECS_COMPONENT_DEFINE(world, TransformComponent);
+	ECS_COMPONENT_DEFINE(world, WorldMatrixComponent);
 	ECS_COMPONENT_DEFINE(world, MaterialComponent);
 	ECS_COMPONENT_DEFINE(world, RenderableTag);
 
 	ECS_COMPONENT_DEFINE(world, RenderContext);
 
-	ECS_SYSTEM(world, TransformSystem, EcsOnUpdate, TransformComponent);
-	ECS_SYSTEM(world, FillRenderDataSystem, EcsPostUpdate, TransformComponent, MeshComponent, MaterialComponent);
+	// Both systems only write per entity data or claimed slots, so flecs can
+	// split their tables across the threads set with ecs_set_task_threads()
+	ecs_system_desc_t transformDesc = {};
+	ecs_entity_desc_t transformEntity = {};
+	ecs_id_t transformPhase[] = {ecs_dependson(EcsOnUpdate), 0};
+	transformEntity.name = "TransformSystem";
+	transformEntity.add = transformPhase;
+	transformDesc.entity = ecs_entity_init(world, &transformEntity);
+	transformDesc.query.terms[0].id = ecs_id(TransformComponent);
+	transformDesc.query.terms[1].id = ecs_id(WorldMatrixComponent);
+	// Roots only, entities under a transform parent belong to HierarchySystem
+	transformDesc.query.terms[2].id = ecs_id(WorldMatrixComponent);
+	transformDesc.query.terms[2].src.id = EcsUp;
+	transformDesc.query.terms[2].trav = EcsChildOf;
+	transformDesc.query.terms[2].oper = EcsNot;
+	transformDesc.callback = TransformSystem;
+	transformDesc.multi_threaded = true;
+	ecs_system_init(world, &transformDesc);
+
+	// Cascade orders the tables by depth, parents are always resolved before
+	// their children. Single threaded so that order holds across tables.
+	ecs_system_desc_t hierarchyDesc = {};
+	ecs_entity_desc_t hierarchyEntity = {};
+	ecs_id_t hierarchyPhase[] = {ecs_dependson(EcsOnUpdate), 0};
+	hierarchyEntity.name = "HierarchySystem";
+	hierarchyEntity.add = hierarchyPhase;
+	hierarchyDesc.entity = ecs_entity_init(world, &hierarchyEntity);
+	hierarchyDesc.query.terms[0].id = ecs_id(TransformComponent);
+	hierarchyDesc.query.terms[1].id = ecs_id(WorldMatrixComponent);
+	hierarchyDesc.query.terms[2].id = ecs_id(WorldMatrixComponent);
+	hierarchyDesc.query.terms[2].src.id = EcsUp | EcsCascade;
+	hierarchyDesc.query.terms[2].trav = EcsChildOf;
+	hierarchyDesc.query.terms[2].inout = EcsIn;
+	hierarchyDesc.query.terms[3].id = ecs_id(TransformComponent);
+	hierarchyDesc.query.terms[3].src.id = EcsUp;
+	hierarchyDesc.query.terms[3].trav = EcsChildOf;
+	hierarchyDesc.query.terms[3].inout = EcsIn;
+	hierarchyDesc.callback = HierarchySystem;
+	ecs_system_init(world, &hierarchyDesc);
+
+	ecs_system_desc_t cullDesc = {};
+	ecs_entity_desc_t cullEntity = {};
+	ecs_id_t cullPhase[] = {ecs_dependson(EcsOnValidate), 0};
+	cullEntity.name = "CullingSystem";
+	cullEntity.add = cullPhase;
+	cullDesc.entity = ecs_entity_init(world, &cullEntity);
+	cullDesc.query.terms[0].id = ecs_id(WorldMatrixComponent);
+	cullDesc.query.terms[0].inout = EcsIn;
+	cullDesc.query.terms[1].id = ecs_id(MeshComponent);
+	cullDesc.query.terms[1].inout = EcsIn;
+	cullDesc.query.terms[2].id = ecs_id(RenderableTag);
+	cullDesc.callback = CullingSystem;
+	cullDesc.multi_threaded = true;
+	ecs_system_init(world, &cullDesc);
+
+	ecs_system_desc_t fillDesc = {};
+	ecs_entity_desc_t fillEntity = {};
+	ecs_id_t fillPhase[] = {ecs_dependson(EcsPostUpdate), 0};
+	fillEntity.name = "FillRenderDataSystem";
+	fillEntity.add = fillPhase;
+	fillDesc.entity = ecs_entity_init(world, &fillEntity);
+	fillDesc.query.terms[0].id = ecs_id(WorldMatrixComponent);
+	fillDesc.query.terms[1].id = ecs_id(MeshComponent);
+	fillDesc.query.terms[2].id = ecs_id(MaterialComponent);
+	fillDesc.query.terms[3].id = ecs_id(RenderableTag);
+	fillDesc.query.terms[3].inout = EcsIn;
+	fillDesc.callback = FillRenderDataSystem;
+	fillDesc.multi_threaded = true;
+	ecs_system_init(world, &fillDesc);
 
 	LOGF(LogLevel::eINFO, "ECS initialized!");
 }
 
+// Adds the transform and world matrix components shared by every transform node
+static void initTransformComponents(ecs_world_t* world, ecs_entity_t entity, const vec3& position,
+									const vec3& rotation, const vec3& scale, ecs_entity_t parent)
+{
+	WorldMatrixComponent worldMatrix = {};
+	worldMatrix.worldMatrix = mat4::identity();
+	ecs_set(world, entity, WorldMatrixComponent, worldMatrix);
+
+	TransformComponent transform = {};
+	transform.position = position;
+	transform.rotation = rotation;
+	transform.scale = scale;
+	transform.dirty = true;
+	ecs_set(world, entity, TransformComponent, transform);
+
+	if (parent)
+		ecs_add_pair(world, entity, EcsChildOf, parent);
+}
+
+ecs_entity_t createTransformEntity(ecs_world_t* world, const TransformDesc* pDesc,
+								   ecs_entity_t parent)
+{
+	ecs_entity_t entity = ecs_new(world);
+	initTransformComponents(world, entity, pDesc->position, pDesc->rotation, pDesc->scale, parent);
+	return entity;
+}
+
 ecs_entity_t createMeshEntity(ecs_world_t* world, const MeshEntityDesc* pDesc)
 {
 	ecs_entity_t entity = ecs_new(world);
@@ -100,26 +661,41 @@ ecs_entity_t createMeshEntity(ecs_world_t* world, const MeshEntityDesc* pDesc)
 	mesh.pIndexBuffer = pDesc->pIndexBuffer;
 	mesh.vertexCount = pDesc->vertexCount;
 	mesh.indexCount = pDesc->indexCount;
+	mesh.indexSize = pDesc->indexSize;
 	mesh.vertexStride = pDesc->vertexStride;
+	mesh.boundsRadius = -1.0f;
+
+	const float* pMin = pDesc->boundsMin;
+	const float* pMax = pDesc->boundsMax;
+	bool hasBounds = pMin[0] != 0.0f || pMin[1] != 0.0f || pMin[2] != 0.0f || pMax[0] != 0.0f ||
+					 pMax[1] != 0.0f || pMax[2] != 0.0f;
+	if (hasBounds)
+	{
+		float halfExtent[3];
+		for (int c = 0; c < 3; ++c)
+		{
+			mesh.boundsCenter[c] = (pMin[c] + pMax[c]) * 0.5f;
+			halfExtent[c] = (pMax[c] - pMin[c]) * 0.5f;
+		}
+		mesh.boundsRadius = sqrtf(halfExtent[0] * halfExtent[0] + halfExtent[1] * halfExtent[1] +
+								  halfExtent[2] * halfExtent[2]);
+	}
 	ecs_set(world, entity, MeshComponent, mesh);
 
-	TransformComponent transform = {};
-	transform.worldMatrix = mat4::identity();
-	transform.position = pDesc->position;
-	transform.rotation = pDesc->rotation;
-	transform.scale = pDesc->scale;
-	transform.dirty = true;
-	ecs_set(world, entity, TransformComponent, transform);
+	initTransformComponents(world, entity, pDesc->position, pDesc->rotation, pDesc->scale,
+							pDesc->parent);
 
 	MaterialComponent material = {};
 	material.pPipeline = pDesc->pPipeline;
+	material.pInstancedPipeline = pDesc->pInstancedPipeline;
+	material.textureSlot = pDesc->textureSlot;
 	ecs_set(world, entity, MaterialComponent, material);
 
 	RenderableTag tag = {};
 	tag.visible = true;
+	tag.inFrustum = true;
 	ecs_set(world, entity, RenderableTag, tag);
 
-	LOGF(LogLevel::eINFO, "Created mesh entity %llu", entity);
 	return entity;
 }
 
@@ -133,4 +709,17 @@ void updateTransform(ecs_world_t* world, ecs_entity_t entity, const TransformDes
 		transform->scale = pDesc->scale;
 		transform->dirty = true;
 	}
-}
\ No newline at end of file
+}
+
+void setParent(ecs_world_t* world, ecs_entity_t child, ecs_entity_t parent)
+{
+	if (parent)
+		ecs_add_pair(world, child, EcsChildOf, parent);
+	else
+		ecs_remove_pair(world, child, EcsChildOf, EcsWildcard);
+
+	// The cached world matrix was relative to the old parent
+	TransformComponent* transform = ecs_get_mut(world, child, TransformComponent);
+	if (transform)
+		transform->dirty = true;
+}
@@ -1,121 +1,356 @@
 /*
- * Engine - Implementation wrapping The Forge
+ * Engine.cpp
  *
- * This file encapsulates all The Forge complexity.
- * The Game project never sees any of this.
+ * IEngine.h on top of EngineApp. Headless engines are driven directly
+ * from the host's thread. Windowed engines run The Forge's platform loop
+ * on an engine thread that waits in Update() and Draw() until the host
+ * asks for a tick, so the window, input and swapchain stay on the thread
+ * that created them.
  */
 
-#include "Engine/IEngine.h"
-
-// The Forge headers (internal only)
-#include "Application/Interfaces/IApp.h"
-#include "Application/Interfaces/IFont.h"
-#include "Application/Interfaces/IUI.h"
-#include "Graphics/Interfaces/IGraphics.h"
+#include "Runtime/IEngine.h"
+#include "Runtime/EngineApp.h"
 #include "Utilities/Interfaces/ILog.h"
-#include "Utilities/Interfaces/ITime.h"
 
-// Simple app implementation
-class EngineApp : public IApp
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#if defined(_WIN32)
+extern int WindowsMain(int argc, char** argv, IApp* app);
+#endif
+
+enum EngineCommand : uint32_t
+{
+	EngineCommand_None = 0,
+	EngineCommand_Update,
+	EngineCommand_Draw,
+};
+
+/// How long a command waits for the engine thread to pick it up before it is dropped
+static const uint32_t ENGINE_COMMAND_TIMEOUT_MS = 100;
+
+/**
+	Handoff between the host and the engine thread of a windowed engine.
+
+	The host posts one command and blocks until the engine thread cleared
+	it, so the two threads never run engine code at the same time. The
+	Forge skips Update() and Draw() while the window is minimized, so a
+	command the engine thread does not pick up in time is withdrawn.
+
+	Quitting is not a command, it has to get through while Update() and
+	Draw() are skipped.
+
+	The Forge's threads and allocator only exist once WindowsMain runs on
+	the engine thread, which is why this uses the standard library.
+*/
+struct EngineHost
+{
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable condition;
+	EngineCommand command;
+	float deltaTime;
+	bool commandTaken; ///< The engine thread runs command, it can no longer be withdrawn
+	bool quit;		   ///< engineShutdown() was called
+	bool loaded;	   ///< Init() and the first Load() succeeded
+	bool finished;	   ///< The engine thread left WindowsMain
+};
+
+/**
+	The EngineApp engineInit() runs.
+
+	Without a host it is a plain EngineApp. With one, Update() and Draw()
+	wait for the host's command instead of running on The Forge's clock.
+*/
+class HostedEngineApp : public EngineApp
 {
 public:
-    bool Init() override
-    {
-        LOGF(LogLevel::eINFO, "Engine Init");
-        return true;
-    }
-
-    void Exit() override
-    {
-        LOGF(LogLevel::eINFO, "Engine Exit");
-    }
-
-    bool Load(ReloadDesc* pReloadDesc) override
-    {
-        LOGF(LogLevel::eINFO, "Engine Load");
-        return true;
-    }
-
-    void Unload(ReloadDesc* pReloadDesc) override
-    {
-        LOGF(LogLevel::eINFO, "Engine Unload");
-    }
-
-    void Update(float deltaTime) override
-    {
-        // Game logic updates go here
-    }
-
-    void Draw() override
-    {
-        // Rendering goes here
-    }
-
-    const char* GetName() override
-    {
-        return "Engine";
-    }
+	HostedEngineApp(const char* pAppName, EngineHost* pEngineHost)
+	: pName(pAppName)
+	, pHost(pEngineHost)
+	{
+	}
+
+	bool Load(ReloadDesc* pReloadDesc) override
+	{
+		if (!EngineApp::Load(pReloadDesc))
+			return false;
+
+		// The first load ends engineInit(), later ones are resizes
+		if (pHost)
+		{
+			std::lock_guard<std::mutex> lock(pHost->mutex);
+			pHost->loaded = true;
+			pHost->condition.notify_all();
+		}
+		return true;
+	}
+
+	void Update(float deltaTime) override
+	{
+		if (!pHost)
+		{
+			EngineApp::Update(deltaTime);
+			return;
+		}
+
+		// A pending draw is left for the Draw() that follows
+		if (waitForCommand(EngineCommand_Update) != EngineCommand_Update)
+			return;
+
+		EngineApp::Update(pHost->deltaTime);
+		completeCommand();
+	}
+
+	void Draw() override
+	{
+		if (!pHost)
+		{
+			EngineApp::Draw();
+			return;
+		}
+
+		// Update after update, this frame is not drawn
+		if (waitForCommand(EngineCommand_Draw) != EngineCommand_Draw)
+			return;
+
+		EngineApp::Draw();
+		completeCommand();
+	}
+
+	const char* GetName() override { return pName; }
+
+private:
+	const char* pName;
+	EngineHost* pHost;
+
+	/**
+		Waits for the host's next command.
+
+		@param accepted Command the caller runs, marked as taken when it is the one posted
+
+		@return The posted command, EngineCommand_None when the host quit
+	*/
+	EngineCommand waitForCommand(EngineCommand accepted)
+	{
+		std::unique_lock<std::mutex> lock(pHost->mutex);
+		pHost->condition.wait(lock, [this]() {
+			return pHost->quit || pHost->command != EngineCommand_None;
+		});
+
+		if (pHost->quit)
+		{
+			mSettings.mQuit = true;
+			return EngineCommand_None;
+		}
+
+		if (pHost->command == accepted)
+			pHost->commandTaken = true;
+		return pHost->command;
+	}
+
+	void completeCommand()
+	{
+		std::lock_guard<std::mutex> lock(pHost->mutex);
+		pHost->command = EngineCommand_None;
+		pHost->commandTaken = false;
+		pHost->condition.notify_all();
+	}
 };
 
 // Global engine state
-static EngineApp* gpEngineApp = NULL;
+static HostedEngineApp* gpEngineApp = NULL;
+static EngineHost* gpEngineHost = NULL; ///< nullptr for headless engines
 
-// C API implementation
-bool engineInit(EngineDesc* pDesc)
+/**
+	Hands a command to the engine thread.
+
+	Waits until the command ran. A command the engine thread has not
+	picked up after ENGINE_COMMAND_TIMEOUT_MS, because The Forge skips
+	Update() and Draw() while the window is minimized, is withdrawn.
+
+	@return True if the command ran, false if it was dropped or the engine
+			thread is gone
+*/
+static bool postEngineCommand(EngineCommand command, float deltaTime)
 {
-    if (!pDesc)
-        return false;
+	std::unique_lock<std::mutex> lock(gpEngineHost->mutex);
+	if (gpEngineHost->finished || gpEngineHost->quit)
+		return false;
+
+	gpEngineHost->command = command;
+	gpEngineHost->deltaTime = deltaTime;
+	gpEngineHost->commandTaken = false;
+	gpEngineHost->condition.notify_all();
+
+	const std::chrono::milliseconds timeout(ENGINE_COMMAND_TIMEOUT_MS);
+	while (!gpEngineHost->finished && gpEngineHost->command != EngineCommand_None)
+	{
+		std::cv_status status = gpEngineHost->condition.wait_for(lock, timeout);
+		if (status == std::cv_status::timeout && !gpEngineHost->commandTaken &&
+			gpEngineHost->command != EngineCommand_None)
+		{
+			gpEngineHost->command = EngineCommand_None;
+			return false;
+		}
+	}
+
+	return gpEngineHost->command == EngineCommand_None;
+}
 
-    // Create the engine app
-    gpEngineApp = new EngineApp();
-    if (!gpEngineApp)
-        return false;
+static void applyEngineDesc(HostedEngineApp* pApp, const EngineDesc* pDesc)
+{
+	pApp->mSettings.mWidth = pDesc->mWidth > 0 ? pDesc->mWidth : 1920;
+	pApp->mSettings.mHeight = pDesc->mHeight > 0 ? pDesc->mHeight : 1080;
+	pApp->mSettings.mFullScreen = pDesc->mFullScreen;
 
-    // Configure app settings
-    gpEngineApp->mSettings.mWidth = pDesc->mWidth > 0 ? pDesc->mWidth : 1920;
-    gpEngineApp->mSettings.mHeight = pDesc->mHeight > 0 ? pDesc->mHeight : 1080;
-    gpEngineApp->mSettings.mFullScreen = pDesc->mFullScreen;
+	pApp->setHeadless((pDesc->flags & EngineFlag_Headless) != 0);
+	pApp->setOverlayEnabled((pDesc->flags & EngineFlag_NoOverlay) == 0);
+	if (pDesc->ecsThreadCount > 1)
+		pApp->setEcsThreadCount(pDesc->ecsThreadCount);
+}
 
-    // Initialize using The Forge's Windows main
-    extern int WindowsMain(int argc, char** argv, IApp* app);
+static bool initHeadlessEngine(const EngineDesc* pDesc)
+{
+	gpEngineApp = new HostedEngineApp(pDesc->pApplicationName, NULL);
+	applyEngineDesc(gpEngineApp, pDesc);
 
-    // Note: This is a simplified version. In production, you'd need to handle
-    // the main loop differently to give control back to the game
+	if (!initHeadlessApp(gpEngineApp, pDesc->pApplicationName))
+	{
+		delete gpEngineApp;
+		gpEngineApp = NULL;
+		return false;
+	}
 
-    LOGF(LogLevel::eINFO, "Engine initialized: %s", pDesc->pApplicationName);
-    return true;
+	LOGF(LogLevel::eINFO, "Engine initialized headless: %s", pDesc->pApplicationName);
+	return true;
+}
+
+static bool initWindowedEngine(const EngineDesc* pDesc)
+{
+#if defined(_WIN32)
+	gpEngineHost = new EngineHost();
+	gpEngineApp = new HostedEngineApp(pDesc->pApplicationName, gpEngineHost);
+	applyEngineDesc(gpEngineApp, pDesc);
+
+	static char* sArgv[2] = {};
+	sArgv[0] = (char*)pDesc->pApplicationName;
+	IApp::argc = 1;
+	IApp::argv = (const char**)sArgv;
+
+	gpEngineHost->thread = std::thread([]() {
+		WindowsMain(IApp::argc, (char**)IApp::argv, gpEngineApp);
+
+		std::lock_guard<std::mutex> lock(gpEngineHost->mutex);
+		gpEngineHost->finished = true;
+		gpEngineHost->condition.notify_all();
+	});
+
+	std::unique_lock<std::mutex> lock(gpEngineHost->mutex);
+	gpEngineHost->condition.wait(lock,
+								 []() { return gpEngineHost->loaded || gpEngineHost->finished; });
+	bool loaded = gpEngineHost->loaded && !gpEngineHost->finished;
+	lock.unlock();
+
+	if (!loaded)
+	{
+		gpEngineHost->thread.join();
+		delete gpEngineApp;
+		gpEngineApp = NULL;
+		delete gpEngineHost;
+		gpEngineHost = NULL;
+		return false;
+	}
+
+	LOGF(LogLevel::eINFO, "Engine initialized: %s", pDesc->pApplicationName);
+	return true;
+#else
+	// Only WindowsMain is wired up, the log does not exist yet to say so
+	(void)pDesc;
+	return false;
+#endif
+}
+
+// C API implementation
+bool engineInit(const EngineDesc* pDesc)
+{
+	if (!pDesc || !pDesc->pApplicationName || gpEngineApp)
+		return false;
+
+	if (pDesc->flags & EngineFlag_Headless)
+		return initHeadlessEngine(pDesc);
+	return initWindowedEngine(pDesc);
 }
 
 void engineShutdown()
 {
-    if (gpEngineApp)
-    {
-        delete gpEngineApp;
-        gpEngineApp = NULL;
-    }
+	if (!gpEngineApp)
+		return;
+
+	if (gpEngineHost)
+	{
+		// The engine thread unloads, exits and tears The Forge down itself. The
+		// platform loop checks mQuit every iteration, also while it skips
+		// Update() and Draw(), and a waiting Update() or Draw() wakes up on quit
+		{
+			std::lock_guard<std::mutex> lock(gpEngineHost->mutex);
+			gpEngineHost->quit = true;
+			gpEngineApp->mSettings.mQuit = true;
+			gpEngineHost->condition.notify_all();
+		}
+		gpEngineHost->thread.join();
+
+		delete gpEngineApp;
+		gpEngineApp = NULL;
+		delete gpEngineHost;
+		gpEngineHost = NULL;
+		return;
+	}
+
+	exitHeadlessApp(gpEngineApp);
+	delete gpEngineApp;
+	gpEngineApp = NULL;
 }
 
 void engineUpdate(float deltaTime)
 {
-    if (gpEngineApp)
-    {
-        gpEngineApp->Update(deltaTime);
-    }
+	if (!gpEngineApp)
+		return;
+
+	if (gpEngineHost)
+		postEngineCommand(EngineCommand_Update, deltaTime);
+	else
+		gpEngineApp->Update(deltaTime);
 }
 
 void engineDraw()
 {
-    if (gpEngineApp)
-    {
-        gpEngineApp->Draw();
-    }
+	if (!gpEngineApp)
+		return;
+
+	if (gpEngineHost)
+		postEngineCommand(EngineCommand_Draw, 0.0f);
+	else
+		gpEngineApp->Draw();
 }
 
 bool engineShouldQuit()
 {
-    if (gpEngineApp)
-    {
-        return gpEngineApp->mSettings.mQuit;
-    }
-    return true;
+	if (!gpEngineApp)
+		return true;
+
+	if (gpEngineHost)
+	{
+		std::lock_guard<std::mutex> lock(gpEngineHost->mutex);
+		if (gpEngineHost->finished)
+			return true;
+	}
+	return gpEngineApp->mSettings.mQuit;
+}
+
+ecs_world_t* engineGetWorld()
+{
+	return gpEngineApp ? gpEngineApp->getWorld() : NULL;
 }
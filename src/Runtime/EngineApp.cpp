@@ -4,15 +4,123 @@
 
 #include "Runtime/EngineApp.h"
 #include "Runtime/ECS.h"
+#include "Runtime/JobSystem.h"
+#include "Runtime/PipelineRegistry.h"
+#include "Runtime/Trace.h"
 #include "Application/Interfaces/IUI.h"
+#include "Utilities/Interfaces/IFileSystem.h"
 #include "Utilities/Interfaces/ILog.h"
+#include "Utilities/Interfaces/IMemory.h"
 #include "Utilities/Math/MathTypes.h"
 #include "Utilities/RingBuffer.h"
 #include "Resources/ResourceLoader/Interfaces/IResourceLoader.h"
+#include "Core/RadixSort.h"
+#include "Runtime/Memory/Arena.h"
+#include "Runtime/Memory/FrameArena.h"
+#include "Utilities/Interfaces/IThread.h"
 
 #include "Graphics/FSL/defaults.h"
 #include "../../Shaders/FSL/Global.srt.h"
 
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+	State bound so far while recording the ECS render pass.
+
+	Every bind in Draw() goes through the helpers below, which compare
+	against this state and skip the call when nothing would change.
+*/
+struct RenderBindState
+{
+	Pipeline* pPipeline;
+	Buffer* pVertexBuffer;
+	uint32_t vertexStride;
+	bool instanceStreamBound; ///< Slot 1 holds this frame's instance buffer
+	Buffer* pIndexBuffer;
+	uint32_t indexSize;
+	uint32_t perObjectIndex;
+	bool frameSetsBound; ///< Persistent and per frame sets are bound
+	RenderStats* pStats;
+};
+
+static void bindPipelineTracked(Cmd* cmd, RenderBindState* pState, Pipeline* pPipeline)
+{
+	if (pState->pPipeline == pPipeline)
+	{
+		pState->pStats->bindsSkipped++;
+		return;
+	}
+
+	cmdBindPipeline(cmd, pPipeline);
+	pState->pPipeline = pPipeline;
+	pState->pStats->pipelineBinds++;
+}
+
+static void bindIndexBufferTracked(Cmd* cmd, RenderBindState* pState, Buffer* pIndexBuffer,
+								   uint32_t indexSize)
+{
+	if (pState->pIndexBuffer == pIndexBuffer && pState->indexSize == indexSize)
+	{
+		pState->pStats->bindsSkipped++;
+		return;
+	}
+
+	// Meshes that leave indexSize at 0 use 16 bit indices
+	IndexType indexType = indexSize == sizeof(uint32_t) ? INDEX_TYPE_UINT32 : INDEX_TYPE_UINT16;
+	cmdBindIndexBuffer(cmd, pIndexBuffer, indexType, 0);
+	pState->pIndexBuffer = pIndexBuffer;
+	pState->indexSize = indexSize;
+	pState->pStats->indexBufferBinds++;
+}
+
+/**
+	One contiguous chunk of the parallel render pass.
+*/
+struct RenderRecordJob
+{
+	EngineApp* pApp;
+	Cmd* pCmd;
+	CmdPool* pCmdPool;
+	RenderTarget* pRenderTarget;
+	uint32_t firstItem;
+	uint32_t itemCount;
+	uint32_t instancedCount;
+	RenderStats stats; ///< Per job counters, summed into gRenderStats after recording
+};
+
+/**
+	Render jobs of the parallel render pass, recorded on the job system.
+
+	Draw() fills jobs, runs jobs 1 and up on the engine job system and
+	records job 0 itself, then waits on counter, helping with the rest.
+	Every job records into its own command list, so which thread picks it up
+	does not matter.
+*/
+struct RenderWorkerPool
+{
+	RenderRecordJob jobs[EngineApp::MAX_RENDER_THREADS];
+	JobDesc jobDescs[EngineApp::MAX_RENDER_THREADS];
+	JobCounter counter;
+	uint32_t workerCount; ///< Jobs recorded besides job 0
+};
+
+/**
+	Dedicated thread that runs drawFrame() for pipelined rendering.
+
+	Draw() sets frameQueued and returns. publishRenderData() and
+	waitForRenderThread() block on condition until the frame is done.
+*/
+struct RenderFrameThread
+{
+	EngineApp* pApp;
+	ThreadHandle thread;
+	Mutex mutex;
+	ConditionVariable condition;
+	bool frameQueued; ///< A frame was handed over and is not finished yet
+	bool quit;
+};
+
 EngineApp::EngineApp()
 : pRenderer(NULL)
 , pGraphicsQueue(NULL)
@@ -21,25 +129,71 @@ EngineApp::EngineApp()
 , pImageAcquiredSemaphore(NULL)
 , pShader(NULL)
 , pPipeline(NULL)
-, pCubeShader(NULL)
 , pCubePipeline(NULL)
+, pInstancedShader(NULL)
+, pInstancedPipeline(NULL)
+, pInstancedCubePipeline(NULL)
 , pWorld(NULL)
 , pRenderQuery(NULL)
 , pRenderDataArray(NULL)
 , maxRenderDataCount(1000)
+, pInstanceBatches(NULL)
+, instanceBatchCount(0)
+, pSortKeys(NULL)
+, pSortTempKeys(NULL)
+, pSortIndices(NULL)
+, pSortTempIndices(NULL)
+, pSortedRenderData(NULL)
+, gRenderStats()
+, gFrameTimings()
+, renderThreadCount(1)
+, pRenderWorkers(NULL)
+, pJobSystem(NULL)
+, pPipelineRegistry(NULL)
 , gFontID(0)
 , gFrameIndex(0)
+, simDataIndex(0)
+, ecsThreadCount(1)
+, pipelinedRendering(false)
+, traceDumpRequested(0)
+, traceDumpCount(0)
+, pRenderThread(NULL)
+, headless(false)
+, overlayEnabled(true)
+, pFrameArena(NULL)
 , pDescriptorSetPersistent(NULL)
 , pDescriptorSetPerFrame(NULL)
 , pDescriptorSetPerObject(NULL)
-, nextObjectBufferIndex(0)
+, gpuRenderCapacity(0)
 {
 	for (uint32_t i = 0; i < gDataBufferCount; ++i)
 		pUniformBufferPerFrame[i] = NULL;
 
 	for (uint32_t i = 0; i < gDataBufferCount; ++i)
-		for (uint32_t j = 0; j < MAX_OBJECTS; ++j)
-			pUniformBufferPerObject[i][j] = NULL;
+		pInstanceBuffer[i] = NULL;
+
+	for (uint32_t i = 0; i < gDataBufferCount; ++i)
+		pPerObjectBuffer[i] = NULL;
+
+	for (uint32_t i = 0; i < gDataBufferCount; ++i)
+		pFrameFences[i] = NULL;
+
+	for (uint32_t i = 0; i < gDataBufferCount; ++i)
+	{
+		pRenderDataBuffers[i] = NULL;
+		renderDataCapacities[i] = 0;
+		renderDataCounts[i] = 0;
+		culledCounts[i] = 0;
+	}
+
+	for (uint32_t i = 0; i < gDataBufferCount; ++i)
+	{
+		for (uint32_t t = 0; t < MAX_RENDER_THREADS; ++t)
+		{
+			pRecordCmdPools[i][t] = NULL;
+			pRecordCmds[i][t] = NULL;
+		}
+	}
 }
 
 EngineApp::~EngineApp()
@@ -49,74 +203,161 @@ EngineApp::~EngineApp()
 bool EngineApp::Init()
 {
 	LOGF(LogLevel::eINFO, "EngineApp::Init");
+	traceSetThreadName("Main");
+
+	// ECS, physics and the render pass all schedule onto these workers
+	pJobSystem = jobSystemCreate();
+	if (!pJobSystem)
+	{
+		LOGF(LogLevel::eERROR, "Failed to create job system");
+		return false;
+	}
 
-	if (!initRendererInternal())
+	// There is nothing to draw the overlay to
+	if (headless)
+	{
+		LOGF(LogLevel::eINFO, "Headless, the renderer is not created");
+		overlayEnabled = false;
+	}
+
+	if (!headless && !initRendererInternal())
 	{
 		LOGF(LogLevel::eERROR, "Failed to initialize renderer");
 		return false;
 	}
 
-	// Initialize root signature
-	RootSignatureDesc rootDesc = {};
-	rootDesc.pGraphicsFileName = "default.rootsig";
-	rootDesc.pComputeFileName = nullptr;
-	initRootSignature(pRenderer, &rootDesc);
+	if (!headless)
+	{
+		// Pipelines are built against the cache the previous run saved
+		pPipelineRegistry = createPipelineRegistry(pRenderer);
+		if (!pPipelineRegistry)
+		{
+			LOGF(LogLevel::eERROR, "Failed to create pipeline registry");
+			return false;
+		}
+	}
 
-	// Define and load fonts
-	FontDesc font = {};
-	font.pFontPath = "TitilliumText/TitilliumText-Bold.otf";
-	fntDefineFonts(&font, 1, &gFontID);
+	if (!headless && !initRenderWorkers())
+	{
+		LOGF(LogLevel::eERROR, "Failed to start render workers");
+		return false;
+	}
 
-	// Initialize font system
-	FontSystemDesc fontRenderDesc = {};
-	fontRenderDesc.pRenderer = pRenderer;
-	if (!initFontSystem(&fontRenderDesc))
+	pFrameArena = frameArenaCreate(gDataBufferCount);
+	if (!pFrameArena)
 	{
-		LOGF(LogLevel::eERROR, "Failed to initialize font system");
+		LOGF(LogLevel::eERROR, "Failed to create frame arenas");
 		return false;
 	}
 
-	// Initialize UI for the performance measures and other Forge widgets
-	UserInterfaceDesc uiRenderDesc = {};
-	uiRenderDesc.pRenderer = pRenderer;
-	initUserInterface(&uiRenderDesc);
+	if (!headless)
+	{
+		// Initialize root signature
+		RootSignatureDesc rootDesc = {};
+		rootDesc.pGraphicsFileName = "default.rootsig";
+		rootDesc.pComputeFileName = nullptr;
+		initRootSignature(pRenderer, &rootDesc);
+	}
 
-	// Initialize profiler
-	ProfilerDesc profiler = {};
-	profiler.pRenderer = pRenderer;
-	initProfiler(&profiler);
+	if (overlayEnabled)
+	{
+		// Define and load fonts
+		FontDesc font = {};
+		font.pFontPath = "TitilliumText/TitilliumText-Bold.otf";
+		fntDefineFonts(&font, 1, &gFontID);
+
+		// Initialize font system
+		FontSystemDesc fontRenderDesc = {};
+		fontRenderDesc.pRenderer = pRenderer;
+		if (!initFontSystem(&fontRenderDesc))
+		{
+			LOGF(LogLevel::eERROR, "Failed to initialize font system");
+			return false;
+		}
 
-	// Initialize GPU profiler
-	gGpuProfileToken = initGpuProfiler(pRenderer, pGraphicsQueue, "Graphics");
+		// Initialize UI for the performance measures and other Forge widgets
+		UserInterfaceDesc uiRenderDesc = {};
+		uiRenderDesc.pRenderer = pRenderer;
+		initUserInterface(&uiRenderDesc);
 
-	// Initialize profiler draw settings
-	gFrameTimeDraw = {};
-	gFrameTimeDraw.mFontColor = 0xff00ffff; // Cyan
-	gFrameTimeDraw.mFontSize = 18.0f;
-	gFrameTimeDraw.mFontID = gFontID;
+		// Initialize profiler
+		ProfilerDesc profiler = {};
+		profiler.pRenderer = pRenderer;
+		initProfiler(&profiler);
+
+		// Initialize GPU profiler
+		gGpuProfileToken = initGpuProfiler(pRenderer, pGraphicsQueue, "Graphics");
+
+		// Initialize profiler draw settings
+		gFrameTimeDraw = {};
+		gFrameTimeDraw.mFontColor = 0xff00ffff; // Cyan
+		gFrameTimeDraw.mFontSize = 18.0f;
+		gFrameTimeDraw.mFontID = gFontID;
+	}
 
 	initEntityComponentSystem();
+	initECSJobHooks(pJobSystem);
 
 	pWorld = ecs_init();
 	initECS(pWorld);
 
-	pRenderDataArray = (MeshRenderData*)tf_malloc(maxRenderDataCount * sizeof(MeshRenderData));
-	if (!pRenderDataArray)
+	// The built in systems are multi threaded, flecs splits their tables across these
+	if (ecsThreadCount > 1)
+		setEcsThreadCount(ecsThreadCount);
+
+	for (uint32_t i = 0; i < gDataBufferCount; ++i)
 	{
-		LOGF(LogLevel::eERROR, "Failed to allocate render data array");
+		pRenderDataBuffers[i] =
+			(MeshRenderData*)tf_malloc(maxRenderDataCount * sizeof(MeshRenderData));
+		if (!pRenderDataBuffers[i])
+		{
+			LOGF(LogLevel::eERROR, "Failed to allocate render data array");
+			return false;
+		}
+
+		renderDataCapacities[i] = maxRenderDataCount;
+		renderDataCounts[i] = 0;
+	}
+
+	// Nothing is published before the first Update()
+	simDataIndex = 0;
+	pRenderDataArray = pRenderDataBuffers[gDataBufferCount - 1];
+
+	// Worst case every entry gets its own batch
+	pInstanceBatches = (InstanceBatch*)tf_malloc(maxRenderDataCount * sizeof(InstanceBatch));
+	if (!pInstanceBatches)
+	{
+		LOGF(LogLevel::eERROR, "Failed to allocate instance batch array");
+		return false;
+	}
+
+	gpuRenderCapacity = maxRenderDataCount;
+
+	if (!allocateSortScratch(gpuRenderCapacity))
+	{
+		LOGF(LogLevel::eERROR, "Failed to allocate render data sort scratch");
 		return false;
 	}
 
 	RenderContext* ctx = ecs_singleton_ensure(pWorld, RenderContext);
-	ctx->pRenderDataArray = pRenderDataArray;
+	ctx->pRenderDataArray = pRenderDataBuffers[simDataIndex];
 	ctx->renderDataCount = 0;
-	ctx->maxRenderData = maxRenderDataCount;
+	ctx->maxRenderData = renderDataCapacities[simDataIndex];
 	ctx->pCmd = NULL;
 	ctx->pRenderTarget = NULL;
 	ctx->frameIndex = 0;
+	ctx->cullingEnabled = false;
+	ctx->culledCount = 0;
+	ctx->pFrameArena = NULL;
 	ecs_singleton_modified(pWorld, RenderContext);
 
-	LOGF(LogLevel::eINFO, "ECS world initialized with %d max render slots", maxRenderDataCount);
+	LOGF(LogLevel::eINFO, "ECS world initialized with %d initial render slots", maxRenderDataCount);
+
+	if (!initRenderThread())
+	{
+		LOGF(LogLevel::eERROR, "Failed to start render thread");
+		return false;
+	}
 
 	return true;
 }
@@ -125,12 +366,26 @@ void EngineApp::Exit()
 {
 	LOGF(LogLevel::eINFO, "EngineApp::Exit");
 
-	if (pRenderDataArray)
+	exitRenderThread();
+
+	for (uint32_t i = 0; i < gDataBufferCount; ++i)
+	{
+		if (pRenderDataBuffers[i])
+		{
+			tf_free(pRenderDataBuffers[i]);
+			pRenderDataBuffers[i] = NULL;
+		}
+	}
+	pRenderDataArray = NULL;
+
+	if (pInstanceBatches)
 	{
-		tf_free(pRenderDataArray);
-		pRenderDataArray = NULL;
+		tf_free(pInstanceBatches);
+		pInstanceBatches = NULL;
 	}
 
+	freeSortScratch();
+
 	if (pWorld)
 	{
 		ecs_fini(pWorld);
@@ -138,28 +393,53 @@ void EngineApp::Exit()
 		LOGF(LogLevel::eINFO, "ECS world cleaned up");
 	}
 
-	exitUserInterface();
+	if (overlayEnabled)
+	{
+		exitUserInterface();
+
+		exitFontSystem();
+
+		exitGpuProfiler(gGpuProfileToken);
+		exitProfiler();
+	}
 
-	exitFontSystem();
+	destroyPipelineRegistry(pPipelineRegistry);
+	pPipelineRegistry = NULL;
+
+	if (!headless)
+	{
+		exitRootSignature(pRenderer);
+		exitRenderWorkers();
+		exitRendererInternal();
+	}
 
-	exitGpuProfiler(gGpuProfileToken);
-	exitProfiler();
+	// After the queue went idle, no fence can still reference the arenas
+	frameArenaRelease(pFrameArena);
+	pFrameArena = NULL;
 
-	exitRootSignature(pRenderer);
-	exitRendererInternal();
+	// Nothing is left to schedule once the world and the render thread are gone
+	initECSJobHooks(NULL);
+	jobSystemDestroy(pJobSystem);
+	pJobSystem = NULL;
 }
 
 bool EngineApp::Load(ReloadDesc* pReloadDesc)
 {
 	LOGF(LogLevel::eINFO, "EngineApp::Load");
 
+	// No swapchain, shaders or GPU buffers to create
+	if (headless)
+		return true;
+
 	if (!pReloadDesc || pReloadDesc->mType & RELOAD_TYPE_SHADER)
 	{
 		loadShaders();
 
 		if (!pDescriptorSetPersistent)
 		{
-			DescriptorSetDesc descPersistent = SRT_SET_DESC(SrtData, Persistent, 1, 0);
+			// One set per frame, so the bindless array is never written while the GPU reads it
+			DescriptorSetDesc descPersistent =
+				SRT_SET_DESC(SrtData, Persistent, gDataBufferCount, 0);
 			addDescriptorSet(pRenderer, &descPersistent, &pDescriptorSetPersistent);
 			LOGF(LogLevel::eINFO, "Persistent descriptor set created (empty)");
 		}
@@ -202,16 +482,20 @@ bool EngineApp::Load(ReloadDesc* pReloadDesc)
 	{
 		createPipeline();
 
+		// Pipelines of render target formats that are gone were not acquired again
+		flushUnusedPipelines(pPipelineRegistry);
+
 		if (!pUniformBufferPerFrame[0])
 		{
 			createPerFrameUniformBuffer();
-			createPerObjectBuffers(10);
-			createPerObjectDescriptorSets(10);
+			createInstanceBuffers();
+			createPerObjectBuffers();
 			LOGF(LogLevel::eINFO, "Per-frame and per-object uniform buffers created");
 		}
 	}
 
-	if (!pReloadDesc || pReloadDesc->mType & (RELOAD_TYPE_RESIZE | RELOAD_TYPE_RENDERTARGET))
+	if (overlayEnabled &&
+		(!pReloadDesc || pReloadDesc->mType & (RELOAD_TYPE_RESIZE | RELOAD_TYPE_RENDERTARGET)))
 	{
 		if (pSwapChain && pSwapChain->ppRenderTargets[0])
 		{
@@ -245,9 +529,14 @@ void EngineApp::Unload(ReloadDesc* pReloadDesc)
 {
 	LOGF(LogLevel::eINFO, "EngineApp::Unload");
 
+	if (headless)
+		return;
+
+	waitForRenderThread();
 	waitQueueIdle(pGraphicsQueue);
 
-	if (!pReloadDesc || pReloadDesc->mType & (RELOAD_TYPE_RESIZE | RELOAD_TYPE_RENDERTARGET))
+	if (overlayEnabled &&
+		(!pReloadDesc || pReloadDesc->mType & (RELOAD_TYPE_RESIZE | RELOAD_TYPE_RENDERTARGET)))
 	{
 		unloadFontSystem(pReloadDesc ? pReloadDesc->mType : RELOAD_TYPE_ALL);
 		unloadUserInterface(pReloadDesc ? pReloadDesc->mType : RELOAD_TYPE_ALL);
@@ -276,7 +565,8 @@ void EngineApp::Unload(ReloadDesc* pReloadDesc)
 
 	if (!pReloadDesc || pReloadDesc->mType & RELOAD_TYPE_SHADER)
 	{
-		destroyPerObjectDescriptorSets();
+		destroyPerObjectBuffers();
+		destroyInstanceBuffers();
 		destroyPerFrameUniformBuffer();
 
 		if (pDescriptorSetPersistent)
@@ -286,26 +576,259 @@ void EngineApp::Unload(ReloadDesc* pReloadDesc)
 			LOGF(LogLevel::eINFO, "Persistent descriptor set destroyed");
 		}
 
+		// A new shader can land at an old address, its pipelines must not match
+		flushUnusedPipelines(pPipelineRegistry);
 		unloadShaders();
 	}
 }
 
 void EngineApp::Update(float deltaTime)
 {
+	ENGINE_PROFILE_SCOPE("EngineApp::Update");
+
+	// Written between frames, so the capture ends with the last full frame
+	if (tfrg_atomic32_load_relaxed(&traceDumpRequested))
+	{
+		tfrg_atomic32_store_relaxed(&traceDumpRequested, 0);
+
+		char tracePath[64];
+		snprintf(tracePath, sizeof(tracePath), "%s_trace_%u.json", GetName(), traceDumpCount++);
+		traceWriteChromeJson(tracePath);
+	}
+
 	if (pWorld)
 	{
+		// The simulation buffer is never the one Draw() reads
 		RenderContext* ctx = ecs_singleton_ensure(pWorld, RenderContext);
+		ctx->pFrameArena = frameArenaBegin(pFrameArena, pRenderer, simDataIndex);
+		ctx->pRenderDataArray = pRenderDataBuffers[simDataIndex];
+		ctx->maxRenderData = renderDataCapacities[simDataIndex];
 		ctx->renderDataCount = 0;
+		ctx->culledCount = 0;
+		resetSystemTimeSpan(&ctx->transformTime);
+		resetSystemTimeSpan(&ctx->fillRenderDataTime);
+
+		// FillRenderDataSystem can run on several threads and never grows the array
+		reserveRenderData(ctx, (uint32_t)ecs_count(pWorld, MeshComponent));
 		ecs_singleton_modified(pWorld, RenderContext);
 
 		float dt = deltaTime > 0.0f ? deltaTime : 0.016f;
 
+		uint64_t progressStartNs = ecs_os_now();
 		ecs_progress(pWorld, dt);
+		gFrameTimings.ecsProgressMs = (float)((double)(ecs_os_now() - progressStartNs) / 1e6);
+
+		const RenderContext* pCtx = ecs_singleton_get(pWorld, RenderContext);
+		gFrameTimings.transformMs = getSystemTimeSpanMs(&pCtx->transformTime);
+		gFrameTimings.fillRenderDataMs = getSystemTimeSpanMs(&pCtx->fillRenderDataTime);
+
+		publishRenderData();
 	}
 }
 
+void EngineApp::publishRenderData()
+{
+	ENGINE_PROFILE_SCOPE("publishRenderData");
+
+	// FillRenderDataSystem grows the array when the scene outgrows it
+	const RenderContext* pCtx = ecs_singleton_get(pWorld, RenderContext);
+	pRenderDataBuffers[simDataIndex] = pCtx->pRenderDataArray;
+	renderDataCapacities[simDataIndex] = pCtx->maxRenderData;
+	uint32_t filledCount = pCtx->renderDataCount;
+	renderDataCounts[simDataIndex] =
+		filledCount < pCtx->maxRenderData ? filledCount : pCtx->maxRenderData;
+	culledCounts[simDataIndex] = pCtx->culledCount;
+
+	// Handoff point, the render thread must be done with the buffer it holds
+	// before the next ecs_progress() starts writing it
+	waitForRenderThread();
+
+	uint32_t publishedCount = renderDataCounts[simDataIndex];
+	pRenderDataArray = pRenderDataBuffers[simDataIndex];
+	maxRenderDataCount = renderDataCapacities[simDataIndex];
+	simDataIndex = (simDataIndex + 1) % gDataBufferCount;
+
+	ensureRenderCapacity(publishedCount);
+}
+
 void EngineApp::Draw()
 {
+	// Update() already published the render data, there is nothing to draw it to
+	if (headless)
+		return;
+
+	RenderFrameThread* pThread = pRenderThread;
+	if (!pThread)
+	{
+		drawFrame();
+		return;
+	}
+
+	acquireMutex(&pThread->mutex);
+	pThread->frameQueued = true;
+	wakeAllConditionVariable(&pThread->condition);
+	releaseMutex(&pThread->mutex);
+}
+
+void EngineApp::waitForRenderThread()
+{
+	ENGINE_PROFILE_SCOPE("waitForRenderThread");
+
+	RenderFrameThread* pThread = pRenderThread;
+	if (!pThread)
+		return;
+
+	acquireMutex(&pThread->mutex);
+	while (pThread->frameQueued)
+		waitConditionVariable(&pThread->condition, &pThread->mutex, UINT32_MAX);
+	releaseMutex(&pThread->mutex);
+}
+
+void EngineApp::renderFrameThread(void* pData)
+{
+	RenderFrameThread* pThread = (RenderFrameThread*)pData;
+	traceSetThreadName("RenderThread");
+
+	for (;;)
+	{
+		acquireMutex(&pThread->mutex);
+		while (!pThread->quit && !pThread->frameQueued)
+			waitConditionVariable(&pThread->condition, &pThread->mutex, UINT32_MAX);
+
+		if (pThread->quit && !pThread->frameQueued)
+		{
+			releaseMutex(&pThread->mutex);
+			return;
+		}
+		releaseMutex(&pThread->mutex);
+
+		pThread->pApp->drawFrame();
+
+		acquireMutex(&pThread->mutex);
+		pThread->frameQueued = false;
+		wakeAllConditionVariable(&pThread->condition);
+		releaseMutex(&pThread->mutex);
+	}
+}
+
+void EngineApp::setEcsThreadCount(uint32_t count)
+{
+	if (count < 1)
+		count = 1;
+
+	ecsThreadCount = count;
+
+	if (!pWorld)
+		return;
+
+	// flecs tasks wait for each other at sync points, each needs a worker of its own
+	uint32_t taskCount = count;
+	uint32_t workerCount = jobSystemGetWorkerCount(pJobSystem);
+	if (taskCount > workerCount)
+	{
+		LOGF(LogLevel::eWARNING, "setEcsThreadCount: Clamped %u ECS threads to %u job workers",
+			 count, workerCount);
+		taskCount = workerCount;
+	}
+
+	ecs_set_task_threads(pWorld, (int32_t)(taskCount > 1 ? taskCount : 0));
+}
+
+void EngineApp::requestTraceDump()
+{
+	tfrg_atomic32_store_relaxed(&traceDumpRequested, 1);
+}
+
+void EngineApp::setPipelinedRendering(bool enabled)
+{
+	if (pRenderThread)
+	{
+		LOGF(LogLevel::eWARNING, "setPipelinedRendering: Render thread already started");
+		return;
+	}
+
+	pipelinedRendering = enabled;
+}
+
+void EngineApp::setHeadless(bool enabled)
+{
+	if (pWorld)
+	{
+		LOGF(LogLevel::eWARNING, "setHeadless: Init() already ran");
+		return;
+	}
+
+	headless = enabled;
+}
+
+void EngineApp::setOverlayEnabled(bool enabled)
+{
+	if (pWorld)
+	{
+		LOGF(LogLevel::eWARNING, "setOverlayEnabled: Init() already ran");
+		return;
+	}
+
+	overlayEnabled = enabled;
+}
+
+bool EngineApp::initRenderThread()
+{
+	// A headless Draw() does nothing, there is no frame to overlap
+	if (!pipelinedRendering || headless)
+		return true;
+
+	RenderFrameThread* pThread = (RenderFrameThread*)tf_calloc(1, sizeof(RenderFrameThread));
+	if (!pThread)
+		return false;
+
+	pThread->pApp = this;
+	initMutex(&pThread->mutex);
+	initConditionVariable(&pThread->condition);
+
+	ThreadDesc threadDesc = {};
+	threadDesc.pFunc = renderFrameThread;
+	threadDesc.pData = pThread;
+	snprintf(threadDesc.mThreadName, sizeof(threadDesc.mThreadName), "RenderThread");
+	if (!initThread(&threadDesc, &pThread->thread))
+	{
+		exitConditionVariable(&pThread->condition);
+		exitMutex(&pThread->mutex);
+		tf_free(pThread);
+		return false;
+	}
+
+	pRenderThread = pThread;
+	LOGF(LogLevel::eINFO, "Pipelined rendering enabled");
+	return true;
+}
+
+void EngineApp::exitRenderThread()
+{
+	RenderFrameThread* pThread = pRenderThread;
+	if (!pThread)
+		return;
+
+	// The thread finishes a queued frame before it quits
+	acquireMutex(&pThread->mutex);
+	pThread->quit = true;
+	wakeAllConditionVariable(&pThread->condition);
+	releaseMutex(&pThread->mutex);
+
+	joinThread(pThread->thread);
+
+	exitConditionVariable(&pThread->condition);
+	exitMutex(&pThread->mutex);
+	tf_free(pThread);
+	pRenderThread = NULL;
+}
+
+void EngineApp::drawFrame()
+{
+	ENGINE_PROFILE_SCOPE("EngineApp::drawFrame");
+
+	uint64_t acquireStartNs = ecs_os_now();
+
 	uint32_t swapchainImageIndex;
 	acquireNextImage(pRenderer, pSwapChain, pImageAcquiredSemaphore, NULL, &swapchainImageIndex);
 
@@ -316,16 +839,24 @@ void EngineApp::Draw()
 	FenceStatus fenceStatus;
 	getFenceStatus(pRenderer, elem.pFence, &fenceStatus);
 	if (fenceStatus == FENCE_STATUS_INCOMPLETE)
+	{
+		ENGINE_PROFILE_SCOPE("waitForFences");
 		waitForFences(pRenderer, 1, &elem.pFence);
+	}
 
-	flipProfiler();
+	uint64_t recordStartNs = ecs_os_now();
+	gFrameTimings.acquireMs = (float)((double)(recordStartNs - acquireStartNs) / 1e6);
+
+	if (overlayEnabled)
+		flipProfiler();
 
 	resetCmdPool(pRenderer, elem.pCmdPool);
 
 	Cmd* cmd = elem.pCmds[0];
 	beginCmd(cmd);
 
-	cmdBeginGpuFrameProfile(cmd, gGpuProfileToken);
+	if (overlayEnabled)
+		cmdBeginGpuFrameProfile(cmd, gGpuProfileToken);
 
 	RenderTargetBarrier barriers[] = {
 		{pRenderTarget, RESOURCE_STATE_PRESENT, RESOURCE_STATE_RENDER_TARGET},
@@ -341,100 +872,122 @@ void EngineApp::Draw()
 				   0.0f, 1.0f);
 	cmdSetScissor(cmd, 0, 0, pRenderTarget->mWidth, pRenderTarget->mHeight);
 
+	// Command lists in submission order, the UI list always goes last
+	Cmd* ppSubmitCmds[MAX_RENDER_THREADS + 2];
+	uint32_t submitCmdCount = 0;
+
 	// Render all entities with mesh components
 	if (pWorld && pPipeline && pRenderDataArray)
 	{
-		cmdBeginGpuTimestampQuery(cmd, gGpuProfileToken, "ECS Render");
+		if (overlayEnabled)
+			cmdBeginGpuTimestampQuery(cmd, gGpuProfileToken, "ECS Render");
 
-		// Get the render data count from the singleton
-		// This was filled by FillRenderDataSystem during ecs_progress() in Update()
-		const RenderContext* ctx = ecs_singleton_get(pWorld, RenderContext);
-		uint32_t drawCount = ctx ? ctx->renderDataCount : 0;
+		// Published by Update() after FillRenderDataSystem filled it
+		uint32_t drawCount = getRenderDataCount();
+		if (drawCount > gpuRenderCapacity)
+			drawCount = gpuRenderCapacity;
 
 		//LOGF(LogLevel::eINFO, "Draw: drawCount = %d, ctx = %p", drawCount, ctx);
 
+		gRenderStats = {};
+		gRenderStats.visibleEntities = drawCount;
+		gRenderStats.culledEntities =
+			culledCounts[(simDataIndex + gDataBufferCount - 1) % gDataBufferCount];
+
 		if (drawCount > 0)
 		{
-			Pipeline* lastBoundPipeline = NULL;
+			// Group draws by pipeline and buffers so redundant binds can be skipped
+			sortRenderData(drawCount);
+
+			// Instanced entries sort to the front, grouped into batches
+			uint32_t instancedCount = 0;
+			instanceBatchCount = buildInstanceBatches(pRenderDataArray, drawCount,
+													  pInstanceBatches, &instancedCount);
+			writeInstanceData(instancedCount);
 
-			for (uint32_t i = 0; i < drawCount; i++)
+			uint32_t itemCount = instanceBatchCount + (drawCount - instancedCount);
+			uint32_t jobCount = pRenderWorkers ? pRenderWorkers->workerCount + 1 : 1;
+			if (jobCount > itemCount / MIN_ITEMS_PER_RENDER_JOB)
+				jobCount = itemCount / MIN_ITEMS_PER_RENDER_JOB;
+
+			if (jobCount <= 1)
 			{
-				const MeshRenderData& renderData = pRenderDataArray[i];
+				recordRenderItems(cmd, 0, itemCount, instancedCount, &gRenderStats);
+			}
+			else
+			{
+				// Close the clear pass, each job reopens the targets with load actions
+				cmdBindRenderTargets(cmd, NULL);
+				endCmd(cmd);
+				ppSubmitCmds[submitCmdCount++] = cmd;
 
-				if (renderData.pPipeline && renderData.pPipeline != lastBoundPipeline)
+				RenderWorkerPool* pPool = pRenderWorkers;
+				for (uint32_t j = 0; j < jobCount; ++j)
 				{
-					cmdBindPipeline(cmd, renderData.pPipeline);
-					lastBoundPipeline = renderData.pPipeline;
-
-					if (pDescriptorSetPersistent)
-					{
-						cmdBindDescriptorSet(cmd, 0, pDescriptorSetPersistent);
-					}
-
-					if (pDescriptorSetPerFrame)
-					{
-						cmdBindDescriptorSet(cmd, gFrameIndex, pDescriptorSetPerFrame);
-					}
+					RenderRecordJob& job = pPool->jobs[j];
+					job.pCmd = pRecordCmds[gFrameIndex][j];
+					job.pCmdPool = pRecordCmdPools[gFrameIndex][j];
+					job.pRenderTarget = pRenderTarget;
+					job.firstItem = itemCount * j / jobCount;
+					job.itemCount = itemCount * (j + 1) / jobCount - job.firstItem;
+					job.instancedCount = instancedCount;
+					job.stats = {};
 				}
 
-				if (pDescriptorSetPerObject)
-				{
-					cmdBindDescriptorSet(cmd, renderData.descriptorSetIndex,
-										 pDescriptorSetPerObject);
-				}
+				pPool->counter = {};
+				jobRun(pJobSystem, &pPool->jobDescs[1], jobCount - 1, &pPool->counter);
 
-				Buffer* vb = renderData.pVertexBuffer;
-				uint32_t stride = renderData.vertexStride;
-				cmdBindVertexBuffer(cmd, 1, &vb, &stride, NULL);
+				recordRenderJob(&pPool->jobs[0]);
 
-				if (renderData.pIndexBuffer)
-				{
-					cmdBindIndexBuffer(cmd, renderData.pIndexBuffer, INDEX_TYPE_UINT16, 0);
-					cmdDrawIndexed(cmd, renderData.indexCount, 0, 0);
-				}
-				else
+				jobWait(pJobSystem, &pPool->counter);
+
+				for (uint32_t j = 0; j < jobCount; ++j)
 				{
-					cmdDraw(cmd, renderData.vertexCount, 0);
+					const RenderStats& jobStats = pPool->jobs[j].stats;
+					gRenderStats.drawCalls += jobStats.drawCalls;
+					gRenderStats.instancedBatches += jobStats.instancedBatches;
+					gRenderStats.pipelineBinds += jobStats.pipelineBinds;
+					gRenderStats.descriptorBinds += jobStats.descriptorBinds;
+					gRenderStats.vertexBufferBinds += jobStats.vertexBufferBinds;
+					gRenderStats.indexBufferBinds += jobStats.indexBufferBinds;
+					gRenderStats.bindsSkipped += jobStats.bindsSkipped;
+					ppSubmitCmds[submitCmdCount++] = pPool->jobs[j].pCmd;
 				}
+
+				// The rest of the frame goes into the ring's second list
+				cmd = elem.pCmds[1];
+				beginCmd(cmd);
 			}
 
 			static uint32_t lastLogFrame = 0;
 			if (gFrameIndex - lastLogFrame > 60)
 			{
-				LOGF(LogLevel::eINFO, "Rendered %d entities via ECS", drawCount);
+				LOGF(LogLevel::eINFO, "Rendered %d entities via ECS (%d instanced batches)", drawCount,
+					 instanceBatchCount);
 				lastLogFrame = gFrameIndex;
 			}
 		}
 
-		cmdEndGpuTimestampQuery(cmd, gGpuProfileToken);
+		if (overlayEnabled)
+			cmdEndGpuTimestampQuery(cmd, gGpuProfileToken);
 	}
 
 	cmdBindRenderTargets(cmd, NULL);
 
-	cmdBeginGpuTimestampQuery(cmd, gGpuProfileToken, "Draw UI");
-
-	BindRenderTargetsDesc bindRenderTargetsUI = {};
-	bindRenderTargetsUI.mRenderTargetCount = 1;
-	bindRenderTargetsUI.mRenderTargets[0] = {pRenderTarget, LOAD_ACTION_LOAD};
-	cmdBindRenderTargets(cmd, &bindRenderTargetsUI);
-
-	gFrameTimeDraw.mFontColor = 0xff00ffff; // Cyan
-	gFrameTimeDraw.mFontSize = 18.0f;
-	gFrameTimeDraw.mFontID = gFontID;
-	float2 txtSizePx = cmdDrawCpuProfile(cmd, float2(8.f, 15.f), &gFrameTimeDraw);
-	cmdDrawGpuProfile(cmd, float2(8.f, txtSizePx.y + 75.f), gGpuProfileToken, &gFrameTimeDraw);
-
-	cmdDrawUserInterface(cmd);
-
-	cmdEndGpuTimestampQuery(cmd, gGpuProfileToken);
-	cmdBindRenderTargets(cmd, NULL);
+	if (overlayEnabled)
+		drawOverlay(cmd, pRenderTarget);
 
 	barriers[0] = {pRenderTarget, RESOURCE_STATE_RENDER_TARGET, RESOURCE_STATE_PRESENT};
 	cmdResourceBarrier(cmd, 0, NULL, 0, NULL, 1, barriers);
 
-	cmdEndGpuFrameProfile(cmd, gGpuProfileToken);
+	if (overlayEnabled)
+		cmdEndGpuFrameProfile(cmd, gGpuProfileToken);
 
 	endCmd(cmd);
+	ppSubmitCmds[submitCmdCount++] = cmd;
+
+	uint64_t submitStartNs = ecs_os_now();
+	gFrameTimings.recordMs = (float)((double)(submitStartNs - recordStartNs) / 1e6);
 
 	FlushResourceUpdateDesc flushUpdateDesc = {};
 	flushUpdateDesc.mNodeIndex = 0;
@@ -443,15 +996,20 @@ void EngineApp::Draw()
 									pImageAcquiredSemaphore};
 
 	QueueSubmitDesc submitDesc = {};
-	submitDesc.mCmdCount = 1;
+	submitDesc.mCmdCount = submitCmdCount;
 	submitDesc.mSignalSemaphoreCount = 1;
 	submitDesc.mWaitSemaphoreCount = waitSemaphores[0] ? 2 : 1;
-	submitDesc.ppCmds = &cmd;
+	submitDesc.ppCmds = ppSubmitCmds;
 	submitDesc.ppSignalSemaphores = &elem.pSemaphore;
 	submitDesc.ppWaitSemaphores = waitSemaphores;
 	submitDesc.pSignalFence = elem.pFence;
 	queueSubmit(pGraphicsQueue, &submitDesc);
 
+	// The published render data's frame arena is free once this submit retires
+	frameArenaSetFence(pFrameArena, (simDataIndex + gDataBufferCount - 1) % gDataBufferCount,
+					   elem.pFence);
+	pFrameFences[gFrameIndex] = elem.pFence;
+
 	// Present
 	QueuePresentDesc presentDesc = {};
 	presentDesc.mIndex = (uint8_t)swapchainImageIndex;
@@ -461,9 +1019,63 @@ void EngineApp::Draw()
 	presentDesc.mSubmitDone = true;
 	queuePresent(pGraphicsQueue, &presentDesc);
 
+	gFrameTimings.submitMs = (float)((double)(ecs_os_now() - submitStartNs) / 1e6);
+
 	gFrameIndex = (gFrameIndex + 1) % gDataBufferCount;
 }
 
+void EngineApp::drawOverlay(Cmd* cmd, RenderTarget* pRenderTarget)
+{
+	cmdBeginGpuTimestampQuery(cmd, gGpuProfileToken, "Draw UI");
+
+	BindRenderTargetsDesc bindRenderTargetsUI = {};
+	bindRenderTargetsUI.mRenderTargetCount = 1;
+	bindRenderTargetsUI.mRenderTargets[0] = {pRenderTarget, LOAD_ACTION_LOAD};
+	cmdBindRenderTargets(cmd, &bindRenderTargetsUI);
+
+	gFrameTimeDraw.mFontColor = 0xff00ffff; // Cyan
+	gFrameTimeDraw.mFontSize = 18.0f;
+	gFrameTimeDraw.mFontID = gFontID;
+	float2 txtSizePx = cmdDrawCpuProfile(cmd, float2(8.f, 15.f), &gFrameTimeDraw);
+	float2 gpuSizePx = cmdDrawGpuProfile(cmd, float2(8.f, txtSizePx.y + 75.f), gGpuProfileToken,
+										 &gFrameTimeDraw);
+
+	char renderStatsText[160];
+	snprintf(renderStatsText, sizeof(renderStatsText),
+			 "Draws: %u (%u instanced)  Binds: %u pipeline, %u descriptor, %u vertex, %u index  "
+			 "Skipped: %u",
+			 gRenderStats.drawCalls, gRenderStats.instancedBatches, gRenderStats.pipelineBinds,
+			 gRenderStats.descriptorBinds, gRenderStats.vertexBufferBinds,
+			 gRenderStats.indexBufferBinds, gRenderStats.bindsSkipped);
+	gFrameTimeDraw.pText = renderStatsText;
+	cmdDrawTextWithFont(cmd, float2(8.f, txtSizePx.y + gpuSizePx.y + 100.f), &gFrameTimeDraw);
+
+	snprintf(renderStatsText, sizeof(renderStatsText), "Entities: %u visible, %u culled",
+			 gRenderStats.visibleEntities, gRenderStats.culledEntities);
+	cmdDrawTextWithFont(cmd, float2(8.f, txtSizePx.y + gpuSizePx.y + 125.f), &gFrameTimeDraw);
+
+	// Memory budget per arena tag
+	ArenaStats arenaTags[MAX_MEMORY_OVERLAY_TAGS];
+	uint32_t arenaTagCount = arenaGetTagStats(arenaTags, MAX_MEMORY_OVERLAY_TAGS);
+	for (uint32_t i = 0; i < arenaTagCount; ++i)
+	{
+		const ArenaStats* pTag = &arenaTags[i];
+		snprintf(renderStatsText, sizeof(renderStatsText),
+				 "Memory %s: %.2f MB used, %.2f MB peak, %.2f MB committed  (%u arenas, %u blocks)",
+				 pTag->pName, pTag->usedBytes / (1024.0 * 1024.0),
+				 pTag->peakBytes / (1024.0 * 1024.0), pTag->committedBytes / (1024.0 * 1024.0),
+				 pTag->arenaCount, pTag->blockCount);
+		cmdDrawTextWithFont(cmd, float2(8.f, txtSizePx.y + gpuSizePx.y + 150.f + 25.f * i),
+							&gFrameTimeDraw);
+	}
+	gFrameTimeDraw.pText = NULL;
+
+	cmdDrawUserInterface(cmd);
+
+	cmdEndGpuTimestampQuery(cmd, gGpuProfileToken);
+	cmdBindRenderTargets(cmd, NULL);
+}
+
 bool EngineApp::initRendererInternal()
 {
 	RendererDesc settings = {};
@@ -481,7 +1093,7 @@ bool EngineApp::initRendererInternal()
 	GpuCmdRingDesc cmdRingDesc = {};
 	cmdRingDesc.pQueue = pGraphicsQueue;
 	cmdRingDesc.mPoolCount = 2;
-	cmdRingDesc.mCmdPerPoolCount = 1;
+	cmdRingDesc.mCmdPerPoolCount = 2; // Before and after the parallel render pass
 	cmdRingDesc.mAddSyncPrimitives = true;
 	initGpuCmdRing(pRenderer, &cmdRingDesc, &gGraphicsCmdRing);
 
@@ -537,18 +1149,18 @@ void EngineApp::loadShaders()
 		LOGF(LogLevel::eERROR, "Failed to load sprite shaders");
 	}
 
-	ShaderLoadDesc cubeShaderDesc = {};
-	cubeShaderDesc.mVert.pFileName = "basic.vert";
-	cubeShaderDesc.mFrag.pFileName = "cube.frag";
-	addShader(pRenderer, &cubeShaderDesc, &pCubeShader);
+	ShaderLoadDesc instancedShaderDesc = {};
+	instancedShaderDesc.mVert.pFileName = "instanced.vert";
+	instancedShaderDesc.mFrag.pFileName = "basic.frag";
+	addShader(pRenderer, &instancedShaderDesc, &pInstancedShader);
 
-	if (pCubeShader)
+	if (pInstancedShader)
 	{
-		LOGF(LogLevel::eINFO, "Cube shaders loaded successfully");
+		LOGF(LogLevel::eINFO, "Instanced shaders loaded successfully");
 	}
 	else
 	{
-		LOGF(LogLevel::eERROR, "Failed to load cube shaders");
+		LOGF(LogLevel::eERROR, "Failed to load instanced shaders");
 	}
 }
 
@@ -560,16 +1172,16 @@ void EngineApp::unloadShaders()
 		pShader = NULL;
 	}
 
-	if (pCubeShader)
+	if (pInstancedShader)
 	{
-		removeShader(pRenderer, pCubeShader);
-		pCubeShader = NULL;
+		removeShader(pRenderer, pInstancedShader);
+		pInstancedShader = NULL;
 	}
 }
 
 void EngineApp::createPipeline()
 {
-	LOGF(LogLevel::eINFO, "createPipeline: Starting pipeline creation");
+	LOGF(LogLevel::eINFO, "createPipeline: Acquiring pipelines");
 	LOGF(LogLevel::eINFO, "createPipeline: pShader = %p, pSwapChain = %p", pShader, pSwapChain);
 
 	VertexLayout vertexLayout = {};
@@ -591,6 +1203,30 @@ void EngineApp::createPipeline()
 	vertexLayout.mAttribs[1].mLocation = 1;
 	vertexLayout.mAttribs[1].mOffset = sizeof(float) * 3;
 
+	// Same mesh stream plus the model matrix columns and texture slot from the instance buffer
+	VertexLayout instancedVertexLayout = vertexLayout;
+	instancedVertexLayout.mBindingCount = 2;
+	instancedVertexLayout.mAttribCount = 7;
+	instancedVertexLayout.mBindings[1].mStride = sizeof(InstanceData);
+	instancedVertexLayout.mBindings[1].mRate = VERTEX_BINDING_RATE_INSTANCE;
+
+	for (uint32_t column = 0; column < 4; ++column)
+	{
+		VertexAttrib& attrib = instancedVertexLayout.mAttribs[2 + column];
+		attrib.mSemantic = (ShaderSemantic)(SEMANTIC_TEXCOORD1 + column);
+		attrib.mFormat = TinyImageFormat_R32G32B32A32_SFLOAT;
+		attrib.mBinding = 1;
+		attrib.mLocation = 2 + column;
+		attrib.mOffset = sizeof(float) * 4 * column;
+	}
+
+	VertexAttrib& slotAttrib = instancedVertexLayout.mAttribs[6];
+	slotAttrib.mSemantic = SEMANTIC_TEXCOORD5;
+	slotAttrib.mFormat = TinyImageFormat_R32_UINT;
+	slotAttrib.mBinding = 1;
+	slotAttrib.mLocation = 6;
+	slotAttrib.mOffset = offsetof(InstanceData, textureSlot);
+
 	RasterizerStateDesc rasterizerStateDesc = {};
 	rasterizerStateDesc.mCullMode = CULL_MODE_NONE;
 
@@ -649,7 +1285,11 @@ void EngineApp::createPipeline()
 	pipelineSettings.pDepthState = &spriteDepthStateDesc;
 	pipelineSettings.pBlendState = &blendStateDesc;
 
-	addPipeline(pRenderer, &pipelineDesc, &pPipeline);
+	pPipeline = acquirePipeline(pPipelineRegistry, &pipelineDesc);
+
+	pipelineSettings.pShaderProgram = pInstancedShader;
+	pipelineSettings.pVertexLayout = &instancedVertexLayout;
+	pInstancedPipeline = acquirePipeline(pPipelineRegistry, &pipelineDesc);
 
 	BlendStateDesc opaqueBlendStateDesc = {};
 	opaqueBlendStateDesc.mSrcFactors[0] = BC_ONE;
@@ -675,28 +1315,45 @@ void EngineApp::createPipeline()
 		cubePipelineSettings.mDepthStencilFormat = pDepthBuffer->mFormat;
 	}
 
-	cubePipelineSettings.pShaderProgram = pCubeShader;
+	// Textures come from the bindless slot, so the cubes share the sprite shaders
+	cubePipelineSettings.pShaderProgram = pShader;
 	cubePipelineSettings.pVertexLayout = &vertexLayout;
 	cubePipelineSettings.pRasterizerState = &rasterizerStateDesc;
 	cubePipelineSettings.pDepthState = &depthStateDesc;
 	cubePipelineSettings.pBlendState = &opaqueBlendStateDesc;
 
-	addPipeline(pRenderer, &cubePipelineDesc, &pCubePipeline);
+	pCubePipeline = acquirePipeline(pPipelineRegistry, &cubePipelineDesc);
+
+	cubePipelineSettings.pShaderProgram = pInstancedShader;
+	cubePipelineSettings.pVertexLayout = &instancedVertexLayout;
+	pInstancedCubePipeline = acquirePipeline(pPipelineRegistry, &cubePipelineDesc);
 }
 
 void EngineApp::destroyPipeline()
 {
 	if (pPipeline)
 	{
-		removePipeline(pRenderer, pPipeline);
+		releasePipeline(pPipelineRegistry, pPipeline);
 		pPipeline = NULL;
 	}
 
 	if (pCubePipeline)
 	{
-		removePipeline(pRenderer, pCubePipeline);
+		releasePipeline(pPipelineRegistry, pCubePipeline);
 		pCubePipeline = NULL;
 	}
+
+	if (pInstancedPipeline)
+	{
+		releasePipeline(pPipelineRegistry, pInstancedPipeline);
+		pInstancedPipeline = NULL;
+	}
+
+	if (pInstancedCubePipeline)
+	{
+		releasePipeline(pPipelineRegistry, pInstancedCubePipeline);
+		pInstancedCubePipeline = NULL;
+	}
 }
 
 Buffer* EngineApp::createMeshBuffer(const void* pVertexData, uint32_t dataSize)
@@ -776,54 +1433,407 @@ void EngineApp::destroyPerFrameUniformBuffer()
 	}
 }
 
-void EngineApp::createPerObjectBuffers(uint32_t count)
+void EngineApp::createInstanceBuffers()
 {
-	if (!pRenderer || count == 0 || count > MAX_OBJECTS)
+	if (!pRenderer)
 		return;
 
-	BufferLoadDesc ubDesc = {};
-	ubDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	ubDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_CPU_TO_GPU;
-	ubDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_PERSISTENT_MAP_BIT;
-	ubDesc.mDesc.mSize = sizeof(mat4);
-	ubDesc.pData = NULL;
+	BufferLoadDesc instanceDesc = {};
+	instanceDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_VERTEX_BUFFER;
+	instanceDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_CPU_TO_GPU;
+	instanceDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_PERSISTENT_MAP_BIT;
+	instanceDesc.mDesc.mSize = (uint64_t)gpuRenderCapacity * sizeof(InstanceData);
+	instanceDesc.pData = NULL;
 
 	for (uint32_t i = 0; i < gDataBufferCount; ++i)
 	{
-		for (uint32_t j = 0; j < count; ++j)
+		instanceDesc.mDesc.pName = "InstanceBuffer";
+		instanceDesc.ppBuffer = &pInstanceBuffer[i];
+		addResource(&instanceDesc, NULL);
+	}
+
+	waitForAllResourceLoads();
+}
+
+void EngineApp::destroyInstanceBuffers()
+{
+	for (uint32_t i = 0; i < gDataBufferCount; ++i)
+	{
+		if (pInstanceBuffer[i])
 		{
-			ubDesc.mDesc.pName = "PerObjectUniformBuffer";
-			ubDesc.ppBuffer = &pUniformBufferPerObject[i][j];
-			addResource(&ubDesc, NULL);
+			removeResource(pInstanceBuffer[i]);
+			pInstanceBuffer[i] = NULL;
 		}
 	}
+}
 
-	waitForAllResourceLoads();
+void EngineApp::writeInstanceData(uint32_t instancedCount)
+{
+	Buffer* pInstances = pInstanceBuffer[gFrameIndex];
+	if (instancedCount == 0 || !pInstances || !pInstances->pCpuMappedAddress)
+		return;
+
+	// The fence wait at the top of Draw() guarantees the GPU is done with this buffer
+	InstanceData* pInstanceData = (InstanceData*)pInstances->pCpuMappedAddress;
+	for (uint32_t i = 0; i < instancedCount; ++i)
+	{
+		pInstanceData[i].modelMatrix = pRenderDataArray[i].modelMatrix;
+		pInstanceData[i].textureSlot = pRenderDataArray[i].textureSlot;
+	}
 }
 
-void EngineApp::createPerObjectDescriptorSets(uint32_t count)
+void EngineApp::recordRenderItems(Cmd* cmd, uint32_t firstItem, uint32_t itemCount,
+								  uint32_t instancedCount, RenderStats* pStats)
 {
-	if (!pRenderer || count == 0 || count > MAX_OBJECTS)
+	RenderBindState bindState = {};
+	bindState.perObjectIndex = UINT32_MAX;
+	bindState.pStats = pStats;
+
+	Buffer* pInstances = pInstanceBuffer[gFrameIndex];
+
+	for (uint32_t item = firstItem; item < firstItem + itemCount; ++item)
+	{
+		if (item < instanceBatchCount)
+		{
+			const InstanceBatch& batch = pInstanceBatches[item];
+			if (!pInstances)
+				continue;
+
+			bindPipelineTracked(cmd, &bindState, batch.pPipeline);
+
+			// All pipelines share the root signature, so these survive pipeline changes
+			if (!bindState.frameSetsBound)
+			{
+				bindFrameDescriptorSets(cmd, pStats);
+				bindState.frameSetsBound = true;
+			}
+
+			// The instance stream is bound at offset 0 and the draw's first instance
+			// selects the batch, so batches that share a mesh share the binding
+			if (!bindState.instanceStreamBound || bindState.pVertexBuffer != batch.pVertexBuffer ||
+				bindState.vertexStride != batch.vertexStride)
+			{
+				Buffer* vbs[2] = {batch.pVertexBuffer, pInstances};
+				uint32_t strides[2] = {batch.vertexStride, (uint32_t)sizeof(InstanceData)};
+				cmdBindVertexBuffer(cmd, 2, vbs, strides, NULL);
+				bindState.pVertexBuffer = batch.pVertexBuffer;
+				bindState.vertexStride = batch.vertexStride;
+				bindState.instanceStreamBound = true;
+				pStats->vertexBufferBinds++;
+			}
+			else
+			{
+				pStats->bindsSkipped++;
+			}
+
+			if (batch.pIndexBuffer)
+			{
+				bindIndexBufferTracked(cmd, &bindState, batch.pIndexBuffer, batch.indexSize);
+				cmdDrawIndexedInstanced(cmd, batch.indexCount, 0, batch.instanceCount, 0,
+										batch.firstInstance);
+			}
+			else
+			{
+				cmdDrawInstanced(cmd, batch.vertexCount, 0, batch.instanceCount,
+								 batch.firstInstance);
+			}
+
+			pStats->drawCalls++;
+			pStats->instancedBatches++;
+			continue;
+		}
+
+		const MeshRenderData& renderData = pRenderDataArray[instancedCount + item -
+															instanceBatchCount];
+
+		if (renderData.pPipeline)
+			bindPipelineTracked(cmd, &bindState, renderData.pPipeline);
+
+		if (!bindState.frameSetsBound && bindState.pPipeline)
+		{
+			bindFrameDescriptorSets(cmd, pStats);
+			bindState.frameSetsBound = true;
+		}
+
+		uint32_t perObjectIndex = gFrameIndex * gpuRenderCapacity + renderData.descriptorSetIndex;
+		if (pDescriptorSetPerObject && perObjectIndex != bindState.perObjectIndex)
+		{
+			cmdBindDescriptorSet(cmd, perObjectIndex, pDescriptorSetPerObject);
+			bindState.perObjectIndex = perObjectIndex;
+			pStats->descriptorBinds++;
+		}
+
+		if (renderData.pVertexBuffer != bindState.pVertexBuffer ||
+			renderData.vertexStride != bindState.vertexStride || bindState.instanceStreamBound)
+		{
+			Buffer* vb = renderData.pVertexBuffer;
+			uint32_t stride = renderData.vertexStride;
+			cmdBindVertexBuffer(cmd, 1, &vb, &stride, NULL);
+			bindState.pVertexBuffer = vb;
+			bindState.vertexStride = stride;
+			bindState.instanceStreamBound = false;
+			pStats->vertexBufferBinds++;
+		}
+		else
+		{
+			pStats->bindsSkipped++;
+		}
+
+		if (renderData.pIndexBuffer)
+		{
+			bindIndexBufferTracked(cmd, &bindState, renderData.pIndexBuffer,
+								   renderData.indexSize);
+			cmdDrawIndexed(cmd, renderData.indexCount, 0, 0);
+		}
+		else
+		{
+			cmdDraw(cmd, renderData.vertexCount, 0);
+		}
+
+		pStats->drawCalls++;
+	}
+}
+
+void EngineApp::recordRenderJob(RenderRecordJob* pJob)
+{
+	ENGINE_PROFILE_SCOPE("recordRenderJob");
+
+	RenderTarget* pRenderTarget = pJob->pRenderTarget;
+	Cmd* cmd = pJob->pCmd;
+
+	// The fence wait at the top of Draw() also covers this frame's job pools
+	resetCmdPool(pRenderer, pJob->pCmdPool);
+	beginCmd(cmd);
+
+	BindRenderTargetsDesc bindRenderTargets = {};
+	bindRenderTargets.mRenderTargetCount = 1;
+	bindRenderTargets.mRenderTargets[0] = {pRenderTarget, LOAD_ACTION_LOAD};
+	bindRenderTargets.mDepthStencil = {pDepthBuffer, LOAD_ACTION_LOAD};
+	cmdBindRenderTargets(cmd, &bindRenderTargets);
+	cmdSetViewport(cmd, 0.0f, 0.0f, (float)pRenderTarget->mWidth, (float)pRenderTarget->mHeight,
+				   0.0f, 1.0f);
+	cmdSetScissor(cmd, 0, 0, pRenderTarget->mWidth, pRenderTarget->mHeight);
+
+	recordRenderItems(cmd, pJob->firstItem, pJob->itemCount, pJob->instancedCount, &pJob->stats);
+
+	cmdBindRenderTargets(cmd, NULL);
+	endCmd(cmd);
+}
+
+void EngineApp::runRenderRecordJob(void* pData)
+{
+	RenderRecordJob* pJob = (RenderRecordJob*)pData;
+	pJob->pApp->recordRenderJob(pJob);
+}
+
+void EngineApp::setRenderThreadCount(uint32_t count)
+{
+	if (pRenderWorkers)
+	{
+		LOGF(LogLevel::eWARNING, "setRenderThreadCount: Render workers already started");
 		return;
+	}
+
+	if (count < 1)
+		count = 1;
+	if (count > MAX_RENDER_THREADS)
+		count = MAX_RENDER_THREADS;
+
+	renderThreadCount = count;
+}
+
+bool EngineApp::initRenderWorkers()
+{
+	if (renderThreadCount <= 1)
+		return true;
+
+	for (uint32_t i = 0; i < gDataBufferCount; ++i)
+	{
+		for (uint32_t t = 0; t < renderThreadCount; ++t)
+		{
+			CmdPoolDesc poolDesc = {};
+			poolDesc.pQueue = pGraphicsQueue;
+			poolDesc.mTransient = true;
+			initCmdPool(pRenderer, &poolDesc, &pRecordCmdPools[i][t]);
+
+			CmdDesc cmdDesc = {};
+			cmdDesc.pPool = pRecordCmdPools[i][t];
+			initCmd(pRenderer, &cmdDesc, &pRecordCmds[i][t]);
+
+			if (!pRecordCmdPools[i][t] || !pRecordCmds[i][t])
+				return false;
+		}
+	}
+
+	RenderWorkerPool* pPool = (RenderWorkerPool*)tf_calloc(1, sizeof(RenderWorkerPool));
+	if (!pPool)
+		return false;
 
-	DescriptorSetDesc descPerObject = SRT_SET_DESC(SrtData, PerDraw, count, 0);
+	for (uint32_t j = 0; j < renderThreadCount; ++j)
+	{
+		pPool->jobs[j].pApp = this;
+		pPool->jobDescs[j].pFunc = runRenderRecordJob;
+		pPool->jobDescs[j].pData = &pPool->jobs[j];
+		pPool->jobDescs[j].flags = JobFlag_None;
+	}
+	pPool->workerCount = renderThreadCount - 1;
+	pRenderWorkers = pPool;
+
+	LOGF(LogLevel::eINFO, "Render pass recording in %u jobs", renderThreadCount);
+	return true;
+}
+
+void EngineApp::exitRenderWorkers()
+{
+	// Draw() waits for its jobs, none can be in flight here
+	if (pRenderWorkers)
+	{
+		tf_free(pRenderWorkers);
+		pRenderWorkers = NULL;
+	}
+
+	for (uint32_t i = 0; i < gDataBufferCount; ++i)
+	{
+		for (uint32_t t = 0; t < MAX_RENDER_THREADS; ++t)
+		{
+			if (pRecordCmds[i][t])
+			{
+				exitCmd(pRenderer, pRecordCmds[i][t]);
+				pRecordCmds[i][t] = NULL;
+			}
+
+			if (pRecordCmdPools[i][t])
+			{
+				exitCmdPool(pRenderer, pRecordCmdPools[i][t]);
+				pRecordCmdPools[i][t] = NULL;
+			}
+		}
+	}
+}
+
+void EngineApp::bindFrameDescriptorSets(Cmd* cmd, RenderStats* pStats)
+{
+	if (pDescriptorSetPersistent)
+	{
+		cmdBindDescriptorSet(cmd, gFrameIndex, pDescriptorSetPersistent);
+		pStats->descriptorBinds++;
+	}
+
+	if (pDescriptorSetPerFrame)
+	{
+		cmdBindDescriptorSet(cmd, gFrameIndex, pDescriptorSetPerFrame);
+		pStats->descriptorBinds++;
+	}
+}
+
+void EngineApp::sortRenderData(uint32_t count)
+{
+	ENGINE_PROFILE_SCOPE("sortRenderData");
+
+	if (count < 2 || !pSortKeys || !pSortedRenderData)
+		return;
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		pSortKeys[i] = pRenderDataArray[i].sortKey;
+		pSortIndices[i] = i;
+	}
+
+	radixSort64(pSortKeys, pSortIndices, pSortTempKeys, pSortTempIndices, count);
+
+	for (uint32_t i = 0; i < count; ++i)
+		pSortedRenderData[i] = pRenderDataArray[pSortIndices[i]];
+
+	memcpy(pRenderDataArray, pSortedRenderData, count * sizeof(MeshRenderData));
+}
+
+bool EngineApp::allocateSortScratch(uint32_t capacity)
+{
+	uint64_t* pKeys = (uint64_t*)tf_realloc(pSortKeys, capacity * sizeof(uint64_t));
+	if (pKeys)
+		pSortKeys = pKeys;
+
+	uint64_t* pTempKeys = (uint64_t*)tf_realloc(pSortTempKeys, capacity * sizeof(uint64_t));
+	if (pTempKeys)
+		pSortTempKeys = pTempKeys;
+
+	uint32_t* pIndices = (uint32_t*)tf_realloc(pSortIndices, capacity * sizeof(uint32_t));
+	if (pIndices)
+		pSortIndices = pIndices;
+
+	uint32_t* pTempIndices = (uint32_t*)tf_realloc(pSortTempIndices, capacity * sizeof(uint32_t));
+	if (pTempIndices)
+		pSortTempIndices = pTempIndices;
+
+	MeshRenderData* pSorted =
+		(MeshRenderData*)tf_realloc(pSortedRenderData, capacity * sizeof(MeshRenderData));
+	if (pSorted)
+		pSortedRenderData = pSorted;
+
+	return pKeys && pTempKeys && pIndices && pTempIndices && pSorted;
+}
+
+void EngineApp::freeSortScratch()
+{
+	tf_free(pSortKeys);
+	tf_free(pSortTempKeys);
+	tf_free(pSortIndices);
+	tf_free(pSortTempIndices);
+	tf_free(pSortedRenderData);
+
+	pSortKeys = NULL;
+	pSortTempKeys = NULL;
+	pSortIndices = NULL;
+	pSortTempIndices = NULL;
+	pSortedRenderData = NULL;
+}
+
+void EngineApp::createPerObjectBuffers()
+{
+	if (!pRenderer || gpuRenderCapacity == 0)
+		return;
+
+	BufferLoadDesc ubDesc = {};
+	ubDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	ubDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_CPU_TO_GPU;
+	ubDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_PERSISTENT_MAP_BIT;
+	ubDesc.mDesc.mSize = (uint64_t)gpuRenderCapacity * PER_OBJECT_DATA_STRIDE;
+	ubDesc.pData = NULL;
+
+	for (uint32_t i = 0; i < gDataBufferCount; ++i)
+	{
+		ubDesc.mDesc.pName = "PerObjectRingBuffer";
+		ubDesc.ppBuffer = &pPerObjectBuffer[i];
+		addResource(&ubDesc, NULL);
+	}
+
+	DescriptorSetDesc descPerObject =
+		SRT_SET_DESC(SrtData, PerDraw, gpuRenderCapacity * gDataBufferCount, 0);
 	addDescriptorSet(pRenderer, &descPerObject, &pDescriptorSetPerObject);
 
-	for (uint32_t objIndex = 0; objIndex < count; ++objIndex)
+	waitForAllResourceLoads();
+
+	// One descriptor per slot, each viewing its range of the frame's buffer
+	for (uint32_t frameIndex = 0; frameIndex < gDataBufferCount; ++frameIndex)
 	{
-		for (uint32_t frameIndex = 0; frameIndex < gDataBufferCount; ++frameIndex)
+		for (uint32_t slot = 0; slot < gpuRenderCapacity; ++slot)
 		{
+			DescriptorDataRange range = {};
+			range.mOffset = slot * PER_OBJECT_DATA_STRIDE;
+			range.mSize = PER_OBJECT_DATA_STRIDE;
+
 			DescriptorData params[1] = {};
 			params[0].mIndex = SRT_RES_IDX(SrtData, PerDraw, gObject);
-			params[0].ppBuffers = &pUniformBufferPerObject[frameIndex][objIndex];
+			params[0].ppBuffers = &pPerObjectBuffer[frameIndex];
+			params[0].pRanges = &range;
 
-			uint32_t descriptorIndex = objIndex;
+			uint32_t descriptorIndex = frameIndex * gpuRenderCapacity + slot;
 			updateDescriptorSet(pRenderer, descriptorIndex, pDescriptorSetPerObject, 1, params);
 		}
 	}
 }
 
-void EngineApp::destroyPerObjectDescriptorSets()
+void EngineApp::destroyPerObjectBuffers()
 {
 	if (pDescriptorSetPerObject)
 	{
@@ -833,28 +1843,57 @@ void EngineApp::destroyPerObjectDescriptorSets()
 
 	for (uint32_t i = 0; i < gDataBufferCount; ++i)
 	{
-		for (uint32_t j = 0; j < MAX_OBJECTS; ++j)
+		if (pPerObjectBuffer[i])
 		{
-			if (pUniformBufferPerObject[i][j])
-			{
-				removeResource(pUniformBufferPerObject[i][j]);
-				pUniformBufferPerObject[i][j] = NULL;
-			}
+			removeResource(pPerObjectBuffer[i]);
+			pPerObjectBuffer[i] = NULL;
 		}
 	}
 }
 
-uint32_t EngineApp::allocateObjectBufferSlot()
+void EngineApp::ensureRenderCapacity(uint32_t count)
 {
-	if (nextObjectBufferIndex >= MAX_OBJECTS)
+	if (count <= gpuRenderCapacity)
+		return;
+
+	uint32_t newCapacity = gpuRenderCapacity ? gpuRenderCapacity : 1;
+	while (newCapacity < count)
+		newCapacity *= 2;
+
+	InstanceBatch* pBatches =
+		(InstanceBatch*)tf_realloc(pInstanceBatches, newCapacity * sizeof(InstanceBatch));
+	if (!pBatches)
+	{
+		LOGF(LogLevel::eERROR, "Failed to grow instance batch array to %d", newCapacity);
+		return;
+	}
+	pInstanceBatches = pBatches;
+
+	if (!allocateSortScratch(newCapacity))
+	{
+		LOGF(LogLevel::eERROR, "Failed to grow render data sort scratch to %d", newCapacity);
+		return;
+	}
+
+	LOGF(LogLevel::eINFO, "Growing render capacity from %d to %d", gpuRenderCapacity,
+		 newCapacity);
+
+	// Buffers are only recreated if Load() already created them
+	bool hasBuffers = pPerObjectBuffer[0] != NULL;
+	if (hasBuffers)
 	{
-		LOGF(LogLevel::eERROR, "Full! Max: %d", MAX_OBJECTS);
-		return 0;
+		waitQueueIdle(pGraphicsQueue);
+		destroyPerObjectBuffers();
+		destroyInstanceBuffers();
 	}
 
-	uint32_t slot = nextObjectBufferIndex++;
-	LOGF(LogLevel::eINFO, "Allocated object buffer slot %d", slot);
-	return slot;
+	gpuRenderCapacity = newCapacity;
+
+	if (hasBuffers)
+	{
+		createInstanceBuffers();
+		createPerObjectBuffers();
+	}
 }
 
 void EngineApp::uploadPerFrameData(const void* pData, size_t size)
@@ -870,40 +1909,104 @@ void EngineApp::uploadPerFrameData(const void* pData, size_t size)
 
 void EngineApp::uploadPerObjectData(uint32_t objectIndex, const void* pData, size_t size)
 {
-	if (!pData || size == 0 || objectIndex >= MAX_OBJECTS ||
-		!pUniformBufferPerObject[gFrameIndex][objectIndex])
+	Buffer* pBuffer = pPerObjectBuffer[gFrameIndex];
+	if (!pData || size == 0 || size > PER_OBJECT_DATA_STRIDE || objectIndex >= gpuRenderCapacity ||
+		!pBuffer || !pBuffer->pCpuMappedAddress)
 		return;
 
-	BufferUpdateDesc cbv = {pUniformBufferPerObject[gFrameIndex][objectIndex]};
-	beginUpdateResource(&cbv);
-	memcpy(cbv.pMappedData, pData, size);
-	endUpdateResource(&cbv);
+	uint8_t* pSlot = (uint8_t*)pBuffer->pCpuMappedAddress +
+					 (uint64_t)objectIndex * PER_OBJECT_DATA_STRIDE;
+	memcpy(pSlot, pData, size);
 }
 
+Arena* EngineApp::getFrameArena() { return frameArenaGet(pFrameArena); }
+
 ecs_entity_t EngineApp::createMeshEntity(const MeshEntityDesc* pDesc)
 {
-	uint32_t descriptorIndex = allocateObjectBufferSlot();
+	return ::createMeshEntity(pWorld, pDesc);
+}
 
-	ecs_entity_t entity = ::createMeshEntity(pWorld, pDesc);
+void EngineApp::updateTransform(ecs_entity_t entity, const TransformDesc* pDesc)
+{
+	::updateTransform(pWorld, entity, pDesc);
+}
 
-	MeshComponent* mesh = ecs_get_mut(pWorld, entity, MeshComponent);
-	if (mesh)
+void EngineApp::setCullingCamera(const mat4* pViewProjection)
+{
+	if (!pWorld)
 	{
-		mesh->descriptorSetIndex = descriptorIndex;
-		ecs_modified(pWorld, entity, MeshComponent);
+		LOGF(LogLevel::eWARNING, "setCullingCamera: No ECS world, call it after Init()");
+		return;
 	}
 
-	LOGF(LogLevel::eINFO, "Entity %llu allocated descriptor set index %d", entity, descriptorIndex);
-	return entity;
+	RenderContext* ctx = ecs_singleton_ensure(pWorld, RenderContext);
+	ctx->cullingEnabled = pViewProjection != nullptr;
+	if (pViewProjection)
+		extractFrustumPlanes(&ctx->cullFrustum, (const float*)pViewProjection);
+	ecs_singleton_modified(pWorld, RenderContext);
 }
 
-void EngineApp::updateTransform(ecs_entity_t entity, const TransformDesc* pDesc)
+ecs_entity_t EngineApp::createTransformEntity(const TransformDesc* pDesc, ecs_entity_t parent)
 {
-	::updateTransform(pWorld, entity, pDesc);
+	return ::createTransformEntity(pWorld, pDesc, parent);
+}
+
+void EngineApp::setParent(ecs_entity_t child, ecs_entity_t parent)
+{
+	::setParent(pWorld, child, parent);
 }
 
 uint32_t EngineApp::getRenderDataCount() const
 {
-	const RenderContext* ctx = ecs_singleton_get(pWorld, RenderContext);
-	return ctx ? ctx->renderDataCount : 0;
+	// The published buffer is the one before the simulation buffer
+	uint32_t publishedIndex = (simDataIndex + gDataBufferCount - 1) % gDataBufferCount;
+	return renderDataCounts[publishedIndex];
+}
+
+///////////////////////////////////////////
+// Headless
+
+bool initHeadlessApp(EngineApp* pApp, const char* pAppName)
+{
+	if (!pApp || !pAppName)
+		return false;
+
+	if (!initMemAlloc(pAppName))
+		return false;
+
+	FileSystemInitDesc fsDesc = {};
+	fsDesc.pAppName = pAppName;
+	if (!initFileSystem(&fsDesc))
+	{
+		exitMemAlloc();
+		return false;
+	}
+	fsSetPathForResourceDir(pSystemFileIO, RM_DEBUG, RD_LOG, "");
+	initLog(pAppName, DEFAULT_LOG_LEVEL);
+
+	if (!pApp->Init() || !pApp->Load(NULL))
+	{
+		LOGF(LogLevel::eERROR, "initHeadlessApp: Failed to initialize %s", pAppName);
+		pApp->Exit();
+
+		exitLog();
+		exitFileSystem();
+		exitMemAlloc();
+		return false;
+	}
+
+	return true;
+}
+
+void exitHeadlessApp(EngineApp* pApp)
+{
+	if (!pApp)
+		return;
+
+	pApp->Unload(NULL);
+	pApp->Exit();
+
+	exitLog();
+	exitFileSystem();
+	exitMemAlloc();
 }
@@ -0,0 +1,583 @@
+/*
+ * JobSystem.cpp
+ *
+ */
+
+#include "Runtime/JobSystem.h"
+#include "Runtime/Memory/Arena.h"
+#include "Runtime/Memory/Pool.h"
+#include "Runtime/Trace.h"
+#include "Utilities/Interfaces/ILog.h"
+#include "Utilities/Interfaces/IThread.h"
+#include "Utilities/Threading/Atomics.h"
+
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define JOB_CPU_PAUSE() _mm_pause()
+#elif defined(__x86_64__) || defined(__i386__)
+#define JOB_CPU_PAUSE() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define JOB_CPU_PAUSE() __asm__ __volatile__("yield")
+#else
+#define JOB_CPU_PAUSE()
+#endif
+
+#define JOB_SPIN_COUNT 64 ///< Empty polls before a worker sleeps or a waiter yields
+
+static_assert((JOB_DEQUE_CAPACITY & (JOB_DEQUE_CAPACITY - 1)) == 0,
+			  "JOB_DEQUE_CAPACITY must be a power of 2");
+
+// The Forge atomics only go up to acquire and release. The deque and the
+// sleep handshake need store to load ordering, which only a full fence gives
+#define JOB_FENCE() std::atomic_thread_fence(std::memory_order_seq_cst)
+
+/**
+	A queued job, allocated from JobSystem::pJobPool.
+*/
+struct Job
+{
+	JobFunc pFunc;
+	void* pData;
+	JobCounter* pCounter; ///< Decremented once the job ran, may be nullptr
+	Job* pNext;			  ///< Link in the shared queues and counter wait lists
+	uint32_t flags;		  ///< JobFlags
+};
+
+/**
+	Chase-Lev work stealing deque.
+
+	The owner pushes and pops at the bottom, thieves take from the top.
+	top and bottom live on separate cache lines so the owner does not
+	bounce the line thieves spin on.
+*/
+struct alignas(64) JobDeque
+{
+	int64_t top;
+	uint8_t padding[56];
+	int64_t bottom;
+	Job* pSlots[JOB_DEQUE_CAPACITY];
+};
+
+struct JobWorker
+{
+	JobSystem* pSystem;
+	ThreadHandle thread;
+	uint32_t index;
+	uint32_t stealSeed; ///< xorshift state for picking the first victim
+};
+
+struct JobSystem
+{
+	Arena* pArena;
+	Pool* pJobPool;
+	JobDeque* pDeques; ///< workerCount + 1, slot 0 belongs to the creating thread
+	JobWorker workers[JOB_SYSTEM_MAX_WORKERS + 1];
+	uint32_t workerCount;
+
+	uint32_t queueLock;	 ///< Guards both shared queues
+	Job* pQueueHead;	 ///< Jobs from outside threads and full deques
+	Job* pQueueTail;
+	Job* pBlockingHead; ///< JobFlag_Blocking jobs, only taken by idle workers
+	Job* pBlockingTail;
+
+	uint32_t pendingCount;	///< Queued jobs not picked up yet, a hint for sleeping
+	uint32_t sleepingCount; ///< Workers waiting on sleepCondition
+	uint32_t quit;
+	Mutex sleepMutex;
+	ConditionVariable sleepCondition;
+};
+
+static thread_local const JobSystem* tpJobSystem = nullptr;
+static thread_local uint32_t tJobThreadIndex = UINT32_MAX;
+
+static uint32_t jobThreadIndex(const JobSystem* pSystem)
+{
+	return tpJobSystem == pSystem ? tJobThreadIndex : UINT32_MAX;
+}
+
+static void jobSpinLock(uint32_t* pLock)
+{
+	tfrg_atomic32_t* pAtomic = (tfrg_atomic32_t*)pLock;
+	while (tfrg_atomic32_cas_relaxed(pAtomic, 0, 1) != 0)
+		JOB_CPU_PAUSE();
+	tfrg_atomic32_load_acquire(pAtomic);
+}
+
+static void jobSpinUnlock(uint32_t* pLock)
+{
+	tfrg_atomic32_store_release((tfrg_atomic32_t*)pLock, 0);
+}
+
+///////////////////////////////////////////
+// Deque
+
+static bool dequePush(JobDeque* pDeque, Job* pJob)
+{
+	int64_t bottom = (int64_t)tfrg_atomic64_load_relaxed((tfrg_atomic64_t*)&pDeque->bottom);
+	int64_t top = (int64_t)tfrg_atomic64_load_acquire((tfrg_atomic64_t*)&pDeque->top);
+	if (bottom - top >= JOB_DEQUE_CAPACITY)
+		return false;
+
+	uint64_t slot = (uint64_t)bottom & (JOB_DEQUE_CAPACITY - 1);
+	tfrg_atomicptr_store_release((tfrg_atomicptr_t*)&pDeque->pSlots[slot], (uintptr_t)pJob);
+	tfrg_atomic64_store_release((tfrg_atomic64_t*)&pDeque->bottom, (uint64_t)(bottom + 1));
+	return true;
+}
+
+static Job* dequePop(JobDeque* pDeque)
+{
+	int64_t bottom = (int64_t)tfrg_atomic64_load_relaxed((tfrg_atomic64_t*)&pDeque->bottom) - 1;
+	tfrg_atomic64_store_relaxed((tfrg_atomic64_t*)&pDeque->bottom, (uint64_t)bottom);
+	JOB_FENCE();
+	int64_t top = (int64_t)tfrg_atomic64_load_relaxed((tfrg_atomic64_t*)&pDeque->top);
+
+	if (top > bottom)
+	{
+		// Empty, restore
+		tfrg_atomic64_store_relaxed((tfrg_atomic64_t*)&pDeque->bottom, (uint64_t)(bottom + 1));
+		return nullptr;
+	}
+
+	Job* pJob = (Job*)tfrg_atomicptr_load_relaxed(
+		(tfrg_atomicptr_t*)&pDeque->pSlots[bottom & (JOB_DEQUE_CAPACITY - 1)]);
+	if (top == bottom)
+	{
+		// Last job, race the thieves for it
+		if (tfrg_atomic64_cas_relaxed((tfrg_atomic64_t*)&pDeque->top, (uint64_t)top,
+									  (uint64_t)(top + 1)) != (uint64_t)top)
+			pJob = nullptr;
+		tfrg_atomic64_store_relaxed((tfrg_atomic64_t*)&pDeque->bottom, (uint64_t)(bottom + 1));
+	}
+	return pJob;
+}
+
+static Job* dequeSteal(JobDeque* pDeque)
+{
+	int64_t top = (int64_t)tfrg_atomic64_load_acquire((tfrg_atomic64_t*)&pDeque->top);
+	JOB_FENCE();
+	int64_t bottom = (int64_t)tfrg_atomic64_load_acquire((tfrg_atomic64_t*)&pDeque->bottom);
+	if (top >= bottom)
+		return nullptr;
+
+	Job* pJob = (Job*)tfrg_atomicptr_load_acquire(
+		(tfrg_atomicptr_t*)&pDeque->pSlots[top & (JOB_DEQUE_CAPACITY - 1)]);
+	if (tfrg_atomic64_cas_relaxed((tfrg_atomic64_t*)&pDeque->top, (uint64_t)top,
+								  (uint64_t)(top + 1)) != (uint64_t)top)
+		return nullptr;
+	return pJob;
+}
+
+///////////////////////////////////////////
+// Queues
+
+static Job* queuePop(uint32_t* pLock, Job** ppHead, Job** ppTail)
+{
+	// Cheap unlocked peek, most polls find both queues empty
+	if (!tfrg_atomicptr_load_relaxed((tfrg_atomicptr_t*)ppHead))
+		return nullptr;
+
+	jobSpinLock(pLock);
+	Job* pJob = *ppHead;
+	if (pJob)
+	{
+		tfrg_atomicptr_store_release((tfrg_atomicptr_t*)ppHead, (uintptr_t)pJob->pNext);
+		if (!pJob->pNext)
+			*ppTail = nullptr;
+	}
+	jobSpinUnlock(pLock);
+	return pJob;
+}
+
+static void queuePush(uint32_t* pLock, Job** ppHead, Job** ppTail, Job* pJob)
+{
+	pJob->pNext = nullptr;
+	jobSpinLock(pLock);
+	if (*ppTail)
+		(*ppTail)->pNext = pJob;
+	else
+		tfrg_atomicptr_store_release((tfrg_atomicptr_t*)ppHead, (uintptr_t)pJob);
+	*ppTail = pJob;
+	jobSpinUnlock(pLock);
+}
+
+static void wakeWorker(JobSystem* pSystem)
+{
+	tfrg_atomic32_add_relaxed((tfrg_atomic32_t*)&pSystem->pendingCount, 1);
+	JOB_FENCE();
+	if (tfrg_atomic32_load_relaxed((tfrg_atomic32_t*)&pSystem->sleepingCount) == 0)
+		return;
+
+	acquireMutex(&pSystem->sleepMutex);
+	wakeOneConditionVariable(&pSystem->sleepCondition);
+	releaseMutex(&pSystem->sleepMutex);
+}
+
+static void submitJob(JobSystem* pSystem, Job* pJob)
+{
+	if (pJob->flags & JobFlag_Blocking)
+	{
+		queuePush(&pSystem->queueLock, &pSystem->pBlockingHead, &pSystem->pBlockingTail, pJob);
+	}
+	else
+	{
+		uint32_t index = jobThreadIndex(pSystem);
+		if (index == UINT32_MAX || !dequePush(&pSystem->pDeques[index], pJob))
+			queuePush(&pSystem->queueLock, &pSystem->pQueueHead, &pSystem->pQueueTail, pJob);
+	}
+
+	wakeWorker(pSystem);
+}
+
+static Job* findJob(JobSystem* pSystem, uint32_t index, bool allowBlocking)
+{
+	Job* pJob = nullptr;
+
+	// Blocking jobs are usually someone else's sync point, start them first
+	if (allowBlocking)
+		pJob = queuePop(&pSystem->queueLock, &pSystem->pBlockingHead, &pSystem->pBlockingTail);
+
+	if (!pJob && index != UINT32_MAX)
+		pJob = dequePop(&pSystem->pDeques[index]);
+
+	if (!pJob)
+		pJob = queuePop(&pSystem->queueLock, &pSystem->pQueueHead, &pSystem->pQueueTail);
+
+	if (!pJob)
+	{
+		uint32_t dequeCount = pSystem->workerCount + 1;
+		uint32_t start = 0;
+		if (index != UINT32_MAX)
+		{
+			uint32_t& seed = pSystem->workers[index].stealSeed;
+			seed ^= seed << 13;
+			seed ^= seed >> 17;
+			seed ^= seed << 5;
+			start = seed % dequeCount;
+		}
+
+		for (uint32_t i = 0; i < dequeCount && !pJob; ++i)
+		{
+			uint32_t victim = (start + i) % dequeCount;
+			if (victim != index)
+				pJob = dequeSteal(&pSystem->pDeques[victim]);
+		}
+	}
+
+	if (pJob)
+		tfrg_atomic32_add_relaxed((tfrg_atomic32_t*)&pSystem->pendingCount, (uint32_t)-1);
+	return pJob;
+}
+
+///////////////////////////////////////////
+// Counters
+
+static void counterFinish(JobSystem* pSystem, JobCounter* pCounter)
+{
+	// The decrement happens under the lock, so a waiter that sees zero and
+	// then an unlocked counter knows this thread is done touching it
+	jobSpinLock(&pCounter->lock);
+	JOB_FENCE();
+	uint32_t previous = tfrg_atomic32_add_relaxed((tfrg_atomic32_t*)&pCounter->value, (uint32_t)-1);
+	Job* pWaiters = nullptr;
+	if (previous == 1)
+	{
+		pWaiters = (Job*)pCounter->pWaiters;
+		pCounter->pWaiters = nullptr;
+	}
+	jobSpinUnlock(&pCounter->lock);
+
+	while (pWaiters)
+	{
+		Job* pNext = pWaiters->pNext;
+		submitJob(pSystem, pWaiters);
+		pWaiters = pNext;
+	}
+}
+
+static void executeJob(JobSystem* pSystem, Job* pJob)
+{
+	pJob->pFunc(pJob->pData);
+
+	JobCounter* pCounter = pJob->pCounter;
+	poolFree(pSystem->pJobPool, pJob);
+
+	if (pCounter)
+		counterFinish(pSystem, pCounter);
+}
+
+bool jobIsDone(const JobCounter* pCounter)
+{
+	if (!pCounter)
+		return true;
+
+	if (tfrg_atomic32_load_acquire((tfrg_atomic32_t*)&pCounter->value) != 0)
+		return false;
+	JOB_FENCE();
+	return tfrg_atomic32_load_acquire((tfrg_atomic32_t*)&pCounter->lock) == 0;
+}
+
+///////////////////////////////////////////
+// Workers
+
+static void jobWorkerThread(void* pData)
+{
+	JobWorker* pWorker = (JobWorker*)pData;
+	JobSystem* pSystem = pWorker->pSystem;
+	tpJobSystem = pSystem;
+	tJobThreadIndex = pWorker->index;
+
+	// Rings outlive the job system, so the name must not point into it
+	traceSetThreadName("JobWorker");
+
+	uint32_t spins = 0;
+	for (;;)
+	{
+		Job* pJob = findJob(pSystem, pWorker->index, true);
+		if (pJob)
+		{
+			executeJob(pSystem, pJob);
+			spins = 0;
+			continue;
+		}
+
+		if (tfrg_atomic32_load_acquire((tfrg_atomic32_t*)&pSystem->quit))
+			break;
+
+		if (++spins < JOB_SPIN_COUNT)
+		{
+			JOB_CPU_PAUSE();
+			continue;
+		}
+
+		// Pairs with wakeWorker, either it sees this worker sleeping or this
+		// worker sees its pending job
+		acquireMutex(&pSystem->sleepMutex);
+		tfrg_atomic32_add_relaxed((tfrg_atomic32_t*)&pSystem->sleepingCount, 1);
+		JOB_FENCE();
+		if (tfrg_atomic32_load_relaxed((tfrg_atomic32_t*)&pSystem->pendingCount) == 0 &&
+			!tfrg_atomic32_load_relaxed((tfrg_atomic32_t*)&pSystem->quit))
+			waitConditionVariable(&pSystem->sleepCondition, &pSystem->sleepMutex, UINT32_MAX);
+		tfrg_atomic32_add_relaxed((tfrg_atomic32_t*)&pSystem->sleepingCount, (uint32_t)-1);
+		releaseMutex(&pSystem->sleepMutex);
+		spins = 0;
+	}
+
+	tpJobSystem = nullptr;
+	tJobThreadIndex = UINT32_MAX;
+}
+
+///////////////////////////////////////////
+// Job system
+
+JobSystem* jobSystemCreate(const JobSystemDesc* pDesc)
+{
+	uint32_t workerCount;
+	if (pDesc && pDesc->workerCount)
+	{
+		workerCount = pDesc->workerCount;
+	}
+	else
+	{
+		uint32_t coreCount = getNumCPUCores();
+		workerCount = coreCount > 1 ? coreCount - 1 : 0;
+	}
+	if (workerCount > JOB_SYSTEM_MAX_WORKERS)
+		workerCount = JOB_SYSTEM_MAX_WORKERS;
+
+	if (tpJobSystem)
+	{
+		LOGF(eERROR, "JobSystem: The calling thread already belongs to a job system");
+		return nullptr;
+	}
+
+	ArenaParams arenaParams = {};
+	arenaParams.pName = "Jobs";
+	Arena* pArena = arenaCreate(&arenaParams);
+	if (!pArena)
+		return nullptr;
+
+	JobSystem* pSystem = arenaPushStruct<JobSystem>(pArena);
+	JobDeque* pDeques = (JobDeque*)arenaPush(pArena, sizeof(JobDeque) * (workerCount + 1),
+											 alignof(JobDeque));
+
+	PoolParams poolParams = {};
+	poolParams.chunkSize = sizeof(Job);
+	poolParams.flags = PoolFlag_ThreadMagazines;
+	Pool* pJobPool = pSystem ? poolCreate(pArena, &poolParams) : nullptr;
+
+	if (!pSystem || !pDeques || !pJobPool)
+	{
+		LOGF(eERROR, "JobSystem: Failed to allocate the job system");
+		arenaRelease(pArena);
+		return nullptr;
+	}
+
+	memset(pDeques, 0, sizeof(JobDeque) * (workerCount + 1));
+	pSystem->pArena = pArena;
+	pSystem->pJobPool = pJobPool;
+	pSystem->pDeques = pDeques;
+	pSystem->workerCount = 0;
+	initMutex(&pSystem->sleepMutex);
+	initConditionVariable(&pSystem->sleepCondition);
+
+	for (uint32_t i = 0; i <= workerCount; ++i)
+	{
+		pSystem->workers[i].pSystem = pSystem;
+		pSystem->workers[i].index = i;
+		pSystem->workers[i].stealSeed = 0x9E3779B9u * (i + 1);
+	}
+
+	// Workers steal from every deque, so they must all exist up front
+	tfrg_atomic32_store_release((tfrg_atomic32_t*)&pSystem->workerCount, workerCount);
+
+	tpJobSystem = pSystem;
+	tJobThreadIndex = 0;
+
+	for (uint32_t i = 1; i <= workerCount; ++i)
+	{
+		ThreadDesc threadDesc = {};
+		threadDesc.pFunc = jobWorkerThread;
+		threadDesc.pData = &pSystem->workers[i];
+		snprintf(threadDesc.mThreadName, sizeof(threadDesc.mThreadName), "JobWorker%u", i);
+		if (!initThread(&threadDesc, &pSystem->workers[i].thread))
+		{
+			LOGF(eERROR, "JobSystem: Failed to start worker %u", i);
+			pSystem->workerCount = i - 1;
+			jobSystemDestroy(pSystem);
+			return nullptr;
+		}
+	}
+
+	LOGF(eINFO, "JobSystem: Started %u workers", workerCount);
+	return pSystem;
+}
+
+void jobSystemDestroy(JobSystem* pJobSystem)
+{
+	if (!pJobSystem)
+		return;
+
+	acquireMutex(&pJobSystem->sleepMutex);
+	tfrg_atomic32_store_release((tfrg_atomic32_t*)&pJobSystem->quit, 1);
+	wakeAllConditionVariable(&pJobSystem->sleepCondition);
+	releaseMutex(&pJobSystem->sleepMutex);
+
+	for (uint32_t i = 1; i <= pJobSystem->workerCount; ++i)
+		joinThread(pJobSystem->workers[i].thread);
+
+	exitConditionVariable(&pJobSystem->sleepCondition);
+	exitMutex(&pJobSystem->sleepMutex);
+
+	if (tpJobSystem == pJobSystem)
+	{
+		tpJobSystem = nullptr;
+		tJobThreadIndex = UINT32_MAX;
+	}
+
+	arenaRelease(pJobSystem->pArena);
+}
+
+uint32_t jobSystemGetWorkerCount(const JobSystem* pJobSystem)
+{
+	return pJobSystem ? pJobSystem->workerCount : 0;
+}
+
+uint32_t jobSystemGetThreadIndex(const JobSystem* pJobSystem)
+{
+	return jobThreadIndex(pJobSystem);
+}
+
+///////////////////////////////////////////
+// Jobs
+
+static Job* allocJob(JobSystem* pSystem, const JobDesc* pDesc, JobCounter* pCounter)
+{
+	Job* pJob = (Job*)poolAlloc(pSystem->pJobPool);
+	if (!pJob)
+		return nullptr;
+
+	pJob->pFunc = pDesc->pFunc;
+	pJob->pData = pDesc->pData;
+	pJob->pCounter = pCounter;
+	pJob->pNext = nullptr;
+	pJob->flags = pDesc->flags;
+	return pJob;
+}
+
+void jobRun(JobSystem* pJobSystem, const JobDesc* pJobs, uint32_t count, JobCounter* pCounter)
+{
+	jobRunAfter(pJobSystem, nullptr, pJobs, count, pCounter);
+}
+
+void jobRunAfter(JobSystem* pJobSystem, JobCounter* pDependency, const JobDesc* pJobs,
+				 uint32_t count, JobCounter* pCounter)
+{
+	if (!pJobSystem || !pJobs || count == 0)
+		return;
+
+	// Count the whole batch first, a waiter must not see zero halfway through
+	if (pCounter)
+		tfrg_atomic32_add_relaxed((tfrg_atomic32_t*)&pCounter->value, count);
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		Job* pJob = allocJob(pJobSystem, &pJobs[i], pCounter);
+		if (!pJob)
+		{
+			// Out of memory, run inline rather than leave the counter hanging
+			LOGF(eERROR, "JobSystem: Failed to allocate a job, running it inline");
+			if (pDependency)
+				jobWait(pJobSystem, pDependency);
+			pJobs[i].pFunc(pJobs[i].pData);
+			if (pCounter)
+				counterFinish(pJobSystem, pCounter);
+			continue;
+		}
+
+		if (pDependency)
+		{
+			jobSpinLock(&pDependency->lock);
+			bool ready = tfrg_atomic32_load_relaxed((tfrg_atomic32_t*)&pDependency->value) == 0;
+			if (!ready)
+			{
+				pJob->pNext = (Job*)pDependency->pWaiters;
+				pDependency->pWaiters = pJob;
+			}
+			jobSpinUnlock(&pDependency->lock);
+
+			if (!ready)
+				continue;
+		}
+
+		submitJob(pJobSystem, pJob);
+	}
+}
+
+void jobWait(JobSystem* pJobSystem, JobCounter* pCounter)
+{
+	if (!pJobSystem || !pCounter)
+		return;
+
+	uint32_t index = jobThreadIndex(pJobSystem);
+	uint32_t spins = 0;
+	while (!jobIsDone(pCounter))
+	{
+		Job* pJob = findJob(pJobSystem, index, false);
+		if (pJob)
+		{
+			executeJob(pJobSystem, pJob);
+			spins = 0;
+			continue;
+		}
+
+		// The last jobs are running elsewhere
+		if (++spins < JOB_SPIN_COUNT)
+			JOB_CPU_PAUSE();
+		else
+			threadSleep(0);
+	}
+}
@@ -5,7 +5,9 @@
 
 #include "Runtime/Memory/Arena.h"
 #include "Runtime/Memory/PlatformMemory.h"
+#include "Runtime/Trace.h"
 #include "Utilities/Interfaces/ILog.h"
+#include "Utilities/Threading/Atomics.h"
 #include <cassert>
 
 /**
@@ -31,11 +33,145 @@ static inline uint64_t alignPow2(uint64_t value, uint64_t align)
 // Core Arena Functions
 // ============================================================================
 
+// ============================================================================
+// Registry
+// ============================================================================
+
+// Every arena links its first block into this list. Blocks are only freed
+// while holding the lock, so reports can walk other threads' chains.
+static Arena* gpArenaRegistry = nullptr;
+static tfrg_atomic32_t gArenaRegistryLock = 0;
+
+static void arenaRegistryLock()
+{
+	while (tfrg_atomic32_cas_relaxed(&gArenaRegistryLock, 0, 1) != 0)
+	{
+	}
+	tfrg_atomic32_load_acquire(&gArenaRegistryLock);
+}
+
+static void arenaRegistryUnlock()
+{
+	tfrg_atomic32_store_release(&gArenaRegistryLock, 0);
+}
+
+static void arenaCountCall(uint32_t* pCounter)
+{
+	tfrg_atomic32_add_relaxed((tfrg_atomic32_t*)pCounter, 1);
+}
+
+/**
+	Bytes pushed into the chain, without headers.
+
+	@note Loads are relaxed, another thread may be pushing
+*/
+static uint64_t arenaUsedBytes(Arena* pArena)
+{
+	uint64_t used = 0;
+	Arena* pBlock = (Arena*)tfrg_atomicptr_load_acquire((tfrg_atomicptr_t*)&pArena->pCurrent);
+	while (pBlock)
+	{
+		// Atomic pushes can overshoot the block they give up on
+		uint64_t pos = tfrg_atomic64_load_relaxed((tfrg_atomic64_t*)&pBlock->pos);
+		if (pos > pBlock->reserved)
+			pos = pBlock->reserved;
+
+		used += pos - ARENA_HEADER_SIZE;
+		pBlock = pBlock->pPrev;
+	}
+	return used;
+}
+
+/**
+	Touches one byte per page so the OS backs the range right away.
+
+	@param pMemory Start of the committed range
+	@param size Bytes to touch
+	@param write Write zeros, only for memory the arena owns
+*/
+static void arenaPrefault(void* pMemory, uint64_t size, bool write)
+{
+	uint64_t pageSize = platformGetPageSize();
+	volatile uint8_t* pBytes = (volatile uint8_t*)pMemory;
+	for (uint64_t offset = 0; offset < size; offset += pageSize)
+	{
+		if (write)
+			pBytes[offset] = 0;
+		else
+			(void)pBytes[offset];
+	}
+}
+
+/**
+	Reserves a block and commits at least its first neededCommit bytes.
+
+	Large page and prefaulted blocks are committed in full. When large
+	pages cannot be allocated the flag is dropped, so blocks chained later
+	do not retry.
+
+	@param pReserveSize Requested reserve size, receives the actual one
+	@param pFlags Arena flags, ArenaFlag_LargePages is cleared on fallback
+	@param commitSize Commit granularity
+	@param neededCommit Bytes that must be usable right away
+	@param pOutCommitted Receives the committed byte count
+
+	@return The block memory, or nullptr on failure
+*/
+static void* arenaReserveBlock(uint64_t* pReserveSize, uint32_t* pFlags, uint64_t commitSize,
+							   uint64_t neededCommit, uint64_t* pOutCommitted)
+{
+	if (*pFlags & ArenaFlag_LargePages)
+	{
+		uint64_t largePageSize = platformGetLargePageSize();
+		if (largePageSize != 0)
+		{
+			uint64_t largeReserveSize = alignPow2(*pReserveSize, largePageSize);
+			void* pMemory = platformAllocateLargePages(largeReserveSize);
+			if (pMemory)
+			{
+				if (*pFlags & ArenaFlag_Prefault)
+					arenaPrefault(pMemory, largeReserveSize, true);
+
+				*pReserveSize = largeReserveSize;
+				*pOutCommitted = largeReserveSize;
+				return pMemory;
+			}
+		}
+
+		LOGF(eWARNING, "Arena: Large pages are not available, using normal pages");
+		*pFlags &= ~ArenaFlag_LargePages;
+	}
+
+	void* pMemory = platformReserveMemory(*pReserveSize);
+	if (!pMemory)
+		return nullptr;
+
+	uint64_t commit = commitSize;
+	if (neededCommit > commit)
+		commit = alignPow2(neededCommit, commitSize);
+	if ((*pFlags & ArenaFlag_Prefault) || commit > *pReserveSize)
+		commit = *pReserveSize;
+
+	if (!platformCommitMemory(pMemory, commit))
+	{
+		platformReleaseMemory(pMemory, *pReserveSize);
+		return nullptr;
+	}
+
+	if (*pFlags & ArenaFlag_Prefault)
+		arenaPrefault(pMemory, commit, true);
+
+	*pOutCommitted = commit;
+	return pMemory;
+}
+
 Arena* arenaCreate(const ArenaParams* pParams)
 {
 	uint64_t reserveSize = ARENA_DEFAULT_RESERVE;
 	uint64_t commitSize = ARENA_DEFAULT_COMMIT;
+	uint64_t decommitThreshold = ARENA_DEFAULT_DECOMMIT_THRESHOLD;
 	uint32_t flags = ArenaFlag_None;
+	void* pBackingBuffer = nullptr;
 
 	if (pParams)
 	{
@@ -45,29 +181,45 @@ Arena* arenaCreate(const ArenaParams* pParams)
 		if (pParams->commitSize != 0)
 			commitSize = pParams->commitSize;
 
-		flags = pParams->flags;
-	}
+		if (pParams->decommitThreshold != 0)
+			decommitThreshold = pParams->decommitThreshold;
 
-	// Get the address of our reserved memory.
-	void* reservedMemoryPtr = platformReserveMemory(reserveSize);
-	if (!reservedMemoryPtr)
-	{
-		LOGF(eERROR, "Arena creation failed: Unable to reserve memory");
-		return nullptr;
+		flags = pParams->flags & ~ArenaFlag_External;
+		pBackingBuffer = pParams->pBackingBuffer;
 	}
 
-	// Commit physical memory for the initial block minimum of header size.
-	// Recall the header is just the struct Arena variables (flags, pos, etc).
-	uint64_t initialCommitSize = commitSize;
+	void* reservedMemoryPtr = nullptr;
+	uint64_t initialCommitSize = 0;
 
-	if (initialCommitSize < ARENA_HEADER_SIZE)
-		initialCommitSize = ARENA_HEADER_SIZE;
+	if (pBackingBuffer)
+	{
+		// The caller owns the buffer, it is usable in full and never released
+		if (pParams->reserveSize < ARENA_HEADER_SIZE || ((uintptr_t)pBackingBuffer & 7) != 0)
+		{
+			LOGF(eERROR, "Arena creation failed: Backing buffer needs 8 byte alignment and "
+						 "reserveSize of at least the header size");
+			return nullptr;
+		}
+
+		if (flags & ArenaFlag_Prefault)
+			arenaPrefault(pBackingBuffer, reserveSize, false);
 
-	if (!platformCommitMemory(reservedMemoryPtr, initialCommitSize))
+		reservedMemoryPtr = pBackingBuffer;
+		initialCommitSize = reserveSize;
+		flags |= ArenaFlag_External;
+	}
+	else
 	{
-		LOGF(eERROR, "Arena creation failed: Unable to commit initial memory");
-		platformReleaseMemory(reservedMemoryPtr, reserveSize);
-		return nullptr;
+		// Get the address of our reserved memory, with physical memory
+		// committed for at least the header. Recall the header is just the
+		// struct Arena variables (flags, pos, etc).
+		reservedMemoryPtr = arenaReserveBlock(&reserveSize, &flags, commitSize,
+											  ARENA_HEADER_SIZE, &initialCommitSize);
+		if (!reservedMemoryPtr)
+		{
+			LOGF(eERROR, "Arena creation failed: Unable to reserve memory");
+			return nullptr;
+		}
 	}
 
 	// Initialize Arena struct IN the reserved memory.
@@ -75,32 +227,234 @@ Arena* arenaCreate(const ArenaParams* pParams)
 	pArena->pPrev = nullptr;
 	pArena->pCurrent = pArena;
 	pArena->flags = flags;
-	pArena->_pad = 0;
+	pArena->chainLock = 0;
 	pArena->commitSize = commitSize;
 	pArena->reserveSize = reserveSize;
 	pArena->basePos = 0;
 	pArena->pos = ARENA_HEADER_SIZE;
 	pArena->committed = initialCommitSize;
 	pArena->reserved = reserveSize;
+	pArena->decommitThreshold = decommitThreshold;
+	pArena->pName = pParams ? pParams->pName : nullptr;
+	pArena->pRegistryPrev = nullptr;
+	pArena->peakUsed = 0;
+	pArena->blockCount = 1;
+	pArena->commitCount = pBackingBuffer ? 0 : 1;
+	pArena->decommitCount = 0;
+
+	arenaRegistryLock();
+	pArena->pRegistryNext = gpArenaRegistry;
+	if (gpArenaRegistry)
+		gpArenaRegistry->pRegistryPrev = pArena;
+	gpArenaRegistry = pArena;
+	arenaRegistryUnlock();
 
 	// The arena again is in the start of the reserved memory block. It
 	// is okay to return now.
 	return pArena;
 }
 
+/**
+	Returns a block to the OS, unless it lives in a backing buffer.
+*/
+static void arenaReleaseBlock(Arena* pBlock)
+{
+	if (!(pBlock->flags & ArenaFlag_External))
+		platformReleaseMemory(pBlock, pBlock->reserved);
+}
+
 void arenaRelease(Arena* pArena)
 {
 	if (!pArena)
 		return;
 
+	arenaRegistryLock();
+
+	if (pArena->pRegistryPrev)
+		pArena->pRegistryPrev->pRegistryNext = pArena->pRegistryNext;
+	else
+		gpArenaRegistry = pArena->pRegistryNext;
+	if (pArena->pRegistryNext)
+		pArena->pRegistryNext->pRegistryPrev = pArena->pRegistryPrev;
+
 	Arena* current = pArena->pCurrent;
 
 	while (current)
 	{
 		Arena* prev = current->pPrev;
-		platformReleaseMemory(current, current->reserved);
+		arenaReleaseBlock(current);
 		current = prev;
 	}
+
+	arenaRegistryUnlock();
+}
+
+/**
+	Reserves and commits a new block to chain after pCurrent.
+
+	@param pArena First block, which keeps the chain statistics
+	@param pCurrent Block that is full
+	@param size Allocation that did not fit, the new block is at least this big
+
+	@return The initialized block, or nullptr on failure
+*/
+static Arena* arenaChainBlock(Arena* pArena, Arena* pCurrent, uint64_t size)
+{
+	ENGINE_PROFILE_SCOPE("arenaChainBlock");
+
+	uint64_t newReserveSize = pCurrent->reserveSize;
+	uint64_t newCommitSize = pCurrent->commitSize;
+	uint32_t newFlags = pCurrent->flags & ~ArenaFlag_External;
+
+	// If the allocation is huge, make the new block big enough to
+	// accommodate it.
+	if (size + ARENA_HEADER_SIZE > newReserveSize)
+	{
+		newReserveSize = alignPow2(size + ARENA_HEADER_SIZE, newCommitSize);
+	}
+
+	uint64_t initialCommit = 0;
+	void* pNewBlock = arenaReserveBlock(&newReserveSize, &newFlags, newCommitSize,
+										ARENA_HEADER_SIZE + size, &initialCommit);
+	if (!pNewBlock)
+	{
+		LOGF(eERROR, "Failed to reserve memory for new arena block");
+		return nullptr;
+	}
+
+	Arena* pNewArena = (Arena*)pNewBlock;
+	pNewArena->pPrev = pCurrent;
+	pNewArena->pCurrent = pNewArena;
+	pNewArena->flags = newFlags;
+	pNewArena->chainLock = 0;
+	pNewArena->commitSize = newCommitSize;
+	pNewArena->reserveSize = newReserveSize;
+	pNewArena->basePos = pCurrent->basePos + pCurrent->reserved;
+	pNewArena->pos = ARENA_HEADER_SIZE;
+	pNewArena->committed = initialCommit;
+	pNewArena->reserved = newReserveSize;
+	pNewArena->decommitThreshold = pCurrent->decommitThreshold;
+	pNewArena->pName = nullptr;
+	pNewArena->pRegistryNext = nullptr;
+	pNewArena->pRegistryPrev = nullptr;
+	pNewArena->peakUsed = 0;
+	pNewArena->blockCount = 0;
+	pNewArena->commitCount = 0;
+	pNewArena->decommitCount = 0;
+
+	arenaCountCall(&pArena->blockCount);
+	arenaCountCall(&pArena->commitCount);
+
+	return pNewArena;
+}
+
+// ============================================================================
+// Atomic Push
+// ============================================================================
+
+/**
+	Makes sure the block is committed up to posNew.
+
+	Racing threads may commit overlapping ranges, which is fine because
+	committing already committed pages keeps their contents. The committed
+	watermark only moves forward.
+*/
+static bool arenaCommitAtomic(Arena* pArena, Arena* pBlock, uint64_t posNew)
+{
+	tfrg_atomic64_t* pCommitted = (tfrg_atomic64_t*)&pBlock->committed;
+	uint64_t committed = tfrg_atomic64_load_relaxed(pCommitted);
+
+	while (posNew > committed)
+	{
+		uint64_t commitTarget = alignPow2(posNew, pBlock->commitSize);
+		if (commitTarget > pBlock->reserved)
+			commitTarget = pBlock->reserved;
+
+		void* pCommitStart = (uint8_t*)pBlock + committed;
+		if (!platformCommitMemory(pCommitStart, commitTarget - committed))
+		{
+			LOGF(eERROR, "Failed to commit additional memory");
+			return false;
+		}
+		arenaCountCall(&pArena->commitCount);
+
+		uint64_t previous = tfrg_atomic64_cas_relaxed(pCommitted, committed, commitTarget);
+		if (previous == committed)
+			break;
+
+		committed = previous;
+	}
+
+	return true;
+}
+
+/**
+	Chains a new block after pFull unless another thread already did.
+
+	Chaining is rare, so it takes a spin lock in the first block instead of
+	trying to publish blocks lock free.
+*/
+static bool arenaChainAtomic(Arena* pArena, Arena* pFull, uint64_t size)
+{
+	tfrg_atomic32_t* pLock = (tfrg_atomic32_t*)&pArena->chainLock;
+	while (tfrg_atomic32_cas_relaxed(pLock, 0, 1) != 0)
+	{
+	}
+
+	bool chained = true;
+	tfrg_atomicptr_t* pCurrentPtr = (tfrg_atomicptr_t*)&pArena->pCurrent;
+	if ((Arena*)tfrg_atomicptr_load_acquire(pCurrentPtr) == pFull)
+	{
+		Arena* pNewArena = arenaChainBlock(pArena, pFull, size);
+		if (pNewArena)
+			tfrg_atomicptr_store_release(pCurrentPtr, (uintptr_t)pNewArena);
+		else
+			chained = false;
+	}
+
+	tfrg_atomic32_store_release(pLock, 0);
+	return chained;
+}
+
+/**
+	Lock free bump allocation for ArenaFlag_Atomic arenas.
+
+	One fetch add claims size plus the worst case alignment padding, so no
+	thread ever retries on contention. A claim that runs past the block
+	chains a new one and tries again there.
+*/
+static void* arenaPushAtomic(Arena* pArena, uint64_t size, uint64_t align)
+{
+	assert((align > 0) && ((align & (align - 1)) == 0) && "Alignment must be a power of 2");
+
+	for (;;)
+	{
+		Arena* pCurrent =
+			(Arena*)tfrg_atomicptr_load_acquire((tfrg_atomicptr_t*)&pArena->pCurrent);
+
+		uint64_t claimStart = tfrg_atomic64_add_relaxed((tfrg_atomic64_t*)&pCurrent->pos,
+														size + align - 1);
+		uint64_t posAligned = alignPow2(claimStart, align);
+		uint64_t posNew = posAligned + size;
+
+		if (posNew <= pCurrent->reserved)
+		{
+			if (!arenaCommitAtomic(pArena, pCurrent, posNew))
+				return nullptr;
+
+			return (uint8_t*)pCurrent + posAligned;
+		}
+
+		// The overshoot is left behind, the full block is never bumped again
+		if (pCurrent->flags & ArenaFlag_NoChain)
+		{
+			LOGF(eERROR, "Arena exhausted (NoChain flag set)");
+			return nullptr;
+		}
+
+		if (!arenaChainAtomic(pArena, pCurrent, size + align))
+			return nullptr;
+	}
 }
 
 void* arenaPush(Arena* pArena, uint64_t size, uint64_t align)
@@ -110,6 +464,9 @@ void* arenaPush(Arena* pArena, uint64_t size, uint64_t align)
 	if (!pArena || size == 0)
 		return nullptr;
 
+	if (pArena->flags & ArenaFlag_Atomic)
+		return arenaPushAtomic(pArena, size, align);
+
 	Arena* pCurrent = pArena->pCurrent;
 
 	// We need to figure out that if we can fit the requested size in the
@@ -126,48 +483,9 @@ void* arenaPush(Arena* pArena, uint64_t size, uint64_t align)
 			return nullptr;
 		}
 
-		uint64_t newReserveSize = pCurrent->reserveSize;
-		uint64_t newCommitSize = pCurrent->commitSize;
-
-		// If the allocation is huge, make the new block big enough to
-		// accommodate it.
-		if (size + ARENA_HEADER_SIZE > newReserveSize)
-		{
-			newReserveSize = alignPow2(size + ARENA_HEADER_SIZE, newCommitSize);
-		}
-
-		void* pNewBlock = platformReserveMemory(newReserveSize);
-		if (!pNewBlock)
-		{
-			LOGF(eERROR, "Failed to reserve memory for new arena block");
+		Arena* pNewArena = arenaChainBlock(pArena, pCurrent, size);
+		if (!pNewArena)
 			return nullptr;
-		}
-
-		uint64_t initialCommit = newCommitSize;
-		uint64_t neededCommit = ARENA_HEADER_SIZE + size;
-		if (neededCommit > initialCommit)
-		{
-			initialCommit = alignPow2(neededCommit, newCommitSize);
-		}
-
-		if (!platformCommitMemory(pNewBlock, initialCommit))
-		{
-			LOGF(eERROR, "Failed to commit memory for new arena block");
-			platformReleaseMemory(pNewBlock, newReserveSize);
-			return nullptr;
-		}
-
-		Arena* pNewArena = (Arena*)pNewBlock;
-		pNewArena->pPrev = pCurrent;
-		pNewArena->pCurrent = pNewArena;
-		pNewArena->flags = pCurrent->flags;
-		pNewArena->_pad = 0;
-		pNewArena->commitSize = newCommitSize;
-		pNewArena->reserveSize = newReserveSize;
-		pNewArena->basePos = pCurrent->basePos + pCurrent->reserved;
-		pNewArena->pos = ARENA_HEADER_SIZE;
-		pNewArena->committed = initialCommit;
-		pNewArena->reserved = newReserveSize;
 
 		pArena->pCurrent = pNewArena;
 
@@ -193,6 +511,7 @@ void* arenaPush(Arena* pArena, uint64_t size, uint64_t align)
 			LOGF(eERROR, "Failed to commit additional memory");
 			return nullptr;
 		}
+		arenaCountCall(&pArena->commitCount);
 
 		pCurrent->committed = commitTarget;
 	}
@@ -215,6 +534,32 @@ uint64_t arenaGetPos(Arena* pArena)
 	return pCurrent->basePos + pCurrent->pos;
 }
 
+/**
+	Decommits the part of a block past both pos and its high water mark.
+
+	Blocks that stay below decommitThreshold keep their pages, so arenas
+	that are cleared and refilled every frame do not fault them back in.
+	Large page, prefaulted and external blocks are never decommitted.
+*/
+static void arenaDecommitTail(Arena* pArena, Arena* pBlock)
+{
+	if (pBlock->flags & (ArenaFlag_LargePages | ArenaFlag_Prefault | ArenaFlag_External))
+		return;
+
+	if (pBlock->decommitThreshold >= pBlock->committed)
+		return;
+
+	uint64_t keep = pBlock->pos > pBlock->decommitThreshold ? pBlock->pos
+															: pBlock->decommitThreshold;
+	keep = alignPow2(alignPow2(keep, pBlock->commitSize), platformGetPageSize());
+	if (keep >= pBlock->committed)
+		return;
+
+	platformDecommitMemory((uint8_t*)pBlock + keep, pBlock->committed - keep);
+	pBlock->committed = keep;
+	arenaCountCall(&pArena->decommitCount);
+}
+
 void arenaPopTo(Arena* pArena, uint64_t targetPos)
 {
 	if (!pArena)
@@ -223,14 +568,29 @@ void arenaPopTo(Arena* pArena, uint64_t targetPos)
 	if (targetPos < ARENA_HEADER_SIZE)
 		targetPos = ARENA_HEADER_SIZE;
 
+	// Usage only ever drops here, so this is where the peak is sampled
+	uint64_t used = arenaUsedBytes(pArena);
+	if (used > pArena->peakUsed)
+		pArena->peakUsed = used;
+
 	// Walk back through the arena blocks to find the one containing targetPos
 	Arena* current = pArena->pCurrent;
 
-	while (current && current->basePos >= targetPos)
+	if (current->basePos >= targetPos)
 	{
-		Arena* prev = current->pPrev;
-		platformReleaseMemory(current, current->reserved);
-		current = prev;
+		// Memory reports may be walking this chain
+		arenaRegistryLock();
+		while (current && current->basePos >= targetPos)
+		{
+			Arena* prev = current->pPrev;
+			arenaReleaseBlock(current);
+			pArena->blockCount--;
+			current = prev;
+		}
+
+		if (current)
+			pArena->pCurrent = current;
+		arenaRegistryUnlock();
 	}
 
 	// We should never be at a nullptr state
@@ -240,11 +600,11 @@ void arenaPopTo(Arena* pArena, uint64_t targetPos)
 		return;
 	}
 
-	pArena->pCurrent = current;
-
 	uint64_t localPos = targetPos - current->basePos;
 
 	current->pos = localPos;
+
+	arenaDecommitTail(pArena, current);
 }
 
 void arenaPop(Arena* pArena, uint64_t amount)
@@ -280,3 +640,136 @@ void arenaTempEnd(ArenaTemp temp)
 {
 	arenaPopTo(temp.pArena, temp.pos);
 }
+
+// ============================================================================
+// Thread Local Scratch
+// ============================================================================
+
+/**
+	Per thread scratch arenas, created on first use and released by the
+	thread_local destructor when the thread exits.
+*/
+struct ScratchArenas
+{
+	Arena* pArenas[ARENA_SCRATCH_COUNT];
+
+	~ScratchArenas()
+	{
+		for (uint32_t i = 0; i < ARENA_SCRATCH_COUNT; ++i)
+			arenaRelease(pArenas[i]);
+	}
+};
+
+static thread_local ScratchArenas tScratchArenas = {};
+
+ArenaTemp arenaScratchBegin(Arena* const* ppConflicts, uint32_t conflictCount)
+{
+	for (uint32_t i = 0; i < ARENA_SCRATCH_COUNT; ++i)
+	{
+		Arena*& pScratch = tScratchArenas.pArenas[i];
+		if (!pScratch)
+		{
+			ArenaParams params = {};
+			params.pName = "Scratch";
+			pScratch = arenaCreate(&params);
+			if (!pScratch)
+			{
+				LOGF(eERROR, "arenaScratchBegin: Failed to create scratch arena");
+				return ArenaTemp{};
+			}
+		}
+
+		bool conflicting = false;
+		for (uint32_t c = 0; c < conflictCount && ppConflicts; ++c)
+			conflicting = conflicting || ppConflicts[c] == pScratch;
+
+		if (!conflicting)
+			return arenaTempBegin(pScratch);
+	}
+
+	LOGF(eERROR, "arenaScratchBegin: Every scratch arena conflicts");
+	return ArenaTemp{};
+}
+
+void arenaScratchEnd(ArenaTemp scratch)
+{
+	if (scratch.pArena)
+		arenaTempEnd(scratch);
+}
+
+// ============================================================================
+// Statistics
+// ============================================================================
+
+/**
+	Adds one arena to pStats.
+
+	@note Caller holds the registry lock when pArena belongs to another thread
+*/
+static void arenaAccumulateStats(Arena* pArena, ArenaStats* pStats)
+{
+	uint64_t used = arenaUsedBytes(pArena);
+	uint64_t peak = tfrg_atomic64_load_relaxed((tfrg_atomic64_t*)&pArena->peakUsed);
+
+	pStats->arenaCount++;
+	pStats->usedBytes += used;
+	pStats->peakBytes += used > peak ? used : peak;
+	pStats->blockCount += tfrg_atomic32_load_relaxed((tfrg_atomic32_t*)&pArena->blockCount);
+	pStats->commitCount += tfrg_atomic32_load_relaxed((tfrg_atomic32_t*)&pArena->commitCount);
+	pStats->decommitCount += tfrg_atomic32_load_relaxed((tfrg_atomic32_t*)&pArena->decommitCount);
+
+	Arena* pBlock = (Arena*)tfrg_atomicptr_load_acquire((tfrg_atomicptr_t*)&pArena->pCurrent);
+	while (pBlock)
+	{
+		pStats->committedBytes += tfrg_atomic64_load_relaxed((tfrg_atomic64_t*)&pBlock->committed);
+		pStats->reservedBytes += pBlock->reserved;
+		pBlock = pBlock->pPrev;
+	}
+}
+
+void arenaGetStats(Arena* pArena, ArenaStats* pOutStats)
+{
+	if (!pOutStats)
+		return;
+
+	memset(pOutStats, 0, sizeof(ArenaStats));
+	if (!pArena)
+		return;
+
+	pOutStats->pName = pArena->pName ? pArena->pName : "Untagged";
+
+	arenaRegistryLock();
+	arenaAccumulateStats(pArena, pOutStats);
+	arenaRegistryUnlock();
+}
+
+uint32_t arenaGetTagStats(ArenaStats* pOutStats, uint32_t maxCount)
+{
+	uint32_t tagCount = 0;
+
+	arenaRegistryLock();
+	for (Arena* pArena = gpArenaRegistry; pArena; pArena = pArena->pRegistryNext)
+	{
+		const char* pName = pArena->pName ? pArena->pName : "Untagged";
+
+		uint32_t tag = 0;
+		while (tag < tagCount && strcmp(pOutStats[tag].pName, pName) != 0)
+			tag++;
+
+		if (tag == tagCount)
+		{
+			// Tags past maxCount are dropped
+			if (tagCount == maxCount)
+				continue;
+
+			memset(&pOutStats[tag], 0, sizeof(ArenaStats));
+			pOutStats[tag].pName = pName;
+			tagCount++;
+		}
+
+		arenaAccumulateStats(pArena, &pOutStats[tag]);
+	}
+	arenaRegistryUnlock();
+
+	return tagCount;
+}
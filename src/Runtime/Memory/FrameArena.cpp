@@ -0,0 +1,91 @@
+/*
+ * FrameArena.cpp
+ *
+ */
+
+#include "Runtime/Memory/FrameArena.h"
+#include "Runtime/Memory/Arena.h"
+#include "Graphics/Interfaces/IGraphics.h"
+#include "Utilities/Interfaces/ILog.h"
+
+#include "Utilities/Interfaces/IMemory.h"
+
+FrameArena* frameArenaCreate(uint32_t frameCount, const ArenaParams* pParams)
+{
+	if (frameCount == 0 || frameCount > FRAME_ARENA_MAX_FRAMES)
+	{
+		LOGF(eERROR, "frameArenaCreate: Frame count %u must be 1..%u", frameCount,
+			 FRAME_ARENA_MAX_FRAMES);
+		return nullptr;
+	}
+
+	FrameArena* pFrameArena = (FrameArena*)tf_calloc(1, sizeof(FrameArena));
+	if (!pFrameArena)
+		return nullptr;
+
+	ArenaParams params = {};
+	if (pParams)
+		params = *pParams;
+	params.flags |= ArenaFlag_Atomic;
+
+	// Cleared every frame, decommitting would fault the same pages back in
+	if (params.decommitThreshold == 0)
+		params.decommitThreshold = ARENA_NEVER_DECOMMIT;
+	if (!params.pName)
+		params.pName = "Frame";
+
+	pFrameArena->frameCount = frameCount;
+	for (uint32_t i = 0; i < frameCount; ++i)
+	{
+		pFrameArena->pArenas[i] = arenaCreate(&params);
+		if (!pFrameArena->pArenas[i])
+		{
+			LOGF(eERROR, "frameArenaCreate: Failed to create arena for frame %u", i);
+			frameArenaRelease(pFrameArena);
+			return nullptr;
+		}
+	}
+
+	return pFrameArena;
+}
+
+void frameArenaRelease(FrameArena* pFrameArena)
+{
+	if (!pFrameArena)
+		return;
+
+	for (uint32_t i = 0; i < pFrameArena->frameCount; ++i)
+		arenaRelease(pFrameArena->pArenas[i]);
+
+	tf_free(pFrameArena);
+}
+
+Arena* frameArenaBegin(FrameArena* pFrameArena, Renderer* pRenderer, uint32_t frameIndex)
+{
+	if (!pFrameArena || frameIndex >= pFrameArena->frameCount)
+		return nullptr;
+
+	// The GPU may still be reading data the last frame in this slot handed it
+	Fence* pFence = pFrameArena->pFences[frameIndex];
+	if (pFence && pRenderer)
+	{
+		FenceStatus fenceStatus;
+		getFenceStatus(pRenderer, pFence, &fenceStatus);
+		if (fenceStatus == FENCE_STATUS_INCOMPLETE)
+			waitForFences(pRenderer, 1, &pFence);
+	}
+	pFrameArena->pFences[frameIndex] = nullptr;
+
+	Arena* pArena = pFrameArena->pArenas[frameIndex];
+	arenaClear(pArena);
+	pFrameArena->currentIndex = frameIndex;
+	return pArena;
+}
+
+void frameArenaSetFence(FrameArena* pFrameArena, uint32_t frameIndex, Fence* pFence)
+{
+	if (!pFrameArena || frameIndex >= pFrameArena->frameCount)
+		return;
+
+	pFrameArena->pFences[frameIndex] = pFence;
+}
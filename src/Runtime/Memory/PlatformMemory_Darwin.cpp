@@ -6,35 +6,63 @@
 #if defined(__APPLE__)
 
 #include "Runtime/Memory/PlatformMemory.h"
+#include <mach/vm_statistics.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 void* platformReserveMemory(uint64_t size)
 {
-	//TODO Need to implement
-	return nullptr;
+	void* ptr = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANON, -1, 0);
+	return ptr == MAP_FAILED ? nullptr : ptr;
 }
 
 bool platformCommitMemory(void* pMemory, uint64_t size)
 {
-	//TODO Need to implement
+	uint64_t pageSize = platformGetPageSize();
+	uint64_t alignedSize = (size + pageSize - 1) & ~(pageSize - 1);
 
-	return false;
+	return mprotect(pMemory, alignedSize, PROT_READ | PROT_WRITE) == 0;
 }
 
 void platformDecommitMemory(void* pMemory, uint64_t size)
 {
-	//TODO Need to implement
+	// MADV_DONTNEED is only a hint on Darwin, mapping fresh PROT_NONE pages
+	// over the range is what actually returns them
+	mmap(pMemory, size, PROT_NONE, MAP_PRIVATE | MAP_ANON | MAP_FIXED, -1, 0);
 }
 
 void platformReleaseMemory(void* pMemory, uint64_t size)
 {
-	//TODO Need to implement
+	munmap(pMemory, size);
 }
 
 uint64_t platformGetPageSize()
 {
-	//TODO Need to implement
+	// 16KB on Apple silicon
+	static const uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+	return pageSize;
+}
 
-	return 4096;
+uint64_t platformGetLargePageSize()
+{
+#if defined(__x86_64__)
+	return 2 * 1024 * 1024;
+#else
+	// Superpages are only supported on Intel Macs
+	return 0;
+#endif
+}
+
+void* platformAllocateLargePages(uint64_t size)
+{
+#if defined(__x86_64__)
+	// The superpage request goes in the file descriptor argument
+	void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON,
+					 VM_FLAGS_SUPERPAGE_SIZE_2MB, 0);
+	return ptr == MAP_FAILED ? nullptr : ptr;
+#else
+	return nullptr;
+#endif
 }
 
 #endif // __APPLE__
@@ -0,0 +1,92 @@
+/*
+ * PlatformMemory_Linux.cpp
+ *
+ * Linux implementation of virtual memory operations using mmap/mprotect/madvise.
+ */
+
+#if defined(__linux__)
+
+#include "Runtime/Memory/PlatformMemory.h"
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define LINUX_HUGE_PAGE_SIZE (2ull * 1024 * 1024)
+
+void* platformReserveMemory(uint64_t size)
+{
+	// Reserve address space only, MAP_NORESERVE keeps big reservations from
+	// counting against overcommit before they are committed
+	void* ptr = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	return ptr == MAP_FAILED ? nullptr : ptr;
+}
+
+bool platformCommitMemory(void* pMemory, uint64_t size)
+{
+	uint64_t pageSize = platformGetPageSize();
+	uint64_t alignedSize = (size + pageSize - 1) & ~(pageSize - 1);
+
+	// Pages are backed on first touch and read back as zero
+	return mprotect(pMemory, alignedSize, PROT_READ | PROT_WRITE) == 0;
+}
+
+void platformDecommitMemory(void* pMemory, uint64_t size)
+{
+	// Drops the physical pages, the range reads as zero if committed again
+	madvise(pMemory, size, MADV_DONTNEED);
+	mprotect(pMemory, size, PROT_NONE);
+}
+
+void platformReleaseMemory(void* pMemory, uint64_t size)
+{
+	munmap(pMemory, size);
+}
+
+uint64_t platformGetPageSize()
+{
+	static const uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+	return pageSize;
+}
+
+uint64_t platformGetLargePageSize()
+{
+	return LINUX_HUGE_PAGE_SIZE;
+}
+
+void* platformAllocateLargePages(uint64_t size)
+{
+	// Explicit huge pages only work if the admin reserved them in
+	// /proc/sys/vm/nr_hugepages
+	void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+					 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if (ptr != MAP_FAILED)
+		return ptr;
+
+	// Otherwise ask for transparent huge pages on a 2MB aligned mapping,
+	// trimming the over reservation on both sides
+	uint64_t paddedSize = size + LINUX_HUGE_PAGE_SIZE;
+	uint8_t* pPadded = (uint8_t*)mmap(nullptr, paddedSize, PROT_READ | PROT_WRITE,
+									  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if ((void*)pPadded == MAP_FAILED)
+		return nullptr;
+
+	uintptr_t aligned =
+		((uintptr_t)pPadded + LINUX_HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(LINUX_HUGE_PAGE_SIZE - 1);
+	uint8_t* pAligned = (uint8_t*)aligned;
+	uint64_t head = (uint64_t)(pAligned - pPadded);
+	uint64_t tail = paddedSize - head - size;
+	if (head)
+		munmap(pPadded, head);
+	if (tail)
+		munmap(pAligned + size, tail);
+
+	if (madvise(pAligned, size, MADV_HUGEPAGE) != 0)
+	{
+		// Kernel without THP, plain pages would only pretend to be large
+		munmap(pAligned, size);
+		return nullptr;
+	}
+
+	return pAligned;
+}
+
+#endif // __linux__
@@ -44,4 +44,36 @@ uint64_t platformGetPageSize()
 	return (uint64_t)sysInfo.dwPageSize;
 }
 
+static uint64_t queryLargePageSize()
+{
+	// Large pages need SeLockMemoryPrivilege granted to the user, and
+	// enabled on the process token before the first allocation
+	HANDLE token;
+	if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+		return 0;
+
+	TOKEN_PRIVILEGES privileges = {};
+	privileges.PrivilegeCount = 1;
+	privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+	bool enabled = LookupPrivilegeValueA(nullptr, "SeLockMemoryPrivilege",
+										 &privileges.Privileges[0].Luid) &&
+				   AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr) &&
+				   GetLastError() == ERROR_SUCCESS;
+	CloseHandle(token);
+
+	return enabled ? (uint64_t)GetLargePageMinimum() : 0;
+}
+
+uint64_t platformGetLargePageSize()
+{
+	static const uint64_t largePageSize = queryLargePageSize();
+	return largePageSize;
+}
+
+void* platformAllocateLargePages(uint64_t size)
+{
+	return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+}
+
 #endif
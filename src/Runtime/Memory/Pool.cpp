@@ -0,0 +1,350 @@
+/*
+ * Pool.cpp
+ *
+ */
+
+#include "Runtime/Memory/Pool.h"
+#include "Runtime/Memory/Arena.h"
+#include "Utilities/Interfaces/ILog.h"
+#include "Utilities/Threading/Atomics.h"
+#include <cassert>
+
+// Slots are handed out once per thread and never reused, threads past
+// POOL_MAX_THREADS fall back to the shared list
+static tfrg_atomic32_t gPoolThreadCount = 0;
+static thread_local uint32_t tPoolThreadSlot = UINT32_MAX;
+
+static uint32_t poolThreadSlot()
+{
+	if (tPoolThreadSlot == UINT32_MAX)
+		tPoolThreadSlot = (uint32_t)tfrg_atomic32_add_relaxed(&gPoolThreadCount, 1);
+	return tPoolThreadSlot;
+}
+
+static void poolLock(Pool* pPool)
+{
+	tfrg_atomic32_t* pLock = (tfrg_atomic32_t*)&pPool->lock;
+	while (tfrg_atomic32_cas_relaxed(pLock, 0, 1) != 0)
+	{
+	}
+	tfrg_atomic32_load_acquire(pLock);
+}
+
+static void poolUnlock(Pool* pPool)
+{
+	tfrg_atomic32_store_release((tfrg_atomic32_t*)&pPool->lock, 0);
+}
+
+static void poolCountAlloc(Pool* pPool)
+{
+	if (!(pPool->flags & PoolFlag_ThreadMagazines))
+	{
+		if (++pPool->liveCount > pPool->peakCount)
+			pPool->peakCount = pPool->liveCount;
+		return;
+	}
+
+	uint64_t live = tfrg_atomic64_add_relaxed((tfrg_atomic64_t*)&pPool->liveCount, 1) + 1;
+	tfrg_atomic64_t* pPeak = (tfrg_atomic64_t*)&pPool->peakCount;
+	uint64_t peak = tfrg_atomic64_load_relaxed(pPeak);
+	while (live > peak)
+	{
+		uint64_t previous = tfrg_atomic64_cas_relaxed(pPeak, peak, live);
+		if (previous == peak)
+			break;
+		peak = previous;
+	}
+}
+
+static void poolCountFree(Pool* pPool)
+{
+	if (pPool->flags & PoolFlag_ThreadMagazines)
+		tfrg_atomic64_add_relaxed((tfrg_atomic64_t*)&pPool->liveCount, (uint64_t)-1);
+	else
+		--pPool->liveCount;
+}
+
+/**
+	Takes one chunk from the shared list, or carves a new one.
+
+	@note Caller holds the lock when the pool uses magazines
+*/
+static void* poolAllocShared(Pool* pPool)
+{
+	void* pChunk = pPool->pFreeList;
+	if (pChunk)
+	{
+		pPool->pFreeList = *(void**)pChunk;
+		return pChunk;
+	}
+
+	if (pPool->pBlockCursor == pPool->pBlockEnd)
+	{
+		uint64_t blockSize = (uint64_t)pPool->chunkSize * pPool->chunksPerBlock;
+		uint8_t* pBlock = (uint8_t*)arenaPush(pPool->pArena, blockSize, pPool->chunkAlign);
+		if (!pBlock)
+		{
+			LOGF(eERROR, "Pool: Failed to push a %llu byte block", (unsigned long long)blockSize);
+			return nullptr;
+		}
+
+		pPool->pBlockCursor = pBlock;
+		pPool->pBlockEnd = pBlock + blockSize;
+		pPool->blockCount++;
+		pPool->totalChunks += pPool->chunksPerBlock;
+	}
+
+	pChunk = pPool->pBlockCursor;
+	pPool->pBlockCursor += pPool->chunkSize;
+	return pChunk;
+}
+
+static void poolFreeShared(Pool* pPool, void* pChunk)
+{
+	*(void**)pChunk = pPool->pFreeList;
+	pPool->pFreeList = pChunk;
+}
+
+// ============================================================================
+// Pool
+// ============================================================================
+
+Pool* poolCreate(Arena* pArena, const PoolParams* pParams)
+{
+	if (!pArena || !pParams || pParams->chunkSize == 0)
+		return nullptr;
+
+	uint32_t chunkAlign = pParams->chunkAlign ? pParams->chunkAlign : 8;
+	if ((chunkAlign & (chunkAlign - 1)) != 0)
+	{
+		LOGF(eERROR, "Pool: Alignment %u is not a power of 2", chunkAlign);
+		return nullptr;
+	}
+
+	// Every chunk has to hold the free list link and keep the next one aligned
+	uint64_t chunkSize = pParams->chunkSize < sizeof(void*) ? sizeof(void*) : pParams->chunkSize;
+	chunkSize = (chunkSize + chunkAlign - 1) & ~(uint64_t)(chunkAlign - 1);
+	if (chunkSize > UINT32_MAX)
+		return nullptr;
+
+	uint32_t chunksPerBlock = pParams->chunksPerBlock;
+	if (chunksPerBlock == 0)
+	{
+		uint64_t defaultCount = POOL_DEFAULT_BLOCK_SIZE / chunkSize;
+		chunksPerBlock = defaultCount > 0 ? (uint32_t)defaultCount : 1;
+	}
+
+	Pool* pPool = arenaPushStruct<Pool>(pArena);
+	if (!pPool)
+		return nullptr;
+
+	pPool->pArena = pArena;
+	pPool->chunkSize = (uint32_t)chunkSize;
+	pPool->chunkAlign = chunkAlign;
+	pPool->chunksPerBlock = chunksPerBlock;
+	pPool->flags = pParams->flags;
+
+	if (pParams->flags & PoolFlag_ThreadMagazines)
+	{
+		pPool->pMagazines = (PoolMagazine*)arenaPush(
+			pArena, sizeof(PoolMagazine) * POOL_MAX_THREADS, alignof(PoolMagazine));
+		if (!pPool->pMagazines)
+		{
+			LOGF(eERROR, "Pool: Failed to allocate thread magazines");
+			return nullptr;
+		}
+		memset(pPool->pMagazines, 0, sizeof(PoolMagazine) * POOL_MAX_THREADS);
+	}
+
+	return pPool;
+}
+
+void* poolAlloc(Pool* pPool)
+{
+	if (!pPool)
+		return nullptr;
+
+	if (!pPool->pMagazines)
+	{
+		void* pChunk = poolAllocShared(pPool);
+		if (pChunk)
+			poolCountAlloc(pPool);
+		return pChunk;
+	}
+
+	uint32_t slot = poolThreadSlot();
+	if (slot >= POOL_MAX_THREADS)
+	{
+		poolLock(pPool);
+		void* pChunk = poolAllocShared(pPool);
+		poolUnlock(pPool);
+		if (pChunk)
+			poolCountAlloc(pPool);
+		return pChunk;
+	}
+
+	PoolMagazine* pMagazine = &pPool->pMagazines[slot];
+	if (pMagazine->count == 0)
+	{
+		// Refill half, so a thread bouncing around the boundary does not
+		// take the lock on every call
+		poolLock(pPool);
+		while (pMagazine->count < POOL_MAGAZINE_SIZE / 2)
+		{
+			void* pChunk = poolAllocShared(pPool);
+			if (!pChunk)
+				break;
+			pMagazine->pChunks[pMagazine->count++] = pChunk;
+		}
+		poolUnlock(pPool);
+
+		if (pMagazine->count == 0)
+			return nullptr;
+	}
+
+	poolCountAlloc(pPool);
+	return pMagazine->pChunks[--pMagazine->count];
+}
+
+void poolFree(Pool* pPool, void* pChunk)
+{
+	if (!pPool || !pChunk)
+		return;
+
+	poolCountFree(pPool);
+
+	if (!pPool->pMagazines)
+	{
+		poolFreeShared(pPool, pChunk);
+		return;
+	}
+
+	uint32_t slot = poolThreadSlot();
+	if (slot >= POOL_MAX_THREADS)
+	{
+		poolLock(pPool);
+		poolFreeShared(pPool, pChunk);
+		poolUnlock(pPool);
+		return;
+	}
+
+	PoolMagazine* pMagazine = &pPool->pMagazines[slot];
+	if (pMagazine->count == POOL_MAGAZINE_SIZE)
+	{
+		poolLock(pPool);
+		while (pMagazine->count > POOL_MAGAZINE_SIZE / 2)
+			poolFreeShared(pPool, pMagazine->pChunks[--pMagazine->count]);
+		poolUnlock(pPool);
+	}
+
+	pMagazine->pChunks[pMagazine->count++] = pChunk;
+}
+
+void poolGetStats(const Pool* pPool, PoolStats* pOutStats)
+{
+	if (!pOutStats)
+		return;
+
+	memset(pOutStats, 0, sizeof(PoolStats));
+	if (!pPool)
+		return;
+
+	tfrg_atomic64_t* pLive = (tfrg_atomic64_t*)&pPool->liveCount;
+	tfrg_atomic64_t* pPeak = (tfrg_atomic64_t*)&pPool->peakCount;
+	tfrg_atomic64_t* pTotal = (tfrg_atomic64_t*)&pPool->totalChunks;
+	uint64_t live = tfrg_atomic64_load_relaxed(pLive);
+	uint64_t total = tfrg_atomic64_load_relaxed(pTotal);
+
+	pOutStats->liveCount = live;
+	pOutStats->peakCount = tfrg_atomic64_load_relaxed(pPeak);
+	pOutStats->freeCount = total > live ? total - live : 0;
+	pOutStats->reservedBytes = total * pPool->chunkSize;
+	pOutStats->blockCount = pPool->blockCount;
+	pOutStats->chunkSize = pPool->chunkSize;
+}
+
+// ============================================================================
+// PoolSet
+// ============================================================================
+
+static uint32_t poolSetSizeClass(uint64_t size)
+{
+	uint32_t sizeClass = 0;
+	while (sizeClass < POOL_SIZE_CLASS_COUNT &&
+		   ((uint64_t)1 << (sizeClass + POOL_SIZE_CLASS_MIN_SHIFT)) < size)
+	{
+		sizeClass++;
+	}
+	return sizeClass;
+}
+
+PoolSet* poolSetCreate(Arena* pArena, uint32_t flags)
+{
+	if (!pArena)
+		return nullptr;
+
+	PoolSet* pSet = arenaPushStruct<PoolSet>(pArena);
+	if (!pSet)
+		return nullptr;
+
+	pSet->pArena = pArena;
+	pSet->flags = flags;
+	return pSet;
+}
+
+Pool* poolSetGetPool(PoolSet* pSet, uint64_t size)
+{
+	if (!pSet)
+		return nullptr;
+
+	uint32_t sizeClass = poolSetSizeClass(size);
+	if (sizeClass >= POOL_SIZE_CLASS_COUNT)
+	{
+		LOGF(eERROR, "PoolSet: %llu bytes is above the largest size class",
+			 (unsigned long long)size);
+		return nullptr;
+	}
+
+	tfrg_atomicptr_t* pPoolPtr = (tfrg_atomicptr_t*)&pSet->pPools[sizeClass];
+	Pool* pPool = (Pool*)tfrg_atomicptr_load_acquire(pPoolPtr);
+	if (pPool)
+		return pPool;
+
+	tfrg_atomic32_t* pLock = (tfrg_atomic32_t*)&pSet->lock;
+	while (tfrg_atomic32_cas_relaxed(pLock, 0, 1) != 0)
+	{
+	}
+
+	pPool = (Pool*)tfrg_atomicptr_load_acquire(pPoolPtr);
+	if (!pPool)
+	{
+		PoolParams params = {};
+		params.chunkSize = 1u << (sizeClass + POOL_SIZE_CLASS_MIN_SHIFT);
+		params.chunkAlign = 64;
+		params.flags = pSet->flags;
+		pPool = poolCreate(pSet->pArena, &params);
+		if (pPool)
+			tfrg_atomicptr_store_release(pPoolPtr, (uintptr_t)pPool);
+	}
+
+	tfrg_atomic32_store_release(pLock, 0);
+	return pPool;
+}
+
+void* poolSetAlloc(PoolSet* pSet, uint64_t size)
+{
+	return poolAlloc(poolSetGetPool(pSet, size));
+}
+
+void poolSetFree(PoolSet* pSet, void* pBlock, uint64_t size)
+{
+	if (!pSet || !pBlock)
+		return;
+
+	uint32_t sizeClass = poolSetSizeClass(size);
+	assert(sizeClass < POOL_SIZE_CLASS_COUNT && pSet->pPools[sizeClass] &&
+		   "PoolSet: Block was not allocated from this set");
+	if (sizeClass < POOL_SIZE_CLASS_COUNT)
+		poolFree((Pool*)tfrg_atomicptr_load_acquire((tfrg_atomicptr_t*)&pSet->pPools[sizeClass]),
+				 pBlock);
+}
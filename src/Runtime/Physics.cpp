@@ -0,0 +1,726 @@
+/*
+ * Physics.cpp
+ */
+
+#include "Runtime/Physics.h"
+#include "Runtime/JobSystem.h"
+#include "Runtime/Memory/Arena.h"
+#include "Runtime/Memory/Pool.h"
+#include "Utilities/Interfaces/ILog.h"
+
+#include <Jolt/Jolt.h>
+#include <Jolt/RegisterTypes.h>
+#include <Jolt/Core/Factory.h>
+#include <Jolt/Core/TempAllocator.h>
+#include <Jolt/Core/JobSystemWithBarrier.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Physics/Collision/Shape/BoxShape.h>
+#include <Jolt/Physics/Collision/Shape/SphereShape.h>
+#include <Jolt/Physics/Collision/Shape/CapsuleShape.h>
+#include <Jolt/Physics/Body/BodyCreationSettings.h>
+
+#include "Utilities/Interfaces/IMemory.h"
+
+ECS_COMPONENT_DECLARE(RigidBodyComponent);
+
+static_assert(PHYSICS_INVALID_BODY_ID == JPH::BodyID::cInvalidBodyID,
+			  "RigidBodyComponent stores raw JPH::BodyID values");
+
+///////////////////////////////////////////
+// Layers
+
+namespace
+{
+	class ObjectLayerPairFilterImpl final : public JPH::ObjectLayerPairFilter
+	{
+	public:
+		bool ShouldCollide(JPH::ObjectLayer inObject1, JPH::ObjectLayer inObject2) const override
+		{
+			return inObject1 == PhysicsLayer_Moving || inObject2 == PhysicsLayer_Moving;
+		}
+	};
+
+	class BPLayerInterfaceImpl final : public JPH::BroadPhaseLayerInterface
+	{
+	public:
+		JPH::uint GetNumBroadPhaseLayers() const override { return PhysicsLayer_Count; }
+
+		JPH::BroadPhaseLayer GetBroadPhaseLayer(JPH::ObjectLayer inLayer) const override
+		{
+			return JPH::BroadPhaseLayer((JPH::BroadPhaseLayer::Type)inLayer);
+		}
+
+#if defined(JPH_EXTERNAL_PROFILE) || defined(JPH_PROFILE_ENABLED)
+		const char* GetBroadPhaseLayerName(JPH::BroadPhaseLayer inLayer) const override
+		{
+			switch ((JPH::BroadPhaseLayer::Type)inLayer)
+			{
+			case PhysicsLayer_Static:
+				return "STATIC";
+			case PhysicsLayer_Moving:
+				return "MOVING";
+			default:
+				return "INVALID";
+			}
+		}
+#endif
+	};
+
+	class ObjectVsBroadPhaseLayerFilterImpl final : public JPH::ObjectVsBroadPhaseLayerFilter
+	{
+	public:
+		bool ShouldCollide(JPH::ObjectLayer inLayer1, JPH::BroadPhaseLayer inLayer2) const override
+		{
+			return inLayer1 == PhysicsLayer_Moving ||
+				   inLayer2 == JPH::BroadPhaseLayer(PhysicsLayer_Moving);
+		}
+	};
+} // namespace
+
+///////////////////////////////////////////
+// Jobs
+
+namespace
+{
+	/**
+		Runs Jolt's simulation jobs on the engine job system.
+
+		Jolt jobs live in a pool and are handed to jobRun as they become
+		ready, so physics shares its workers with the ECS and the render pass
+		instead of running a thread pool of its own. The thread calling
+		PhysicsSystem::Update waits in the Jolt barrier and runs jobs from it,
+		so the update never depends on a worker being free.
+	*/
+	class JoltJobSystem final : public JPH::JobSystemWithBarrier
+	{
+	public:
+		bool Init(JobSystem* pJobSystem)
+		{
+			JPH::JobSystemWithBarrier::Init(JPH::cMaxPhysicsBarriers);
+
+			ArenaParams arenaParams = {};
+			arenaParams.pName = "PhysicsJobs";
+			pArena = arenaCreate(&arenaParams);
+			if (!pArena)
+				return false;
+
+			PoolParams poolParams = {};
+			poolParams.chunkSize = sizeof(Job);
+			poolParams.chunkAlign = alignof(Job);
+			poolParams.flags = PoolFlag_ThreadMagazines;
+			pJobPool = poolCreate(pArena, &poolParams);
+			pJobs = pJobSystem;
+			return pJobPool != nullptr;
+		}
+
+		void Exit()
+		{
+			arenaRelease(pArena);
+			pArena = nullptr;
+			pJobPool = nullptr;
+		}
+
+		int GetMaxConcurrency() const override
+		{
+			return (int)jobSystemGetWorkerCount(pJobs) + 1;
+		}
+
+		JobHandle CreateJob(const char* inName, JPH::ColorArg inColor,
+							const JobFunction& inJobFunction,
+							JPH::uint32 inNumDependencies) override
+		{
+			void* pMemory = poolAlloc(pJobPool);
+			JPH_ASSERT(pMemory);
+
+			Job* pJob = new (pMemory) Job(inName, inColor, this, inJobFunction, inNumDependencies);
+			JobHandle handle(pJob);
+			if (inNumDependencies == 0)
+				QueueJob(pJob);
+			return handle;
+		}
+
+	protected:
+		void QueueJob(Job* inJob) override { QueueJobs(&inJob, 1); }
+
+		void QueueJobs(Job** inJobs, JPH::uint inNumJobs) override
+		{
+			JobDesc descs[16];
+			while (inNumJobs > 0)
+			{
+				uint32_t count = inNumJobs < 16 ? inNumJobs : 16;
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					// Released by runJoltJob once the job ran
+					inJobs[i]->AddRef();
+					descs[i] = {runJoltJob, inJobs[i], JobFlag_None};
+				}
+
+				jobRun(pJobs, descs, count, nullptr);
+				inJobs += count;
+				inNumJobs -= count;
+			}
+		}
+
+		void FreeJob(Job* inJob) override
+		{
+			inJob->~Job();
+			poolFree(pJobPool, inJob);
+		}
+
+	private:
+		static void runJoltJob(void* pData)
+		{
+			// A barrier may already have run it, Execute only runs a job once
+			Job* pJob = (Job*)pData;
+			pJob->Execute();
+			pJob->Release();
+		}
+
+		JobSystem* pJobs = nullptr;
+		Arena* pArena = nullptr;
+		Pool* pJobPool = nullptr;
+	};
+} // namespace
+
+///////////////////////////////////////////
+// Shared Jolt state
+
+/**
+	Jolt globals shared by every physics world.
+
+	Registered by the first createPhysicsWorld and unregistered with the
+	last world.
+*/
+struct PhysicsRuntime
+{
+	uint32_t worldCount;
+};
+
+static PhysicsRuntime gPhysicsRuntime = {};
+
+static bool acquirePhysicsRuntime()
+{
+	if (gPhysicsRuntime.worldCount++ > 0)
+		return true;
+
+	JPH::RegisterDefaultAllocator();
+	JPH::Factory::sInstance = new JPH::Factory();
+	JPH::RegisterTypes();
+	return true;
+}
+
+static void releasePhysicsRuntime()
+{
+	if (gPhysicsRuntime.worldCount == 0 || --gPhysicsRuntime.worldCount > 0)
+		return;
+
+	JPH::UnregisterTypes();
+	delete JPH::Factory::sInstance;
+	JPH::Factory::sInstance = nullptr;
+}
+
+///////////////////////////////////////////
+// World
+
+/**
+	Per body interpolation state, indexed by JPH::BodyID::GetIndex().
+*/
+struct PhysicsBodyState
+{
+	JPH::Quat prevRotation;
+	JPH::Quat rotation;
+	JPH::RVec3 prevPosition;
+	JPH::RVec3 position;
+	ecs_entity_t entity;
+	uint32_t movingSlot; ///< Index in PhysicsWorld::movingBodies, UINT32_MAX when at rest
+	bool writeback;		 ///< The next writeBackTransforms writes the entity's pose
+};
+
+struct PhysicsWorld
+{
+	JPH::PhysicsSystem system;
+	BPLayerInterfaceImpl broadPhaseLayers;
+	ObjectVsBroadPhaseLayerFilterImpl objectVsBroadPhaseFilter;
+	ObjectLayerPairFilterImpl objectPairFilter;
+	JPH::TempAllocatorImpl* pTempAllocator;
+	JoltJobSystem jobSystem;
+
+	ecs_world_t* pWorld;
+	ecs_query_t* pBodyQuery; ///< Cached TransformComponent and RigidBodyComponent query
+
+	JPH::Array<PhysicsBodyState> bodyStates;
+	JPH::Array<JPH::BodyID> movingBodies; ///< Bodies whose transforms are written back
+	JPH::BodyIDVector activeBodies;		  ///< Scratch for GetActiveBodies
+
+	float fixedTimeStep;
+	float accumulator;
+	uint32_t maxStepsPerFrame;
+	uint32_t collisionSteps;
+
+	PhysicsStats stats;
+};
+
+static void startMoving(PhysicsWorld* pPhysics, JPH::BodyID id)
+{
+	PhysicsBodyState& state = pPhysics->bodyStates[id.GetIndex()];
+	if (state.movingSlot != UINT32_MAX)
+		return;
+
+	state.movingSlot = (uint32_t)pPhysics->movingBodies.size();
+	pPhysics->movingBodies.push_back(id);
+}
+
+static void stopMoving(PhysicsWorld* pPhysics, JPH::BodyID id)
+{
+	PhysicsBodyState& state = pPhysics->bodyStates[id.GetIndex()];
+	uint32_t slot = state.movingSlot;
+	if (slot == UINT32_MAX)
+		return;
+
+	// Swap and pop, the moved body keeps its slot in sync
+	JPH::BodyID last = pPhysics->movingBodies.back();
+	pPhysics->movingBodies[slot] = last;
+	pPhysics->bodyStates[last.GetIndex()].movingSlot = slot;
+	pPhysics->movingBodies.pop_back();
+	state.movingSlot = UINT32_MAX;
+}
+
+static void setTransformPose(TransformComponent* pTransform, JPH::RVec3Arg position,
+							 JPH::QuatArg rotation)
+{
+	// Jolt's Euler angles are RotZ * RotY * RotX, the order TransformComponent uses
+	JPH::Vec3 euler = rotation.GetEulerAngles();
+	pTransform->position =
+		vec3((float)position.GetX(), (float)position.GetY(), (float)position.GetZ());
+	pTransform->rotation = vec3(euler.GetX(), euler.GetY(), euler.GetZ());
+	pTransform->dirty = true;
+}
+
+// Single entity path for teleports, the per frame writeback goes through the query
+static void writeTransform(PhysicsWorld* pPhysics, ecs_entity_t entity, JPH::RVec3Arg position,
+						   JPH::QuatArg rotation)
+{
+	TransformComponent* pTransform = ecs_get_mut(pPhysics->pWorld, entity, TransformComponent);
+	if (!pTransform)
+		return;
+
+	setTransformPose(pTransform, position, rotation);
+	ecs_modified(pPhysics->pWorld, entity, TransformComponent);
+}
+
+/**
+	Writes the interpolated pose of every flagged body into its entity.
+
+	Walks the cached body query table by table and writes through the
+	TransformComponent column, so there is no entity lookup per body.
+	Iterating marks the column of each visited table modified once, tables
+	without a flagged body are skipped and keep their change state.
+
+	@param flaggedCount Bodies with PhysicsBodyState::writeback set, ends the walk early
+
+	@return Number of transforms written
+*/
+static uint32_t writeBackTransforms(PhysicsWorld* pPhysics, float alpha, uint32_t flaggedCount)
+{
+	if (flaggedCount == 0)
+		return 0;
+
+	PhysicsBodyState* pStates = pPhysics->bodyStates.data();
+	uint32_t writtenCount = 0;
+
+	ecs_iter_t it = ecs_query_iter(pPhysics->pWorld, pPhysics->pBodyQuery);
+	while (ecs_query_next(&it))
+	{
+		TransformComponent* pTransforms = ecs_field(&it, TransformComponent, 0);
+		const RigidBodyComponent* pBodies = ecs_field(&it, RigidBodyComponent, 1);
+
+		uint32_t tableCount = 0;
+		for (int32_t i = 0; i < it.count; ++i)
+		{
+			JPH::BodyID id(pBodies[i].bodyId);
+			if (id.IsInvalid())
+				continue;
+
+			PhysicsBodyState& state = pStates[id.GetIndex()];
+			if (!state.writeback || state.entity != it.entities[i])
+				continue;
+
+			state.writeback = false;
+			JPH::RVec3 position =
+				state.prevPosition + (state.position - state.prevPosition) * alpha;
+			JPH::Quat rotation = state.prevRotation.SLERP(state.rotation, alpha);
+			setTransformPose(&pTransforms[i], position, rotation);
+			tableCount++;
+		}
+
+		if (tableCount == 0)
+			ecs_iter_skip(&it);
+
+		writtenCount += tableCount;
+		if (writtenCount == flaggedCount)
+		{
+			ecs_iter_fini(&it);
+			break;
+		}
+	}
+
+	return writtenCount;
+}
+
+PhysicsWorld* createPhysicsWorld(ecs_world_t* world, const PhysicsWorldDesc* pDesc)
+{
+	if (!world)
+		return nullptr;
+
+	if (!pDesc || !pDesc->pJobSystem)
+	{
+		LOGF(eERROR, "Physics: createPhysicsWorld needs a job system");
+		return nullptr;
+	}
+
+	PhysicsWorldDesc desc = *pDesc;
+	if (desc.maxBodies == 0)
+		desc.maxBodies = PHYSICS_DEFAULT_MAX_BODIES;
+	if (desc.maxBodyPairs == 0)
+		desc.maxBodyPairs = desc.maxBodies;
+	if (desc.maxContactConstraints == 0)
+		desc.maxContactConstraints = desc.maxBodies;
+	if (desc.maxStepsPerFrame == 0)
+		desc.maxStepsPerFrame = PHYSICS_DEFAULT_MAX_STEPS;
+	if (desc.collisionSteps == 0)
+		desc.collisionSteps = 1;
+	if (desc.tempAllocatorSize == 0)
+		desc.tempAllocatorSize = PHYSICS_DEFAULT_TEMP_ALLOCATOR_SIZE;
+	if (desc.fixedTimeStep <= 0.0f)
+		desc.fixedTimeStep = PHYSICS_DEFAULT_FIXED_TIMESTEP;
+
+	if (!acquirePhysicsRuntime())
+		return nullptr;
+
+	PhysicsWorld* pPhysics = tf_new(PhysicsWorld);
+	if (!pPhysics)
+	{
+		LOGF(eERROR, "Physics: Failed to allocate physics world");
+		releasePhysicsRuntime();
+		return nullptr;
+	}
+
+	if (!pPhysics->jobSystem.Init(desc.pJobSystem))
+	{
+		LOGF(eERROR, "Physics: Failed to create the job pool");
+		pPhysics->jobSystem.Exit();
+		tf_delete(pPhysics);
+		releasePhysicsRuntime();
+		return nullptr;
+	}
+
+	pPhysics->system.Init(desc.maxBodies, 0, desc.maxBodyPairs, desc.maxContactConstraints,
+						  pPhysics->broadPhaseLayers, pPhysics->objectVsBroadPhaseFilter,
+						  pPhysics->objectPairFilter);
+	// A set flag takes gravity as is, an all zero vector means no gravity
+	if (desc.customGravity)
+		pPhysics->system.SetGravity(JPH::Vec3(desc.gravity[0], desc.gravity[1], desc.gravity[2]));
+	else
+		pPhysics->system.SetGravity(JPH::Vec3(0.0f, PHYSICS_DEFAULT_GRAVITY_Y, 0.0f));
+
+	pPhysics->pTempAllocator = new JPH::TempAllocatorImpl(desc.tempAllocatorSize);
+	pPhysics->pWorld = world;
+	pPhysics->fixedTimeStep = desc.fixedTimeStep;
+	pPhysics->accumulator = 0.0f;
+	pPhysics->maxStepsPerFrame = desc.maxStepsPerFrame;
+	pPhysics->collisionSteps = desc.collisionSteps;
+	pPhysics->stats = {};
+
+	PhysicsBodyState emptyState = {};
+	emptyState.movingSlot = UINT32_MAX;
+	pPhysics->bodyStates.resize(desc.maxBodies, emptyState);
+	pPhysics->movingBodies.reserve(desc.maxBodies);
+	pPhysics->activeBodies.reserve(desc.maxBodies);
+
+	ECS_COMPONENT_DEFINE(world, RigidBodyComponent);
+
+	ecs_query_desc_t queryDesc = {};
+	queryDesc.terms[0].id = ecs_id(TransformComponent);
+	queryDesc.terms[0].inout = EcsInOut;
+	queryDesc.terms[1].id = ecs_id(RigidBodyComponent);
+	queryDesc.terms[1].inout = EcsIn;
+	queryDesc.cache_kind = EcsQueryCacheAuto;
+	pPhysics->pBodyQuery = ecs_query_init(world, &queryDesc);
+
+	return pPhysics;
+}
+
+void destroyPhysicsWorld(PhysicsWorld* pPhysics)
+{
+	if (!pPhysics)
+		return;
+
+	JPH::BodyIDVector bodies;
+	pPhysics->system.GetBodies(bodies);
+	JPH::BodyInterface& bodyInterface = pPhysics->system.GetBodyInterfaceNoLock();
+	if (!bodies.empty())
+	{
+		bodyInterface.RemoveBodies(bodies.data(), (int)bodies.size());
+		bodyInterface.DestroyBodies(bodies.data(), (int)bodies.size());
+	}
+
+	if (pPhysics->pBodyQuery)
+		ecs_query_fini(pPhysics->pBodyQuery);
+
+	delete pPhysics->pTempAllocator;
+	pPhysics->jobSystem.Exit();
+	tf_delete(pPhysics);
+
+	releasePhysicsRuntime();
+}
+
+void updatePhysicsWorld(PhysicsWorld* pPhysics, float deltaTime)
+{
+	if (!pPhysics)
+		return;
+
+	const float step = pPhysics->fixedTimeStep;
+	pPhysics->accumulator += deltaTime > 0.0f ? deltaTime : 0.0f;
+
+	uint32_t stepCount = (uint32_t)(pPhysics->accumulator / step);
+	if (stepCount > pPhysics->maxStepsPerFrame)
+	{
+		// Drop the backlog instead of simulating ever more steps per frame
+		stepCount = pPhysics->maxStepsPerFrame;
+		pPhysics->accumulator = step * (float)stepCount;
+	}
+	pPhysics->accumulator -= step * (float)stepCount;
+
+	const JPH::BodyInterface& bodyInterface = pPhysics->system.GetBodyInterfaceNoLock();
+	PhysicsBodyState* pStates = pPhysics->bodyStates.data();
+
+	for (uint32_t s = 0; s < stepCount; ++s)
+	{
+		// Bodies at rest already have prev == current
+		for (const JPH::BodyID& id : pPhysics->movingBodies)
+		{
+			PhysicsBodyState& state = pStates[id.GetIndex()];
+			state.prevPosition = state.position;
+			state.prevRotation = state.rotation;
+		}
+
+		pPhysics->system.Update(step, (int)pPhysics->collisionSteps, pPhysics->pTempAllocator,
+								&pPhysics->jobSystem);
+
+		// Bodies woken up by this step join the moving set, bodies that just
+		// fell asleep stay in it until the writeback below settles them
+		pPhysics->system.GetActiveBodies(JPH::EBodyType::RigidBody, pPhysics->activeBodies);
+		for (const JPH::BodyID& id : pPhysics->activeBodies)
+			startMoving(pPhysics, id);
+
+		for (const JPH::BodyID& id : pPhysics->movingBodies)
+		{
+			PhysicsBodyState& state = pStates[id.GetIndex()];
+			bodyInterface.GetPositionAndRotation(id, state.position, state.rotation);
+		}
+	}
+
+	const float alpha = pPhysics->accumulator / step;
+	uint32_t flaggedCount = 0;
+
+	for (uint32_t i = 0; i < (uint32_t)pPhysics->movingBodies.size();)
+	{
+		JPH::BodyID id = pPhysics->movingBodies[i];
+		PhysicsBodyState& state = pStates[id.GetIndex()];
+		state.writeback = true;
+		flaggedCount++;
+
+		if (!bodyInterface.IsActive(id))
+		{
+			// Settle on the final pose, written once more and then left alone
+			state.prevPosition = state.position;
+			state.prevRotation = state.rotation;
+			stopMoving(pPhysics, id);
+			continue;
+		}
+
+		++i;
+	}
+
+	uint32_t writebackCount = writeBackTransforms(pPhysics, alpha, flaggedCount);
+
+	pPhysics->stats.bodyCount = pPhysics->system.GetNumBodies();
+	pPhysics->stats.activeCount = (uint32_t)pPhysics->activeBodies.size();
+	pPhysics->stats.stepCount = stepCount;
+	pPhysics->stats.writebackCount = writebackCount;
+	pPhysics->stats.interpolation = alpha;
+}
+
+void getPhysicsStats(const PhysicsWorld* pPhysics, PhysicsStats* pOutStats)
+{
+	if (!pOutStats)
+		return;
+
+	*pOutStats = pPhysics ? pPhysics->stats : PhysicsStats{};
+}
+
+JPH::PhysicsSystem* getPhysicsSystem(PhysicsWorld* pPhysics)
+{
+	return pPhysics ? &pPhysics->system : nullptr;
+}
+
+///////////////////////////////////////////
+// Bodies
+
+static JPH::BodyID getBodyId(PhysicsWorld* pPhysics, ecs_entity_t entity)
+{
+	if (!pPhysics || !entity)
+		return JPH::BodyID();
+
+	const RigidBodyComponent* pBody = ecs_get(pPhysics->pWorld, entity, RigidBodyComponent);
+	return pBody ? JPH::BodyID(pBody->bodyId) : JPH::BodyID();
+}
+
+static JPH::ShapeRefC createShape(const RigidBodyDesc* pDesc)
+{
+	JPH::ShapeSettings::ShapeResult result;
+	switch (pDesc->shape)
+	{
+	case RigidBodyShape_Sphere:
+		result = JPH::SphereShapeSettings(pDesc->radius).Create();
+		break;
+	case RigidBodyShape_Capsule:
+		result = JPH::CapsuleShapeSettings(pDesc->halfHeight, pDesc->radius).Create();
+		break;
+	case RigidBodyShape_Box:
+	default:
+		result = JPH::BoxShapeSettings(
+					 JPH::Vec3(pDesc->halfExtents[0], pDesc->halfExtents[1], pDesc->halfExtents[2]))
+					 .Create();
+		break;
+	}
+
+	if (result.HasError())
+	{
+		LOGF(eERROR, "Physics: Failed to create shape: %s", result.GetError().c_str());
+		return nullptr;
+	}
+
+	return result.Get();
+}
+
+bool addRigidBody(PhysicsWorld* pPhysics, ecs_entity_t entity, const RigidBodyDesc* pDesc)
+{
+	if (!pPhysics || !entity || !pDesc)
+		return false;
+
+	ecs_world_t* world = pPhysics->pWorld;
+	const TransformComponent* pTransform = ecs_get(world, entity, TransformComponent);
+	if (!pTransform)
+	{
+		LOGF(eERROR, "Physics: Entity has no TransformComponent");
+		return false;
+	}
+	if (ecs_has(world, entity, RigidBodyComponent))
+	{
+		LOGF(eERROR, "Physics: Entity already has a rigid body");
+		return false;
+	}
+
+	JPH::ShapeRefC shape = createShape(pDesc);
+	if (!shape)
+		return false;
+
+	JPH::RVec3 position(pTransform->position.getX(), pTransform->position.getY(),
+						pTransform->position.getZ());
+	JPH::Quat rotation = JPH::Quat::sEulerAngles(JPH::Vec3(
+		pTransform->rotation.getX(), pTransform->rotation.getY(), pTransform->rotation.getZ()));
+
+	JPH::EMotionType motionType = (JPH::EMotionType)pDesc->motion;
+	JPH::ObjectLayer layer =
+		pDesc->motion == RigidBodyMotion_Static ? PhysicsLayer_Static : PhysicsLayer_Moving;
+
+	JPH::BodyCreationSettings settings(shape, position, rotation, motionType, layer);
+	settings.mUserData = (JPH::uint64)entity;
+	if (pDesc->friction > 0.0f)
+		settings.mFriction = pDesc->friction;
+	settings.mRestitution = pDesc->restitution;
+
+	JPH::BodyInterface& bodyInterface = pPhysics->system.GetBodyInterface();
+	JPH::EActivation activation = pDesc->motion != RigidBodyMotion_Static && !pDesc->startAsleep
+									  ? JPH::EActivation::Activate
+									  : JPH::EActivation::DontActivate;
+	JPH::BodyID id = bodyInterface.CreateAndAddBody(settings, activation);
+	if (id.IsInvalid())
+	{
+		LOGF(eERROR, "Physics: Out of bodies, raise PhysicsWorldDesc::maxBodies");
+		return false;
+	}
+
+	PhysicsBodyState& state = pPhysics->bodyStates[id.GetIndex()];
+	state.prevPosition = state.position = position;
+	state.prevRotation = state.rotation = rotation;
+	state.entity = entity;
+	state.movingSlot = UINT32_MAX;
+	state.writeback = false;
+
+	RigidBodyComponent body = {};
+	body.bodyId = id.GetIndexAndSequenceNumber();
+	body.motion = pDesc->motion;
+	ecs_set_ptr(world, entity, RigidBodyComponent, &body);
+
+	return true;
+}
+
+void removeRigidBody(PhysicsWorld* pPhysics, ecs_entity_t entity)
+{
+	JPH::BodyID id = getBodyId(pPhysics, entity);
+	if (id.IsInvalid())
+		return;
+
+	stopMoving(pPhysics, id);
+	pPhysics->bodyStates[id.GetIndex()].entity = 0;
+	pPhysics->bodyStates[id.GetIndex()].writeback = false;
+
+	JPH::BodyInterface& bodyInterface = pPhysics->system.GetBodyInterface();
+	bodyInterface.RemoveBody(id);
+	bodyInterface.DestroyBody(id);
+
+	ecs_remove(pPhysics->pWorld, entity, RigidBodyComponent);
+}
+
+void teleportRigidBody(PhysicsWorld* pPhysics, ecs_entity_t entity, const vec3& position,
+					   const vec3& rotation)
+{
+	JPH::BodyID id = getBodyId(pPhysics, entity);
+	if (id.IsInvalid())
+		return;
+
+	JPH::RVec3 bodyPosition(position.getX(), position.getY(), position.getZ());
+	JPH::Quat bodyRotation =
+		JPH::Quat::sEulerAngles(JPH::Vec3(rotation.getX(), rotation.getY(), rotation.getZ()));
+	pPhysics->system.GetBodyInterface().SetPositionAndRotation(id, bodyPosition, bodyRotation,
+															   JPH::EActivation::Activate);
+
+	// Both poses move, so the next writeback does not blend across the jump
+	PhysicsBodyState& state = pPhysics->bodyStates[id.GetIndex()];
+	state.prevPosition = state.position = bodyPosition;
+	state.prevRotation = state.rotation = bodyRotation;
+	writeTransform(pPhysics, entity, bodyPosition, bodyRotation);
+}
+
+vec3 getRigidBodyLinearVelocity(PhysicsWorld* pPhysics, ecs_entity_t entity)
+{
+	JPH::BodyID id = getBodyId(pPhysics, entity);
+	if (id.IsInvalid())
+		return vec3(0.0f, 0.0f, 0.0f);
+
+	JPH::Vec3 velocity = pPhysics->system.GetBodyInterface().GetLinearVelocity(id);
+	return vec3(velocity.GetX(), velocity.GetY(), velocity.GetZ());
+}
+
+void setRigidBodyLinearVelocity(PhysicsWorld* pPhysics, ecs_entity_t entity,
+								const vec3& velocity)
+{
+	JPH::BodyID id = getBodyId(pPhysics, entity);
+	if (id.IsInvalid())
+		return;
+
+	pPhysics->system.GetBodyInterface().SetLinearVelocity(
+		id, JPH::Vec3(velocity.getX(), velocity.getY(), velocity.getZ()));
+}
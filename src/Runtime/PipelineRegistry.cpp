@@ -0,0 +1,358 @@
+/*
+ * PipelineRegistry.cpp
+ *
+ */
+
+#include "Runtime/PipelineRegistry.h"
+#include "Runtime/Memory/Arena.h"
+#include "Core/HashedKey.h"
+#include "Graphics/Interfaces/IGraphics.h"
+#include "Utilities/Interfaces/IFileSystem.h"
+#include "Utilities/Interfaces/ILog.h"
+#include "Utilities/Interfaces/IMemory.h"
+
+#include <string.h>
+
+/**
+	Everything a pipeline is keyed on, flattened into one zeroed block.
+
+	Pointers in PipelineDesc are followed, only the vertex bindings and
+	attributes in use are copied, and the debug name is left out, so two
+	descriptions of the same state produce the same bytes.
+*/
+struct PipelineKey
+{
+	uint32_t type;
+	uint32_t renderTargetCount;
+	Shader* pShader;
+	uint32_t colorFormats[MAX_RENDER_TARGET_ATTACHMENTS];
+	uint32_t depthStencilFormat;
+	uint32_t sampleCount;
+	uint32_t sampleQuality;
+	uint32_t primitiveTopo;
+	uint32_t bindingCount;
+	uint32_t attribCount;
+	uint32_t bindings[MAX_VERTEX_BINDINGS][2]; ///< Stride, rate
+	uint32_t attribs[MAX_VERTEX_ATTRIBS][5];   ///< Semantic, format, binding, location, offset
+	uint32_t stateMask;						   ///< Which of the states below were given
+	BlendStateDesc blend;
+	DepthStateDesc depth;
+	RasterizerStateDesc rasterizer;
+};
+
+struct PipelineEntry
+{
+	PipelineKey key;
+	uint32_t hash; ///< hashString of key, checked before comparing keys
+	uint32_t refCount;
+	Pipeline* pPipeline;
+};
+
+struct PipelineRegistry
+{
+	Arena* pArena;
+	Renderer* pRenderer;
+	PipelineCache* pCache;
+	const char* pCacheFileName;
+	PipelineEntry* pEntries;
+	uint32_t entryCount;
+	PipelineRegistryStats stats;
+};
+
+static void buildPipelineKey(const PipelineDesc* pDesc, PipelineKey* pKey)
+{
+	memset(pKey, 0, sizeof(PipelineKey));
+	pKey->type = (uint32_t)pDesc->mType;
+
+	if (pDesc->mType == PIPELINE_TYPE_COMPUTE)
+	{
+		pKey->pShader = pDesc->mComputeDesc.pShaderProgram;
+		return;
+	}
+
+	const GraphicsPipelineDesc& graphics = pDesc->mGraphicsDesc;
+	pKey->pShader = graphics.pShaderProgram;
+	pKey->renderTargetCount = graphics.mRenderTargetCount;
+	for (uint32_t i = 0; i < graphics.mRenderTargetCount && graphics.pColorFormats; ++i)
+		pKey->colorFormats[i] = (uint32_t)graphics.pColorFormats[i];
+	pKey->depthStencilFormat = (uint32_t)graphics.mDepthStencilFormat;
+	pKey->sampleCount = (uint32_t)graphics.mSampleCount;
+	pKey->sampleQuality = graphics.mSampleQuality;
+	pKey->primitiveTopo = (uint32_t)graphics.mPrimitiveTopo;
+
+	if (const VertexLayout* pLayout = graphics.pVertexLayout)
+	{
+		pKey->bindingCount = pLayout->mBindingCount;
+		pKey->attribCount = pLayout->mAttribCount;
+		for (uint32_t i = 0; i < pLayout->mBindingCount; ++i)
+		{
+			pKey->bindings[i][0] = pLayout->mBindings[i].mStride;
+			pKey->bindings[i][1] = (uint32_t)pLayout->mBindings[i].mRate;
+		}
+		for (uint32_t i = 0; i < pLayout->mAttribCount; ++i)
+		{
+			const VertexAttrib& attrib = pLayout->mAttribs[i];
+			pKey->attribs[i][0] = (uint32_t)attrib.mSemantic;
+			pKey->attribs[i][1] = (uint32_t)attrib.mFormat;
+			pKey->attribs[i][2] = attrib.mBinding;
+			pKey->attribs[i][3] = attrib.mLocation;
+			pKey->attribs[i][4] = attrib.mOffset;
+		}
+	}
+
+	if (graphics.pBlendState)
+	{
+		pKey->stateMask |= 1u << 0;
+		pKey->blend = *graphics.pBlendState;
+	}
+	if (graphics.pDepthState)
+	{
+		pKey->stateMask |= 1u << 1;
+		pKey->depth = *graphics.pDepthState;
+	}
+	if (graphics.pRasterizerState)
+	{
+		pKey->stateMask |= 1u << 2;
+		pKey->rasterizer = *graphics.pRasterizerState;
+	}
+}
+
+static PipelineEntry* findPipelineEntry(PipelineRegistry* pRegistry, const Pipeline* pPipeline)
+{
+	for (uint32_t i = 0; i < pRegistry->entryCount; ++i)
+	{
+		if (pRegistry->pEntries[i].pPipeline == pPipeline)
+			return &pRegistry->pEntries[i];
+	}
+
+	return nullptr;
+}
+
+static void loadPipelineCache(PipelineRegistry* pRegistry)
+{
+	PipelineCacheDesc cacheDesc = {};
+
+	// A missing or unreadable file is a cold start, the driver fills an empty cache
+	void* pData = nullptr;
+	FileStream stream = {};
+	if (fsOpenStreamFromPath(RD_PIPELINE_CACHE, pRegistry->pCacheFileName, FM_READ, &stream))
+	{
+		ssize_t size = fsGetStreamFileSize(&stream);
+		pData = size > 0 ? tf_malloc((size_t)size) : nullptr;
+		if (pData && fsReadFromStream(&stream, pData, (size_t)size) == (size_t)size)
+		{
+			cacheDesc.pData = pData;
+			cacheDesc.mSize = (size_t)size;
+		}
+		fsCloseStream(&stream);
+	}
+
+	addPipelineCache(pRegistry->pRenderer, &cacheDesc, &pRegistry->pCache);
+	if (pRegistry->pCache && cacheDesc.pData)
+	{
+		pRegistry->stats.cacheLoadBytes = cacheDesc.mSize;
+		LOGF(eINFO, "PipelineRegistry: Loaded %zu byte pipeline cache '%s'", cacheDesc.mSize,
+			 pRegistry->pCacheFileName);
+	}
+
+	// The driver copies the initial data
+	tf_free(pData);
+}
+
+///////////////////////////////////////////
+// Lifecycle
+
+PipelineRegistry* createPipelineRegistry(Renderer* pRenderer, const char* pCacheFileName)
+{
+	if (!pRenderer)
+		return nullptr;
+
+	ArenaParams arenaParams = {};
+	arenaParams.pName = "Pipelines";
+	Arena* pArena = arenaCreate(&arenaParams);
+	if (!pArena)
+		return nullptr;
+
+	PipelineRegistry* pRegistry = arenaPushStruct<PipelineRegistry>(pArena);
+	PipelineEntry* pEntries =
+		arenaPushArray<PipelineEntry>(pArena, PIPELINE_REGISTRY_MAX_PIPELINES);
+	if (!pRegistry || !pEntries)
+	{
+		LOGF(eERROR, "PipelineRegistry: Failed to allocate the registry");
+		arenaRelease(pArena);
+		return nullptr;
+	}
+
+	pRegistry->pArena = pArena;
+	pRegistry->pRenderer = pRenderer;
+	pRegistry->pCacheFileName =
+		pCacheFileName ? pCacheFileName : PIPELINE_REGISTRY_DEFAULT_CACHE_FILE;
+	pRegistry->pEntries = pEntries;
+
+	loadPipelineCache(pRegistry);
+	return pRegistry;
+}
+
+void destroyPipelineRegistry(PipelineRegistry* pRegistry)
+{
+	if (!pRegistry)
+		return;
+
+	savePipelineCache(pRegistry);
+
+	for (uint32_t i = 0; i < pRegistry->entryCount; ++i)
+	{
+		PipelineEntry* pEntry = &pRegistry->pEntries[i];
+		if (pEntry->refCount > 0)
+			LOGF(eWARNING, "PipelineRegistry: Pipeline destroyed with %u references left",
+				 pEntry->refCount);
+		removePipeline(pRegistry->pRenderer, pEntry->pPipeline);
+	}
+
+	if (pRegistry->pCache)
+		removePipelineCache(pRegistry->pRenderer, pRegistry->pCache);
+
+	arenaRelease(pRegistry->pArena);
+}
+
+bool savePipelineCache(PipelineRegistry* pRegistry)
+{
+	if (!pRegistry || !pRegistry->pCache)
+		return false;
+
+	size_t size = 0;
+	getPipelineCacheData(pRegistry->pRenderer, pRegistry->pCache, &size, nullptr);
+	if (size == 0)
+		return false;
+
+	void* pData = tf_malloc(size);
+	if (!pData)
+		return false;
+
+	getPipelineCacheData(pRegistry->pRenderer, pRegistry->pCache, &size, pData);
+
+	bool saved = false;
+	FileStream stream = {};
+	if (fsOpenStreamFromPath(RD_PIPELINE_CACHE, pRegistry->pCacheFileName, FM_WRITE, &stream))
+	{
+		saved = fsWriteToStream(&stream, pData, size) == size;
+		fsCloseStream(&stream);
+	}
+
+	if (!saved)
+		LOGF(eWARNING, "PipelineRegistry: Failed to write pipeline cache '%s'",
+			 pRegistry->pCacheFileName);
+
+	tf_free(pData);
+	return saved;
+}
+
+///////////////////////////////////////////
+// Pipelines
+
+Pipeline* acquirePipeline(PipelineRegistry* pRegistry, const PipelineDesc* pDesc)
+{
+	if (!pRegistry || !pDesc)
+		return nullptr;
+
+	PipelineKey key;
+	buildPipelineKey(pDesc, &key);
+	uint32_t hash = hashString((const char*)&key, (uint32_t)sizeof(key));
+
+	for (uint32_t i = 0; i < pRegistry->entryCount; ++i)
+	{
+		PipelineEntry* pEntry = &pRegistry->pEntries[i];
+		if (pEntry->hash == hash && memcmp(&pEntry->key, &key, sizeof(key)) == 0)
+		{
+			if (pEntry->refCount == 0)
+				pRegistry->stats.unusedCount--;
+			pEntry->refCount++;
+			pRegistry->stats.hits++;
+			return pEntry->pPipeline;
+		}
+	}
+
+	if (pRegistry->entryCount == PIPELINE_REGISTRY_MAX_PIPELINES)
+	{
+		LOGF(eERROR, "PipelineRegistry: More than %u pipelines", PIPELINE_REGISTRY_MAX_PIPELINES);
+		return nullptr;
+	}
+
+	PipelineDesc desc = *pDesc;
+	desc.pCache = pRegistry->pCache;
+
+	Pipeline* pPipeline = nullptr;
+	addPipeline(pRegistry->pRenderer, &desc, &pPipeline);
+	if (!pPipeline)
+	{
+		LOGF(eERROR, "PipelineRegistry: Failed to create pipeline '%s'",
+			 pDesc->pName ? pDesc->pName : "unnamed");
+		return nullptr;
+	}
+
+	PipelineEntry* pEntry = &pRegistry->pEntries[pRegistry->entryCount++];
+	pEntry->key = key;
+	pEntry->hash = hash;
+	pEntry->refCount = 1;
+	pEntry->pPipeline = pPipeline;
+
+	pRegistry->stats.misses++;
+	pRegistry->stats.pipelineCount++;
+	return pPipeline;
+}
+
+void releasePipeline(PipelineRegistry* pRegistry, Pipeline* pPipeline)
+{
+	if (!pRegistry || !pPipeline)
+		return;
+
+	PipelineEntry* pEntry = findPipelineEntry(pRegistry, pPipeline);
+	if (!pEntry || pEntry->refCount == 0)
+	{
+		LOGF(eWARNING, "PipelineRegistry: Released a pipeline it does not hold");
+		return;
+	}
+
+	pEntry->refCount--;
+	if (pEntry->refCount == 0)
+		pRegistry->stats.unusedCount++;
+}
+
+uint32_t flushUnusedPipelines(PipelineRegistry* pRegistry)
+{
+	if (!pRegistry)
+		return 0;
+
+	// Swap remove, entries are only ever found by scanning
+	uint32_t removed = 0;
+	for (uint32_t i = 0; i < pRegistry->entryCount;)
+	{
+		PipelineEntry* pEntry = &pRegistry->pEntries[i];
+		if (pEntry->refCount > 0)
+		{
+			++i;
+			continue;
+		}
+
+		removePipeline(pRegistry->pRenderer, pEntry->pPipeline);
+		*pEntry = pRegistry->pEntries[--pRegistry->entryCount];
+		removed++;
+	}
+
+	pRegistry->stats.pipelineCount -= removed;
+	pRegistry->stats.unusedCount = 0;
+	return removed;
+}
+
+PipelineCache* getPipelineCache(PipelineRegistry* pRegistry)
+{
+	return pRegistry ? pRegistry->pCache : nullptr;
+}
+
+void getPipelineRegistryStats(const PipelineRegistry* pRegistry, PipelineRegistryStats* pOutStats)
+{
+	if (!pRegistry || !pOutStats)
+		return;
+
+	*pOutStats = pRegistry->stats;
+}
@@ -0,0 +1,311 @@
+/*
+ * Trace.cpp
+ */
+
+#include "Runtime/Trace.h"
+#include "Runtime/Memory/PlatformMemory.h"
+#include "Utilities/Interfaces/ILog.h"
+#include "Utilities/Threading/Atomics.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+static_assert((TRACE_RING_CAPACITY & (TRACE_RING_CAPACITY - 1)) == 0,
+			  "TRACE_RING_CAPACITY must be a power of 2");
+
+/**
+	Events of one thread.
+
+	Only the owning thread writes events and head. Readers copy the slots
+	below head and then check head again, a slot the writer may have
+	reused in the meantime is dropped.
+*/
+struct TraceRing
+{
+	tfrg_atomic64_t head;	 ///< Events ever written, the next one goes to head % capacity
+	tfrg_atomic64_t cleared; ///< head when traceClear ran, older events are not reported
+	const char* pThreadName;
+	TraceEvent events[TRACE_RING_CAPACITY];
+};
+
+// Rings are never freed, a thread's events stay dumpable after it exited
+static TraceRing* gTraceRings[TRACE_MAX_THREADS];
+static tfrg_atomic32_t gTraceRingCount = 0;
+static tfrg_atomic32_t gTraceEnabled = 1;
+
+static thread_local TraceRing* tpTraceRing = nullptr;
+static thread_local bool tTraceRingFailed = false;
+
+/**
+	Gets the calling thread's ring, creating it on the first scope.
+
+	Rings come straight from platform memory so that recording the arena
+	growth scope never allocates from an arena.
+*/
+static TraceRing* getThreadRing()
+{
+	if (tpTraceRing || tTraceRingFailed)
+		return tpTraceRing;
+
+	tTraceRingFailed = true;
+
+	uint32_t index = tfrg_atomic32_add_relaxed(&gTraceRingCount, 1);
+	if (index >= TRACE_MAX_THREADS)
+	{
+		LOGF(eWARNING, "Trace: More than %u threads, thread %u is not recorded", TRACE_MAX_THREADS,
+			 index);
+		return nullptr;
+	}
+
+	void* pMemory = platformReserveMemory(sizeof(TraceRing));
+	if (!pMemory || !platformCommitMemory(pMemory, sizeof(TraceRing)))
+	{
+		LOGF(eERROR, "Trace: Failed to allocate the ring of thread %u", index);
+		return nullptr;
+	}
+
+	// Committed pages are zeroed, head and cleared start at 0
+	TraceRing* pRing = (TraceRing*)pMemory;
+	tfrg_atomicptr_store_release((tfrg_atomicptr_t*)&gTraceRings[index], (uintptr_t)pRing);
+
+	tpTraceRing = pRing;
+	tTraceRingFailed = false;
+	return pRing;
+}
+
+uint64_t traceNowNs()
+{
+	// Offset from the first call, so 0 can mean "not recording" in traceBeginScope
+	static const std::chrono::steady_clock::time_point sEpoch =
+		std::chrono::steady_clock::now() - std::chrono::nanoseconds(1);
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+			   std::chrono::steady_clock::now() - sEpoch)
+		.count();
+}
+
+void traceSetEnabled(bool enabled)
+{
+	tfrg_atomic32_store_relaxed(&gTraceEnabled, enabled ? 1 : 0);
+}
+
+bool traceIsEnabled()
+{
+	return tfrg_atomic32_load_relaxed(&gTraceEnabled) != 0;
+}
+
+void traceSetThreadName(const char* pName)
+{
+	// Trace.h only includes Tracy when profiling is enabled
+#if ENGINE_PROFILE_ENABLED && defined(ENGINE_PROFILE_TRACY)
+	if (pName)
+		tracy::SetThreadName(pName);
+#endif
+
+	TraceRing* pRing = getThreadRing();
+	if (pRing)
+		tfrg_atomicptr_store_release((tfrg_atomicptr_t*)&pRing->pThreadName, (uintptr_t)pName);
+}
+
+const char* traceGetThreadName(uint32_t threadIndex)
+{
+	if (threadIndex >= TRACE_MAX_THREADS)
+		return nullptr;
+
+	TraceRing* pRing =
+		(TraceRing*)tfrg_atomicptr_load_acquire((tfrg_atomicptr_t*)&gTraceRings[threadIndex]);
+	if (!pRing)
+		return nullptr;
+	return (const char*)tfrg_atomicptr_load_acquire((tfrg_atomicptr_t*)&pRing->pThreadName);
+}
+
+uint64_t traceBeginScope()
+{
+	if (!tfrg_atomic32_load_relaxed(&gTraceEnabled))
+		return 0;
+	return traceNowNs();
+}
+
+void traceEndScope(const char* pName, uint64_t startNs)
+{
+	if (startNs == 0)
+		return;
+
+	TraceRing* pRing = getThreadRing();
+	if (!pRing)
+		return;
+
+	uint64_t head = tfrg_atomic64_load_relaxed(&pRing->head);
+	TraceEvent* pEvent = &pRing->events[head & (TRACE_RING_CAPACITY - 1)];
+	pEvent->pName = pName;
+	pEvent->startNs = startNs;
+	pEvent->endNs = traceNowNs();
+
+	tfrg_atomic64_store_release(&pRing->head, head + 1);
+}
+
+uint32_t traceSnapshot(TraceEvent* pEvents, uint32_t maxEvents)
+{
+	uint32_t ringCount = tfrg_atomic32_load_relaxed(&gTraceRingCount);
+	if (ringCount > TRACE_MAX_THREADS)
+		ringCount = TRACE_MAX_THREADS;
+
+	uint32_t count = 0;
+	for (uint32_t t = 0; t < ringCount; ++t)
+	{
+		TraceRing* pRing =
+			(TraceRing*)tfrg_atomicptr_load_acquire((tfrg_atomicptr_t*)&gTraceRings[t]);
+		if (!pRing)
+			continue;
+
+		// The slot after head is the one the writer fills next, it is never reported
+		uint64_t head = tfrg_atomic64_load_acquire(&pRing->head);
+		uint64_t first = head >= TRACE_RING_CAPACITY ? head + 1 - TRACE_RING_CAPACITY : 0;
+		uint64_t cleared = tfrg_atomic64_load_relaxed(&pRing->cleared);
+		if (first < cleared)
+			first = cleared;
+
+		if (!pEvents)
+		{
+			count += (uint32_t)(head - first);
+			continue;
+		}
+
+		uint32_t copyStart = count;
+		for (uint64_t e = first; e < head && count < maxEvents; ++e)
+		{
+			pEvents[count] = pRing->events[e & (TRACE_RING_CAPACITY - 1)];
+			pEvents[count].threadIndex = t;
+			count++;
+		}
+
+		// The writer may be filling slot newHead right now, which held newHead - capacity
+		uint64_t newHead = tfrg_atomic64_load_acquire(&pRing->head);
+		uint64_t validFirst = newHead + 1 > TRACE_RING_CAPACITY
+								  ? newHead + 1 - TRACE_RING_CAPACITY
+								  : 0;
+		if (validFirst > first)
+		{
+			uint32_t overwritten = (uint32_t)(validFirst - first);
+			uint32_t copied = count - copyStart;
+			if (overwritten > copied)
+				overwritten = copied;
+
+			memmove(&pEvents[copyStart], &pEvents[copyStart + overwritten],
+					(copied - overwritten) * sizeof(TraceEvent));
+			count -= overwritten;
+		}
+	}
+	return count;
+}
+
+void traceClear()
+{
+	uint32_t ringCount = tfrg_atomic32_load_relaxed(&gTraceRingCount);
+	if (ringCount > TRACE_MAX_THREADS)
+		ringCount = TRACE_MAX_THREADS;
+
+	for (uint32_t t = 0; t < ringCount; ++t)
+	{
+		TraceRing* pRing =
+			(TraceRing*)tfrg_atomicptr_load_acquire((tfrg_atomicptr_t*)&gTraceRings[t]);
+		if (pRing)
+			tfrg_atomic64_store_relaxed(&pRing->cleared,
+										tfrg_atomic64_load_acquire(&pRing->head));
+	}
+}
+
+// Names are literals but may still carry quotes or backslashes
+static void writeJsonString(FILE* pFile, const char* pText)
+{
+	fputc('"', pFile);
+	for (const char* c = pText ? pText : "?"; *c; ++c)
+	{
+		if (*c == '"' || *c == '\\')
+			fputc('\\', pFile);
+		if ((unsigned char)*c >= 0x20)
+			fputc(*c, pFile);
+	}
+	fputc('"', pFile);
+}
+
+bool traceWriteChromeJson(const char* pPath)
+{
+#if defined(ENGINE_PROFILE_TRACY)
+	LOGF(eWARNING, "Trace: Built with ENGINE_PROFILE_TRACY, capture %s from Tracy", pPath);
+	return false;
+#else
+	// Snapshot first, the file is written without holding up the recording threads
+	uint32_t capacity = traceSnapshot(nullptr, 0);
+	uint64_t bytes = (uint64_t)capacity * sizeof(TraceEvent);
+	TraceEvent* pEvents = capacity ? (TraceEvent*)platformReserveMemory(bytes) : nullptr;
+	if (capacity && (!pEvents || !platformCommitMemory(pEvents, bytes)))
+	{
+		LOGF(eERROR, "Trace: Failed to allocate %u events for %s", capacity, pPath);
+		if (pEvents)
+			platformReleaseMemory(pEvents, bytes);
+		return false;
+	}
+	uint32_t count = pEvents ? traceSnapshot(pEvents, capacity) : 0;
+
+	FILE* pFile = fopen(pPath, "w");
+	if (!pFile)
+	{
+		LOGF(eERROR, "Trace: Failed to open %s", pPath);
+		if (pEvents)
+			platformReleaseMemory(pEvents, bytes);
+		return false;
+	}
+
+	fprintf(pFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	uint32_t ringCount = tfrg_atomic32_load_relaxed(&gTraceRingCount);
+	if (ringCount > TRACE_MAX_THREADS)
+		ringCount = TRACE_MAX_THREADS;
+
+	bool first = true;
+	for (uint32_t t = 0; t < ringCount; ++t)
+	{
+		char defaultName[32];
+		const char* pName = traceGetThreadName(t);
+		if (!pName)
+		{
+			snprintf(defaultName, sizeof(defaultName), "Thread %u", t);
+			pName = defaultName;
+		}
+
+		fprintf(pFile,
+				"%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,"
+				"\"args\":{\"name\":",
+				first ? "" : ",\n", t);
+		writeJsonString(pFile, pName);
+		fprintf(pFile, "}}");
+		first = false;
+	}
+
+	// Chrome wants microseconds, fractions keep the nanosecond resolution
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const TraceEvent* pEvent = &pEvents[i];
+		fprintf(pFile, "%s{\"ph\":\"X\",\"name\":", first ? "" : ",\n");
+		writeJsonString(pFile, pEvent->pName);
+		fprintf(pFile, ",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", pEvent->threadIndex,
+				(double)pEvent->startNs / 1000.0,
+				(double)(pEvent->endNs - pEvent->startNs) / 1000.0);
+		first = false;
+	}
+
+	fprintf(pFile, "\n]}\n");
+	bool written = ferror(pFile) == 0;
+	fclose(pFile);
+
+	if (pEvents)
+		platformReleaseMemory(pEvents, bytes);
+
+	if (written)
+		LOGF(eINFO, "Trace: Wrote %u events of %u threads to %s", count, ringCount, pPath);
+	else
+		LOGF(eERROR, "Trace: Failed to write %s", pPath);
+	return written;
+#endif
+}
@@ -0,0 +1,316 @@
+/*
+ * MeshCooker.cpp
+ *
+ * Offline glTF -> .mesh converter
+ *
+ * Usage:
+ *   MeshCooker <input.gltf|input.glb> <output.mesh> [--normals] [--index32]
+ *
+ * Every triangle primitive in the default scene is flattened into one mesh
+ * with node transforms applied. The output is laid out as described by
+ * MeshFileHeader so the runtime can upload it without any parsing.
+ */
+
+#define CGLTF_IMPLEMENTATION
+#include "cgltf.h"
+
+#include "Runtime/MeshFormat.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+struct CookOptions
+{
+	uint32_t attributes; ///< MeshAttribute flags to write
+	bool forceIndex32;	 ///< Always write 32 bit indices
+};
+
+struct CookedMesh
+{
+	std::vector<float> vertices; ///< Interleaved vertex data
+	std::vector<uint32_t> indices;
+	uint32_t vertexCount;
+	float boundsMin[3];
+	float boundsMax[3];
+};
+
+static const cgltf_accessor* findAttribute(const cgltf_primitive* pPrimitive,
+										   cgltf_attribute_type type)
+{
+	for (cgltf_size i = 0; i < pPrimitive->attributes_count; ++i)
+	{
+		const cgltf_attribute* pAttribute = &pPrimitive->attributes[i];
+		if (pAttribute->type == type && pAttribute->index == 0)
+			return pAttribute->data;
+	}
+
+	return nullptr;
+}
+
+static void transformPoint(const float* m, const float* p, float* pOut)
+{
+	// cgltf matrices are column major
+	for (int r = 0; r < 3; ++r)
+		pOut[r] = m[0 + r] * p[0] + m[4 + r] * p[1] + m[8 + r] * p[2] + m[12 + r];
+}
+
+static void transformNormal(const float* m, const float* n, float* pOut)
+{
+	// Upper 3x3 only, fine for rotations and uniform scale
+	for (int r = 0; r < 3; ++r)
+		pOut[r] = m[0 + r] * n[0] + m[4 + r] * n[1] + m[8 + r] * n[2];
+
+	float length = sqrtf(pOut[0] * pOut[0] + pOut[1] * pOut[1] + pOut[2] * pOut[2]);
+	if (length > 0.0f)
+	{
+		pOut[0] /= length;
+		pOut[1] /= length;
+		pOut[2] /= length;
+	}
+}
+
+static bool appendPrimitive(CookedMesh* pMesh, const cgltf_primitive* pPrimitive,
+							const float* worldMatrix, const CookOptions* pOptions)
+{
+	if (pPrimitive->type != cgltf_primitive_type_triangles)
+		return true;
+
+	const cgltf_accessor* pPositions = findAttribute(pPrimitive, cgltf_attribute_type_position);
+	const cgltf_accessor* pNormals = findAttribute(pPrimitive, cgltf_attribute_type_normal);
+	const cgltf_accessor* pTexCoords = findAttribute(pPrimitive, cgltf_attribute_type_texcoord);
+	if (!pPositions)
+	{
+		fprintf(stderr, "MeshCooker: Skipping primitive without positions\n");
+		return true;
+	}
+
+	uint32_t baseVertex = pMesh->vertexCount;
+	uint32_t vertexCount = (uint32_t)pPositions->count;
+
+	for (uint32_t v = 0; v < vertexCount; ++v)
+	{
+		float position[3] = {};
+		float worldPosition[3] = {};
+		cgltf_accessor_read_float(pPositions, v, position, 3);
+		transformPoint(worldMatrix, position, worldPosition);
+
+		if (pOptions->attributes & MeshAttribute_Position)
+		{
+			pMesh->vertices.insert(pMesh->vertices.end(), worldPosition, worldPosition + 3);
+			for (int c = 0; c < 3; ++c)
+			{
+				pMesh->boundsMin[c] = fminf(pMesh->boundsMin[c], worldPosition[c]);
+				pMesh->boundsMax[c] = fmaxf(pMesh->boundsMax[c], worldPosition[c]);
+			}
+		}
+
+		if (pOptions->attributes & MeshAttribute_Normal)
+		{
+			float normal[3] = {0.0f, 1.0f, 0.0f};
+			float worldNormal[3] = {};
+			if (pNormals)
+				cgltf_accessor_read_float(pNormals, v, normal, 3);
+			transformNormal(worldMatrix, normal, worldNormal);
+			pMesh->vertices.insert(pMesh->vertices.end(), worldNormal, worldNormal + 3);
+		}
+
+		if (pOptions->attributes & MeshAttribute_TexCoord0)
+		{
+			float uv[2] = {};
+			if (pTexCoords)
+				cgltf_accessor_read_float(pTexCoords, v, uv, 2);
+			pMesh->vertices.insert(pMesh->vertices.end(), uv, uv + 2);
+		}
+	}
+
+	if (pPrimitive->indices)
+	{
+		for (cgltf_size i = 0; i < pPrimitive->indices->count; ++i)
+		{
+			uint32_t index = (uint32_t)cgltf_accessor_read_index(pPrimitive->indices, i);
+			pMesh->indices.push_back(baseVertex + index);
+		}
+	}
+	else
+	{
+		for (uint32_t i = 0; i < vertexCount; ++i)
+			pMesh->indices.push_back(baseVertex + i);
+	}
+
+	pMesh->vertexCount += vertexCount;
+	return true;
+}
+
+static bool cookNode(CookedMesh* pMesh, const cgltf_node* pNode, const CookOptions* pOptions)
+{
+	if (pNode->mesh)
+	{
+		float worldMatrix[16];
+		cgltf_node_transform_world(pNode, worldMatrix);
+
+		for (cgltf_size p = 0; p < pNode->mesh->primitives_count; ++p)
+		{
+			if (!appendPrimitive(pMesh, &pNode->mesh->primitives[p], worldMatrix, pOptions))
+				return false;
+		}
+	}
+
+	for (cgltf_size c = 0; c < pNode->children_count; ++c)
+	{
+		if (!cookNode(pMesh, pNode->children[c], pOptions))
+			return false;
+	}
+
+	return true;
+}
+
+static bool writePadding(FILE* pFile, uint64_t* pOffset)
+{
+	static const uint8_t zeros[MESH_FILE_ALIGNMENT] = {};
+	uint64_t padding = (MESH_FILE_ALIGNMENT - (*pOffset % MESH_FILE_ALIGNMENT)) % MESH_FILE_ALIGNMENT;
+	*pOffset += padding;
+	return fwrite(zeros, 1, (size_t)padding, pFile) == padding;
+}
+
+static bool writeMeshFile(const char* pPath, const CookedMesh* pMesh, const CookOptions* pOptions)
+{
+	bool index32 = pOptions->forceIndex32 || pMesh->vertexCount > 0xFFFF;
+
+	MeshFileHeader header = {};
+	header.magic = MESH_FILE_MAGIC;
+	header.version = MESH_FILE_VERSION;
+	header.attributes = pOptions->attributes;
+	header.vertexStride = meshAttributeStride(pOptions->attributes);
+	header.vertexCount = pMesh->vertexCount;
+	header.indexCount = (uint32_t)pMesh->indices.size();
+	header.indexSize = index32 ? sizeof(uint32_t) : sizeof(uint16_t);
+	memcpy(header.boundsMin, pMesh->boundsMin, sizeof(header.boundsMin));
+	memcpy(header.boundsMax, pMesh->boundsMax, sizeof(header.boundsMax));
+
+	uint64_t vertexBytes = (uint64_t)header.vertexCount * header.vertexStride;
+	uint64_t indexBytes = (uint64_t)header.indexCount * header.indexSize;
+
+	uint64_t offset = sizeof(MeshFileHeader);
+	offset += (MESH_FILE_ALIGNMENT - (offset % MESH_FILE_ALIGNMENT)) % MESH_FILE_ALIGNMENT;
+	header.vertexOffset = offset;
+	offset += vertexBytes;
+	offset += (MESH_FILE_ALIGNMENT - (offset % MESH_FILE_ALIGNMENT)) % MESH_FILE_ALIGNMENT;
+	header.indexOffset = offset;
+
+	FILE* pFile = fopen(pPath, "wb");
+	if (!pFile)
+	{
+		fprintf(stderr, "MeshCooker: Failed to open '%s' for writing\n", pPath);
+		return false;
+	}
+
+	bool ok = true;
+	uint64_t written = sizeof(MeshFileHeader);
+	ok = ok && fwrite(&header, sizeof(header), 1, pFile) == 1;
+	ok = ok && writePadding(pFile, &written);
+	ok = ok && fwrite(pMesh->vertices.data(), 1, (size_t)vertexBytes, pFile) == vertexBytes;
+	written += vertexBytes;
+	ok = ok && writePadding(pFile, &written);
+
+	if (index32)
+	{
+		ok = ok && fwrite(pMesh->indices.data(), 1, (size_t)indexBytes, pFile) == indexBytes;
+	}
+	else
+	{
+		std::vector<uint16_t> indices16(pMesh->indices.begin(), pMesh->indices.end());
+		ok = ok && fwrite(indices16.data(), 1, (size_t)indexBytes, pFile) == indexBytes;
+	}
+
+	fclose(pFile);
+
+	if (!ok)
+		fprintf(stderr, "MeshCooker: Failed to write '%s'\n", pPath);
+
+	return ok;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		fprintf(stderr,
+				"Usage: MeshCooker <input.gltf|input.glb> <output.mesh> [--normals] [--index32]\n");
+		return 1;
+	}
+
+	const char* pInputPath = argv[1];
+	const char* pOutputPath = argv[2];
+
+	CookOptions options = {};
+	options.attributes = MeshAttribute_Position | MeshAttribute_TexCoord0;
+	for (int i = 3; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--normals") == 0)
+			options.attributes |= MeshAttribute_Normal;
+		else if (strcmp(argv[i], "--index32") == 0)
+			options.forceIndex32 = true;
+		else
+			fprintf(stderr, "MeshCooker: Ignoring unknown option '%s'\n", argv[i]);
+	}
+
+	cgltf_options gltfOptions = {};
+	cgltf_data* pData = nullptr;
+	if (cgltf_parse_file(&gltfOptions, pInputPath, &pData) != cgltf_result_success)
+	{
+		fprintf(stderr, "MeshCooker: Failed to parse '%s'\n", pInputPath);
+		return 1;
+	}
+
+	if (cgltf_load_buffers(&gltfOptions, pData, pInputPath) != cgltf_result_success ||
+		cgltf_validate(pData) != cgltf_result_success)
+	{
+		fprintf(stderr, "MeshCooker: Failed to load buffers for '%s'\n", pInputPath);
+		cgltf_free(pData);
+		return 1;
+	}
+
+	CookedMesh mesh = {};
+	for (int c = 0; c < 3; ++c)
+	{
+		mesh.boundsMin[c] = FLT_MAX;
+		mesh.boundsMax[c] = -FLT_MAX;
+	}
+
+	// Without a scene, every root node is part of the mesh
+	bool ok = true;
+	const cgltf_scene* pScene = pData->scene;
+	if (!pScene && pData->scenes_count > 0)
+		pScene = &pData->scenes[0];
+	if (pScene)
+	{
+		for (cgltf_size n = 0; n < pScene->nodes_count && ok; ++n)
+			ok = cookNode(&mesh, pScene->nodes[n], &options);
+	}
+	else
+	{
+		for (cgltf_size n = 0; n < pData->nodes_count && ok; ++n)
+		{
+			if (!pData->nodes[n].parent)
+				ok = cookNode(&mesh, &pData->nodes[n], &options);
+		}
+	}
+
+	cgltf_free(pData);
+
+	if (!ok || mesh.vertexCount == 0)
+	{
+		fprintf(stderr, "MeshCooker: No triangle geometry found in '%s'\n", pInputPath);
+		return 1;
+	}
+
+	if (!writeMeshFile(pOutputPath, &mesh, &options))
+		return 1;
+
+	printf("MeshCooker: %s -> %s (%u vertices, %u indices, stride %u)\n", pInputPath, pOutputPath,
+		   mesh.vertexCount, (uint32_t)mesh.indices.size(), meshAttributeStride(options.attributes));
+	return 0;
+}